@@ -14,13 +14,20 @@ function getApiToken() {
   return localStorage.getItem("apiToken") || "";
 }
 
-function authFetch(url, options = {}) {
+// The device answers 429 with Retry-After when it is shedding load
+async function authFetch(url, options = {}, attempt = 0) {
   const headers = new Headers(options.headers || {});
   const token = getApiToken();
   if (token) {
     headers.set("X-API-Key", token);
   }
-  return fetch(url, { ...options, headers });
+  const resp = await fetch(url, { ...options, headers });
+  if (resp.status === 429 && attempt < 3) {
+    const retryAfter = parseInt(resp.headers.get("Retry-After") || "1", 10);
+    await new Promise((resolve) => setTimeout(resolve, Math.max(1, retryAfter) * 1000));
+    return authFetch(url, options, attempt + 1);
+  }
+  return resp;
 }
 
 /************************************************
@@ -236,7 +243,7 @@ function bindSpeedControl() {
     debounce(() => {
       const speed = sliderToSpeed(slider.value);
       number.value = speed;
-      apiSet("setSpeed", speed);
+      apiSet("param/speed", speed);
     }, 250)
   );
 
@@ -252,7 +259,7 @@ function bindSpeedControl() {
     debounce(() => {
       const speed = parseInt(number.value, 10);
       if (!isNaN(speed)) {
-        apiSet("setSpeed", speed);
+        apiSet("param/speed", speed);
       }
     }, 250)
   );
@@ -261,14 +268,17 @@ function bindSpeedControl() {
 /************************************************
  * Animation visibility
  ************************************************/
+// data-anim may list several animations, separated by spaces
 function updateAnimationVisibility(name) {
+  const shownFor = (el) => el.dataset.anim.split(" ").includes(name);
+
   document.querySelectorAll(".anim-group").forEach((group) => {
-    group.classList.toggle("active", group.dataset.anim === name);
+    group.classList.toggle("active", shownFor(group));
   });
 
   document.querySelectorAll("[data-anim]").forEach((el) => {
     if (el.classList.contains("anim-group")) return;
-    el.style.display = el.dataset.anim === name ? "" : "none";
+    el.style.display = shownFor(el) ? "" : "none";
   });
 }
 
@@ -330,39 +340,66 @@ async function loadLifeRules() {
     select.appendChild(option);
   });
   select.value = data.current;
-  select.addEventListener("change", () => apiSet("setLifeRule", select.value));
+  select.addEventListener("change", () => apiSet("param/lifeRule", select.value));
 }
 
 async function loadSettings() {
-  const values = await Promise.all([
-    fetchText("/api/getBrightness", "30"),
-    fetchText("/api/getFadeAmount", "20"),
-    fetchText("/api/getTailLength", "3"),
-    fetchText("/api/getSpawnRate", "0.2"),
-    fetchText("/api/getMaxFlakes", "50"),
-    fetchText("/api/getSpeed", "30"),
-    fetchText("/api/getPanelCount", "2"),
-    fetchText("/api/getRotation?panel=PANEL1", "90"),
-    fetchText("/api/getRotation?panel=PANEL2", "90"),
-    fetchText("/api/getRotation?panel=PANEL3", "90"),
-    fetchText("/api/getPanelOrder", "left"),
-    fetchText("/api/getLifeDensity", "33"),
-    fetchText("/api/getLifeStagnation", "45"),
-    fetchText("/api/getLifeWrap", "1"),
-    fetchText("/api/getLifeColorMode", "0"),
-    fetchText("/api/getAntRule", "LR"),
-    fetchText("/api/getAntCount", "1"),
-    fetchText("/api/getAntSteps", "8"),
-    fetchText("/api/getAntWrap", "1"),
-    fetchText("/api/getCarpetDepth", "4"),
-    fetchText("/api/getCarpetShift", "2"),
-    fetchText("/api/getCarpetInvert", "0"),
-    fetchText("/api/getFireworkMax", "10"),
-    fetchText("/api/getFireworkParticles", "40"),
-    fetchText("/api/getFireworkGravity", "0.15"),
-    fetchText("/api/getFireworkLaunch", "0.15"),
-    fetchText("/api/getRainbowHueScale", "4")
-  ]);
+  // One bulk read; the server only admits a few reads at a time, and a
+  // request per setting would come back 429 and fall back to defaults
+  const params = {};
+  try {
+    const res = await authFetch("/api/params");
+    if (!res.ok) throw new Error("HTTP " + res.status);
+    const list = await res.json();
+    list.forEach((p) => {
+      if (p.value !== undefined) params[p.name] = p.value;
+    });
+  } catch (err) {
+    log("Failed to load settings: " + err.message);
+    return;
+  }
+  const param = (name, fallback) => (name in params ? params[name] : fallback);
+  const panelCountText = await fetchText("/api/getPanelCount", "2");
+
+  const values = [
+    param("brightness", "30"),
+    param("fadeAmount", "20"),
+    param("tailLength", "3"),
+    param("spawnRate", "0.2"),
+    param("maxFlakes", "50"),
+    param("speed", "30"),
+    panelCountText,
+    param("rotation1", "90"),
+    param("rotation2", "90"),
+    param("rotation3", "90"),
+    param("panelOrder", "left"),
+    param("lifeDensity", "33"),
+    param("lifeStagnation", "45"),
+    param("lifeWrap", "1"),
+    param("lifeColorMode", "0"),
+    param("antRule", "LR"),
+    param("antCount", "1"),
+    param("antSteps", "8"),
+    param("antWrap", "1"),
+    param("carpetDepth", "4"),
+    param("carpetShift", "2"),
+    param("carpetInvert", "0"),
+    param("fireworkMax", "10"),
+    param("fireworkParticles", "40"),
+    param("fireworkGravity", "0.15"),
+    param("fireworkLaunch", "0.15"),
+    param("rainbowHueScale", "4"),
+    param("transitionMs", "800"),
+    param("transitionWipe", "0"),
+    param("transitionCurve", "1"),
+    param("randomSeed", "0"),
+    param("textMessage", "Hello"),
+    param("textMode", "0"),
+    param("textFont", "0"),
+    param("textSpeed", "12"),
+    param("gamma", "2.2"),
+    param("dither", "1")
+  ];
 
   const [
     brightness,
@@ -391,7 +428,17 @@ async function loadSettings() {
     fireworkParticles,
     fireworkGravity,
     fireworkLaunch,
-    rainbowHueScale
+    rainbowHueScale,
+    transitionMs,
+    transitionWipe,
+    transitionCurve,
+    randomSeed,
+    textMessage,
+    textMode,
+    textFont,
+    textSpeed,
+    gamma,
+    dither
   ] = values;
 
   let panelCountValue = panelCount;
@@ -407,6 +454,8 @@ async function loadSettings() {
   }
 
   setRangePair("sliderBrightness", "numBrightness", brightness);
+  setRangePair("gamma", "gammaVal", gamma);
+  setToggle("dither", dither === "1" || dither === "true");
   setRangePair("sliderFade", "numFade", fade);
   setRangePair("sliderTail", "numTail", tail);
   setRangePair("sliderSpawn", "numSpawn", spawn);
@@ -444,6 +493,19 @@ async function loadSettings() {
   setRangePair("fireworkLaunch", "fireworkLaunchVal", fireworkLaunch);
 
   setRangePair("rainbowHueScale", "rainbowHueScaleVal", rainbowHueScale);
+
+  setRangePair("transitionMs", "transitionMsVal", transitionMs);
+  setSelect("transitionWipe", transitionWipe);
+  setSelect("transitionCurve", transitionCurve);
+
+  const randomSeedInput = document.getElementById("randomSeed");
+  if (randomSeedInput) randomSeedInput.value = parseInt(randomSeed, 10) || 0;
+
+  const textMessageInput = document.getElementById("textMessage");
+  if (textMessageInput) textMessageInput.value = textMessage;
+  setSelect("textMode", textMode);
+  setSelect("textFont", textFont);
+  setRangePair("textSpeed", "textSpeedVal", textSpeed);
 }
 
 async function refreshConnectionStatus() {
@@ -487,15 +549,24 @@ function setupControls() {
   bindRangePair({
     sliderId: "sliderBrightness",
     numberId: "numBrightness",
-    api: "setBrightness",
+    api: "param/brightness",
     min: 0,
     max: 255
   });
+  bindRangePair({
+    sliderId: "gamma",
+    numberId: "gammaVal",
+    api: "param/gamma",
+    min: 1,
+    max: 3,
+    float: true
+  });
+  bindToggle("dither", "param/dither");
 
   bindRangePair({
     sliderId: "sliderFade",
     numberId: "numFade",
-    api: "setFadeAmount",
+    api: "param/fadeAmount",
     min: 0,
     max: 255
   });
@@ -503,7 +574,7 @@ function setupControls() {
   bindRangePair({
     sliderId: "sliderTail",
     numberId: "numTail",
-    api: "setTailLength",
+    api: "param/tailLength",
     min: 1,
     max: 30
   });
@@ -511,7 +582,7 @@ function setupControls() {
   bindRangePair({
     sliderId: "sliderSpawn",
     numberId: "numSpawn",
-    api: "setSpawnRate",
+    api: "param/spawnRate",
     min: 0,
     max: 1,
     float: true
@@ -520,7 +591,7 @@ function setupControls() {
   bindRangePair({
     sliderId: "sliderMaxFlakes",
     numberId: "numMaxFlakes",
-    api: "setMaxFlakes",
+    api: "param/maxFlakes",
     min: 10,
     max: 500
   });
@@ -549,7 +620,7 @@ function setupControls() {
   if (btnPanelOrder) {
     btnPanelOrder.addEventListener("click", () => {
       const order = document.getElementById("panelOrder").value;
-      apiSet("setPanelOrder", order);
+      apiSet("param/panelOrder", order);
     });
   }
 
@@ -573,7 +644,7 @@ function setupControls() {
   if (btnRotatePanel1) {
     btnRotatePanel1.addEventListener("click", () => {
       const angle = document.getElementById("rotatePanel1").value;
-      apiSet("rotatePanel1", angle);
+      apiSet("param/rotation1", angle);
     });
   }
 
@@ -581,7 +652,7 @@ function setupControls() {
   if (btnRotatePanel2) {
     btnRotatePanel2.addEventListener("click", () => {
       const angle = document.getElementById("rotatePanel2").value;
-      apiSet("rotatePanel2", angle);
+      apiSet("param/rotation2", angle);
     });
   }
 
@@ -589,7 +660,7 @@ function setupControls() {
   if (btnRotatePanel3) {
     btnRotatePanel3.addEventListener("click", () => {
       const angle = document.getElementById("rotatePanel3").value;
-      apiSet("rotatePanel3", angle);
+      apiSet("param/rotation3", angle);
     });
   }
 
@@ -597,19 +668,19 @@ function setupControls() {
   bindRangePair({
     sliderId: "lifeDensity",
     numberId: "lifeDensityVal",
-    api: "setLifeDensity",
+    api: "param/lifeDensity",
     min: 0,
     max: 100
   });
   bindRangePair({
     sliderId: "lifeStagnation",
     numberId: "lifeStagnationVal",
-    api: "setLifeStagnation",
+    api: "param/lifeStagnation",
     min: 5,
     max: 250
   });
-  bindSelect("lifeColorMode", "setLifeColorMode");
-  bindToggle("lifeWrap", "setLifeWrap");
+  bindSelect("lifeColorMode", "param/lifeColorMode");
+  bindToggle("lifeWrap", "param/lifeWrap");
 
   const lifeReseed = document.getElementById("lifeReseed");
   if (lifeReseed) {
@@ -617,59 +688,59 @@ function setupControls() {
   }
 
   // Ant controls
-  bindText("antRule", "setAntRule");
+  bindText("antRule", "param/antRule");
   bindRangePair({
     sliderId: "antCount",
     numberId: "antCountVal",
-    api: "setAntCount",
+    api: "param/antCount",
     min: 1,
     max: 6
   });
   bindRangePair({
     sliderId: "antSteps",
     numberId: "antStepsVal",
-    api: "setAntSteps",
+    api: "param/antSteps",
     min: 1,
     max: 50
   });
-  bindToggle("antWrap", "setAntWrap");
+  bindToggle("antWrap", "param/antWrap");
 
   // Carpet controls
   bindRangePair({
     sliderId: "carpetDepth",
     numberId: "carpetDepthVal",
-    api: "setCarpetDepth",
+    api: "param/carpetDepth",
     min: 1,
     max: 6
   });
   bindRangePair({
     sliderId: "carpetShift",
     numberId: "carpetShiftVal",
-    api: "setCarpetShift",
+    api: "param/carpetShift",
     min: 1,
     max: 20
   });
-  bindToggle("carpetInvert", "setCarpetInvert");
+  bindToggle("carpetInvert", "param/carpetInvert");
 
   // Firework controls
   bindRangePair({
     sliderId: "fireworkMax",
     numberId: "fireworkMaxVal",
-    api: "setFireworkMax",
+    api: "param/fireworkMax",
     min: 1,
     max: 25
   });
   bindRangePair({
     sliderId: "fireworkParticles",
     numberId: "fireworkParticlesVal",
-    api: "setFireworkParticles",
+    api: "param/fireworkParticles",
     min: 10,
     max: 120
   });
   bindRangePair({
     sliderId: "fireworkGravity",
     numberId: "fireworkGravityVal",
-    api: "setFireworkGravity",
+    api: "param/fireworkGravity",
     min: 0.01,
     max: 0.5,
     float: true
@@ -677,7 +748,7 @@ function setupControls() {
   bindRangePair({
     sliderId: "fireworkLaunch",
     numberId: "fireworkLaunchVal",
-    api: "setFireworkLaunch",
+    api: "param/fireworkLaunch",
     min: 0.01,
     max: 1,
     float: true
@@ -687,10 +758,36 @@ function setupControls() {
   bindRangePair({
     sliderId: "rainbowHueScale",
     numberId: "rainbowHueScaleVal",
-    api: "setRainbowHueScale",
+    api: "param/rainbowHueScale",
     min: 1,
     max: 12
   });
+
+  // Transitions
+  bindRangePair({
+    sliderId: "transitionMs",
+    numberId: "transitionMsVal",
+    api: "param/transitionMs",
+    min: 0,
+    max: 5000
+  });
+  bindSelect("transitionWipe", "param/transitionWipe");
+  bindSelect("transitionCurve", "param/transitionCurve");
+
+  // Deterministic mode
+  bindText("randomSeed", "param/randomSeed");
+
+  // Text
+  bindText("textMessage", "param/textMessage");
+  bindSelect("textMode", "param/textMode");
+  bindSelect("textFont", "param/textFont");
+  bindRangePair({
+    sliderId: "textSpeed",
+    numberId: "textSpeedVal",
+    api: "param/textSpeed",
+    min: 1,
+    max: 100
+  });
 }
 
 /************************************************
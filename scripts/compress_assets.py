@@ -0,0 +1,188 @@
+# File: compress_assets.py
+# PlatformIO pre-build script: stages data/ for the filesystem image.
+#
+# Text assets (html/js/css/svg) are gzipped and stored only as "<name>.gz";
+# everything else is copied unchanged. A manifest (/etags.txt) lists every
+# served path with a strong ETag taken from the uncompressed content, which
+# StaticAssets loads at boot. References to js/css inside HTML get a
+# "?v=<etag>" suffix so those files can be cached as immutable.
+#
+# The same files are packed into assets.bin for the memory-mapped "assets"
+# partition (format documented in src/AssetBundle.h); flash it with
+#   pio run -t uploadassets
+# The manifest and the bundle carry the same build stamp (newest source
+# mtime, or SOURCE_DATE_EPOCH), so the firmware can serve whichever of the
+# two was flashed from newer sources.
+#
+# Can also be run by hand:  python scripts/compress_assets.py data out_dir [bundle]
+# The bundle defaults to assets.bin next to out_dir, never inside it, so it
+# does not end up in the filesystem image.
+
+import gzip
+import hashlib
+import os
+import re
+import shutil
+import struct
+import sys
+
+COMPRESS_EXT = (".html", ".htm", ".js", ".css", ".svg")
+MANIFEST = "etags.txt"
+BUNDLE = "assets.bin"
+BUNDLE_PATH_SIZE = 40
+BUNDLE_ETAG_SIZE = 16
+BUNDLE_ENTRY = struct.Struct("<%ds%dsII" % (BUNDLE_PATH_SIZE, BUNDLE_ETAG_SIZE))
+BUNDLE_HEADER = struct.Struct("<4sIII")
+REF_RE = re.compile(r'((?:src|href)=")(/[^"?#]+\.(?:js|css))(")')
+
+
+def etag_of(data):
+    return hashlib.sha1(data).hexdigest()[:16]
+
+
+def collect(src_dir):
+    files = {}
+    for root, _, names in os.walk(src_dir):
+        for name in sorted(names):
+            full = os.path.join(root, name)
+            rel = "/" + os.path.relpath(full, src_dir).replace(os.sep, "/")
+            with open(full, "rb") as f:
+                files[rel] = f.read()
+    return files
+
+
+def build_stamp(src_dir):
+    # Stable between rebuilds of unchanged sources, larger after any edit
+    if os.environ.get("SOURCE_DATE_EPOCH"):
+        return int(os.environ["SOURCE_DATE_EPOCH"]) & 0xFFFFFFFF
+    newest = 0
+    for root, _, names in os.walk(src_dir):
+        for name in names:
+            newest = max(newest, int(os.path.getmtime(os.path.join(root, name))))
+    return newest & 0xFFFFFFFF
+
+
+def stage_assets(src_dir, dst_dir, stamp):
+    files = collect(src_dir)
+
+    # js/css first so HTML can reference their final ETags
+    etags = {}
+    for path, data in files.items():
+        if not path.endswith((".html", ".htm")):
+            etags[path] = etag_of(data)
+
+    def bust(match):
+        path = match.group(2)
+        if path not in etags:
+            return match.group(0)
+        return match.group(1) + path + "?v=" + etags[path] + match.group(3)
+
+    for path in list(files):
+        if path.endswith((".html", ".htm")):
+            text = files[path].decode("utf-8")
+            files[path] = REF_RE.sub(bust, text).encode("utf-8")
+            etags[path] = etag_of(files[path])
+
+    if os.path.isdir(dst_dir):
+        shutil.rmtree(dst_dir)
+    os.makedirs(dst_dir)
+
+    entries = []
+    raw_total = 0
+    out_total = 0
+    for path in sorted(files):
+        data = files[path]
+        compress = path.endswith(COMPRESS_EXT)
+        out = data
+        out_path = path
+        if compress:
+            # mtime=0 keeps the output byte-identical between builds
+            out = gzip.compress(data, compresslevel=9, mtime=0)
+            out_path = path + ".gz"
+        target = os.path.join(dst_dir, out_path.lstrip("/"))
+        os.makedirs(os.path.dirname(target), exist_ok=True)
+        with open(target, "wb") as f:
+            f.write(out)
+        entries.append((path, etags[path], compress))
+        raw_total += len(data)
+        out_total += len(out)
+
+    with open(os.path.join(dst_dir, MANIFEST), "w") as f:
+        f.write("#build %d\n" % stamp)
+        for path, etag, compress in entries:
+            f.write("%s %s %d\n" % (path, etag, 1 if compress else 0))
+
+    print("compress_assets: %d files, %d -> %d bytes" % (len(entries), raw_total, out_total))
+    return entries
+
+
+def pack_bundle(stage_dir, entries, out_file, stamp):
+    # Entries are sorted by path (byte order) so the firmware can bisect
+    blobs = []
+    for path, etag, compress in sorted(entries):
+        if len(path) >= BUNDLE_PATH_SIZE:
+            raise ValueError("asset path too long for bundle: " + path)
+        name = path + ".gz" if compress else path
+        with open(os.path.join(stage_dir, name.lstrip("/")), "rb") as f:
+            blobs.append((path, etag, compress, f.read()))
+
+    offset = BUNDLE_HEADER.size + BUNDLE_ENTRY.size * len(blobs)
+    index = b""
+    data = b""
+    for path, etag, compress, blob in blobs:
+        pad = (-(offset + len(data))) % 4
+        data += b"\0" * pad
+        length = len(blob) | (0x80000000 if compress else 0)
+        index += BUNDLE_ENTRY.pack(path.encode(), etag.encode(), offset + len(data), length)
+        data += blob
+
+    total = offset + len(data)
+    with open(out_file, "wb") as f:
+        f.write(BUNDLE_HEADER.pack(b"WAB1", len(blobs), total, stamp))
+        f.write(index)
+        f.write(data)
+    print("compress_assets: bundle %s, %d bytes" % (out_file, total))
+    return total
+
+
+def partition_offset(csv_path, label):
+    with open(csv_path) as f:
+        for line in f:
+            cols = [c.strip() for c in line.split("#")[0].split(",")]
+            if len(cols) >= 5 and cols[0] == label:
+                return int(cols[3], 0), int(cols[4], 0)
+    raise ValueError("partition '%s' not found in %s" % (label, csv_path))
+
+
+if __name__ == "__main__" and len(sys.argv) in (3, 4):
+    out_dir = os.path.normpath(sys.argv[2])
+    bundle = sys.argv[3] if len(sys.argv) == 4 else os.path.join(os.path.dirname(out_dir), BUNDLE)
+    stamp = build_stamp(sys.argv[1])
+    staged = stage_assets(sys.argv[1], out_dir, stamp)
+    pack_bundle(out_dir, staged, bundle, stamp)
+else:
+    Import("env")  # noqa: F821 (provided by PlatformIO)
+    src = env.subst("$PROJECT_DATA_DIR")  # noqa: F821
+    build = os.path.join(env.subst("$PROJECT_BUILD_DIR"), env.subst("$PIOENV"))  # noqa: F821
+    dst = os.path.join(build, "data_gz")
+    bundle = os.path.join(build, BUNDLE)
+    stamp = build_stamp(src)
+    staged = stage_assets(src, dst, stamp)
+    size = pack_bundle(dst, staged, bundle, stamp)
+    env.Replace(PROJECT_DATA_DIR=dst)  # noqa: F821
+
+    part_csv = os.path.join(env.subst("$PROJECT_DIR"), env.GetProjectOption("board_build.partitions"))  # noqa: F821
+    part_offset, part_size = partition_offset(part_csv, "assets")
+    if size > part_size:
+        raise ValueError("asset bundle (%d bytes) does not fit the assets partition (%d bytes)" % (size, part_size))
+
+    env.AddCustomTarget(  # noqa: F821
+        name="uploadassets",
+        dependencies=None,
+        actions=[
+            '"$PYTHONEXE" "$UPLOADER" --chip esp32s3 --port "$UPLOAD_PORT" --baud $UPLOAD_SPEED '
+            'write_flash 0x%x "%s"' % (part_offset, bundle)
+        ],
+        title="Upload web assets",
+        description="Flash the web asset bundle into the assets partition",
+    )
@@ -0,0 +1,106 @@
+// File: AccumBuffer.cpp
+// 16-bit-per-channel accumulation buffer for additive effects
+
+#include "AccumBuffer.h"
+#include <esp_heap_caps.h>
+
+// Lane value >> 4 (whole 8-bit steps, up to about 8x white) -> output
+static const int TONE_MAP_SIZE = 2048;
+static uint8_t TONE_MAP[TONE_MAP_SIZE];
+static bool toneMapBuilt = false;
+
+AccumBuffer::AccumBuffer()
+    : _pixels(nullptr)
+    , _count(0)
+{
+    if (!toneMapBuilt) {
+        buildToneMap();
+    }
+}
+
+AccumBuffer::~AccumBuffer() {
+    release();
+}
+
+// Identity up to KNEE, then x / (x + c) scaled to reach 255 at the top of
+// the range, with c chosen so the slope is 1 at the knee and the curve has
+// no visible kink
+void AccumBuffer::buildToneMap() {
+    const float headroom = 255.0f - KNEE;
+    const float range = (float)(TONE_MAP_SIZE - 1) - KNEE;
+    const float c = headroom * range / (range - headroom);
+    const float norm = (range + c) / range;
+    for (int i = 0; i < TONE_MAP_SIZE; i++) {
+        // Centre of the bucket, so dropping the fraction does not bias down
+        float v = i + 0.5f;
+        float out = v;
+        if (v > KNEE) {
+            float x = v - KNEE;
+            out = KNEE + headroom * norm * x / (x + c);
+        }
+        TONE_MAP[i] = out >= 255.0f ? 255 : (uint8_t)out;
+    }
+    toneMapBuilt = true;
+}
+
+bool AccumBuffer::resize(uint16_t count) {
+    if (count == _count) {
+        return _pixels != nullptr || count == 0;
+    }
+    uint64_t* pixels = nullptr;
+    if (count > 0) {
+        const size_t bytes = sizeof(uint64_t) * count;
+        pixels = (uint64_t*)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!pixels) {
+            pixels = (uint64_t*)heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+        }
+        if (!pixels) {
+            Serial.println("AccumBuffer: Failed to allocate buffer");
+            release();
+            return false;
+        }
+        const uint16_t kept = count < _count ? count : _count;
+        if (kept) {
+            memcpy(pixels, _pixels, sizeof(uint64_t) * kept);
+        }
+        memset(pixels + kept, 0, sizeof(uint64_t) * (count - kept));
+    }
+    release();
+    _pixels = pixels;
+    _count = count;
+    return true;
+}
+
+void AccumBuffer::release() {
+    if (_pixels) {
+        heap_caps_free(_pixels);
+        _pixels = nullptr;
+    }
+    _count = 0;
+}
+
+void AccumBuffer::clear() {
+    if (_pixels) {
+        memset(_pixels, 0, bytes());
+    }
+}
+
+// Even lanes (r, b) and odd lanes (g, unused) are scaled separately so
+// each product has 32 bits of room: 0x7FFF * 255 < 2^23
+void AccumBuffer::fade(uint8_t scale) {
+    for (uint16_t i = 0; i < _count; i++) {
+        const uint64_t p = _pixels[i];
+        const uint64_t even = (((p & EVEN_LANES) * scale) >> 8) & EVEN_LANES;
+        const uint64_t odd = ((((p >> 16) & EVEN_LANES) * scale) >> 8) & EVEN_LANES;
+        _pixels[i] = even | (odd << 16);
+    }
+}
+
+void AccumBuffer::toneMap(CRGB* out) const {
+    for (uint16_t i = 0; i < _count; i++) {
+        const uint64_t p = _pixels[i];
+        out[i].r = TONE_MAP[(p >> 4) & 0x7FF];
+        out[i].g = TONE_MAP[(p >> 20) & 0x7FF];
+        out[i].b = TONE_MAP[(p >> 36) & 0x7FF];
+    }
+}
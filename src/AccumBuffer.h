@@ -0,0 +1,85 @@
+// File: AccumBuffer.h
+// 16-bit-per-channel accumulation buffer for additive effects
+
+#ifndef ACCUMBUFFER_H
+#define ACCUMBUFFER_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+/**
+ * Additive effects drawing straight into CRGB saturate at every add and
+ * lose everything below one 8-bit step when they fade. This buffer keeps
+ * each channel in a 15-bit lane with 4 fractional bits: ONE units per
+ * 8-bit step, so white is 255 * ONE and there is room for roughly eight
+ * times white before a lane saturates.
+ *
+ * A pixel is one 64-bit word holding r, g and b in 16-bit lanes (the top
+ * lane is unused). The top bit of every lane is a guard bit, so adds and
+ * fades work on all three channels at once with plain integer operations.
+ *
+ * toneMap() produces the 8-bit frame: values up to KNEE pass through,
+ * brighter ones roll off smoothly towards 255 instead of clipping.
+ * Indices are physical, like the LED array.
+ */
+class AccumBuffer {
+public:
+    static const uint16_t ONE = 16;
+    static const uint8_t KNEE = 224;
+
+    AccumBuffer();
+    ~AccumBuffer();
+
+    // Keeps the first min(old, new) pixels and clears the rest. Returns
+    // false (and holds nothing) if the buffer could not be allocated.
+    bool resize(uint16_t count);
+    void release();
+
+    uint16_t size() const { return _count; }
+    size_t bytes() const { return _count * sizeof(uint64_t); }
+
+    void clear();
+
+    // Saturating adds of an 8-bit colour, optionally scaled by scale/256
+    // first; the scaled-off fraction is kept
+    void add(uint16_t index, const CRGB& color) {
+        _pixels[index] = addLanes(_pixels[index], pack(color));
+    }
+    void addScaled(uint16_t index, const CRGB& color, uint8_t scale) {
+        _pixels[index] = addLanes(_pixels[index], packScaled(color, scale));
+    }
+
+    // Multiplies every pixel by scale/256
+    void fade(uint8_t scale);
+
+    // Writes the tone-mapped 8-bit frame, size() pixels
+    void toneMap(CRGB* out) const;
+
+private:
+    static const uint64_t LANE_GUARD = 0x8000800080008000ULL;
+    static const uint64_t LANE_VALUE = 0x7FFF7FFF7FFF7FFFULL;
+    static const uint64_t EVEN_LANES = 0x0000FFFF0000FFFFULL;
+
+    static uint64_t pack(const CRGB& c) {
+        return ((uint64_t)c.r << 4) | ((uint64_t)c.g << 20) | ((uint64_t)c.b << 36);
+    }
+    static uint64_t packScaled(const CRGB& c, uint8_t scale) {
+        return ((uint64_t)((c.r * scale) >> 4))
+             | ((uint64_t)((c.g * scale) >> 4) << 16)
+             | ((uint64_t)((c.b * scale) >> 4) << 32);
+    }
+    // Lanes hold at most 0x7FFF, so the sum cannot carry into the next
+    // lane; a set guard bit marks a lane to clamp
+    static uint64_t addLanes(uint64_t a, uint64_t b) {
+        uint64_t sum = a + b;
+        uint64_t over = sum & LANE_GUARD;
+        return (sum | (over - (over >> 15))) & LANE_VALUE;
+    }
+
+    static void buildToneMap();
+
+    uint64_t* _pixels;
+    uint16_t _count;
+};
+
+#endif // ACCUMBUFFER_H
@@ -0,0 +1,117 @@
+// File: AnimationCache.cpp
+// Keeps recently used animations suspended so switching back resumes them
+
+#include "AnimationCache.h"
+#include "AnimationClock.h"
+#include "animations/BaseAnimation.h"
+
+AnimationCache::AnimationCache()
+    : _count(0)
+    , _bytes(0)
+    , _budget(BUDGET_INTERNAL)
+    , _hits(0)
+    , _misses(0)
+    , _evictions(0)
+{
+}
+
+AnimationCache::~AnimationCache() {
+    clear();
+}
+
+void AnimationCache::begin() {
+    _budget = psramFound() ? BUDGET_PSRAM : BUDGET_INTERNAL;
+}
+
+BaseAnimation* AnimationCache::take(int index, uint32_t& suspendedMs) {
+    for (int i = 0; i < _count; i++) {
+        if (_entries[i].index == index) {
+            BaseAnimation* anim = _entries[i].anim;
+            suspendedMs = AnimationClock::now() - _entries[i].suspendedAt;
+            remove(i);
+            _hits++;
+            return anim;
+        }
+    }
+    suspendedMs = 0;
+    _misses++;
+    return nullptr;
+}
+
+void AnimationCache::put(int index, BaseAnimation* anim) {
+    if (!anim) return;
+
+    anim->suspend();
+    Entry entry;
+    entry.index = index;
+    entry.anim = anim;
+    entry.bytes = anim->memoryUsage() + ENTRY_OVERHEAD;
+    entry.suspendedAt = AnimationClock::now();
+
+    if (entry.bytes > _budget) {
+        anim->end();
+        delete anim;
+        _evictions++;
+        return;
+    }
+
+    // A stale instance for the same index is replaced
+    for (int i = 0; i < _count; i++) {
+        if (_entries[i].index == index) {
+            _entries[i].anim->end();
+            delete _entries[i].anim;
+            remove(i);
+            break;
+        }
+    }
+    while (_count > 0 && (_count >= MAX_ENTRIES || _bytes + entry.bytes > _budget)) {
+        evictOldest();
+    }
+
+    for (int i = _count; i > 0; i--) {
+        _entries[i] = _entries[i - 1];
+    }
+    _entries[0] = entry;
+    _count++;
+    _bytes += entry.bytes;
+    trim();
+}
+
+void AnimationCache::trim() {
+    while (_count > 0 && ESP.getFreeHeap() < MIN_FREE_HEAP) {
+        evictOldest();
+    }
+}
+
+void AnimationCache::clear() {
+    while (_count > 0) {
+        evictOldest();
+    }
+}
+
+AnimationCache::Stats AnimationCache::stats() const {
+    Stats s;
+    s.hits = _hits;
+    s.misses = _misses;
+    s.evictions = _evictions;
+    s.entries = (uint8_t)_count;
+    s.bytes = _bytes;
+    s.budget = _budget;
+    return s;
+}
+
+void AnimationCache::evictOldest() {
+    Entry& oldest = _entries[_count - 1];
+    oldest.anim->end();
+    delete oldest.anim;
+    remove(_count - 1);
+    _evictions++;
+}
+
+void AnimationCache::remove(int slot) {
+    _bytes -= _entries[slot].bytes;
+    for (int i = slot; i < _count - 1; i++) {
+        _entries[i] = _entries[i + 1];
+    }
+    _count--;
+}
@@ -0,0 +1,84 @@
+// File: AnimationCache.h
+// Keeps recently used animations suspended so switching back resumes them
+
+#ifndef ANIMATIONCACHE_H
+#define ANIMATIONCACHE_H
+
+#include <Arduino.h>
+
+class BaseAnimation;
+
+/**
+ * A small most-recently-used list of suspended animation instances, keyed by
+ * animation index. take() hands an instance back (a hit) or returns nullptr
+ * (a miss, the caller constructs a new one); put() suspends an instance that
+ * is being switched away from.
+ *
+ * Entries are charged BaseAnimation::memoryUsage() plus a fixed overhead
+ * against a byte budget, which is larger when PSRAM is present. The least
+ * recently used entry is evicted when the budget or entry limit would be
+ * exceeded, and trim() evicts while the free heap is below a floor.
+ *
+ * Not thread safe; LEDManager calls it with its state lock held.
+ */
+class AnimationCache {
+public:
+    struct Stats {
+        uint32_t hits;
+        uint32_t misses;
+        uint32_t evictions;
+        uint8_t entries;
+        size_t bytes;
+        size_t budget;
+    };
+
+    AnimationCache();
+    ~AnimationCache();
+
+    // Sizes the budget; call once PSRAM state is known
+    void begin();
+
+    // Removes and returns the instance cached for index, or nullptr. On a
+    // hit, suspendedMs receives how long it was suspended.
+    BaseAnimation* take(int index, uint32_t& suspendedMs);
+
+    // Suspends and stores anim. Takes ownership; anim may be deleted at once
+    // if it does not fit.
+    void put(int index, BaseAnimation* anim);
+
+    // Evicts least recently used entries while free heap is below the floor
+    void trim();
+
+    // Deletes all entries
+    void clear();
+
+    Stats stats() const;
+
+private:
+    struct Entry {
+        int index;
+        BaseAnimation* anim;
+        size_t bytes;
+        unsigned long suspendedAt;
+    };
+
+    static const int MAX_ENTRIES = 4;
+    static const size_t ENTRY_OVERHEAD = 512;
+    static const size_t BUDGET_INTERNAL = 24 * 1024;
+    static const size_t BUDGET_PSRAM = 128 * 1024;
+    static const uint32_t MIN_FREE_HEAP = 48 * 1024;
+
+    void evictOldest();
+    void remove(int slot);
+
+    // Most recently used first
+    Entry _entries[MAX_ENTRIES];
+    int _count;
+    size_t _bytes;
+    size_t _budget;
+    uint32_t _hits;
+    uint32_t _misses;
+    uint32_t _evictions;
+};
+
+#endif // ANIMATIONCACHE_H
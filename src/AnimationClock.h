@@ -0,0 +1,53 @@
+// File: AnimationClock.h
+// Time base for animations: the wall clock, or a fixed step per frame
+
+#ifndef ANIMATIONCLOCK_H
+#define ANIMATIONCLOCK_H
+
+#include <Arduino.h>
+
+/**
+ * Animations, zones, transitions and the warm cache read the time from
+ * here instead of millis(). Normally it is millis(). With a fixed step set,
+ * time only moves when LEDManager calls tick() at the start of a rendered
+ * frame, by exactly that step, so frame N of a seeded animation is the
+ * same however long the frames before it took to draw.
+ */
+class AnimationClock {
+public:
+    // 0 returns to the wall clock. The fixed clock starts from the current
+    // millis(), so running timers see neither a jump nor a step back.
+    static void setFixedStep(uint16_t stepMs) {
+        State& s = state();
+        s.stepMs = stepMs;
+        s.ms = millis();
+    }
+
+    static uint16_t fixedStep() { return state().stepMs; }
+
+    static void tick() {
+        State& s = state();
+        if (s.stepMs) {
+            s.ms += s.stepMs;
+        }
+    }
+
+    static unsigned long now() {
+        const State& s = state();
+        return s.stepMs ? s.ms : millis();
+    }
+
+private:
+    struct State {
+        uint16_t stepMs;
+        unsigned long ms;
+    };
+
+    // One instance shared by every translation unit through the inline function
+    static State& state() {
+        static State s = { 0, 0 };
+        return s;
+    }
+};
+
+#endif // ANIMATIONCLOCK_H
@@ -0,0 +1,104 @@
+// File: AssetBundle.cpp
+// Read-only web asset bundle mapped straight out of the "assets" partition
+
+#include "AssetBundle.h"
+#include <string.h>
+
+const char* const AssetBundle::PARTITION_LABEL = "assets";
+
+static const size_t HEADER_SIZE = 16;
+static_assert(sizeof(AssetBundle::Entry) == 64, "bundle entry layout must match compress_assets.py");
+
+static uint32_t readU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+AssetBundle::AssetBundle()
+    : _base(nullptr)
+    , _entries(nullptr)
+    , _count(0)
+    , _buildStamp(0)
+    , _handle(0) {
+}
+
+AssetBundle::~AssetBundle() {
+    end();
+}
+
+void AssetBundle::end() {
+    if (_base) {
+        spi_flash_munmap(_handle);
+        _base = nullptr;
+        _entries = nullptr;
+        _count = 0;
+        _buildStamp = 0;
+    }
+}
+
+bool AssetBundle::begin() {
+    if (_base) {
+        return true;
+    }
+
+    const esp_partition_t* part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                           PARTITION_SUBTYPE, PARTITION_LABEL);
+    if (!part) {
+        Serial.println("AssetBundle: no assets partition");
+        return false;
+    }
+
+    const void* ptr = nullptr;
+    esp_err_t err = esp_partition_mmap(part, 0, part->size, SPI_FLASH_MMAP_DATA, &ptr, &_handle);
+    if (err != ESP_OK) {
+        Serial.printf("AssetBundle: mmap failed (%s)\n", esp_err_to_name(err));
+        return false;
+    }
+
+    const uint8_t* base = (const uint8_t*)ptr;
+    uint32_t count = readU32(base + 4);
+    uint32_t total = readU32(base + 8);
+    bool valid = memcmp(base, "WAB1", 4) == 0 &&
+                 total <= part->size &&
+                 HEADER_SIZE + count * sizeof(Entry) <= total;
+
+    const Entry* entries = (const Entry*)(base + HEADER_SIZE);
+    for (uint32_t i = 0; valid && i < count; i++) {
+        if (entries[i].path[PATH_SIZE - 1] != '\0' ||
+            entries[i].offset + length(entries[i]) > total) {
+            valid = false;
+        }
+    }
+
+    if (!valid) {
+        // Erased or foreign partition contents
+        Serial.println("AssetBundle: partition does not contain a valid bundle");
+        spi_flash_munmap(_handle);
+        return false;
+    }
+
+    _base = base;
+    _entries = entries;
+    _count = count;
+    _buildStamp = readU32(base + 12);
+    Serial.printf("AssetBundle: %u assets mapped (%u bytes, build %u)\n",
+                  (unsigned)count, (unsigned)total, (unsigned)_buildStamp);
+    return true;
+}
+
+const AssetBundle::Entry* AssetBundle::find(const char* path) const {
+    size_t lo = 0;
+    size_t hi = _count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        int cmp = strncmp(path, _entries[mid].path, PATH_SIZE);
+        if (cmp == 0) {
+            return &_entries[mid];
+        }
+        if (cmp < 0) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,67 @@
+// File: AssetBundle.h
+// Read-only web asset bundle mapped straight out of the "assets" partition
+
+#ifndef ASSETBUNDLE_H
+#define ASSETBUNDLE_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+
+/**
+ * Bundle layout, written by scripts/compress_assets.py (little endian):
+ *
+ *   Header  (16 bytes)  magic "WAB1", uint32 entry count, uint32 total size,
+ *                       uint32 build stamp (0 in bundles older than the stamp)
+ *   Entries (64 bytes each, sorted by path)
+ *                       char path[40] (NUL padded), char etag[16],
+ *                       uint32 data offset, uint32 length (bit 31 = gzipped)
+ *   Data                file contents, each starting on a 4-byte boundary
+ *
+ * The partition is mapped into the data address space once at boot, so
+ * lookups and reads are plain memory accesses: no VFS, no file handles and
+ * no contention with SPIFFS writers.
+ */
+class AssetBundle {
+public:
+    static const char* const PARTITION_LABEL;
+    static const esp_partition_subtype_t PARTITION_SUBTYPE = (esp_partition_subtype_t)0x40;
+    static const size_t PATH_SIZE = 40;
+    static const size_t ETAG_SIZE = 16;
+
+    struct Entry {
+        char path[PATH_SIZE];
+        char etag[ETAG_SIZE];
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    AssetBundle();
+    ~AssetBundle();
+
+    // Maps the partition and validates the header. False if absent or empty.
+    bool begin();
+    // Unmaps the partition; entries and data pointers become invalid
+    void end();
+
+    bool mapped() const { return _base != nullptr; }
+    size_t count() const { return _count; }
+    // Same stamp as the "#build" line of the SPIFFS manifest from that build
+    uint32_t buildStamp() const { return _buildStamp; }
+    const Entry& entry(size_t i) const { return _entries[i]; }
+
+    const Entry* find(const char* path) const;
+
+    // Pointer into mapped flash; valid for the lifetime of the bundle
+    const uint8_t* data(const Entry& e) const { return _base + e.offset; }
+    static size_t length(const Entry& e) { return e.length & 0x7FFFFFFF; }
+    static bool gzipped(const Entry& e) { return (e.length & 0x80000000) != 0; }
+
+private:
+    const uint8_t* _base;
+    const Entry* _entries;
+    size_t _count;
+    uint32_t _buildStamp;
+    spi_flash_mmap_handle_t _handle;
+};
+
+#endif // ASSETBUNDLE_H
@@ -0,0 +1,41 @@
+// File: BitmapFont.h
+// Compact column-major bitmap fonts for text on the LED canvas
+
+#ifndef BITMAPFONT_H
+#define BITMAPFONT_H
+
+#include <Arduino.h>
+
+/**
+ * Glyphs are stored column by column, one byte per column, bit 0 = top row.
+ * Characters outside [first, last] render as blanks. The tables live in
+ * flash.
+ */
+struct BitmapFont {
+    char first;
+    char last;
+    uint8_t width;      // columns per glyph
+    uint8_t height;     // rows used, at most 8
+    uint8_t spacing;    // blank columns after each glyph
+    const uint8_t* columns;
+
+    uint8_t advance() const { return width + spacing; }
+
+    // Column bits for c, or 0 for a blank
+    uint8_t column(char c, uint8_t col) const {
+        if (c < first || c > last || col >= width) {
+            return 0;
+        }
+        return pgm_read_byte(columns + (c - first) * width + col);
+    }
+};
+
+enum FontId : uint8_t {
+    FONT_5X7 = 0,   // printable ASCII
+    FONT_3X5,       // space to ':' (digits and clock punctuation)
+    FONT_COUNT
+};
+
+const BitmapFont& fontById(uint8_t id);
+
+#endif // BITMAPFONT_H
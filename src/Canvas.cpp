@@ -0,0 +1,280 @@
+// File: Canvas.cpp
+// Clipped 2D drawing primitives on the logical canvas
+
+#include "Canvas.h"
+#include <math.h>
+
+Canvas::Canvas(CRGB* pixels, const PanelLayout& layout)
+    : _pixels(pixels)
+    , _layout(layout)
+    , _mode(DRAW_SET)
+{
+    resetClip();
+}
+
+void Canvas::setClip(int x, int y, int w, int h) {
+    _clipX0 = x < 0 ? 0 : x;
+    _clipY0 = y < 0 ? 0 : y;
+    _clipX1 = x + w > width() ? width() : x + w;
+    _clipY1 = y + h > height() ? height() : y + h;
+    if (_clipX1 < _clipX0) _clipX1 = _clipX0;
+    if (_clipY1 < _clipY0) _clipY1 = _clipY0;
+}
+
+void Canvas::resetClip() {
+    _clipX0 = 0;
+    _clipY0 = 0;
+    _clipX1 = width();
+    _clipY1 = height();
+}
+
+void Canvas::put(int x, int y, const CRGB& color) {
+    CRGB& dst = _pixels[_layout.index(x, y)];
+    if (_mode == DRAW_ADD) {
+        dst += color;
+    } else {
+        dst = color;
+    }
+}
+
+void Canvas::putCoverage(int x, int y, const CRGB& color, uint8_t coverage) {
+    if (!coverage || !inClip(x, y)) {
+        return;
+    }
+    CRGB& dst = _pixels[_layout.index(x, y)];
+    if (_mode == DRAW_ADD) {
+        CRGB scaled = color;
+        scaled.nscale8(coverage);
+        dst += scaled;
+    } else {
+        nblend(dst, color, coverage);
+    }
+}
+
+void Canvas::pixel(int x, int y, const CRGB& color) {
+    if (inClip(x, y)) {
+        put(x, y, color);
+    }
+}
+
+void Canvas::hspan(int x0, int x1, int y, const CRGB& color) {
+    if (x0 > x1) {
+        int t = x0; x0 = x1; x1 = t;
+    }
+    if (y < _clipY0 || y >= _clipY1) return;
+    if (x0 < _clipX0) x0 = _clipX0;
+    if (x1 >= _clipX1) x1 = _clipX1 - 1;
+    if (x0 > x1) return;
+
+    const int count = x1 - x0 + 1;
+    if (_mode == DRAW_ADD) {
+        for (int i = 0; i < count; i++) {
+            _pixels[_layout.index(x0 + i, y)] += color;
+        }
+    } else {
+        for (int i = 0; i < count; i++) {
+            _pixels[_layout.index(x0 + i, y)] = color;
+        }
+    }
+}
+
+void Canvas::vspan(int x, int y0, int y1, const CRGB& color) {
+    if (y0 > y1) {
+        int t = y0; y0 = y1; y1 = t;
+    }
+    if (x < _clipX0 || x >= _clipX1) return;
+    if (y0 < _clipY0) y0 = _clipY0;
+    if (y1 >= _clipY1) y1 = _clipY1 - 1;
+    if (y0 > y1) return;
+
+    if (_mode == DRAW_ADD) {
+        for (int y = y0; y <= y1; y++) {
+            _pixels[_layout.index(x, y)] += color;
+        }
+    } else {
+        for (int y = y0; y <= y1; y++) {
+            _pixels[_layout.index(x, y)] = color;
+        }
+    }
+}
+
+void Canvas::line(int x0, int y0, int x1, int y1, const CRGB& color) {
+    if (y0 == y1) {
+        hspan(x0, x1, y0, color);
+        return;
+    }
+    if (x0 == x1) {
+        vspan(x0, y0, y1, color);
+        return;
+    }
+
+    const int dx = abs(x1 - x0);
+    const int dy = -abs(y1 - y0);
+    const int sx = x0 < x1 ? 1 : -1;
+    const int sy = y0 < y1 ? 1 : -1;
+    int err = dx + dy;
+    for (;;) {
+        if (inClip(x0, y0)) {
+            put(x0, y0, color);
+        }
+        if (x0 == x1 && y0 == y1) break;
+        int e2 = 2 * err;
+        if (e2 >= dy) { err += dy; x0 += sx; }
+        if (e2 <= dx) { err += dx; y0 += sy; }
+    }
+}
+
+static inline float fractionalPart(float v) { return v - floorf(v); }
+static inline uint8_t toCoverage(float v) { return (uint8_t)(v * 255.0f + 0.5f); }
+
+void Canvas::lineAA(float x0, float y0, float x1, float y1, const CRGB& color) {
+    const bool steep = fabsf(y1 - y0) > fabsf(x1 - x0);
+    if (steep) {
+        float t;
+        t = x0; x0 = y0; y0 = t;
+        t = x1; x1 = y1; y1 = t;
+    }
+    if (x0 > x1) {
+        float t;
+        t = x0; x0 = x1; x1 = t;
+        t = y0; y0 = y1; y1 = t;
+    }
+
+    const float dx = x1 - x0;
+    const float gradient = dx == 0.0f ? 1.0f : (y1 - y0) / dx;
+
+    // Plots (major, minor) back in the caller's orientation
+    auto plot = [&](int major, int minor, float coverage) {
+        if (steep) {
+            putCoverage(minor, major, color, toCoverage(coverage));
+        } else {
+            putCoverage(major, minor, color, toCoverage(coverage));
+        }
+    };
+
+    // First end point
+    float xEnd = floorf(x0 + 0.5f);
+    float yEnd = y0 + gradient * (xEnd - x0);
+    float xGap = 1.0f - fractionalPart(x0 + 0.5f);
+    const int xStart = (int)xEnd;
+    int yi = (int)floorf(yEnd);
+    plot(xStart, yi, (1.0f - fractionalPart(yEnd)) * xGap);
+    plot(xStart, yi + 1, fractionalPart(yEnd) * xGap);
+    float intery = yEnd + gradient;
+
+    // Second end point
+    xEnd = floorf(x1 + 0.5f);
+    yEnd = y1 + gradient * (xEnd - x1);
+    xGap = fractionalPart(x1 + 0.5f);
+    const int xStop = (int)xEnd;
+    yi = (int)floorf(yEnd);
+    plot(xStop, yi, (1.0f - fractionalPart(yEnd)) * xGap);
+    plot(xStop, yi + 1, fractionalPart(yEnd) * xGap);
+
+    for (int x = xStart + 1; x < xStop; x++) {
+        int y = (int)floorf(intery);
+        float f = fractionalPart(intery);
+        plot(x, y, 1.0f - f);
+        plot(x, y + 1, f);
+        intery += gradient;
+    }
+}
+
+void Canvas::rect(int x, int y, int w, int h, const CRGB& color) {
+    if (w <= 0 || h <= 0) return;
+    const int x1 = x + w - 1;
+    const int y1 = y + h - 1;
+    hspan(x, x1, y, color);
+    if (h > 1) {
+        hspan(x, x1, y1, color);
+    }
+    if (h > 2) {
+        vspan(x, y + 1, y1 - 1, color);
+        if (w > 1) {
+            vspan(x1, y + 1, y1 - 1, color);
+        }
+    }
+}
+
+void Canvas::fillRect(int x, int y, int w, int h, const CRGB& color) {
+    if (w <= 0 || h <= 0) return;
+    int y0 = y < _clipY0 ? _clipY0 : y;
+    int y1 = y + h > _clipY1 ? _clipY1 : y + h;
+    for (int row = y0; row < y1; row++) {
+        hspan(x, x + w - 1, row, color);
+    }
+}
+
+void Canvas::circle(int cx, int cy, int r, const CRGB& color) {
+    if (r < 0) return;
+    if (r == 0) {
+        pixel(cx, cy, color);
+        return;
+    }
+
+    // Midpoint circle; the axis points and the diagonal are plotted once so
+    // DRAW_ADD does not double them
+    pixel(cx + r, cy, color);
+    pixel(cx - r, cy, color);
+    pixel(cx, cy + r, color);
+    pixel(cx, cy - r, color);
+
+    int x = r;
+    int y = 0;
+    int err = 1 - r;
+    for (;;) {
+        y++;
+        if (err < 0) {
+            err += 2 * y + 1;
+        } else {
+            x--;
+            err += 2 * (y - x) + 1;
+        }
+        if (x < y) break;
+        pixel(cx + x, cy + y, color);
+        pixel(cx - x, cy + y, color);
+        pixel(cx + x, cy - y, color);
+        pixel(cx - x, cy - y, color);
+        if (x != y) {
+            pixel(cx + y, cy + x, color);
+            pixel(cx - y, cy + x, color);
+            pixel(cx + y, cy - x, color);
+            pixel(cx - y, cy - x, color);
+        }
+    }
+}
+
+void Canvas::fillCircle(int cx, int cy, int r, const CRGB& color) {
+    if (r < 0) return;
+
+    // One span per row, widest first; r*r + r rounds the outline the same
+    // way circle() does
+    const int limit = r * r + r;
+    int half = r;
+    for (int dy = 0; dy <= r; dy++) {
+        while (half > 0 && half * half + dy * dy > limit) {
+            half--;
+        }
+        hspan(cx - half, cx + half, cy + dy, color);
+        if (dy) {
+            hspan(cx - half, cx + half, cy - dy, color);
+        }
+    }
+}
+
+void Canvas::blit(int x, int y, const CRGB* sprite, int w, int h, const CRGB& transparent) {
+    if (!sprite || w <= 0 || h <= 0) return;
+    const int sx0 = x < _clipX0 ? _clipX0 - x : 0;
+    const int sy0 = y < _clipY0 ? _clipY0 - y : 0;
+    const int sx1 = x + w > _clipX1 ? _clipX1 - x : w;
+    const int sy1 = y + h > _clipY1 ? _clipY1 - y : h;
+
+    for (int sy = sy0; sy < sy1; sy++) {
+        const CRGB* row = sprite + sy * w;
+        for (int sx = sx0; sx < sx1; sx++) {
+            if (row[sx] != transparent) {
+                put(x + sx, y + sy, row[sx]);
+            }
+        }
+    }
+}
@@ -0,0 +1,77 @@
+// File: Canvas.h
+// Clipped 2D drawing primitives on the logical canvas
+
+#ifndef CANVAS_H
+#define CANVAS_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include "PanelLayout.h"
+
+/**
+ * Draws in logical (x, y) coordinates into a buffer in physical LED order,
+ * going through the layout's lookup table. Every primitive is clipped to
+ * the clip rectangle (the whole canvas by default) up front: spans and
+ * fills are trimmed once and then written without per-pixel checks, only
+ * pixel(), lines and outlines test each point.
+ *
+ * A Canvas holds no pixels of its own and is cheap to construct; make one
+ * for each frame rather than keeping it across layout changes.
+ *
+ * In DRAW_SET mode primitives overwrite; in DRAW_ADD they add with
+ * saturation, for trails and glows that overlap.
+ */
+class Canvas {
+public:
+    enum DrawMode : uint8_t {
+        DRAW_SET = 0,
+        DRAW_ADD
+    };
+
+    Canvas(CRGB* pixels, const PanelLayout& layout);
+
+    int width() const { return _layout.width(); }
+    int height() const { return _layout.height(); }
+
+    void setMode(DrawMode mode) { _mode = mode; }
+
+    // Clip to a rectangle, intersected with the canvas
+    void setClip(int x, int y, int w, int h);
+    void resetClip();
+
+    void pixel(int x, int y, const CRGB& color);
+
+    // Inclusive end points, either order
+    void hspan(int x0, int x1, int y, const CRGB& color);
+    void vspan(int x, int y0, int y1, const CRGB& color);
+
+    // Bresenham
+    void line(int x0, int y0, int x1, int y1, const CRGB& color);
+    // Xiaolin Wu, anti-aliased, sub-pixel end points
+    void lineAA(float x0, float y0, float x1, float y1, const CRGB& color);
+
+    void rect(int x, int y, int w, int h, const CRGB& color);
+    void fillRect(int x, int y, int w, int h, const CRGB& color);
+    void circle(int cx, int cy, int r, const CRGB& color);
+    void fillCircle(int cx, int cy, int r, const CRGB& color);
+
+    // w*h sprite, row-major; pixels equal to transparent are skipped
+    void blit(int x, int y, const CRGB* sprite, int w, int h, const CRGB& transparent);
+
+private:
+    bool inClip(int x, int y) const {
+        return x >= _clipX0 && x < _clipX1 && y >= _clipY0 && y < _clipY1;
+    }
+
+    // Unchecked
+    void put(int x, int y, const CRGB& color);
+    // Checked, color weighted by coverage (0-255)
+    void putCoverage(int x, int y, const CRGB& color, uint8_t coverage);
+
+    CRGB* _pixels;
+    const PanelLayout& _layout;
+    DrawMode _mode;
+    int _clipX0, _clipY0, _clipX1, _clipY1;     // end exclusive
+};
+
+#endif // CANVAS_H
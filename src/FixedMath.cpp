@@ -0,0 +1,90 @@
+// File: FixedMath.cpp
+// Bench for the fixed-point library; the library itself is FixedMath.h
+
+#include "FixedMath.h"
+#include <math.h>
+
+static const float TURN = 6.28318531f;
+
+// Largest |fixed - float| over a sweep, in the float function's units
+struct Accuracy {
+    float sinCos;   // 1.0 = unit amplitude
+    float atan2;    // degrees
+    float sqrt;     // relative
+};
+
+static Accuracy measureAccuracy() {
+    Accuracy worst = { 0, 0, 0 };
+    for (uint32_t a = 0; a < 65536; a += 7) {
+        const float rad = a * (TURN / 65536.0f);
+        float e = fabsf(q16ToFloat(fxSin((angle16)a)) - sinf(rad));
+        if (e > worst.sinCos) worst.sinCos = e;
+        e = fabsf(q16ToFloat(fxCos((angle16)a)) - cosf(rad));
+        if (e > worst.sinCos) worst.sinCos = e;
+    }
+    for (int y = -40; y <= 40; y++) {
+        for (int x = -40; x <= 40; x++) {
+            if (x == 0 && y == 0) continue;
+            const float expected = atan2f((float)y, (float)x) * (360.0f / TURN);
+            float got = fxAtan2(y, x) * (360.0f / 65536.0f);
+            if (got > 180.0f) got -= 360.0f;
+            float e = fabsf(got - expected);
+            if (e > 180.0f) e = 360.0f - e;
+            if (e > worst.atan2) worst.atan2 = e;
+        }
+    }
+    for (q16_16 x = 1; x < INT32_MAX / 3; x = x * 3 + 1) {
+        const float expected = sqrtf(q16ToFloat(x));
+        const float e = fabsf(q16ToFloat(fxSqrt(x)) - expected) / expected;
+        if (e > worst.sqrt) worst.sqrt = e;
+    }
+    return worst;
+}
+
+void benchFixedMath(Print& out, uint32_t count) {
+    const Accuracy worst = measureAccuracy();
+
+    // The same work both ways: a velocity from an angle and speed, a
+    // position step, and rounding to a pixel. The sums keep the loops alive.
+    int32_t sumFloat = 0, sumFixed = 0;
+    uint32_t t = micros();
+    for (uint32_t i = 0; i < count; i++) {
+        const float angle = (i * 97 & 0xFFFF) * (TURN / 65536.0f);
+        const float speed = 0.1f + (i & 63) * 0.01f;
+        const float x = 8.0f + cosf(angle) * speed * 4.0f;
+        const float y = 8.0f + sinf(angle) * speed * 4.0f;
+        sumFloat += (int32_t)roundf(x) + (int32_t)roundf(y);
+    }
+    const uint32_t floatUs = micros() - t;
+    t = micros();
+    for (uint32_t i = 0; i < count; i++) {
+        const angle16 angle = (angle16)(i * 97);
+        const q16_16 speed = 6554 + (q16_16)(i & 63) * 655;
+        const q16_16 x = 8 * Q16_ONE + q16Mul(fxCos(angle), speed) * 4;
+        const q16_16 y = 8 * Q16_ONE + q16Mul(fxSin(angle), speed) * 4;
+        sumFixed += q16Round(x) + q16Round(y);
+    }
+    const uint32_t fixedUs = micros() - t;
+
+    float sumSqrtF = 0;
+    t = micros();
+    for (uint32_t i = 0; i < count; i++) {
+        sumSqrtF += sqrtf((float)(i + 1));
+    }
+    const uint32_t sqrtFloatUs = micros() - t;
+    uint32_t sumSqrtQ = 0;
+    t = micros();
+    for (uint32_t i = 0; i < count; i++) {
+        sumSqrtQ += fxSqrt(q16FromInt(i + 1)) >> 8;
+    }
+    const uint32_t sqrtFixedUs = micros() - t;
+
+    out.printf("Fixed-point math, %lu evaluations:\n", (unsigned long)count);
+    out.printf("  max error: sin/cos %.6f, atan2 %.4f deg, sqrt %.6f%%\n",
+               worst.sinCos, worst.atan2, worst.sqrt * 100.0f);
+    out.printf("  particle step  float %6lu us  fixed %6lu us  (sums %ld / %ld)\n",
+               (unsigned long)floatUs, (unsigned long)fixedUs, (long)sumFloat, (long)sumFixed);
+    out.printf("  sqrt           float %6lu us  fixed %6lu us  (sums %.0f / %lu)\n",
+               (unsigned long)sqrtFloatUs, (unsigned long)sqrtFixedUs,
+               sumSqrtF, (unsigned long)(sumSqrtQ >> 8));
+}
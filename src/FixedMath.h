@@ -0,0 +1,264 @@
+// File: FixedMath.h
+// Fixed-point types, trigonometry and easing for animation hot paths
+
+#ifndef FIXEDMATH_H
+#define FIXEDMATH_H
+
+#include <Arduino.h>
+
+/**
+ * Header-only integer replacements for the float maths animations do per
+ * particle or per pixel. The S3's FPU is single precision only, and sinf,
+ * cosf, atan2f and roundf are library calls; these are a handful of integer
+ * instructions each.
+ *
+ *   q8_8    16-bit, 8 fractional bits:  1.0 = Q8_ONE (256)
+ *   q16_16  32-bit, 16 fractional bits: 1.0 = Q16_ONE (65536)
+ *   angle16 one full turn = 65536, wrapping for free like FastLED's sin16
+ *
+ * Adds, subtracts, multiplies, divides and conversions from float saturate
+ * at the type's limits instead of wrapping. Multiplies round to nearest.
+ *
+ * fxSin/fxCos interpolate a 64-segment quarter-wave table (error below
+ * 1e-4), fxAtan2 a 64-segment arctangent table over one octant (error
+ * about 0.01 degrees). fxSqrt is exact to the last bit.
+ *
+ * Fractions ("t") are 0..65535 for 0..1 unless a name says otherwise.
+ * FixedMath.cpp holds only the on-target bench against the float path.
+ */
+
+typedef int16_t q8_8;
+typedef int32_t q16_16;
+typedef uint16_t angle16;
+
+static const q8_8 Q8_ONE = 256;
+static const q16_16 Q16_ONE = 65536;
+static const angle16 ANGLE_QUARTER = 16384;
+
+/****************************************************
+ * Conversions
+ ****************************************************/
+inline q16_16 q16Saturate(int64_t v) {
+    return v > INT32_MAX ? INT32_MAX : (v < INT32_MIN ? INT32_MIN : (q16_16)v);
+}
+
+inline q8_8 q8Saturate(int32_t v) {
+    return v > INT16_MAX ? INT16_MAX : (v < INT16_MIN ? INT16_MIN : (q8_8)v);
+}
+
+inline q16_16 q16(float f) {
+    const float scaled = f * 65536.0f;
+    if (scaled >= 2147483520.0f) return INT32_MAX;
+    if (scaled <= -2147483648.0f) return INT32_MIN;
+    return (q16_16)(scaled + (scaled >= 0 ? 0.5f : -0.5f));
+}
+
+inline q8_8 q8(float f) {
+    const float scaled = f * 256.0f;
+    if (scaled >= 32767.0f) return INT16_MAX;
+    if (scaled <= -32768.0f) return INT16_MIN;
+    return (q8_8)(scaled + (scaled >= 0 ? 0.5f : -0.5f));
+}
+
+inline q16_16 q16FromInt(int32_t i) { return q16Saturate((int64_t)i * 65536); }
+inline q8_8 q8FromInt(int32_t i) {
+    return i > 127 ? INT16_MAX : (i < -128 ? INT16_MIN : (q8_8)(i * 256));
+}
+
+inline float q16ToFloat(q16_16 x) { return x * (1.0f / 65536.0f); }
+inline float q8ToFloat(q8_8 x) { return x * (1.0f / 256.0f); }
+
+inline q16_16 q16FromQ8(q8_8 x) { return (q16_16)x * 256; }
+inline q8_8 q8FromQ16(q16_16 x) { return q8Saturate((x + 0x80) >> 8); }
+
+// Integer part, towards minus infinity, and nearest integer (halves up)
+inline int32_t q16Floor(q16_16 x) { return x >> 16; }
+inline int32_t q16Round(q16_16 x) { return ((x >> 15) + 1) >> 1; }
+inline int16_t q8Floor(q8_8 x) { return x >> 8; }
+inline int16_t q8Round(q8_8 x) { return ((x >> 7) + 1) >> 1; }
+
+/****************************************************
+ * Saturating arithmetic
+ ****************************************************/
+inline q16_16 q16Add(q16_16 a, q16_16 b) { return q16Saturate((int64_t)a + b); }
+inline q16_16 q16Sub(q16_16 a, q16_16 b) { return q16Saturate((int64_t)a - b); }
+
+inline q16_16 q16Mul(q16_16 a, q16_16 b) {
+    return q16Saturate(((int64_t)a * b + 0x8000) >> 16);
+}
+
+// Division by zero saturates towards the sign of a
+inline q16_16 q16Div(q16_16 a, q16_16 b) {
+    if (b == 0) {
+        return a >= 0 ? INT32_MAX : INT32_MIN;
+    }
+    return q16Saturate((int64_t)a * 65536 / b);
+}
+
+inline q8_8 q8Add(q8_8 a, q8_8 b) { return q8Saturate((int32_t)a + b); }
+inline q8_8 q8Sub(q8_8 a, q8_8 b) { return q8Saturate((int32_t)a - b); }
+
+inline q8_8 q8Mul(q8_8 a, q8_8 b) {
+    return q8Saturate(((int32_t)a * b + 0x80) >> 8);
+}
+
+inline q8_8 q8Div(q8_8 a, q8_8 b) {
+    if (b == 0) {
+        return a >= 0 ? INT16_MAX : INT16_MIN;
+    }
+    return q8Saturate((int32_t)a * 256 / b);
+}
+
+/****************************************************
+ * Trigonometry and roots
+ ****************************************************/
+// sin over a quarter turn at 64 steps, 1.0 = 65536; shared by every
+// translation unit through the inline function
+inline const int32_t* fxSinTable() {
+    static const int32_t table[65] = {
+        0, 1608, 3216, 4821, 6424, 8022, 9616, 11204,
+        12785, 14359, 15924, 17479, 19024, 20557, 22078, 23586,
+        25080, 26558, 28020, 29466, 30893, 32303, 33692, 35062,
+        36410, 37736, 39040, 40320, 41576, 42806, 44011, 45190,
+        46341, 47464, 48559, 49624, 50660, 51665, 52639, 53581,
+        54491, 55368, 56212, 57022, 57798, 58538, 59244, 59914,
+        60547, 61145, 61705, 62228, 62714, 63162, 63572, 63944,
+        64277, 64571, 64827, 65043, 65220, 65358, 65457, 65516,
+        65536
+    };
+    return table;
+}
+
+// atan(i / 64) as an angle16, 0 to an eighth of a turn
+inline const uint16_t* fxAtanTable() {
+    static const uint16_t table[65] = {
+        0, 163, 326, 489, 651, 813, 975, 1136,
+        1297, 1457, 1617, 1775, 1933, 2090, 2246, 2401,
+        2555, 2708, 2860, 3010, 3159, 3307, 3453, 3599,
+        3742, 3884, 4025, 4164, 4302, 4438, 4572, 4705,
+        4836, 4966, 5094, 5220, 5344, 5467, 5589, 5708,
+        5826, 5943, 6058, 6171, 6282, 6392, 6500, 6607,
+        6712, 6815, 6917, 7018, 7117, 7214, 7310, 7405,
+        7498, 7589, 7679, 7768, 7856, 7942, 8026, 8110,
+        8192
+    };
+    return table;
+}
+
+inline angle16 fxDegrees(int32_t degrees) {
+    return (angle16)((degrees * 65536) / 360);
+}
+
+inline q16_16 fxSin(angle16 angle) {
+    // Position within the quarter, mirrored on the falling quarters
+    uint16_t offset = angle & (ANGLE_QUARTER - 1);
+    if (angle & ANGLE_QUARTER) {
+        offset = ANGLE_QUARTER - offset;
+    }
+    const int32_t* table = fxSinTable();
+    const uint16_t segment = offset >> 8;
+    int32_t value = table[segment];
+    if (segment < 64) {
+        value += ((table[segment + 1] - value) * (int32_t)(offset & 0xFF)) >> 8;
+    }
+    return (angle & 0x8000) ? -value : value;
+}
+
+inline q16_16 fxCos(angle16 angle) {
+    return fxSin(angle + ANGLE_QUARTER);
+}
+
+// Direction of (x, y), counter-clockwise from +x; y and x only need a
+// common scale. (0, 0) gives 0.
+inline angle16 fxAtan2(int32_t y, int32_t x) {
+    if (x == 0 && y == 0) {
+        return 0;
+    }
+    const uint32_t ax = x < 0 ? 0u - (uint32_t)x : (uint32_t)x;
+    const uint32_t ay = y < 0 ? 0u - (uint32_t)y : (uint32_t)y;
+    const bool steep = ay > ax;
+    const uint32_t lo = steep ? ax : ay;
+    const uint32_t hi = steep ? ay : ax;
+
+    // lo / hi in 0..1 as 6.8 table position
+    const uint32_t ratio = (uint32_t)(((uint64_t)lo << 14) / hi);
+    const uint16_t segment = ratio >> 8;
+    const uint16_t* table = fxAtanTable();
+    uint32_t angle = table[segment];
+    if (segment < 64) {
+        angle += ((table[segment + 1] - angle) * (ratio & 0xFF)) >> 8;
+    }
+
+    // Unfold the octant, then the quadrant
+    if (steep) angle = ANGLE_QUARTER - angle;
+    if (x < 0) angle = 2 * ANGLE_QUARTER - angle;
+    if (y < 0) angle = 0x10000 - angle;
+    return (angle16)angle;
+}
+
+// floor(sqrt(v)), one result bit per iteration
+inline uint32_t fxIsqrt(uint64_t v) {
+    uint64_t result = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+    while (bit > v) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (v >= result + bit) {
+            v -= result + bit;
+            result = (result >> 1) + bit;
+        } else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)result;
+}
+
+// 0 for x <= 0
+inline q16_16 fxSqrt(q16_16 x) {
+    return x > 0 ? (q16_16)fxIsqrt((uint64_t)x << 16) : 0;
+}
+
+/****************************************************
+ * Interpolation and easing
+ ****************************************************/
+// a + (b - a) * t / 65536
+inline q16_16 fxLerp(q16_16 a, q16_16 b, uint16_t t) {
+    return q16Saturate(a + (((int64_t)b - a) * t >> 16));
+}
+
+// a + (b - a) * t / 255, exact at both ends, for 8-bit slider values
+inline int32_t fxLerp8(int32_t a, int32_t b, uint8_t t) {
+    return a + (int32_t)((((int64_t)b - a) * (t * 257) + 0x8000) >> 16);
+}
+
+inline uint16_t fxEaseInQuad(uint16_t t) {
+    return ((uint32_t)t * t) >> 16;
+}
+
+inline uint16_t fxEaseOutQuad(uint16_t t) {
+    return 0xFFFF - fxEaseInQuad(0xFFFF - t);
+}
+
+inline uint16_t fxEaseInOutCubic(uint16_t t) {
+    // 4t^3 on the first half, mirrored on the second
+    const bool second = t & 0x8000;
+    uint32_t x = second ? 0xFFFF - t : t;
+    uint32_t y = (((x * x) >> 16) * x) >> 14;
+    return second ? 0xFFFF - y : y;
+}
+
+// 3t^2 - 2t^3
+inline uint16_t fxSmoothstep(uint16_t t) {
+    const uint32_t t2 = ((uint32_t)t * t) >> 16;
+    const uint32_t t3 = (t2 * t) >> 16;
+    const int32_t y = 3 * (int32_t)t2 - 2 * (int32_t)t3;
+    return y < 0 ? 0 : (y > 0xFFFF ? 0xFFFF : y);
+}
+
+// Checks trig and roots against the float functions and times both over
+// count evaluations each
+void benchFixedMath(Print& out, uint32_t count);
+
+#endif // FIXEDMATH_H
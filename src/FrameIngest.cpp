@@ -0,0 +1,190 @@
+// File: FrameIngest.cpp
+// Receives binary RGB frames and hands them to the render loop
+
+#include "FrameIngest.h"
+#include <esp_heap_caps.h>
+#include <cstring>
+
+FrameIngest::FrameIngest()
+    : _rx(0)
+    , _pending(1)
+    , _work(2)
+    , _pendingValid(false)
+    , _rxClient(0)
+    , _rxExpected(0)
+    , _rxReceived(0)
+    , _canvasWidth(PanelLayout::PANEL_SIZE)
+    , _canvasHeight(PanelLayout::PANEL_SIZE)
+    , _lastAppliedSeq(0)
+    , _received(0)
+    , _dropped(0)
+    , _applied(0)
+{
+    _slots[0] = _slots[1] = _slots[2] = nullptr;
+    _pendingRect.x = _pendingRect.y = _pendingRect.w = _pendingRect.h = 0;
+    portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+    _mux = unlocked;
+}
+
+FrameIngest::~FrameIngest() {
+    for (int i = 0; i < 3; i++) {
+        if (_slots[i]) {
+            heap_caps_free(_slots[i]);
+            _slots[i] = nullptr;
+        }
+    }
+}
+
+bool FrameIngest::allocate() {
+    for (int i = 0; i < 3; i++) {
+        if (_slots[i]) continue;
+        _slots[i] = (uint8_t*)heap_caps_malloc(CAPACITY, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!_slots[i]) {
+            _slots[i] = (uint8_t*)heap_caps_malloc(CAPACITY, MALLOC_CAP_8BIT);
+        }
+        if (!_slots[i]) {
+            Serial.println("FrameIngest: Failed to allocate frame buffer");
+            return false;
+        }
+    }
+    return true;
+}
+
+void FrameIngest::setCanvasSize(int width, int height) {
+    _canvasWidth = width;
+    _canvasHeight = height;
+}
+
+FrameIngest::Status FrameIngest::receive(uint32_t clientId, const uint8_t* data, size_t len,
+                                         size_t index, size_t total, uint16_t& seq) {
+    seq = 0;
+    if (!_slots[_rx]) {
+        return REJECTED;
+    }
+
+    if (index == 0) {
+        _rxClient = clientId;
+        _rxExpected = total;
+        _rxReceived = 0;
+    } else if (clientId != _rxClient || index != _rxReceived) {
+        // Fragment of a message we are not assembling (or out of order)
+        _rxExpected = 0;
+        return REJECTED;
+    }
+
+    if (_rxExpected < HEADER_FULL || _rxExpected > CAPACITY || index + len > _rxExpected) {
+        _rxExpected = 0;
+        return REJECTED;
+    }
+
+    memcpy(_slots[_rx] + index, data, len);
+    _rxReceived += len;
+    if (_rxReceived < _rxExpected) {
+        return INCOMPLETE;
+    }
+
+    Rect rect;
+    if (!parseHeader(_slots[_rx], _rxReceived, rect, seq)) {
+        return REJECTED;
+    }
+    _received++;
+
+    Status status = QUEUED;
+    portENTER_CRITICAL(&_mux);
+    if (_pendingValid && !covers(rect, _pendingRect)) {
+        status = BUSY;
+    } else {
+        if (_pendingValid) {
+            status = REPLACED;
+            _dropped++;
+        }
+        uint8_t tmp = _pending;
+        _pending = _rx;
+        _rx = tmp;
+        _pendingRect = rect;
+        _pendingValid = true;
+    }
+    portEXIT_CRITICAL(&_mux);
+
+    return status;
+}
+
+bool FrameIngest::parseHeader(const uint8_t* data, size_t len, Rect& rect, uint16_t& seq) const {
+    seq = readU16(data + 2);
+    int canvasW = _canvasWidth;
+    int canvasH = _canvasHeight;
+    size_t header;
+
+    if (data[0] == OP_FULL) {
+        header = HEADER_FULL;
+        rect.x = 0;
+        rect.y = 0;
+        rect.w = canvasW;
+        rect.h = canvasH;
+    } else if (data[0] == OP_RECT && len >= HEADER_RECT) {
+        header = HEADER_RECT;
+        rect.x = readU16(data + 4);
+        rect.y = readU16(data + 6);
+        rect.w = readU16(data + 8);
+        rect.h = readU16(data + 10);
+    } else {
+        return false;
+    }
+
+    if (rect.w <= 0 || rect.h <= 0 ||
+        rect.x + rect.w > canvasW || rect.y + rect.h > canvasH) {
+        return false;
+    }
+    return len == header + (size_t)rect.w * rect.h * 3;
+}
+
+bool FrameIngest::covers(const Rect& outer, const Rect& inner) {
+    return outer.x <= inner.x && outer.y <= inner.y &&
+           outer.x + outer.w >= inner.x + inner.w &&
+           outer.y + outer.h >= inner.y + inner.h;
+}
+
+bool FrameIngest::applyPending(CRGB* leds, const PanelLayout& layout) {
+    portENTER_CRITICAL(&_mux);
+    if (!_pendingValid) {
+        portEXIT_CRITICAL(&_mux);
+        return false;
+    }
+    uint8_t tmp = _work;
+    _work = _pending;
+    _pending = tmp;
+    Rect rect = _pendingRect;
+    _pendingValid = false;
+    portEXIT_CRITICAL(&_mux);
+
+    const uint8_t* frame = _slots[_work];
+    const uint8_t* src = frame + (frame[0] == OP_RECT ? HEADER_RECT : HEADER_FULL);
+
+    // The layout may have shrunk since the frame was validated
+    int maxX = rect.x + rect.w;
+    int maxY = rect.y + rect.h;
+    if (maxX > layout.width()) maxX = layout.width();
+    if (maxY > layout.height()) maxY = layout.height();
+
+    for (int y = rect.y; y < maxY; y++) {
+        const uint8_t* row = src + (size_t)(y - rect.y) * rect.w * 3;
+        for (int x = rect.x; x < maxX; x++) {
+            const uint8_t* px = row + (x - rect.x) * 3;
+            leds[layout.index(x, y)] = CRGB(px[0], px[1], px[2]);
+        }
+    }
+
+    _lastAppliedSeq = readU16(frame + 2);
+    _applied++;
+    return true;
+}
+
+void FrameIngest::buildAck(Status status, uint16_t seq, uint8_t out[ACK_SIZE]) const {
+    uint16_t applied = _lastAppliedSeq;
+    out[0] = 'A';
+    out[1] = (uint8_t)status;
+    out[2] = (uint8_t)(seq & 0xFF);
+    out[3] = (uint8_t)(seq >> 8);
+    out[4] = (uint8_t)(applied & 0xFF);
+    out[5] = (uint8_t)(applied >> 8);
+}
@@ -0,0 +1,102 @@
+// File: FrameIngest.h
+// Receives binary RGB frames (e.g. from /ws/frames) and hands them to the
+// render loop at the next frame boundary.
+
+#ifndef FRAMEINGEST_H
+#define FRAMEINGEST_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <freertos/FreeRTOS.h>
+#include "PanelLayout.h"
+
+/**
+ * Wire format (all integers little endian):
+ *
+ *   byte 0      opcode: 0x01 = full frame, 0x02 = rectangle
+ *   byte 1      flags (reserved, send 0)
+ *   bytes 2-3   sequence number, echoed back in the ack
+ *   rectangle only:
+ *   bytes 4-11  x, y, w, h as uint16 in logical canvas coordinates
+ *   payload     RGB888, row-major; w*h*3 bytes (full frame: canvas size)
+ *
+ * Three buffers rotate between the network task (rx), a single pending slot
+ * and the render loop (work). A complete message costs one memcpy into rx; the
+ * pointer swap into the pending slot happens under a spinlock. If a pending
+ * frame has not been consumed yet it is dropped when the new frame covers it,
+ * otherwise the new frame is refused with BUSY so the sender backs off.
+ */
+class FrameIngest {
+public:
+    enum Status : uint8_t {
+        QUEUED       = 0,  // accepted
+        REPLACED     = 1,  // accepted, an unconsumed older frame was dropped
+        REJECTED     = 2,  // malformed or out of bounds
+        BUSY         = 3,  // pending rectangle not covered by this one; retry
+        UNAUTHORIZED = 4,
+        INCOMPLETE   = 0xFF // more fragments expected, no ack yet
+    };
+
+    static const uint8_t OP_FULL = 0x01;
+    static const uint8_t OP_RECT = 0x02;
+    static const size_t HEADER_FULL = 4;
+    static const size_t HEADER_RECT = 12;
+    static const size_t CAPACITY = HEADER_RECT + PanelLayout::MAX_PIXELS * 3;
+    static const size_t ACK_SIZE = 6;
+
+    FrameIngest();
+    ~FrameIngest();
+
+    // Allocates the three frame buffers (PSRAM preferred). Safe to call repeatedly.
+    bool allocate();
+
+    // Render side keeps this in sync with the current layout
+    void setCanvasSize(int width, int height);
+
+    // Network side: feed one fragment of a binary message
+    Status receive(uint32_t clientId, const uint8_t* data, size_t len,
+                   size_t index, size_t total, uint16_t& seq);
+
+    // Render side: copy the pending frame (if any) into leds through the layout
+    bool applyPending(CRGB* leds, const PanelLayout& layout);
+
+    // Builds the ack message for a completed receive()
+    void buildAck(Status status, uint16_t seq, uint8_t out[ACK_SIZE]) const;
+
+    uint32_t receivedFrames() const { return _received; }
+    uint32_t droppedFrames() const { return _dropped; }
+    uint32_t appliedFrames() const { return _applied; }
+
+private:
+    struct Rect {
+        int x, y, w, h;
+    };
+
+    bool parseHeader(const uint8_t* data, size_t len, Rect& rect, uint16_t& seq) const;
+    static bool covers(const Rect& outer, const Rect& inner);
+    static uint16_t readU16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+
+    uint8_t* _slots[3];
+    uint8_t  _rx;
+    uint8_t  _pending;
+    uint8_t  _work;
+
+    bool     _pendingValid;
+    Rect     _pendingRect;
+
+    uint32_t _rxClient;
+    size_t   _rxExpected;
+    size_t   _rxReceived;
+
+    volatile int _canvasWidth;
+    volatile int _canvasHeight;
+
+    volatile uint16_t _lastAppliedSeq;
+    volatile uint32_t _received;
+    volatile uint32_t _dropped;
+    volatile uint32_t _applied;
+
+    portMUX_TYPE _mux;
+};
+
+#endif // FRAMEINGEST_H
@@ -0,0 +1,44 @@
+// File: HueTable.cpp
+// Precomputed full-saturation rainbow hues
+
+#include "HueTable.h"
+
+CRGB HueTable::_rgb[256];
+
+void HueTable::begin() {
+    for (int h = 0; h < 256; h++) {
+        hsv2rgb_rainbow(CHSV((uint8_t)h, 255, 255), _rgb[h]);
+    }
+}
+
+void HueTable::bench(Print& out, uint16_t count) {
+    uint32_t mismatches = 0;
+    for (int h = 0; h < 256; h++) {
+        for (int v = 0; v < 256; v++) {
+            if (CRGB(CHSV((uint8_t)h, 255, (uint8_t)v)) != color((uint8_t)h, (uint8_t)v)) {
+                mismatches++;
+            }
+        }
+    }
+
+    // Hues and values vary per pixel like a rainbow or a particle field;
+    // the checksums keep the compiler from dropping either loop
+    uint32_t sumChsv = 0, sumTable = 0;
+    uint32_t t = micros();
+    for (uint16_t i = 0; i < count; i++) {
+        CRGB c = CHSV((uint8_t)(i * 7), 255, (uint8_t)(i * 13));
+        sumChsv += c.r + c.g + c.b;
+    }
+    uint32_t chsvUs = micros() - t;
+    t = micros();
+    for (uint16_t i = 0; i < count; i++) {
+        CRGB c = color((uint8_t)(i * 7), (uint8_t)(i * 13));
+        sumTable += c.r + c.g + c.b;
+    }
+    uint32_t tableUs = micros() - t;
+
+    out.printf("Hue conversion, %u pixels:\n", (unsigned)count);
+    out.printf("  CHSV   %6lu us\n", (unsigned long)chsvUs);
+    out.printf("  table  %6lu us  %s\n", (unsigned long)tableUs,
+               mismatches == 0 && sumChsv == sumTable ? "ok" : "MISMATCH");
+}
@@ -0,0 +1,41 @@
+// File: HueTable.h
+// Precomputed full-saturation rainbow hues
+
+#ifndef HUETABLE_H
+#define HUETABLE_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+/**
+ * CRGB(CHSV(hue, 255, value)) without running the HSV conversion: the 256
+ * full-brightness hues are converted once with hsv2rgb_rainbow (what the
+ * CHSV to CRGB conversion uses), and a value below 255 applies the same
+ * video-scaled dimming the conversion would. Results are bit-exact with
+ * the CHSV path.
+ *
+ * The table is filled by begin(), which LEDManager calls at construction,
+ * before anything renders.
+ */
+class HueTable {
+public:
+    static void begin();
+
+    static const CRGB& color(uint8_t hue) { return _rgb[hue]; }
+    static CRGB color(uint8_t hue, uint8_t value) {
+        CRGB c = _rgb[hue];
+        if (value != 255) {
+            c.nscale8(scale8_video(value, value));
+        }
+        return c;
+    }
+
+    // Checks the table against CHSV over every hue and value and times a
+    // frame's worth (count pixels) of conversions both ways
+    static void bench(Print& out, uint16_t count);
+
+private:
+    static CRGB _rgb[256];
+};
+
+#endif // HUETABLE_H
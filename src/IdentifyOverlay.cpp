@@ -0,0 +1,141 @@
+// File: IdentifyOverlay.cpp
+// Timed "which panel is which" overlay drawn over the running animation
+
+#include "IdentifyOverlay.h"
+
+// 4x7 digits 1-8, one byte per row, bit 7 = leftmost column
+static const uint8_t DIGIT_GLYPHS[8][8] = {
+    { 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20 },
+    { 0xF0, 0x10, 0x10, 0xF0, 0x80, 0x80, 0xF0, 0x00 },
+    { 0xF0, 0x10, 0x10, 0x70, 0x10, 0x10, 0xF0, 0x00 },
+    { 0x90, 0x90, 0x90, 0xF0, 0x10, 0x10, 0x10, 0x00 },
+    { 0xF0, 0x80, 0x80, 0xF0, 0x10, 0x10, 0xF0, 0x00 },
+    { 0x70, 0x80, 0x80, 0xF0, 0x90, 0x90, 0x70, 0x00 },
+    { 0xF0, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00 },
+    { 0x70, 0x90, 0x90, 0x70, 0x90, 0x90, 0x70, 0x00 }
+};
+
+static const int DIGIT_X = 6;
+static const int DIGIT_Y = 6;
+static const int ARROW_Y = 1;
+
+IdentifyOverlay::IdentifyOverlay()
+    : _startMillis(0)
+    , _durationMs(0)
+{
+}
+
+void IdentifyOverlay::start(const PanelLayout& layout, uint32_t durationMs) {
+    _startMillis = millis();
+    _durationMs = durationMs;
+    build(layout);
+}
+
+void IdentifyOverlay::stop() {
+    std::vector<Pixel>().swap(_pixels);
+}
+
+void IdentifyOverlay::relayout(const PanelLayout& layout) {
+    if (active()) {
+        build(layout);
+    }
+}
+
+uint32_t IdentifyOverlay::remainingMs() const {
+    if (!active()) {
+        return 0;
+    }
+    unsigned long elapsed = millis() - _startMillis;
+    return elapsed >= _durationMs ? 0 : _durationMs - elapsed;
+}
+
+bool IdentifyOverlay::apply(CRGB* leds) {
+    if (_pixels.empty()) {
+        return false;
+    }
+    if (millis() - _startMillis >= _durationMs) {
+        stop();
+        return false;
+    }
+    for (size_t i = 0; i < _pixels.size(); i++) {
+        Pixel& px = _pixels[i];
+        px.saved = leds[px.index];
+        leds[px.index] = px.color;
+    }
+    return true;
+}
+
+void IdentifyOverlay::restore(CRGB* leds) {
+    // Reverse order so pixels drawn twice get their original value back
+    for (size_t i = _pixels.size(); i-- > 0; ) {
+        leds[_pixels[i].index] = _pixels[i].saved;
+    }
+}
+
+void IdentifyOverlay::build(const PanelLayout& layout) {
+    const int size = PanelLayout::PANEL_SIZE;
+    _pixels.clear();
+    _pixels.reserve(layout.panelCount() * 120);
+
+    for (int p = 0; p < layout.panelCount(); p++) {
+        int base = layout.panelBase(p);
+        const PanelInfo& info = layout.panel(p);
+
+        // Outline, in wiring space
+        for (int i = 0; i < size; i++) {
+            addWired(base, i, 0, CRGB(0, 0, 64));
+            addWired(base, i, size - 1, CRGB(0, 0, 64));
+            addWired(base, 0, i, CRGB(0, 0, 64));
+            addWired(base, size - 1, i, CRGB(0, 0, 64));
+        }
+
+        // First wired row fades along the data direction, then the turn
+        for (int i = 0; i < size; i++) {
+            uint8_t level = 255 - i * 12;
+            addPixel(base + i, CRGB(level, level, 0));
+        }
+        addPixel(base + size, CRGB(48, 48, 0));
+        addPixel(base, CRGB::Red);
+
+        // Arrow pointing to logical "up"
+        for (int row = 0; row < 4; row++) {
+            for (int x = 8 - row; x <= 8 + row; x++) {
+                addLogical(layout, info.originX + x, info.originY + ARROW_Y + row, CRGB::Green);
+            }
+        }
+
+        // Panel number
+        int digit = p + 1;
+        CRGB color = CHSV((digit * 32) & 255, 255, 255);
+        const uint8_t* glyph = DIGIT_GLYPHS[digit - 1];
+        for (int row = 0; row < 8; row++) {
+            for (int col = 0; col < 8; col++) {
+                if (glyph[row] & (0x80 >> col)) {
+                    addLogical(layout, info.originX + DIGIT_X + col, info.originY + DIGIT_Y + row, color);
+                }
+            }
+        }
+    }
+}
+
+void IdentifyOverlay::addPixel(int index, const CRGB& color) {
+    Pixel px;
+    px.index = (uint16_t)index;
+    px.color = color;
+    _pixels.push_back(px);
+}
+
+void IdentifyOverlay::addLogical(const PanelLayout& layout, int x, int y, const CRGB& color) {
+    int index = layout.indexChecked(x, y);
+    if (index >= 0) {
+        addPixel(index, color);
+    }
+}
+
+// Panel-local coordinates in wiring order: row localY of the strip, with odd
+// rows running back the other way
+void IdentifyOverlay::addWired(int base, int localX, int localY, const CRGB& color) {
+    const int size = PanelLayout::PANEL_SIZE;
+    int column = (localY % 2 != 0) ? (size - 1 - localX) : localX;
+    addPixel(base + localY * size + column, color);
+}
@@ -0,0 +1,62 @@
+// File: IdentifyOverlay.h
+// Timed "which panel is which" overlay drawn over the running animation
+
+#ifndef IDENTIFYOVERLAY_H
+#define IDENTIFYOVERLAY_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <vector>
+#include "PanelLayout.h"
+
+/**
+ * For every panel the overlay shows
+ *
+ *  - in logical space (so it reads upright when rotation is configured
+ *    correctly): an up arrow and the panel number,
+ *  - in wiring space (straight from the strip index): the panel outline in
+ *    blue, the first LED of the panel in red and the first wired row as a
+ *    yellow gradient fading along the data direction, plus the first LED of
+ *    the second row to show where the zigzag turns.
+ *
+ * The pixels are computed once in start(). At show time apply() saves what
+ * the animation drew underneath and paints the overlay; restore() puts the
+ * animation's pixels back afterwards, so animations that build on their
+ * previous frame are unaffected. Once the overlay expires the pixel list is
+ * freed and apply() is a single comparison.
+ */
+class IdentifyOverlay {
+public:
+    IdentifyOverlay();
+
+    void start(const PanelLayout& layout, uint32_t durationMs);
+    void stop();
+
+    // Rebuilds the pixels for a changed layout, keeping the remaining time
+    void relayout(const PanelLayout& layout);
+
+    bool active() const { return !_pixels.empty(); }
+    uint32_t remainingMs() const;
+
+    // Returns true if the overlay was drawn; restore() must follow the show
+    bool apply(CRGB* leds);
+    void restore(CRGB* leds);
+
+private:
+    struct Pixel {
+        uint16_t index;
+        CRGB color;
+        CRGB saved;
+    };
+
+    void build(const PanelLayout& layout);
+    void addPixel(int index, const CRGB& color);
+    void addLogical(const PanelLayout& layout, int x, int y, const CRGB& color);
+    void addWired(int base, int localX, int localY, const CRGB& color);
+
+    std::vector<Pixel> _pixels;
+    unsigned long _startMillis;
+    uint32_t _durationMs;
+};
+
+#endif // IDENTIFYOVERLAY_H
@@ -0,0 +1,171 @@
+// File: JsonWriter.cpp
+// Minimal streaming JSON writer for API responses
+
+#include "JsonWriter.h"
+#include <stdio.h>
+
+JsonWriter::JsonWriter(Print& out)
+    : _out(out)
+    , _len(0)
+    , _depth(0)
+    , _skipped(0)
+    , _hasItems(0)
+    , _afterKey(false) {
+}
+
+JsonWriter::~JsonWriter() {
+    flush();
+}
+
+void JsonWriter::flush() {
+    if (_len > 0) {
+        _out.write((const uint8_t*)_buf, _len);
+        _len = 0;
+    }
+}
+
+void JsonWriter::raw(char c) {
+    if (_len == SCRATCH_SIZE) {
+        flush();
+    }
+    _buf[_len++] = c;
+}
+
+void JsonWriter::raw(const char* s) {
+    while (*s) {
+        raw(*s++);
+    }
+}
+
+bool JsonWriter::separator() {
+    if (_skipped) {
+        return false;
+    }
+    if (_afterKey) {
+        _afterKey = false;
+        return true;
+    }
+    uint16_t bit = (uint16_t)(1u << _depth);
+    if (_hasItems & bit) {
+        raw(',');
+    }
+    _hasItems |= bit;
+    return true;
+}
+
+// A container that would nest deeper than MAX_DEPTH is written as null and
+// everything up to its matching end is dropped, so begin/end stay paired
+// and the output stays valid
+void JsonWriter::open(char bracket) {
+    if (!separator()) {
+        _skipped++;
+        return;
+    }
+    if (_depth + 1 >= MAX_DEPTH) {
+        raw("null");
+        _skipped++;
+        return;
+    }
+    raw(bracket);
+    _depth++;
+    _hasItems &= (uint16_t)~(1u << _depth);
+}
+
+void JsonWriter::close(char bracket) {
+    if (_skipped) {
+        _skipped--;
+        return;
+    }
+    if (_depth == 0) {
+        return;
+    }
+    raw(bracket);
+    _depth--;
+}
+
+void JsonWriter::beginObject() {
+    open('{');
+}
+
+void JsonWriter::endObject() {
+    close('}');
+}
+
+void JsonWriter::beginArray() {
+    open('[');
+}
+
+void JsonWriter::endArray() {
+    close(']');
+}
+
+void JsonWriter::key(const char* name) {
+    if (!separator()) return;
+    escaped(name);
+    raw(':');
+    _afterKey = true;
+}
+
+void JsonWriter::value(const char* s) {
+    if (!separator()) return;
+    escaped(s ? s : "");
+}
+
+void JsonWriter::value(bool b) {
+    if (!separator()) return;
+    raw(b ? "true" : "false");
+}
+
+void JsonWriter::value(long v) {
+    char tmp[16];
+    snprintf(tmp, sizeof(tmp), "%ld", v);
+    if (!separator()) return;
+    raw(tmp);
+}
+
+void JsonWriter::value(unsigned long v) {
+    char tmp[16];
+    snprintf(tmp, sizeof(tmp), "%lu", v);
+    if (!separator()) return;
+    raw(tmp);
+}
+
+void JsonWriter::value(float v, uint8_t decimals) {
+    if (!separator()) return;
+    if (isnan(v) || isinf(v)) {
+        raw("null");
+        return;
+    }
+    char tmp[24];
+    snprintf(tmp, sizeof(tmp), "%.*f", (int)decimals, (double)v);
+    raw(tmp);
+}
+
+void JsonWriter::nullValue() {
+    if (!separator()) return;
+    raw("null");
+}
+
+void JsonWriter::escaped(const char* s) {
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+    raw('"');
+    for (; *s; s++) {
+        char c = *s;
+        switch (c) {
+            case '"':  raw("\\\""); break;
+            case '\\': raw("\\\\"); break;
+            case '\n': raw("\\n"); break;
+            case '\r': raw("\\r"); break;
+            case '\t': raw("\\t"); break;
+            default:
+                if ((uint8_t)c < 0x20) {
+                    raw("\\u00");
+                    raw(HEX_DIGITS[(c >> 4) & 0x0F]);
+                    raw(HEX_DIGITS[c & 0x0F]);
+                } else {
+                    raw(c);
+                }
+        }
+    }
+    raw('"');
+}
@@ -0,0 +1,74 @@
+// File: JsonWriter.h
+// Minimal streaming JSON writer for API responses
+
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include <Arduino.h>
+
+/**
+ * Writes JSON straight to a Print (typically an AsyncResponseStream) through
+ * a small fixed scratch buffer, so building a response never grows a String.
+ * Commas between members and elements are inserted automatically and string
+ * values are escaped. Nesting is limited to MAX_DEPTH - 1 levels: a deeper
+ * object or array is written as null and its contents are dropped.
+ *
+ *   JsonWriter json(*stream);
+ *   json.beginObject();
+ *   json.key("animations"); json.beginArray();
+ *   json.value(name);
+ *   json.endArray();
+ *   json.endObject();
+ *   json.flush();
+ */
+class JsonWriter {
+public:
+    static const size_t SCRATCH_SIZE = 128;
+    static const uint8_t MAX_DEPTH = 16;
+
+    explicit JsonWriter(Print& out);
+    ~JsonWriter();
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+
+    void key(const char* name);
+
+    void value(const char* s);
+    void value(const String& s) { value(s.c_str()); }
+    void value(bool b);
+    void value(int v) { value((long)v); }
+    void value(unsigned int v) { value((unsigned long)v); }
+    void value(long v);
+    void value(unsigned long v);
+    void value(float v, uint8_t decimals = 2);
+    void nullValue();
+
+    // Shorthands for object members
+    template <typename T>
+    void member(const char* name, const T& v) { key(name); value(v); }
+
+    // Writes buffered output to the underlying Print
+    void flush();
+
+private:
+    // False while inside a container dropped for being too deep
+    bool separator();
+    void open(char bracket);
+    void close(char bracket);
+    void raw(const char* s);
+    void raw(char c);
+    void escaped(const char* s);
+
+    Print& _out;
+    char _buf[SCRATCH_SIZE];
+    size_t _len;
+    uint8_t _depth;
+    uint8_t _skipped;     // open containers past MAX_DEPTH, not written
+    uint16_t _hasItems;   // bit per depth: a value was already written there
+    bool _afterKey;
+};
+
+#endif // JSONWRITER_H
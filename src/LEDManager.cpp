@@ -5,6 +5,11 @@
 #include <typeinfo>
 #include <ctype.h>
 #include "LogManager.h"
+#include "PixelKernels.h"
+#include "HueTable.h"
+#include "AnimationClock.h"
+#include "Rng.h"
+#include "FixedMath.h"
 
 // Include Animation header files
 #include "animations/TrafficAnimation.h"
@@ -14,6 +19,8 @@
 #include "animations/GameOfLifeAnimation.h"
 #include "animations/LangtonsAntAnimation.h"
 #include "animations/SierpinskiCarpetAnimation.h"
+#include "animations/TextAnimation.h"
+#include "animations/SnowAnimation.h"
 
 // Animations
 #include "animations/BaseAnimation.h"
@@ -59,11 +66,21 @@ static const LifeRulePreset LIFE_RULES[] = {
 
 static const size_t LIFE_RULE_COUNT = sizeof(LIFE_RULES) / sizeof(LIFE_RULES[0]);
 
+// RainbowWave keeps its own 8 ms frame; the update interval sets how far
+// the hue moves per frame instead, from 3x at the fastest setting down to
+// 0.5x at the slowest
+static q8_8 rainbowSpeedFor(unsigned long intervalMs) {
+    int32_t effective = 250 + ((int32_t)intervalMs - 10) * 1250 / 1490;
+    effective = constrain(effective, 250, 1500);
+    return 3 * Q8_ONE - (q8_8)((effective - 250) * (5 * Q8_ONE / 2) / 1250);
+}
+
 LEDManager::LEDManager()
     : _panelCount(2) // default
     , _numLeds(_panelCount * 16 * 16)
     , _brightness(32)
     , currentPalette(0)
+    , _builtinPaletteCount(0)
     , _currentAnimation(nullptr)
     , _currentAnimationIndex(-1)
     , spawnRate(1.0f)
@@ -93,6 +110,22 @@ LEDManager::LEDManager()
     , fireworkGravity(0.15f)
     , fireworkLaunchProbability(0.15f)
     , rainbowHueScale(4)
+    , textMessage("Hello")
+    , textMode(TextAnimation::MODE_MESSAGE)
+    , textFont(FONT_5X7)
+    , textSpeed(12)
+    , _outgoingAnimation(nullptr)
+    , _outgoingAnimationIndex(-1)
+    , _transitionFrame(0)
+    , transitionMs(800)
+    , transitionCurve(TransitionCompositor::CURVE_EASE_IN_OUT)
+    , transitionWipe(TransitionCompositor::WIPE_CROSSFADE)
+    , _randomSeed(0)
+    , _streaming(false)
+    , _lastStreamFrame(0)
+    , _controller(nullptr)
+    , _controllerLeds(0)
+    , _pendingPanelCount(0)
     , _isInitializing(true)
     , _stateMutex(xSemaphoreCreateRecursiveMutex())
 {
@@ -101,6 +134,7 @@ LEDManager::LEDManager()
     }
 
     createPalettes();
+    HueTable::begin();
     _animationNames.push_back("Traffic");     // index=0
     _animationNames.push_back("Blink");       // index=1
     _animationNames.push_back("RainbowWave"); // index=2
@@ -108,6 +142,10 @@ LEDManager::LEDManager()
     _animationNames.push_back("GameOfLife");  // index=4
     _animationNames.push_back("LangtonsAnt"); // index=5
     _animationNames.push_back("SierpinskiCarpet"); // index=6
+    _animationNames.push_back("Text");        // index=7
+    _animationNames.push_back("Snow");        // index=8
+
+    rebuildLayout();
 }
 
 bool LEDManager::beginExclusiveAccess(uint32_t timeoutMs) const {
@@ -140,23 +178,21 @@ bool LEDManager::LockGuard::locked() const {
 
 void LEDManager::begin() {
     LEDMANAGER_LOCK_OR_RETURN(1000);
-    reinitFastLED();
+    _animationCache.begin();
+    initController();
     showLoadingAnimation();
+    _output.process(leds, _numLeds);
+    FastLED.show();
 }
 
 void LEDManager::showLoadingAnimation() {
-    FastLED.clear();
+    fill_solid(leds, _numLeds, CRGB::Black);
     for (int i = 0; i < 5; i++) {
         int pos = (millis() / 200 + i * 3) % _numLeds;
         leds[pos] = CRGB::Blue;
     }
     uint8_t pulse = sin8(millis() / 10);
-    for (int i = 0; i < _numLeds; i++) {
-        if (leds[i]) {
-            leds[i].fadeToBlackBy(255 - pulse);
-        }
-    }
-    FastLED.show();
+    spanFade(leds, _numLeds, 255 - pulse);
 }
 
 void LEDManager::finishInitialization() {
@@ -181,48 +217,211 @@ void LEDManager::finishInitialization() {
     Serial.printf("Free heap after animation switch: %u bytes\n", ESP.getFreeHeap());
 }
 
-void LEDManager::reinitFastLED() {
+// Registers the strip with FastLED once. Later size changes go through
+// setLeds() on the same controller, see applyPanelCount(). The controller
+// sends the output stage's buffer; brightness, colour correction and
+// dithering all happen there, so FastLED's own are neutral.
+void LEDManager::initController() {
     LEDMANAGER_LOCK_OR_RETURN(1000);
-    FastLED.clear(true);
-    FastLED.setBrightness(_brightness);
+    FastLED.setBrightness(255);
+    FastLED.setDither(DISABLE_DITHER);
+    _output.setBrightness(_brightness);
 
     if(_numLeds > MAX_LEDS) {
         Serial.println("Error: _numLeds > MAX_LEDS, adjusting.");
         _numLeds = MAX_LEDS;
     }
-    FastLED.clearData();
-    FastLED.addLeds<WS2812B, LED_PIN, GRB>(leds, _numLeds).setCorrection(TypicalLEDStrip);
+    if (_controller) {
+        resizeController(_numLeds);
+        return;
+    }
+    _output.clear();
+    _controller = &FastLED.addLeds<WS2812B, LED_PIN, GRB>(_output.output(), _numLeds);
+    _controller->setCorrection(UncorrectedColor);
+    _controllerLeds = _numLeds;
     FastLED.show();
 }
 
+void LEDManager::resizeController(uint16_t count) {
+    if (_controller && count != _controllerLeds) {
+        _controller->setLeds(_output.output(), count);
+        _controllerLeds = count;
+    }
+}
+
 void LEDManager::update() {
     LockGuard lock(*this, 0);
     if (!lock.locked()) {
         return;
     }
 
+    // Frame boundary: nothing has been drawn for this frame yet
+    if (_pendingPanelCount > 0) {
+        applyPanelCount(_pendingPanelCount);
+    }
+
     if (_isInitializing) {
         showLoadingAnimation();
         return;
     }
+    if (pollFrameStream()) {
+        // A transition interrupted by a stream just runs out its time
+        if (_outgoingAnimation && _transition.finished()) {
+            finishTransition();
+        }
+        return;
+    }
+    // Everything below sees this frame's time; fixed in deterministic mode
+    AnimationClock::tick();
+    if (_outgoingAnimation) {
+        updateTransition();
+    } else if (_currentAnimation && !_zones.coversCanvas()) {
+        // Paused while zones hide all of it; it picks up where it was
+        _currentAnimation->update();
+    }
+    if (_zones.active()) {
+        _zones.update();
+        _zones.compose(renderTarget());
+    }
+    if (_layers.active()) {
+        _layers.update();
+        _layers.compose(leds, _numLeds);
+    }
+}
+
+// Where the main animation (or transition) output goes: leds[] directly,
+// or the layer stack's base buffer while overlays are assigned
+CRGB* LEDManager::renderTarget() {
+    return _layers.active() ? _layers.base() : leds;
+}
+
+// Moves the running animation into the compositor's outgoing buffer so it
+// keeps rendering underneath the new one. Returns false for a hard cut.
+bool LEDManager::beginTransition() {
+    if (_outgoingAnimation) {
+        // Switching again mid-transition: the incoming one becomes the base
+        finishTransition();
+    }
+    if (transitionMs == 0 || !_currentAnimation || _isInitializing || !_transition.allocate()) {
+        return false;
+    }
+
+    memcpy(_transition.outgoing(), renderTarget(), sizeof(CRGB) * _numLeds);
+    fill_solid(_transition.incoming(), _numLeds, CRGB::Black);
+    _currentAnimation->setTarget(_transition.outgoing());
+    _outgoingAnimation = _currentAnimation;
+    _outgoingAnimationIndex = _currentAnimationIndex;
+    _currentAnimation = nullptr;
+    _transitionFrame = 0;
+    _transition.start(transitionMs,
+                      (TransitionCompositor::Curve)transitionCurve,
+                      (TransitionCompositor::Wipe)transitionWipe);
+    return true;
+}
+
+// The outgoing animation only advances every other frame; it is on its
+// way out and this keeps the two render passes near the cost of one.
+void LEDManager::updateTransition() {
+    _transitionFrame++;
+    if (_transitionFrame & 1) {
+        _outgoingAnimation->update();
+    }
     if (_currentAnimation) {
         _currentAnimation->update();
     }
+    if (!_transition.compose(renderTarget(), _layout)) {
+        finishTransition();
+    }
+}
+
+void LEDManager::finishTransition() {
+    if (_currentAnimation) {
+        memcpy(renderTarget(), _transition.incoming(), sizeof(CRGB) * _numLeds);
+        _currentAnimation->setTarget(renderTarget());
+    }
+    if (_outgoingAnimation) {
+        _outgoingAnimation->setTarget(leds);
+        _animationCache.put(_outgoingAnimationIndex, _outgoingAnimation);
+        _outgoingAnimation = nullptr;
+    }
+    _transition.stop();
+}
+
+// Applies a streamed frame if one is pending. While frames keep arriving the
+// animation is paused; it resumes once the stream has been idle for
+// STREAM_TIMEOUT_MS. Returns true while the stream owns the LEDs.
+bool LEDManager::pollFrameStream() {
+    unsigned long now = millis();
+    if (_frameIngest.applyPending(leds, _layout)) {
+        if (!_streaming) {
+            _streaming = true;
+            systemInfo("Frame stream started, animation paused");
+        }
+        _lastStreamFrame = now;
+        return true;
+    }
+    if (_streaming && now - _lastStreamFrame > STREAM_TIMEOUT_MS) {
+        _streaming = false;
+        systemInfo("Frame stream idle, resuming animation");
+    }
+    return _streaming;
+}
+
+void LEDManager::rebuildLayout() {
+    const int rotations[3] = { rotationAngle1, rotationAngle2, rotationAngle3 };
+    _layout.configure(_panelCount, panelOrder, rotations);
+    _frameIngest.setCanvasSize(_layout.width(), _layout.height());
+    _identify.relayout(_layout);
+    _zones.relayout(_layout);
+    _layers.relayout(_layout, _numLeds, _panelCount);
 }
 
+FrameIngest& LEDManager::frameIngest() {
+    return _frameIngest;
+}
+
+bool LEDManager::isStreaming() const {
+    LEDMANAGER_LOCK_CONST_OR_RETURN_VALUE(1000, false);
+    return _streaming;
+}
+
+// Pushes the frame to the strip with any overlay on top, through the
+// output stage. If another task holds the state, the strip keeps showing
+// the previous frame.
 void LEDManager::show() {
+    LockGuard lock(*this, 0);
+    if (!lock.locked()) {
+        return;
+    }
+    bool overlay = _identify.apply(leds);
+    // Until a shrink is committed the controller still sends the blanked
+    // LEDs past _numLeds
+    _output.process(leds, _controllerLeds > _numLeds ? _controllerLeds : _numLeds);
+    if (overlay) {
+        _identify.restore(leds);
+    }
     FastLED.show();
+    // A shrink is committed only after the frame that blanked the
+    // panels being dropped has gone out
+    if (_controllerLeds > _numLeds) {
+        resizeController(_numLeds);
+    }
 }
 
 void LEDManager::configureCurrentAnimation() {
-    if (!_currentAnimation) return;
+    configureAnimation(_currentAnimation, _currentAnimationIndex);
+}
+
+// Applies the current settings to an animation of the given index
+void LEDManager::configureAnimation(BaseAnimation* animation, int index) {
+    if (!animation) return;
     
     // Set common properties for all animations
-    _currentAnimation->setBrightness(_brightness);
+    animation->setBrightness(_brightness);
     
     // Set animation-specific properties
-    if (_currentAnimationIndex == 0) { // Traffic
-        TrafficAnimation* anim = static_cast<TrafficAnimation*>(_currentAnimation);
+    if (index == 0) { // Traffic
+        TrafficAnimation* anim = static_cast<TrafficAnimation*>(animation);
         anim->setRotationAngle1(rotationAngle1);
         anim->setRotationAngle2(rotationAngle2);
         anim->setRotationAngle3(rotationAngle3);
@@ -234,21 +433,16 @@ void LEDManager::configureCurrentAnimation() {
         anim->setAllPalettes(&ALL_PALETTES);
         anim->setCurrentPalette(currentPalette);
     }
-    else if (_currentAnimationIndex == 1) { // Blink
-        BlinkAnimation* anim = static_cast<BlinkAnimation*>(_currentAnimation);
+    else if (index == 1) { // Blink
+        BlinkAnimation* anim = static_cast<BlinkAnimation*>(animation);
         anim->setInterval(ledUpdateInterval);
         anim->setPalette(&ALL_PALETTES[currentPalette]);
     }
-    else if (_currentAnimationIndex == 2) { // RainbowWave
-        RainbowWaveAnimation* anim = static_cast<RainbowWaveAnimation*>(_currentAnimation);
-        // Calculate speed based on update interval
-        float effectiveSpeed = 250.0f + (ledUpdateInterval - 10.0f) * (1250.0f / 1490.0f);
-        float speedValue = constrain(effectiveSpeed, 250, 1500);
-        float speedMultiplier = 3.0f - ((speedValue - 250) / 1250.0f * 2.5f);
-        
+    else if (index == 2) { // RainbowWave
+        RainbowWaveAnimation* anim = static_cast<RainbowWaveAnimation*>(animation);
         // Set animation parameters
         anim->setUpdateInterval(8);
-        anim->setSpeedMultiplier(speedMultiplier);
+        anim->setSpeedMultiplier(rainbowSpeedFor(ledUpdateInterval));
         anim->setHueScale(rainbowHueScale);
         
         // Set panel configuration
@@ -257,8 +451,8 @@ void LEDManager::configureCurrentAnimation() {
         anim->setRotationAngle2(rotationAngle2);
         anim->setRotationAngle3(rotationAngle3);
     }
-    else if (_currentAnimationIndex == 3) { // Firework
-        FireworkAnimation* anim = static_cast<FireworkAnimation*>(_currentAnimation);
+    else if (index == 3) { // Firework
+        FireworkAnimation* anim = static_cast<FireworkAnimation*>(animation);
         anim->setRotationAngle1(rotationAngle1);
         anim->setRotationAngle2(rotationAngle2);
         anim->setRotationAngle3(rotationAngle3);
@@ -269,8 +463,8 @@ void LEDManager::configureCurrentAnimation() {
         anim->setGravity(fireworkGravity);
         anim->setLaunchProbability(fireworkLaunchProbability);
     }
-    else if (_currentAnimationIndex == 4) { // GameOfLife
-        GameOfLifeAnimation* anim = static_cast<GameOfLifeAnimation*>(_currentAnimation);
+    else if (index == 4) { // GameOfLife
+        GameOfLifeAnimation* anim = static_cast<GameOfLifeAnimation*>(animation);
         anim->setRotationAngle1(rotationAngle1);
         anim->setRotationAngle2(rotationAngle2);
         anim->setRotationAngle3(rotationAngle3);
@@ -286,8 +480,8 @@ void LEDManager::configureCurrentAnimation() {
         anim->setStagnationLimit(lifeStagnationLimit);
         anim->setColorMode(lifeColorMode);
     }
-    else if (_currentAnimationIndex == 5) { // LangtonsAnt
-        LangtonsAntAnimation* anim = static_cast<LangtonsAntAnimation*>(_currentAnimation);
+    else if (index == 5) { // LangtonsAnt
+        LangtonsAntAnimation* anim = static_cast<LangtonsAntAnimation*>(animation);
         anim->setRotationAngle1(rotationAngle1);
         anim->setRotationAngle2(rotationAngle2);
         anim->setRotationAngle3(rotationAngle3);
@@ -299,8 +493,8 @@ void LEDManager::configureCurrentAnimation() {
         anim->setWrapMode(antWrapEdges);
         anim->setPalette(&ALL_PALETTES[currentPalette]);
     }
-    else if (_currentAnimationIndex == 6) { // SierpinskiCarpet
-        SierpinskiCarpetAnimation* anim = static_cast<SierpinskiCarpetAnimation*>(_currentAnimation);
+    else if (index == 6) { // SierpinskiCarpet
+        SierpinskiCarpetAnimation* anim = static_cast<SierpinskiCarpetAnimation*>(animation);
         anim->setRotationAngle1(rotationAngle1);
         anim->setRotationAngle2(rotationAngle2);
         anim->setRotationAngle3(rotationAngle3);
@@ -311,10 +505,44 @@ void LEDManager::configureCurrentAnimation() {
         anim->setColorShift(carpetColorShift);
         anim->setPalette(&ALL_PALETTES[currentPalette]);
     }
+    else if (index == 7) { // Text
+        TextAnimation* anim = static_cast<TextAnimation*>(animation);
+        anim->setRotationAngle1(rotationAngle1);
+        anim->setRotationAngle2(rotationAngle2);
+        anim->setRotationAngle3(rotationAngle3);
+        anim->setPanelOrder(panelOrder);
+        anim->setMessage(textMessage);
+        anim->setMode(textMode);
+        anim->setFont(textFont);
+        anim->setScrollSpeed(textSpeed);
+        anim->setPalette(&ALL_PALETTES[currentPalette]);
+    }
+    else if (index == 8) { // Snow
+        SnowAnimation* anim = static_cast<SnowAnimation*>(animation);
+        anim->setRotationAngle1(rotationAngle1);
+        anim->setRotationAngle2(rotationAngle2);
+        anim->setRotationAngle3(rotationAngle3);
+        anim->setPanelOrder(panelOrder);
+        anim->setUpdateInterval(ledUpdateInterval);
+        anim->setSpawnRate(spawnRate);
+        anim->setMaxFlakes(maxFlakes);
+        anim->setFadeAmount(fadeAmount);
+        anim->setPalette(&ALL_PALETTES[currentPalette]);
+    }
 }
 
 void LEDManager::cleanupAnimation() {
     LEDMANAGER_LOCK_OR_RETURN(1000);
+    if (_currentAnimation) {
+        _currentAnimation->setTarget(leds);
+        _animationCache.put(_currentAnimationIndex, _currentAnimation);
+        _currentAnimation = nullptr;
+    }
+}
+
+// Drops the running animation without caching it, so reselecting it starts
+// over
+void LEDManager::discardAnimation() {
     if (_currentAnimation) {
         _currentAnimation->end();
         // Add a delay before deletion to ensure resources are properly cleaned up
@@ -326,6 +554,33 @@ void LEDManager::cleanupAnimation() {
     }
 }
 
+// Constructs an animation by index for a canvas of panelCount panels;
+// nullptr for an unknown index
+BaseAnimation* LEDManager::createAnimation(int index, uint16_t numLeds, int panelCount) {
+    switch (index) {
+        case 0: // Traffic
+            return new TrafficAnimation(numLeds, _brightness, panelCount);
+        case 1: // Blink
+            return new BlinkAnimation(numLeds, _brightness, panelCount);
+        case 2: // RainbowWave
+            return new RainbowWaveAnimation(numLeds, _brightness, panelCount);
+        case 3: // Firework
+            return new FireworkAnimation(numLeds, _brightness, panelCount);
+        case 4: // GameOfLife
+            return new GameOfLifeAnimation(numLeds, _brightness, panelCount);
+        case 5: // LangtonsAnt
+            return new LangtonsAntAnimation(numLeds, _brightness, panelCount);
+        case 6: // SierpinskiCarpet
+            return new SierpinskiCarpetAnimation(numLeds, _brightness, panelCount);
+        case 7: // Text
+            return new TextAnimation(numLeds, _brightness, panelCount);
+        case 8: // Snow
+            return new SnowAnimation(numLeds, _brightness, panelCount);
+        default:
+            return nullptr;
+    }
+}
+
 void LEDManager::setAnimation(int index) {
     LEDMANAGER_LOCK_OR_RETURN(1000);
     // Validate animation index
@@ -339,39 +594,30 @@ void LEDManager::setAnimation(int index) {
     systemInfo("Setting animation to: " + _animationNames[index] + " (index " + String(index) + ")");
     systemInfo("Free heap before animation change: " + String(heapBefore) + " bytes");
 
-    // Clean up old animation
+    // Reselecting the running animation restarts it
+    if (index == _currentAnimationIndex && _currentAnimation && !_outgoingAnimation) {
+        discardAnimation();
+    }
+
+    // Keep the old animation running under a transition, or park it in the
+    // warm cache
+    bool transition = beginTransition();
     cleanupAnimation();
-    
+
+    if (resumeCachedAnimation(index, transition)) {
+        return;
+    }
+    _animationCache.trim();
+
     // Create new animation
     _currentAnimationIndex = index;
     
     try {
-        switch (index) {
-            case 0: // Traffic
-                _currentAnimation = new TrafficAnimation(_numLeds, _brightness, _panelCount);
-                break;
-            case 1: // Blink
-                _currentAnimation = new BlinkAnimation(_numLeds, _brightness, _panelCount);
-                break;
-            case 2: // RainbowWave
-                _currentAnimation = new RainbowWaveAnimation(_numLeds, _brightness, _panelCount);
-                break;
-            case 3: // Firework
-                _currentAnimation = new FireworkAnimation(_numLeds, _brightness, _panelCount);
-                break;
-            case 4: // GameOfLife
-                _currentAnimation = new GameOfLifeAnimation(_numLeds, _brightness, _panelCount);
-                break;
-            case 5: // LangtonsAnt
-                _currentAnimation = new LangtonsAntAnimation(_numLeds, _brightness, _panelCount);
-                break;
-            case 6: // SierpinskiCarpet
-                _currentAnimation = new SierpinskiCarpetAnimation(_numLeds, _brightness, _panelCount);
-                break;
-            default:
-                systemError("Unknown animation index: " + String(index) + ", falling back to Traffic");
-                _currentAnimation = new TrafficAnimation(_numLeds, _brightness, _panelCount);
-                _currentAnimationIndex = 0;
+        _currentAnimation = createAnimation(index, _numLeds, _panelCount);
+        if (!_currentAnimation) {
+            systemError("Unknown animation index: " + String(index) + ", falling back to Traffic");
+            _currentAnimation = new TrafficAnimation(_numLeds, _brightness, _panelCount);
+            _currentAnimationIndex = 0;
         }
     } catch (const std::exception& e) {
         // Handle memory allocation failures
@@ -384,6 +630,9 @@ void LEDManager::setAnimation(int index) {
         } catch (...) {
             systemCritical("CRITICAL: Failed to create even the fallback animation!");
             _currentAnimation = nullptr;
+            if (transition) {
+                finishTransition();
+            }
             return;
         }
     } catch (...) {
@@ -396,6 +645,9 @@ void LEDManager::setAnimation(int index) {
         } catch (...) {
             systemCritical("CRITICAL: Failed to create even the fallback animation!");
             _currentAnimation = nullptr;
+            if (transition) {
+                finishTransition();
+            }
             return;
         }
     }
@@ -407,233 +659,94 @@ void LEDManager::setAnimation(int index) {
     
     // Configure the new animation
     if (_currentAnimation) {
+        _currentAnimation->setTarget(transition ? _transition.incoming() : renderTarget());
         this->configureCurrentAnimation();
+        _currentAnimation->seedRandom(animationSeed(_currentAnimationIndex, 0));
         _currentAnimation->begin();
+    } else if (transition) {
+        finishTransition();
     }
 }
 
+// Swaps in a suspended instance of the animation, if the cache has one
+bool LEDManager::resumeCachedAnimation(int index, bool transition) {
+    uint32_t suspendedMs = 0;
+    BaseAnimation* cached = _animationCache.take(index, suspendedMs);
+    if (!cached) {
+        return false;
+    }
+
+    _currentAnimation = cached;
+    _currentAnimationIndex = index;
+    // The panel count may have changed while it was parked
+    _currentAnimation->resize(_numLeds, _panelCount);
+    _currentAnimation->setTarget(transition ? _transition.incoming() : renderTarget());
+    this->configureCurrentAnimation();
+    _currentAnimation->resume(suspendedMs);
+    systemInfo("Animation resumed from cache: " + _animationNames[index] +
+               " (suspended " + String(suspendedMs) + " ms)");
+    return true;
+}
+
 void LEDManager::setPanelCount(int count) {
     LEDMANAGER_LOCK_OR_RETURN(1000);
     if(count<1) count=1;
     if(count>8) count=8;
 
-    Serial.printf("Setting panel count to %d\n", count);
-    systemInfo("Setting panel count to " + String(count));
+    if (!_controller) {
+        // Not rendering yet (startup), nothing to synchronise with
+        applyPanelCount(count);
+        return;
+    }
+    // Committed by update() at the next frame boundary
+    _pendingPanelCount = count;
+    Serial.printf("Panel count change to %d pending\n", count);
+}
 
-    int oldCount = _panelCount;
-    int oldNumLeds= _numLeds;
-    int oldIdx = _currentAnimationIndex;
+// Resizes the output and the running animation in place. The controller
+// grows before the next show; when shrinking, the dropped LEDs are blanked
+// and the controller shrinks after that frame has been sent (see show()).
+void LEDManager::applyPanelCount(int count) {
+    _pendingPanelCount = 0;
+    if (count == _panelCount) {
+        return;
+    }
 
+    int oldNumLeds = _numLeds;
     _panelCount = count;
     _numLeds = _panelCount * 16 * 16;
+    rebuildLayout();
     Serial.printf("Panel count set to %d, _numLeds=%d\n", _panelCount, _numLeds);
     systemInfo("Panel count set to " + String(_panelCount) + ", total LEDs=" + String(_numLeds));
 
-    if(_numLeds < oldNumLeds){
-        systemInfo("Clearing unused LEDs from previous configuration");
-        for(int i=_numLeds; i<oldNumLeds && i<MAX_LEDS; i++){
-            leds[i]=CRGB::Black;
-        }
-        FastLED.show();
-    }
-    
-    systemInfo("Reinitializing FastLED with new panel count");
-    reinitFastLED();
-
-    systemInfo("Cleaning up animation for panel count change");
-    cleanupAnimation();
-    _currentAnimationIndex = -1;
-    
-    // Reset animation with safety checks
-    if (oldIdx >= 0 && oldIdx < (int)_animationNames.size()) {
-        systemInfo("Recreating animation: " + _animationNames[oldIdx]);
-        
-        try {
-            setAnimation(oldIdx);
-        } catch (const std::exception& e) {
-            // Catch any memory allocation failures or other exceptions
-            systemError("Error recreating animation: " + String(e.what()));
-            
-            // Try to fall back to Traffic animation (simplest)
-            systemInfo("Falling back to Traffic animation");
-            try {
-                setAnimation(0); // Traffic animation
-            } catch (...) {
-                systemCritical("CRITICAL: Failed to create fallback animation!");
-            }
-        } catch (...) {
-            systemError("Unknown error recreating animation");
-            
-            // Try to fall back to Traffic animation
-            try {
-                setAnimation(0); // Traffic animation
-            } catch (...) {
-                systemCritical("CRITICAL: Failed to create fallback animation!");
-            }
+    if (_numLeds < oldNumLeds) {
+        for (int i = _numLeds; i < oldNumLeds && i < MAX_LEDS; i++) {
+            leds[i] = CRGB::Black;
         }
     } else {
-        systemInfo("No valid previous animation, defaulting to Traffic");
-        try {
-            setAnimation(0); // Set to Traffic animation (first one)
-        } catch (...) {
-            systemCritical("CRITICAL: Failed to create any animation!");
+        for (int i = oldNumLeds; i < _numLeds && i < MAX_LEDS; i++) {
+            leds[i] = CRGB::Black;
         }
+        resizeController(_numLeds);
+    }
+
+    if (_currentAnimation) {
+        _currentAnimation->resize(_numLeds, _panelCount);
+    }
+    if (_outgoingAnimation) {
+        _outgoingAnimation->resize(_numLeds, _panelCount);
     }
 }
 
 int LEDManager::getPanelCount() const {
     LEDMANAGER_LOCK_CONST_OR_RETURN_VALUE(1000, _panelCount);
-    return _panelCount;
+    return _pendingPanelCount > 0 ? _pendingPanelCount : _panelCount;
 }
 
 void LEDManager::identifyPanels(){
     LEDMANAGER_LOCK_OR_RETURN(1000);
-    Serial.println("identifyPanels() invoked, blocking 10s...");
-    int oldIdx = _currentAnimationIndex;
-    cleanupAnimation();
-    _currentAnimationIndex=-1; 
-
-    FastLED.clear(true);
-
-    for(int p=0; p<_panelCount; p++){
-        int base = p*16*16; 
-        drawUpArrow(base);
-        drawLargeDigit(base, p+1); 
-    }
-    FastLED.show();
-
-    delay(10000);
-
-    if(oldIdx>=0){
-        setAnimation(oldIdx);
-    } else {
-        setAnimation(0);
-    }
-}
-
-void LEDManager::drawUpArrow(int baseIndex){
-    int idx = baseIndex + (0*16)+8;
-    if(idx<MAX_LEDS) leds[idx]=CRGB::Green;
-
-    for(int x=7; x<=9; x++){
-        idx= baseIndex+(1*16)+x;
-        if(idx<MAX_LEDS) leds[idx]=CRGB::Green;
-    }
-    for(int x=6; x<=10; x++){
-        idx= baseIndex+(2*16)+x;
-        if(idx<MAX_LEDS) leds[idx]=CRGB::Green;
-    }
-    for(int x=5; x<=11; x++){
-        idx= baseIndex+(3*16)+x;
-        if(idx<MAX_LEDS) leds[idx]=CRGB::Green;
-    }
-}
-
-void LEDManager::drawLargeDigit(int baseIndex, int digit){
-    if(digit<1) digit=1;
-    if(digit>8) digit=8;
-    static const bool digits8x8[8][64] = {
-        {
-          false,false,true,false,false,false,false,false,
-          false,false,true,false,false,false,false,false,
-          false,false,true,false,false,false,false,false,
-          false,false,true,false,false,false,false,false,
-          false,false,true,false,false,false,false,false,
-          false,false,true,false,false,false,false,false,
-          false,false,true,false,false,false,false,false,
-          false,false,true,false,false,false,false,false
-        },
-        {
-          true,true,true,true,false,false,false,false,
-          false,false,false,true,false,false,false,false,
-          false,false,false,true,false,false,false,false,
-          true,true,true,true,false,false,false,false,
-          true,false,false,false,false,false,false,false,
-          true,false,false,false,false,false,false,false,
-          true,true,true,true,false,false,false,false,
-          false,false,false,false,false,false,false,false
-        },
-        {
-          true,true,true,true,false,false,false,false,
-          false,false,false,true,false,false,false,false,
-          false,false,false,true,false,false,false,false,
-          false,true,true,true,false,false,false,false,
-          false,false,false,true,false,false,false,false,
-          false,false,false,true,false,false,false,false,
-          true,true,true,true,false,false,false,false,
-          false,false,false,false,false,false,false,false
-        },
-        {
-          true,false,false,true,false,false,false,false,
-          true,false,false,true,false,false,false,false,
-          true,false,false,true,false,false,false,false,
-          true,true,true,true,false,false,false,false,
-          false,false,false,true,false,false,false,false,
-          false,false,false,true,false,false,false,false,
-          false,false,false,true,false,false,false,false,
-          false,false,false,false,false,false,false,false
-        },
-        {
-          true,true,true,true,false,false,false,false,
-          true,false,false,false,false,false,false,false,
-          true,false,false,false,false,false,false,false,
-          true,true,true,true,false,false,false,false,
-          false,false,false,true,false,false,false,false,
-          false,false,false,true,false,false,false,false,
-          true,true,true,true,false,false,false,false,
-          false,false,false,false,false,false,false,false
-        },
-        {
-          false,true,true,true,false,false,false,false,
-          true,false,false,false,false,false,false,false,
-          true,false,false,false,false,false,false,false,
-          true,true,true,true,false,false,false,false,
-          true,false,false,true,false,false,false,false,
-          true,false,false,true,false,false,false,false,
-          false,true,true,true,false,false,false,false,
-          false,false,false,false,false,false,false,false
-        },
-        {
-          true,true,true,true,false,false,false,false,
-          false,false,false,true,false,false,false,false,
-          false,false,false,true,false,false,false,false,
-          false,false,false,true,false,false,false,false,
-          false,false,false,true,false,false,false,false,
-          false,false,false,true,false,false,false,false,
-          false,false,false,true,false,false,false,false,
-          false,false,false,false,false,false,false,false
-        },
-        {
-          false,true,true,true,false,false,false,false,
-          true,false,false,true,false,false,false,false,
-          true,false,false,true,false,false,false,false,
-          false,true,true,true,false,false,false,false,
-          true,false,false,true,false,false,false,false,
-          true,false,false,true,false,false,false,false,
-          false,true,true,true,false,false,false,false,
-          false,false,false,false,false,false,false,false
-        }
-    };
-
-    CRGB color = CHSV((digit*32) & 255, 255, 255);
-
-    int startX=4;
-    int startY=6;
-    int indexDigit= digit-1;
-
-    for(int row=0; row<8; row++){
-        for(int col=0; col<8; col++){
-            bool on = digits8x8[indexDigit][row*8 + col];
-            if(on){
-                int x= startX+ col;
-                int y= startY+ row;
-                int idx= baseIndex + y*16 + x;
-                if(idx<MAX_LEDS){
-                    leds[idx]= color;
-                }
-            }
-        }
-    }
+    Serial.printf("identifyPanels() invoked, overlay for %lu ms\n", (unsigned long)IDENTIFY_DURATION_MS);
+    _identify.start(_layout, IDENTIFY_DURATION_MS);
 }
 
 void LEDManager::createPalettes() {
@@ -662,12 +775,22 @@ void LEDManager::createPalettes() {
         "retro_arcade",
         "royal_rainbow"
     };
+    _builtinPaletteCount = ALL_PALETTES.size();
+}
+
+int LEDManager::findPalette(const String& name) const {
+    for (size_t i = 0; i < PALETTE_NAMES.size(); i++) {
+        if (PALETTE_NAMES[i] == name) {
+            return (int)i;
+        }
+    }
+    return -1;
 }
 
 void LEDManager::setBrightness(uint8_t b){
     LEDMANAGER_LOCK_OR_RETURN(1000);
     _brightness=b;
-    FastLED.setBrightness(_brightness);
+    _output.setBrightness(_brightness);
 
     if(_currentAnimation) {
         _currentAnimation->setBrightness(_brightness);
@@ -679,34 +802,140 @@ uint8_t LEDManager::getBrightness() const {
     return _brightness;
 }
 
+void LEDManager::setGamma(float gamma) {
+    LEDMANAGER_LOCK_OR_RETURN(1000);
+    _output.setGamma(gamma);
+}
+
+float LEDManager::getGamma() const {
+    LEDMANAGER_LOCK_CONST_OR_RETURN_VALUE(1000, _output.gamma());
+    return _output.gamma();
+}
+
+void LEDManager::setDither(bool enabled) {
+    LEDMANAGER_LOCK_OR_RETURN(1000);
+    _output.setDither(enabled);
+}
+
+bool LEDManager::getDither() const {
+    LEDMANAGER_LOCK_CONST_OR_RETURN_VALUE(1000, _output.dither());
+    return _output.dither();
+}
+
+void LEDManager::setPanelCalibration(uint8_t panel, const PanelCalibration& calibration) {
+    LEDMANAGER_LOCK_OR_RETURN(1000);
+    _output.setCalibration(panel, calibration);
+}
+
+PanelCalibration LEDManager::getPanelCalibration(uint8_t panel) const {
+    LEDMANAGER_LOCK_CONST_OR_RETURN_VALUE(1000, _output.calibration(panel));
+    return _output.calibration(panel);
+}
+
+void LEDManager::setPowerBudget(uint16_t budgetMa) {
+    LEDMANAGER_LOCK_OR_RETURN(1000);
+    _output.setPowerBudget(budgetMa);
+    warnIfBudgetBelowIdle();
+}
+
+uint16_t LEDManager::getPowerBudget() const {
+    LEDMANAGER_LOCK_CONST_OR_RETURN_VALUE(1000, _output.powerBudget());
+    return _output.powerBudget();
+}
+
+void LEDManager::setPowerRailPanels(uint8_t panels) {
+    LEDMANAGER_LOCK_OR_RETURN(1000);
+    _output.setRailPanels(panels);
+    warnIfBudgetBelowIdle();
+}
+
+// The limiter can only dim lit LEDs, so a rail whose idle draw already
+// uses the budget is held at the limiter's floor
+void LEDManager::warnIfBudgetBelowIdle() const {
+    const uint16_t budgetMa = _output.powerBudget();
+    const uint32_t idleMa = _output.railIdleMa();
+    if (budgetMa != 0 && budgetMa <= idleMa) {
+        systemWarning("Power budget " + String(budgetMa) + " mA is at or below the " +
+                      String(idleMa) + " mA idle current of a " +
+                      String(_output.railPanels()) + "-panel rail; it cannot be met");
+    }
+}
+
+uint8_t LEDManager::getPowerRailPanels() const {
+    LEDMANAGER_LOCK_CONST_OR_RETURN_VALUE(1000, _output.railPanels());
+    return _output.railPanels();
+}
+
+OutputStage::PowerStats LEDManager::getPowerStats() const {
+    LEDMANAGER_LOCK_CONST_OR_RETURN_VALUE(1000, _output.powerStats());
+    return _output.powerStats();
+}
+
 void LEDManager::setPalette(int idx){
     LEDMANAGER_LOCK_OR_RETURN(1000);
     if(idx>=0 && idx<(int)ALL_PALETTES.size()){
         currentPalette= idx;
         Serial.printf("Palette %d (%s) selected.\n", idx, PALETTE_NAMES[idx].c_str());
-        if(_currentAnimationIndex==0 && _currentAnimation){
-            TrafficAnimation* t = static_cast<TrafficAnimation*>(_currentAnimation);
-            t->setCurrentPalette(currentPalette);
-        }
-        else if(_currentAnimationIndex==1 && _currentAnimation){
-            BlinkAnimation* bA = static_cast<BlinkAnimation*>(_currentAnimation);
-            bA->setPalette(&ALL_PALETTES[currentPalette]);
-        }
-        else if(_currentAnimationIndex==4 && _currentAnimation){
-            auto* g = static_cast<GameOfLifeAnimation*>(_currentAnimation);
-            g->setCurrentPalette(currentPalette);
+        if(_currentAnimation){
+            applyPalette(_currentAnimation, _currentAnimationIndex, currentPalette);
         }
-        else if(_currentAnimationIndex==5 && _currentAnimation){
-            auto* a = static_cast<LangtonsAntAnimation*>(_currentAnimation);
-            a->setPalette(&ALL_PALETTES[currentPalette]);
+        refreshPalette(currentPalette);
+    }
+}
+
+// Hands palette idx to an animation that draws with one; the others ignore it
+void LEDManager::applyPalette(BaseAnimation* animation, int index, int idx) {
+    if (index == 0) { // Traffic
+        static_cast<TrafficAnimation*>(animation)->setCurrentPalette(idx);
+    }
+    else if (index == 1) { // Blink
+        static_cast<BlinkAnimation*>(animation)->setPalette(&ALL_PALETTES[idx]);
+    }
+    else if (index == 4) { // GameOfLife
+        static_cast<GameOfLifeAnimation*>(animation)->setCurrentPalette(idx);
+    }
+    else if (index == 5) { // LangtonsAnt
+        static_cast<LangtonsAntAnimation*>(animation)->setPalette(&ALL_PALETTES[idx]);
+    }
+    else if (index == 6) { // SierpinskiCarpet
+        static_cast<SierpinskiCarpetAnimation*>(animation)->setPalette(&ALL_PALETTES[idx]);
+    }
+    else if (index == 7) { // Text
+        static_cast<TextAnimation*>(animation)->setPalette(&ALL_PALETTES[idx]);
+    }
+    else if (index == 8) { // Snow
+        static_cast<SnowAnimation*>(animation)->setPalette(&ALL_PALETTES[idx]);
+    }
+}
+
+// Palette idx was selected or its stops changed: re-applies it to every
+// zone drawing with it (pinned, or following the global palette) and, when
+// it is the global palette, to the layers
+void LEDManager::refreshPalette(int idx) {
+    for (uint8_t slot = 0; slot < ZoneSet::MAX_ZONES; slot++) {
+        BaseAnimation* animation = _zones.animation(slot);
+        if (!animation) continue;
+        const ZoneConfig config = _zones.config(slot);
+        if (zonePalette(config) == idx) {
+            applyPalette(animation, config.animation, idx);
         }
-        else if(_currentAnimationIndex==6 && _currentAnimation){
-            auto* s = static_cast<SierpinskiCarpetAnimation*>(_currentAnimation);
-            s->setPalette(&ALL_PALETTES[currentPalette]);
+    }
+    if (idx != currentPalette) {
+        return;
+    }
+    for (uint8_t slot = 0; slot < LayerStack::MAX_LAYERS; slot++) {
+        BaseAnimation* animation = _layers.animation(slot);
+        if (animation) {
+            applyPalette(animation, _layers.info(slot).source, idx);
         }
     }
 }
 
+int LEDManager::zonePalette(const ZoneConfig& config) const {
+    return (config.palette >= 0 && config.palette < (int)ALL_PALETTES.size())
+        ? config.palette : currentPalette;
+}
+
 int LEDManager::getCurrentPalette() const {
     LEDMANAGER_LOCK_CONST_OR_RETURN_VALUE(1000, currentPalette);
     return currentPalette;
@@ -731,12 +960,99 @@ const std::vector<CRGB>& LEDManager::getCurrentPaletteColors() const {
     return ALL_PALETTES[currentPalette];
 }
 
+// Animations copy or compile the stops they are given, so growing or
+// shrinking ALL_PALETTES leaves nothing pointing into it; re-selecting the
+// current palette hands the running animation its (possibly moved) entry
+bool LEDManager::setUserPalette(const String& name, const std::vector<CRGB>& stops) {
+    LEDMANAGER_LOCK_OR_RETURN_VALUE(1000, false);
+    if (!PaletteStore::validName(name) || stops.empty() || stops.size() > PaletteStore::MAX_STOPS) {
+        return false;
+    }
+    int idx = findPalette(name);
+    if (idx >= 0 && idx < (int)_builtinPaletteCount) {
+        return false;
+    }
+    if (idx >= 0) {
+        ALL_PALETTES[idx] = stops;
+    } else {
+        if (ALL_PALETTES.size() - _builtinPaletteCount >= PaletteStore::MAX_PALETTES) {
+            return false;
+        }
+        ALL_PALETTES.push_back(stops);
+        PALETTE_NAMES.push_back(name);
+        idx = (int)ALL_PALETTES.size() - 1;
+    }
+    if (idx == currentPalette) {
+        setPalette(currentPalette);
+    } else {
+        refreshPalette(idx);
+    }
+    return true;
+}
+
+// Indices above the removed palette shift down, in zones too; if it was
+// selected the first built-in palette takes over, and zones pinned to it
+// go back to following the global palette
+bool LEDManager::removeUserPalette(const String& name) {
+    LEDMANAGER_LOCK_OR_RETURN_VALUE(1000, false);
+    int idx = findPalette(name);
+    if (idx < (int)_builtinPaletteCount) {
+        return false;
+    }
+    ALL_PALETTES.erase(ALL_PALETTES.begin() + idx);
+    PALETTE_NAMES.erase(PALETTE_NAMES.begin() + idx);
+    if (currentPalette >= idx) {
+        currentPalette = currentPalette == idx ? 0 : currentPalette - 1;
+        setPalette(currentPalette);
+    }
+    for (uint8_t slot = 0; slot < ZoneSet::MAX_ZONES; slot++) {
+        BaseAnimation* animation = _zones.animation(slot);
+        ZoneConfig config = _zones.config(slot);
+        if (!animation || config.palette < idx) continue;
+        config.palette = config.palette == idx ? -1 : config.palette - 1;
+        _zones.setPalette(slot, config.palette);
+        applyPalette(animation, config.animation, zonePalette(config));
+    }
+    return true;
+}
+
+std::vector<PaletteDef> LEDManager::getUserPalettes() const {
+    std::vector<PaletteDef> palettes;
+    LEDMANAGER_LOCK_CONST_OR_RETURN_VALUE(1000, palettes);
+    for (size_t i = _builtinPaletteCount; i < ALL_PALETTES.size(); i++) {
+        PaletteDef p;
+        p.name = PALETTE_NAMES[i];
+        p.stops = ALL_PALETTES[i];
+        palettes.push_back(p);
+    }
+    return palettes;
+}
+
+size_t LEDManager::getBuiltinPaletteCount() const {
+    return _builtinPaletteCount;
+}
+
 void LEDManager::setSpawnRate(float r){
     LEDMANAGER_LOCK_OR_RETURN(1000);
     spawnRate=r;
-    if(_currentAnimationIndex==0 && _currentAnimation){
-        TrafficAnimation* t = static_cast<TrafficAnimation*>(_currentAnimation);
-        t->setSpawnRate(r);
+    if(_currentAnimation){
+        applySpawnRate(_currentAnimation, _currentAnimationIndex, r);
+    }
+    for (uint8_t slot = 0; slot < ZoneSet::MAX_ZONES; slot++) {
+        BaseAnimation* animation = _zones.animation(slot);
+        const ZoneConfig config = _zones.config(slot);
+        if (animation && config.spawnRate < 0) {
+            applySpawnRate(animation, config.animation, r);
+        }
+    }
+}
+
+void LEDManager::applySpawnRate(BaseAnimation* animation, int index, float rate) {
+    if (index == 0) { // Traffic
+        static_cast<TrafficAnimation*>(animation)->setSpawnRate(rate);
+    }
+    else if (index == 8) { // Snow
+        static_cast<SnowAnimation*>(animation)->setSpawnRate(rate);
     }
 }
 float LEDManager::getSpawnRate() const {
@@ -751,6 +1067,9 @@ void LEDManager::setMaxFlakes(int m){
         TrafficAnimation* t = static_cast<TrafficAnimation*>(_currentAnimation);
         t->setMaxCars(m);
     }
+    else if(_currentAnimationIndex==8 && _currentAnimation){
+        static_cast<SnowAnimation*>(_currentAnimation)->setMaxFlakes(m);
+    }
 }
 int LEDManager::getMaxFlakes() const {
     LEDMANAGER_LOCK_CONST_OR_RETURN_VALUE(1000, maxFlakes);
@@ -773,9 +1092,24 @@ int LEDManager::getTailLength() const {
 void LEDManager::setFadeAmount(uint8_t a){
     LEDMANAGER_LOCK_OR_RETURN(1000);
     fadeAmount=a;
-    if(_currentAnimationIndex==0 && _currentAnimation){
-        TrafficAnimation* t = static_cast<TrafficAnimation*>(_currentAnimation);
-        t->setFadeAmount(a);
+    if(_currentAnimation){
+        applyFadeAmount(_currentAnimation, _currentAnimationIndex, a);
+    }
+    for (uint8_t slot = 0; slot < ZoneSet::MAX_ZONES; slot++) {
+        BaseAnimation* animation = _zones.animation(slot);
+        const ZoneConfig config = _zones.config(slot);
+        if (animation && config.fade < 0) {
+            applyFadeAmount(animation, config.animation, a);
+        }
+    }
+}
+
+void LEDManager::applyFadeAmount(BaseAnimation* animation, int index, uint8_t amount) {
+    if (index == 0) { // Traffic
+        static_cast<TrafficAnimation*>(animation)->setFadeAmount(amount);
+    }
+    else if (index == 8) { // Snow
+        static_cast<SnowAnimation*>(animation)->setFadeAmount(amount);
     }
 }
 uint8_t LEDManager::getFadeAmount() const {
@@ -786,6 +1120,7 @@ uint8_t LEDManager::getFadeAmount() const {
 void LEDManager::swapPanels(){
     LEDMANAGER_LOCK_OR_RETURN(1000);
     panelOrder=1-panelOrder;
+    rebuildLayout();
     Serial.println("Panels swapped successfully.");
     if(!_currentAnimation) {
         return;
@@ -809,6 +1144,8 @@ void LEDManager::swapPanels(){
     } else if(_currentAnimationIndex==6){
         auto* s = static_cast<SierpinskiCarpetAnimation*>(_currentAnimation);
         s->setPanelOrder(panelOrder);
+    } else if(_currentAnimationIndex==8){
+        static_cast<SnowAnimation*>(_currentAnimation)->setPanelOrder(panelOrder);
     }
 }
 void LEDManager::setPanelOrder(String order){
@@ -824,6 +1161,7 @@ void LEDManager::setPanelOrder(String order){
     else{
         return;
     }
+    rebuildLayout();
     if(!_currentAnimation) {
         return;
     }
@@ -846,6 +1184,8 @@ void LEDManager::setPanelOrder(String order){
     } else if(_currentAnimationIndex==6){
         auto* s = static_cast<SierpinskiCarpetAnimation*>(_currentAnimation);
         s->setPanelOrder(panelOrder);
+    } else if(_currentAnimationIndex==8){
+        static_cast<SnowAnimation*>(_currentAnimation)->setPanelOrder(panelOrder);
     }
 }
 
@@ -862,6 +1202,7 @@ void LEDManager::rotatePanel(String panel, int angle){
     }
     if(panel.equalsIgnoreCase("panel1")){
         rotationAngle1=angle;
+        rebuildLayout();
         Serial.printf("Panel1 angle set to %d\n", angle);
         if(_currentAnimation){
             if(_currentAnimationIndex==0){
@@ -876,11 +1217,14 @@ void LEDManager::rotatePanel(String panel, int angle){
                 static_cast<LangtonsAntAnimation*>(_currentAnimation)->setRotationAngle1(angle);
             } else if(_currentAnimationIndex==6){
                 static_cast<SierpinskiCarpetAnimation*>(_currentAnimation)->setRotationAngle1(angle);
+            } else if(_currentAnimationIndex==8){
+                static_cast<SnowAnimation*>(_currentAnimation)->setRotationAngle1(angle);
             }
         }
     }
     else if(panel.equalsIgnoreCase("panel2")){
         rotationAngle2=angle;
+        rebuildLayout();
         Serial.printf("Panel2 angle set to %d\n", angle);
         if(_currentAnimation){
             if(_currentAnimationIndex==0){
@@ -895,11 +1239,14 @@ void LEDManager::rotatePanel(String panel, int angle){
                 static_cast<LangtonsAntAnimation*>(_currentAnimation)->setRotationAngle2(angle);
             } else if(_currentAnimationIndex==6){
                 static_cast<SierpinskiCarpetAnimation*>(_currentAnimation)->setRotationAngle2(angle);
+            } else if(_currentAnimationIndex==8){
+                static_cast<SnowAnimation*>(_currentAnimation)->setRotationAngle2(angle);
             }
         }
     }
     else if(panel.equalsIgnoreCase("panel3")){
         rotationAngle3=angle;
+        rebuildLayout();
         Serial.printf("Panel3 angle set to %d\n", angle);
         if(_currentAnimation){
             if(_currentAnimationIndex==0){
@@ -914,6 +1261,8 @@ void LEDManager::rotatePanel(String panel, int angle){
                 static_cast<LangtonsAntAnimation*>(_currentAnimation)->setRotationAngle3(angle);
             } else if(_currentAnimationIndex==6){
                 static_cast<SierpinskiCarpetAnimation*>(_currentAnimation)->setRotationAngle3(angle);
+            } else if(_currentAnimationIndex==8){
+                static_cast<SnowAnimation*>(_currentAnimation)->setRotationAngle3(angle);
             }
         }
     }
@@ -938,46 +1287,48 @@ void LEDManager::setUpdateSpeed(unsigned long speed){
         LEDMANAGER_LOCK_OR_RETURN(1000);
         ledUpdateInterval=speed;
         Serial.printf("LED update speed set to %lu ms\n", speed);
-        if(_currentAnimationIndex==0 && _currentAnimation){
-            TrafficAnimation* t = static_cast<TrafficAnimation*>(_currentAnimation);
-            t->setUpdateInterval(speed);
-        }
-        else if(_currentAnimationIndex==1 && _currentAnimation){
-            BlinkAnimation* bA = static_cast<BlinkAnimation*>(_currentAnimation);
-            bA->setInterval(speed);
-        }
-        else if(_currentAnimationIndex==2 && _currentAnimation){
-            RainbowWaveAnimation* wA = static_cast<RainbowWaveAnimation*>(_currentAnimation);
-            
-            float effectiveSpeed = 250.0f + (speed - 10.0f) * (1250.0f / 1490.0f);
-            
-            float speedValue = constrain(effectiveSpeed, 250, 1500);
-            float speedMultiplier = 3.0f - ((speedValue - 250) / 1250.0f * 2.5f);
-            
-            wA->setSpeedMultiplier(speedMultiplier);
-            
-            Serial.printf("RainbowWave effective speed: %.0fms, multiplier: %.2f\n", 
-                speedValue, speedMultiplier);
-        }
-        else if(_currentAnimationIndex==3 && _currentAnimation){
-            auto* f = static_cast<FireworkAnimation*>(_currentAnimation);
-            f->setUpdateInterval(speed);
-        }
-        else if(_currentAnimationIndex==4 && _currentAnimation){
-            auto* g = static_cast<GameOfLifeAnimation*>(_currentAnimation);
-            uint8_t mapped = map((int)speed, 3, 1500, 0, 255);
-            g->setSpeed(mapped);
-        }
-        else if(_currentAnimationIndex==5 && _currentAnimation){
-            auto* a = static_cast<LangtonsAntAnimation*>(_currentAnimation);
-            a->setUpdateInterval(speed);
+        if(_currentAnimation){
+            applySpeed(_currentAnimation, _currentAnimationIndex, speed);
         }
-        else if(_currentAnimationIndex==6 && _currentAnimation){
-            auto* s = static_cast<SierpinskiCarpetAnimation*>(_currentAnimation);
-            s->setUpdateInterval(speed);
+        for (uint8_t slot = 0; slot < ZoneSet::MAX_ZONES; slot++) {
+            BaseAnimation* animation = _zones.animation(slot);
+            const ZoneConfig config = _zones.config(slot);
+            if (animation && config.speed < 0) {
+                applySpeed(animation, config.animation, speed);
+            }
         }
     }
 }
+
+// The speed setting is an update interval in ms; each animation maps it
+// onto its own notion of speed
+void LEDManager::applySpeed(BaseAnimation* animation, int index, unsigned long speed) {
+    if (index == 0) { // Traffic
+        static_cast<TrafficAnimation*>(animation)->setUpdateInterval(speed);
+    }
+    else if (index == 1) { // Blink
+        static_cast<BlinkAnimation*>(animation)->setInterval(speed);
+    }
+    else if (index == 2) { // RainbowWave
+        static_cast<RainbowWaveAnimation*>(animation)->setSpeedMultiplier(rainbowSpeedFor(speed));
+    }
+    else if (index == 3) { // Firework
+        static_cast<FireworkAnimation*>(animation)->setUpdateInterval(speed);
+    }
+    else if (index == 4) { // GameOfLife
+        uint8_t mapped = map((int)speed, 3, 1500, 0, 255);
+        static_cast<GameOfLifeAnimation*>(animation)->setSpeed(mapped);
+    }
+    else if (index == 5) { // LangtonsAnt
+        static_cast<LangtonsAntAnimation*>(animation)->setUpdateInterval(speed);
+    }
+    else if (index == 6) { // SierpinskiCarpet
+        static_cast<SierpinskiCarpetAnimation*>(animation)->setUpdateInterval(speed);
+    }
+    else if (index == 8) { // Snow
+        static_cast<SnowAnimation*>(animation)->setUpdateInterval(speed);
+    }
+}
 unsigned long LEDManager::getUpdateSpeed() const {
     LEDMANAGER_LOCK_CONST_OR_RETURN_VALUE(1000, ledUpdateInterval);
     return ledUpdateInterval;
@@ -1280,6 +1631,129 @@ uint8_t LEDManager::getRainbowHueScale() const {
     return rainbowHueScale;
 }
 
+void LEDManager::setTextMessage(const String& message) {
+    LEDMANAGER_LOCK_OR_RETURN(1000);
+    textMessage = message.substring(0, TEXT_MESSAGE_MAX);
+    if (_currentAnimationIndex == 7 && _currentAnimation) {
+        static_cast<TextAnimation*>(_currentAnimation)->setMessage(textMessage);
+    }
+    for (uint8_t slot = 0; slot < ZoneSet::MAX_ZONES; slot++) {
+        BaseAnimation* animation = _zones.animation(slot);
+        const ZoneConfig config = _zones.config(slot);
+        if (animation && config.animation == 7 && config.message.length() == 0) {
+            static_cast<TextAnimation*>(animation)->setMessage(textMessage);
+        }
+    }
+}
+
+String LEDManager::getTextMessage() const {
+    LEDMANAGER_LOCK_CONST_OR_RETURN_VALUE(1000, textMessage);
+    return textMessage;
+}
+
+void LEDManager::setTextMode(uint8_t mode) {
+    LEDMANAGER_LOCK_OR_RETURN(1000);
+    if (mode >= TextAnimation::MODE_COUNT) mode = TextAnimation::MODE_MESSAGE;
+    textMode = mode;
+    if (_currentAnimationIndex == 7 && _currentAnimation) {
+        static_cast<TextAnimation*>(_currentAnimation)->setMode(textMode);
+    }
+}
+
+uint8_t LEDManager::getTextMode() const {
+    LEDMANAGER_LOCK_CONST_OR_RETURN_VALUE(1000, textMode);
+    return textMode;
+}
+
+void LEDManager::setTextFont(uint8_t font) {
+    LEDMANAGER_LOCK_OR_RETURN(1000);
+    if (font >= FONT_COUNT) font = FONT_5X7;
+    textFont = font;
+    if (_currentAnimationIndex == 7 && _currentAnimation) {
+        static_cast<TextAnimation*>(_currentAnimation)->setFont(textFont);
+    }
+}
+
+uint8_t LEDManager::getTextFont() const {
+    LEDMANAGER_LOCK_CONST_OR_RETURN_VALUE(1000, textFont);
+    return textFont;
+}
+
+void LEDManager::setTextSpeed(uint8_t columnsPerSecond) {
+    LEDMANAGER_LOCK_OR_RETURN(1000);
+    if (columnsPerSecond < 1) columnsPerSecond = 1;
+    if (columnsPerSecond > 100) columnsPerSecond = 100;
+    textSpeed = columnsPerSecond;
+    if (_currentAnimationIndex == 7 && _currentAnimation) {
+        static_cast<TextAnimation*>(_currentAnimation)->setScrollSpeed(textSpeed);
+    }
+}
+
+uint8_t LEDManager::getTextSpeed() const {
+    LEDMANAGER_LOCK_CONST_OR_RETURN_VALUE(1000, textSpeed);
+    return textSpeed;
+}
+
+void LEDManager::setTransitionDuration(uint16_t ms) {
+    LEDMANAGER_LOCK_OR_RETURN(1000);
+    if (ms > 5000) ms = 5000;
+    transitionMs = ms;
+}
+
+uint16_t LEDManager::getTransitionDuration() const {
+    LEDMANAGER_LOCK_CONST_OR_RETURN_VALUE(1000, transitionMs);
+    return transitionMs;
+}
+
+void LEDManager::setTransitionCurve(uint8_t curve) {
+    LEDMANAGER_LOCK_OR_RETURN(1000);
+    if (curve >= TransitionCompositor::CURVE_COUNT) curve = TransitionCompositor::CURVE_LINEAR;
+    transitionCurve = curve;
+}
+
+uint8_t LEDManager::getTransitionCurve() const {
+    LEDMANAGER_LOCK_CONST_OR_RETURN_VALUE(1000, transitionCurve);
+    return transitionCurve;
+}
+
+void LEDManager::setTransitionWipe(uint8_t wipe) {
+    LEDMANAGER_LOCK_OR_RETURN(1000);
+    if (wipe >= TransitionCompositor::WIPE_COUNT) wipe = TransitionCompositor::WIPE_CROSSFADE;
+    transitionWipe = wipe;
+}
+
+uint8_t LEDManager::getTransitionWipe() const {
+    LEDMANAGER_LOCK_CONST_OR_RETURN_VALUE(1000, transitionWipe);
+    return transitionWipe;
+}
+
+void LEDManager::setRandomSeed(uint32_t seed) {
+    LEDMANAGER_LOCK_OR_RETURN(1000);
+    _randomSeed = seed;
+    AnimationClock::setFixedStep(seed ? DETERMINISTIC_FRAME_MS : 0);
+    systemInfo(seed ? "Deterministic mode, seed " + String(seed) : String("Deterministic mode off"));
+    // A resumed instance would carry on from its old sequence
+    _animationCache.clear();
+    if (_currentAnimation) {
+        setAnimation(_currentAnimationIndex);
+    }
+}
+
+uint32_t LEDManager::getRandomSeed() const {
+    LEDMANAGER_LOCK_CONST_OR_RETURN_VALUE(1000, _randomSeed);
+    return _randomSeed;
+}
+
+// Mixes the place into the seed so a layer or zone running the same
+// animation as the main one does not mirror it
+uint32_t LEDManager::animationSeed(int index, uint16_t place) const {
+    if (_randomSeed == 0) {
+        return esp_random();
+    }
+    Rng mix(_randomSeed ^ ((uint32_t)place << 16) ^ (uint32_t)index);
+    return mix.next();
+}
+
 int LEDManager::getAnimation() const {
     LEDMANAGER_LOCK_CONST_OR_RETURN_VALUE(1000, _currentAnimationIndex);
     return _currentAnimationIndex;
@@ -1295,3 +1769,215 @@ String LEDManager::getAnimationName(int animIndex) const {
     }
     return "Unknown";
 }
+
+AnimationCache::Stats LEDManager::getAnimationCacheStats() const {
+    LEDMANAGER_LOCK_CONST_OR_RETURN_VALUE(1000, AnimationCache::Stats());
+    return _animationCache.stats();
+}
+
+// Assigns an animation to an overlay layer; animIndex < 0 clears it. The
+// layer's instance takes the settings current at assignment time.
+bool LEDManager::setLayer(uint8_t slot, int animIndex) {
+    LEDMANAGER_LOCK_OR_RETURN_VALUE(1000, false);
+    if (slot >= LayerStack::MAX_LAYERS || animIndex >= (int)_animationNames.size()) {
+        return false;
+    }
+    bool wasActive = _layers.active();
+
+    if (animIndex < 0) {
+        if (!_layers.animation(slot)) {
+            return true;
+        }
+        if (_layers.count() == 1) {
+            // Last layer going: hand leds[] back to the main animation first
+            memcpy(leds, _layers.base(), sizeof(CRGB) * _numLeds);
+            retargetMainAnimation(leds);
+        }
+        _layers.clear(slot);
+        systemInfo("Layer " + String(slot) + " cleared");
+        return true;
+    }
+
+    BaseAnimation* animation = nullptr;
+    try {
+        animation = createAnimation(animIndex, _numLeds, _panelCount);
+    } catch (...) {
+        animation = nullptr;
+    }
+    if (!animation) {
+        systemError("Failed to create layer animation '" + _animationNames[animIndex] + "'");
+        return false;
+    }
+    configureAnimation(animation, animIndex);
+    if (!_layers.assign(slot, animation, animIndex, _numLeds)) {
+        return false;
+    }
+    animation->seedRandom(animationSeed(animIndex, SEED_LAYER + slot));
+    animation->begin();
+
+    if (!wasActive) {
+        memcpy(_layers.base(), leds, sizeof(CRGB) * _numLeds);
+        retargetMainAnimation(_layers.base());
+    }
+    systemInfo("Layer " + String(slot) + " set to " + _animationNames[animIndex]);
+    return true;
+}
+
+// During a transition the animations draw into the compositor's buffers and
+// only its output follows renderTarget(), so nothing needs moving
+void LEDManager::retargetMainAnimation(CRGB* target) {
+    if (_currentAnimation && !_outgoingAnimation) {
+        _currentAnimation->setTarget(target);
+    }
+}
+
+void LEDManager::setLayerOpacity(uint8_t slot, uint8_t opacity) {
+    LEDMANAGER_LOCK_OR_RETURN(1000);
+    _layers.setOpacity(slot, opacity);
+}
+
+void LEDManager::setLayerBlend(uint8_t slot, uint8_t blend) {
+    LEDMANAGER_LOCK_OR_RETURN(1000);
+    _layers.setBlend(slot, blend);
+}
+
+void LEDManager::setLayerMask(uint8_t slot, uint8_t mode, int x, int y, int w, int h) {
+    LEDMANAGER_LOCK_OR_RETURN(1000);
+    _layers.setMask(slot, mode, x, y, w, h, _layout);
+}
+
+LayerStack::LayerInfo LEDManager::getLayerInfo(uint8_t slot) const {
+    LEDMANAGER_LOCK_CONST_OR_RETURN_VALUE(1000, LayerStack::LayerInfo());
+    return _layers.info(slot);
+}
+
+bool LEDManager::setZone(uint8_t slot, const ZoneConfig& config) {
+    LEDMANAGER_LOCK_OR_RETURN_VALUE(1000, false);
+    if (slot >= ZoneSet::MAX_ZONES || config.animation >= (int)_animationNames.size()) {
+        return false;
+    }
+    if (config.animation < 0) {
+        _zones.clear(slot);
+        systemInfo("Zone " + String(slot) + " cleared");
+        return true;
+    }
+    if (config.w <= 0 || config.h <= 0) {
+        return false;
+    }
+
+    int panels = ZoneSet::panelsFor(config);
+    BaseAnimation* animation = nullptr;
+    try {
+        animation = createAnimation(config.animation, panels * 16 * 16, panels);
+    } catch (...) {
+        animation = nullptr;
+    }
+    if (!animation) {
+        systemError("Failed to create zone animation '" + _animationNames[config.animation] + "'");
+        return false;
+    }
+    ZoneConfig zone = config;
+    zone.message = zone.message.substring(0, TEXT_MESSAGE_MAX);
+    configureAnimation(animation, zone.animation);
+    applyZoneSettings(animation, zone.animation, zone);
+    if (!_zones.assign(slot, zone, animation, _layout)) {
+        return false;
+    }
+    animation->seedRandom(animationSeed(config.animation, SEED_ZONE + slot));
+    animation->begin();
+    systemInfo("Zone " + String(slot) + " set to " + _animationNames[config.animation] +
+               " at " + String(config.x) + "," + String(config.y) + " " +
+               String(config.w) + "x" + String(config.h));
+    return true;
+}
+
+ZoneConfig LEDManager::getZone(uint8_t slot) const {
+    LEDMANAGER_LOCK_CONST_OR_RETURN_VALUE(1000, _zones.config(ZoneSet::MAX_ZONES));
+    return _zones.config(slot);
+}
+
+// Zone animations draw an unrotated left-to-right strip (ZoneSet maps it
+// onto the canvas) and may use their own palette
+void LEDManager::applyZoneSettings(BaseAnimation* animation, int index, const ZoneConfig& config) {
+    int palette = zonePalette(config);
+
+    if (index == 0) { // Traffic
+        TrafficAnimation* anim = static_cast<TrafficAnimation*>(animation);
+        anim->setRotationAngle1(0);
+        anim->setRotationAngle2(0);
+        anim->setRotationAngle3(0);
+        anim->setPanelOrder(0);
+        anim->setCurrentPalette(palette);
+    }
+    else if (index == 1) { // Blink
+        static_cast<BlinkAnimation*>(animation)->setPalette(&ALL_PALETTES[palette]);
+    }
+    else if (index == 2) { // RainbowWave
+        RainbowWaveAnimation* anim = static_cast<RainbowWaveAnimation*>(animation);
+        anim->setPanelOrder(0);
+        anim->setRotationAngle1(0);
+        anim->setRotationAngle2(0);
+        anim->setRotationAngle3(0);
+    }
+    else if (index == 3) { // Firework
+        FireworkAnimation* anim = static_cast<FireworkAnimation*>(animation);
+        anim->setRotationAngle1(0);
+        anim->setRotationAngle2(0);
+        anim->setRotationAngle3(0);
+        anim->setPanelOrder(0);
+    }
+    else if (index == 4) { // GameOfLife
+        GameOfLifeAnimation* anim = static_cast<GameOfLifeAnimation*>(animation);
+        anim->setRotationAngle1(0);
+        anim->setRotationAngle2(0);
+        anim->setRotationAngle3(0);
+        anim->setPanelOrder(0);
+        anim->setCurrentPalette(palette);
+    }
+    else if (index == 5) { // LangtonsAnt
+        LangtonsAntAnimation* anim = static_cast<LangtonsAntAnimation*>(animation);
+        anim->setRotationAngle1(0);
+        anim->setRotationAngle2(0);
+        anim->setRotationAngle3(0);
+        anim->setPanelOrder(0);
+        anim->setPalette(&ALL_PALETTES[palette]);
+    }
+    else if (index == 6) { // SierpinskiCarpet
+        SierpinskiCarpetAnimation* anim = static_cast<SierpinskiCarpetAnimation*>(animation);
+        anim->setRotationAngle1(0);
+        anim->setRotationAngle2(0);
+        anim->setRotationAngle3(0);
+        anim->setPanelOrder(0);
+        anim->setPalette(&ALL_PALETTES[palette]);
+    }
+    else if (index == 7) { // Text
+        TextAnimation* anim = static_cast<TextAnimation*>(animation);
+        anim->setRotationAngle1(0);
+        anim->setRotationAngle2(0);
+        anim->setRotationAngle3(0);
+        anim->setPanelOrder(0);
+        anim->setPalette(&ALL_PALETTES[palette]);
+    }
+    else if (index == 8) { // Snow
+        SnowAnimation* anim = static_cast<SnowAnimation*>(animation);
+        anim->setRotationAngle1(0);
+        anim->setRotationAngle2(0);
+        anim->setRotationAngle3(0);
+        anim->setPanelOrder(0);
+        anim->setPalette(&ALL_PALETTES[palette]);
+    }
+
+    // The zone's own settings over the global ones configureAnimation() set
+    if (config.speed > 0) {
+        applySpeed(animation, index, config.speed);
+    }
+    if (config.spawnRate >= 0) {
+        applySpawnRate(animation, index, config.spawnRate);
+    }
+    if (config.fade >= 0) {
+        applyFadeAmount(animation, index, (uint8_t)config.fade);
+    }
+    if (index == 7 && config.message.length() > 0) {
+        static_cast<TextAnimation*>(animation)->setMessage(config.message);
+    }
+}
@@ -6,6 +6,15 @@
 #include <Arduino.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
+#include "PanelLayout.h"
+#include "FrameIngest.h"
+#include "IdentifyOverlay.h"
+#include "TransitionCompositor.h"
+#include "AnimationCache.h"
+#include "LayerStack.h"
+#include "ZoneSet.h"
+#include "OutputStage.h"
+#include "PaletteStore.h"
 
 // Up to 8 panels of 16×16
 static const int MAX_LEDS = 16 * 16 * 8;
@@ -29,7 +38,8 @@ public:
     void setPanelCount(int count);
     int  getPanelCount() const;
 
-    // Identify panels (stops animation, draws arrow+digit, waits 10s, restores)
+    // Identify panels: overlays number, arrow and wiring on each panel for
+    // IDENTIFY_DURATION_MS. Returns immediately; the animation keeps running.
     void identifyPanels();
 
     // Animations
@@ -37,11 +47,41 @@ public:
     int  getAnimation() const;
     size_t getAnimationCount() const;
     String getAnimationName(int animIndex) const;
+    AnimationCache::Stats getAnimationCacheStats() const;
+
+    // Overlay layers over the main animation, bottom (0) to top
+    bool setLayer(uint8_t slot, int animIndex);
+    void setLayerOpacity(uint8_t slot, uint8_t opacity);
+    void setLayerBlend(uint8_t slot, uint8_t blend);
+    void setLayerMask(uint8_t slot, uint8_t mode, int x, int y, int w, int h);
+    LayerStack::LayerInfo getLayerInfo(uint8_t slot) const;
+
+    // Zones: independent animations on canvas rectangles, drawn over the
+    // main animation and under the layers. animation < 0 clears the slot.
+    bool setZone(uint8_t slot, const ZoneConfig& config);
+    ZoneConfig getZone(uint8_t slot) const;
 
     // Brightness
     void setBrightness(uint8_t brightness);
     uint8_t getBrightness() const;
 
+    // Output stage: gamma curve, temporal dithering and per-panel colour
+    // calibration, applied with brightness when the frame is sent
+    void setGamma(float gamma);
+    float getGamma() const;
+    void setDither(bool enabled);
+    bool getDither() const;
+    void setPanelCalibration(uint8_t panel, const PanelCalibration& calibration);
+    PanelCalibration getPanelCalibration(uint8_t panel) const;
+
+    // Current limiting: budget in mA for each rail of railPanels panels
+    // along the strip (0 = unlimited)
+    void setPowerBudget(uint16_t budgetMa);
+    uint16_t getPowerBudget() const;
+    void setPowerRailPanels(uint8_t panels);
+    uint8_t getPowerRailPanels() const;
+    OutputStage::PowerStats getPowerStats() const;
+
     // Palette
     void setPalette(int paletteIndex);
     int  getCurrentPalette() const;
@@ -49,6 +89,15 @@ public:
     String getPaletteNameAt(int index) const;
     const std::vector<CRGB>& getCurrentPaletteColors() const;
 
+    // User palettes follow the built-in ones. Setting an existing user
+    // palette's name replaces its stops. False for an invalid name or
+    // stops, a built-in name, or when PaletteStore::MAX_PALETTES are
+    // already defined.
+    bool setUserPalette(const String& name, const std::vector<CRGB>& stops);
+    bool removeUserPalette(const String& name);
+    std::vector<PaletteDef> getUserPalettes() const;
+    size_t getBuiltinPaletteCount() const;
+
     // Spawn
     void setSpawnRate(float rate);
     float getSpawnRate() const;
@@ -70,6 +119,10 @@ public:
     void rotatePanel(String panel, int angle);
     int  getRotation(String panel) const;
 
+    // Frame streaming (/ws/frames)
+    FrameIngest& frameIngest();
+    bool isStreaming() const;
+
     // Speed
     void setUpdateSpeed(unsigned long speed);
     unsigned long getUpdateSpeed() const;
@@ -121,6 +174,35 @@ public:
     void setRainbowHueScale(uint8_t scale);
     uint8_t getRainbowHueScale() const;
 
+    // Text settings
+    void setTextMessage(const String& message);
+    String getTextMessage() const;
+    void setTextMode(uint8_t mode);
+    uint8_t getTextMode() const;
+    void setTextFont(uint8_t font);
+    uint8_t getTextFont() const;
+    void setTextSpeed(uint8_t columnsPerSecond);
+    uint8_t getTextSpeed() const;
+
+    // Animation transitions (0 ms = hard cut)
+    void setTransitionDuration(uint16_t ms);
+    uint16_t getTransitionDuration() const;
+    void setTransitionCurve(uint8_t curve);
+    uint8_t getTransitionCurve() const;
+    void setTransitionWipe(uint8_t wipe);
+    uint8_t getTransitionWipe() const;
+
+    // Deterministic mode: with a nonzero seed every animation instance is
+    // seeded from it (and its index and slot) when it starts, and animation
+    // time advances DETERMINISTIC_FRAME_MS per rendered frame instead of
+    // following the wall clock. The same seed and settings then replay the
+    // same frames, frame for frame, at any frame rate. 0 seeds from the
+    // hardware RNG and returns to wall-clock time. Setting it restarts the
+    // main animation and drops the cache; layers and zones pick it up when
+    // next assigned.
+    void setRandomSeed(uint32_t seed);
+    uint32_t getRandomSeed() const;
+
     bool beginExclusiveAccess(uint32_t timeoutMs = 1000) const;
     void endExclusiveAccess() const;
 
@@ -135,15 +217,41 @@ public:
     };
 
 private:
-    // Re-init FastLED if panelCount changes
-    void reinitFastLED();
+    // Output controller, registered once and resized in place
+    void initController();
+    void resizeController(uint16_t count);
+    void applyPanelCount(int count);
+    void warnIfBudgetBelowIdle() const;
+    BaseAnimation* createAnimation(int index, uint16_t numLeds, int panelCount);
+    void applyZoneSettings(BaseAnimation* animation, int index, const ZoneConfig& config);
+    void applyPalette(BaseAnimation* animation, int index, int idx);
+    void applySpeed(BaseAnimation* animation, int index, unsigned long speed);
+    void applySpawnRate(BaseAnimation* animation, int index, float rate);
+    void applyFadeAmount(BaseAnimation* animation, int index, uint8_t amount);
+    void refreshPalette(int idx);
+    // Palette a zone draws with: its own, or the global one
+    int zonePalette(const ZoneConfig& config) const;
+    void configureAnimation(BaseAnimation* animation, int index);
     void cleanupAnimation();
+    void discardAnimation();
+    bool resumeCachedAnimation(int index, bool transition);
     void createPalettes();
+    int findPalette(const String& name) const;
     void configureCurrentAnimation();
-
-    // The bigger arrow + digit methods
-    void drawUpArrow(int baseIndex);
-    void drawLargeDigit(int baseIndex, int digit);
+    void rebuildLayout();
+    bool pollFrameStream();
+    bool beginTransition();
+    void updateTransition();
+    void finishTransition();
+    CRGB* renderTarget();
+    void retargetMainAnimation(CRGB* target);
+    // Seed for animation index starting in place: 0 for the main
+    // animation, SEED_LAYER or SEED_ZONE plus the slot otherwise
+    uint32_t animationSeed(int index, uint16_t place) const;
+    static const uint16_t SEED_LAYER = 0x100;
+    // Animation time per frame in deterministic mode (50 fps)
+    static const uint16_t DETERMINISTIC_FRAME_MS = 20;
+    static const uint16_t SEED_ZONE = 0x200;
 
 private:
     bool _isInitializing;  // Flag to indicate system is still initializing
@@ -154,11 +262,15 @@ private:
     std::vector<std::vector<CRGB>> ALL_PALETTES;
     std::vector<String>            PALETTE_NAMES;
     int                            currentPalette;
+    size_t                         _builtinPaletteCount;
 
     BaseAnimation* _currentAnimation;
     int            _currentAnimationIndex;
     std::vector<String> _animationNames;
 
+    // Animations switched away from, kept suspended for a quick return
+    AnimationCache _animationCache;
+
     float   spawnRate;
     int     maxFlakes;
     int     tailLength;
@@ -199,6 +311,52 @@ private:
     // Rainbow wave settings
     uint8_t rainbowHueScale;
 
+    // Text settings
+    String textMessage;
+    uint8_t textMode;
+    uint8_t textFont;
+    uint8_t textSpeed;
+    static const unsigned int TEXT_MESSAGE_MAX = 128;
+
+    // Animation transitions: the previous animation keeps rendering into
+    // the compositor until the incoming one has fully taken over
+    TransitionCompositor _transition;
+    BaseAnimation* _outgoingAnimation;
+    int _outgoingAnimationIndex;
+    uint32_t _transitionFrame;
+    uint16_t transitionMs;
+    uint8_t transitionCurve;
+    uint8_t transitionWipe;
+
+    // 0 = not deterministic
+    uint32_t _randomSeed;
+
+    // Zone animations and overlays composited over the main animation in
+    // update(), in that order
+    ZoneSet _zones;
+    LayerStack _layers;
+
+    // Logical canvas mapping and streamed frames
+    PanelLayout _layout;
+    FrameIngest _frameIngest;
+    bool _streaming;
+    unsigned long _lastStreamFrame;
+    static const unsigned long STREAM_TIMEOUT_MS = 2500;
+
+    // FastLED controller for the strip and the length it currently drives
+    CLEDController* _controller;
+    uint16_t _controllerLeds;
+    // Panel count requested by setPanelCount(), applied in update(); 0 = none
+    int _pendingPanelCount;
+
+    // Brightness, gamma, calibration, dithering and current limiting into
+    // the buffer the controller sends, run in show()
+    OutputStage _output;
+
+    // Panel identification overlay, composited in show()
+    IdentifyOverlay _identify;
+    static const uint32_t IDENTIFY_DURATION_MS = 10000;
+
     mutable SemaphoreHandle_t _stateMutex;
 };
 
@@ -0,0 +1,281 @@
+// File: LayerStack.cpp
+// Overlay layers composited over the main animation
+
+#include "LayerStack.h"
+#include "animations/BaseAnimation.h"
+#include <esp_heap_caps.h>
+#include <string.h>
+
+static void* allocPreferPsram(size_t bytes) {
+    void* p = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!p) {
+        p = heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+    }
+    return p;
+}
+
+LayerStack::LayerStack()
+    : _base(nullptr)
+    , _assigned(0)
+    , _numLeds(0)
+{
+    for (uint8_t i = 0; i < MAX_LAYERS; i++) {
+        Layer& layer = _layers[i];
+        layer.anim = nullptr;
+        layer.source = -1;
+        layer.pixels = nullptr;
+        layer.mask = nullptr;
+        layer.covered = 0;
+        layer.opacity = 255;
+        layer.blend = BLEND_NORMAL;
+        layer.maskMode = MASK_NONE;
+        layer.x = layer.y = layer.w = layer.h = 0;
+    }
+}
+
+LayerStack::~LayerStack() {
+    clearAll();
+}
+
+bool LayerStack::assign(uint8_t slot, BaseAnimation* anim, int source, uint16_t numLeds) {
+    if (slot >= MAX_LAYERS || !anim) {
+        delete anim;
+        return false;
+    }
+    Layer& layer = _layers[slot];
+
+    if (!_base) {
+        _base = (CRGB*)allocPreferPsram(sizeof(CRGB) * PanelLayout::MAX_PIXELS);
+    }
+    if (!layer.pixels) {
+        layer.pixels = (CRGB*)allocPreferPsram(sizeof(CRGB) * PanelLayout::MAX_PIXELS);
+    }
+    if (!_base || !layer.pixels) {
+        Serial.println("LayerStack: Failed to allocate layer buffers");
+        delete anim;
+        if (!layer.anim) {
+            release(layer);
+        }
+        if (_assigned == 0 && _base) {
+            heap_caps_free(_base);
+            _base = nullptr;
+        }
+        return false;
+    }
+
+    if (layer.anim) {
+        layer.anim->end();
+        delete layer.anim;
+    } else {
+        _assigned++;
+    }
+    _numLeds = numLeds;
+    fill_solid(layer.pixels, PanelLayout::MAX_PIXELS, CRGB::Black);
+    layer.anim = anim;
+    layer.source = source;
+    anim->setTarget(layer.pixels);
+    return true;
+}
+
+void LayerStack::clear(uint8_t slot) {
+    if (slot >= MAX_LAYERS) {
+        return;
+    }
+    // An empty slot can still hold a mask set ahead of assign()
+    const bool assigned = _layers[slot].anim != nullptr;
+    release(_layers[slot]);
+    if (!assigned) {
+        return;
+    }
+    _assigned--;
+    if (_assigned == 0 && _base) {
+        heap_caps_free(_base);
+        _base = nullptr;
+    }
+}
+
+void LayerStack::clearAll() {
+    for (uint8_t i = 0; i < MAX_LAYERS; i++) {
+        clear(i);
+    }
+}
+
+void LayerStack::release(Layer& layer) {
+    if (layer.anim) {
+        layer.anim->end();
+        delete layer.anim;
+        layer.anim = nullptr;
+    }
+    if (layer.pixels) {
+        heap_caps_free(layer.pixels);
+        layer.pixels = nullptr;
+    }
+    if (layer.mask) {
+        heap_caps_free(layer.mask);
+        layer.mask = nullptr;
+    }
+    layer.source = -1;
+    layer.covered = 0;
+    layer.opacity = 255;
+    layer.blend = BLEND_NORMAL;
+    layer.maskMode = MASK_NONE;
+    layer.x = layer.y = layer.w = layer.h = 0;
+}
+
+void LayerStack::setOpacity(uint8_t slot, uint8_t opacity) {
+    if (slot < MAX_LAYERS) {
+        _layers[slot].opacity = opacity;
+    }
+}
+
+void LayerStack::setBlend(uint8_t slot, uint8_t blend) {
+    if (slot < MAX_LAYERS) {
+        _layers[slot].blend = blend < BLEND_COUNT ? blend : BLEND_NORMAL;
+    }
+}
+
+void LayerStack::setMask(uint8_t slot, uint8_t mode, int x, int y, int w, int h, const PanelLayout& layout) {
+    if (slot >= MAX_LAYERS) {
+        return;
+    }
+    Layer& layer = _layers[slot];
+    layer.maskMode = mode < MASK_COUNT ? mode : MASK_NONE;
+    layer.x = (int16_t)x;
+    layer.y = (int16_t)y;
+    layer.w = (int16_t)(w > 0 ? w : 0);
+    layer.h = (int16_t)(h > 0 ? h : 0);
+    buildMask(layer, layout);
+}
+
+// Rectangle masks are resolved to physical indices once, so compose() does
+// not need the layout
+void LayerStack::buildMask(Layer& layer, const PanelLayout& layout) {
+    if (layer.maskMode != MASK_RECT) {
+        if (layer.mask) {
+            heap_caps_free(layer.mask);
+            layer.mask = nullptr;
+        }
+        layer.covered = layout.pixelCount();
+        return;
+    }
+    if (!layer.mask) {
+        layer.mask = (uint8_t*)allocPreferPsram(PanelLayout::MAX_PIXELS);
+        if (!layer.mask) {
+            Serial.println("LayerStack: Failed to allocate mask");
+            layer.covered = 0;
+            return;
+        }
+    }
+    memset(layer.mask, 0, PanelLayout::MAX_PIXELS);
+    layer.covered = 0;
+    for (int y = layer.y; y < layer.y + layer.h; y++) {
+        for (int x = layer.x; x < layer.x + layer.w; x++) {
+            int index = layout.indexChecked(x, y);
+            if (index >= 0 && !layer.mask[index]) {
+                layer.mask[index] = 255;
+                layer.covered++;
+            }
+        }
+    }
+}
+
+LayerStack::LayerInfo LayerStack::info(uint8_t slot) const {
+    LayerInfo out;
+    const Layer& layer = _layers[slot < MAX_LAYERS ? slot : 0];
+    out.source = slot < MAX_LAYERS ? layer.source : -1;
+    out.opacity = layer.opacity;
+    out.blend = layer.blend;
+    out.mask = layer.maskMode;
+    out.x = layer.x;
+    out.y = layer.y;
+    out.w = layer.w;
+    out.h = layer.h;
+    return out;
+}
+
+BaseAnimation* LayerStack::animation(uint8_t slot) const {
+    return slot < MAX_LAYERS ? _layers[slot].anim : nullptr;
+}
+
+void LayerStack::relayout(const PanelLayout& layout, uint16_t numLeds, int panelCount) {
+    _numLeds = numLeds;
+    for (uint8_t i = 0; i < MAX_LAYERS; i++) {
+        Layer& layer = _layers[i];
+        if (!layer.anim) continue;
+        layer.anim->resize(numLeds, panelCount);
+        buildMask(layer, layout);
+    }
+}
+
+bool LayerStack::visible(const Layer& layer) const {
+    return layer.anim && layer.opacity != 0 &&
+           (layer.maskMode != MASK_RECT || layer.covered != 0);
+}
+
+void LayerStack::update() {
+    for (uint8_t i = 0; i < MAX_LAYERS; i++) {
+        if (visible(_layers[i])) {
+            _layers[i].anim->update();
+        }
+    }
+}
+
+CRGB LayerStack::blendPixel(const CRGB& dst, const CRGB& src, uint8_t mode, uint8_t alpha) {
+    CRGB mixed;
+    switch (mode) {
+        case BLEND_ADD:
+            return CRGB(qadd8(dst.r, scale8(src.r, alpha)),
+                        qadd8(dst.g, scale8(src.g, alpha)),
+                        qadd8(dst.b, scale8(src.b, alpha)));
+        case BLEND_MULTIPLY:
+            mixed = CRGB(scale8(dst.r, src.r), scale8(dst.g, src.g), scale8(dst.b, src.b));
+            break;
+        case BLEND_SCREEN:
+            mixed = CRGB(255 - scale8(255 - dst.r, 255 - src.r),
+                         255 - scale8(255 - dst.g, 255 - src.g),
+                         255 - scale8(255 - dst.b, 255 - src.b));
+            break;
+        case BLEND_MAX:
+            mixed = CRGB(max(dst.r, src.r), max(dst.g, src.g), max(dst.b, src.b));
+            break;
+        default:
+            mixed = src;
+            break;
+    }
+    return alpha == 255 ? mixed : blend(dst, mixed, alpha);
+}
+
+void LayerStack::compose(CRGB* out, uint16_t count) {
+    // Gather the visible layers once so the pixel loop only walks those
+    const Layer* visibleLayers[MAX_LAYERS];
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < MAX_LAYERS; i++) {
+        if (visible(_layers[i])) {
+            visibleLayers[n++] = &_layers[i];
+        }
+    }
+    if (n == 0) {
+        memcpy(out, _base, sizeof(CRGB) * count);
+        return;
+    }
+
+    for (uint16_t i = 0; i < count; i++) {
+        CRGB c = _base[i];
+        for (uint8_t l = 0; l < n; l++) {
+            const Layer& layer = *visibleLayers[l];
+            uint8_t alpha = layer.opacity;
+            if (layer.mask) {
+                alpha = scale8(alpha, layer.mask[i]);
+            }
+            const CRGB& src = layer.pixels[i];
+            if (layer.maskMode == MASK_LUMA) {
+                alpha = scale8(alpha, max(src.r, max(src.g, src.b)));
+            }
+            if (alpha == 0) {
+                continue;
+            }
+            c = blendPixel(c, src, layer.blend, alpha);
+        }
+        out[i] = c;
+    }
+}
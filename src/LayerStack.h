@@ -0,0 +1,110 @@
+// File: LayerStack.h
+// Overlay layers composited over the main animation
+
+#ifndef LAYERSTACK_H
+#define LAYERSTACK_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include "PanelLayout.h"
+
+class BaseAnimation;
+
+/**
+ * Up to MAX_LAYERS overlays drawn over the main animation, bottom to top.
+ * Each layer owns an animation instance rendering into a private buffer,
+ * an opacity, a blend mode and an optional mask.
+ *
+ * While any layer is assigned the main animation renders into base()
+ * instead of leds[], so the overlays never feed back into animations that
+ * build on their previous frame. compose() then makes a single pass over
+ * the pixels, folding every visible layer into the base colour before the
+ * result is written out. Layers at zero opacity, or whose mask covers no
+ * pixel, are neither updated nor composited.
+ *
+ * Buffers are allocated when a layer is first assigned (PSRAM preferred)
+ * and freed when the last layer is cleared.
+ */
+class LayerStack {
+public:
+    static const uint8_t MAX_LAYERS = 3;
+
+    enum BlendMode : uint8_t {
+        BLEND_NORMAL = 0,
+        BLEND_ADD,
+        BLEND_MULTIPLY,
+        BLEND_SCREEN,
+        BLEND_MAX,
+        BLEND_COUNT
+    };
+
+    enum MaskMode : uint8_t {
+        MASK_NONE = 0,
+        MASK_LUMA,      // black source pixels are transparent
+        MASK_RECT,      // only a logical rectangle is drawn
+        MASK_COUNT
+    };
+
+    struct LayerInfo {
+        int source;         // animation index, -1 = empty
+        uint8_t opacity;
+        uint8_t blend;
+        uint8_t mask;
+        int16_t x, y, w, h; // MASK_RECT rectangle, logical pixels
+    };
+
+    LayerStack();
+    ~LayerStack();
+
+    bool active() const { return _assigned > 0; }
+    uint8_t count() const { return _assigned; }
+    CRGB* base() { return _base; }
+
+    // Takes ownership of anim and points it at the layer's buffer. Replaces
+    // (and deletes) whatever the slot held. Returns false if buffers could
+    // not be allocated; anim is deleted in that case.
+    bool assign(uint8_t slot, BaseAnimation* anim, int source, uint16_t numLeds);
+    void clear(uint8_t slot);
+    void clearAll();
+
+    void setOpacity(uint8_t slot, uint8_t opacity);
+    void setBlend(uint8_t slot, uint8_t blend);
+    void setMask(uint8_t slot, uint8_t mode, int x, int y, int w, int h, const PanelLayout& layout);
+
+    LayerInfo info(uint8_t slot) const;
+    BaseAnimation* animation(uint8_t slot) const;
+
+    // Panel count changed: resizes the layer animations and rebuilds masks
+    void relayout(const PanelLayout& layout, uint16_t numLeds, int panelCount);
+
+    // Advances the visible layers' animations
+    void update();
+
+    // out[i] = base[i] with every visible layer blended over it
+    void compose(CRGB* out, uint16_t count);
+
+private:
+    struct Layer {
+        BaseAnimation* anim;
+        int source;
+        CRGB* pixels;
+        uint8_t* mask;      // per-pixel coverage for MASK_RECT, else null
+        uint16_t covered;   // pixels with non-zero coverage
+        uint8_t opacity;
+        uint8_t blend;
+        uint8_t maskMode;
+        int16_t x, y, w, h;
+    };
+
+    bool visible(const Layer& layer) const;
+    void buildMask(Layer& layer, const PanelLayout& layout);
+    void release(Layer& layer);
+    static CRGB blendPixel(const CRGB& dst, const CRGB& src, uint8_t mode, uint8_t alpha);
+
+    Layer _layers[MAX_LAYERS];
+    CRGB* _base;
+    uint8_t _assigned;
+    uint16_t _numLeds;
+};
+
+#endif // LAYERSTACK_H
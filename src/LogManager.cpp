@@ -1,10 +1,13 @@
 #include "LogManager.h"
+#include "WorkQueue.h"
 
 // LogManager implementation
 LogManager::LogManager() {
     // Create mutex for thread safety
     logMutex = xSemaphoreCreateMutex();
+    nextSeq = 0;
     pendingFlushCount = 0;
+    flushQueued = false;
     lastFlushMillis = millis();
     
     // Attempt to load logs from file
@@ -18,19 +21,7 @@ void LogManager::log(LogLevel level, const String& message) {
     bool shouldFlush = false;
     // Take mutex
     if (logMutex != NULL && xSemaphoreTake(logMutex, pdMS_TO_TICKS(500)) == pdTRUE) {
-        // Trim logs if exceeding maximum
-        if (logs.size() >= MAX_LOG_ENTRIES) {
-            logs.erase(logs.begin());
-        }
-        
-        // Create log entry
-        LogEntry entry;
-        entry.timestamp = millis();
-        entry.level = level;
-        entry.message = message;
-        
-        // Add to logs
-        logs.push_back(entry);
+        pushEntry(millis(), level, message);
         
         // Always print to Serial for debugging
         Serial.print(millis());
@@ -62,7 +53,7 @@ void LogManager::log(LogLevel level, const String& message) {
     }
 
     if (shouldFlush) {
-        saveLogsToFile();
+        requestFlush();
     }
 }
 
@@ -127,6 +118,83 @@ String LogManager::getLogs(LogLevel minLevel) {
     return result;
 }
 
+// Caller holds logMutex
+void LogManager::pushEntry(unsigned long timestamp, LogLevel level, const String& message) {
+    // Trim logs if exceeding maximum
+    if (logs.size() >= MAX_LOG_ENTRIES) {
+        logs.erase(logs.begin());
+    }
+
+    LogEntry entry;
+    entry.seq = nextSeq++;
+    entry.timestamp = timestamp;
+    entry.level = level;
+    entry.message = message;
+    logs.push_back(entry);
+}
+
+int LogManager::readLogs(LogLevel minLevel, LogCursor& cursor, char* buf, size_t len) {
+    // Short wait: callers retry, and 0 would read as the end of the log
+    if (logMutex == NULL || xSemaphoreTake(logMutex, pdMS_TO_TICKS(50)) != pdTRUE) {
+        return -1;
+    }
+
+    size_t written = 0;
+    if (!logs.empty()) {
+        uint32_t firstSeq = logs.front().seq;
+        if (cursor.seq < firstSeq) {
+            // Entries we had not sent yet were trimmed; carry on from the oldest
+            cursor.seq = firstSeq;
+            cursor.offset = 0;
+        }
+
+        size_t i = cursor.seq - firstSeq;
+        while (i < logs.size() && written < len) {
+            const LogEntry& entry = logs[i];
+            if (entry.level < minLevel) {
+                i++;
+                cursor.seq++;
+                cursor.offset = 0;
+                continue;
+            }
+
+            // Line is emitted in three pieces so a message never has to be copied
+            // into a temporary String; cursor.offset spans all of them.
+            char prefix[40];
+            int prefixLen = snprintf(prefix, sizeof(prefix), "[%lu] [%s] ",
+                                     entry.timestamp, levelName(entry.level));
+            if (prefixLen < 0) prefixLen = 0;
+            if (prefixLen >= (int)sizeof(prefix)) prefixLen = sizeof(prefix) - 1;
+
+            const char* parts[3] = { prefix, entry.message.c_str(), "\n" };
+            size_t partLen[3] = { (size_t)prefixLen, entry.message.length(), 1 };
+
+            size_t skip = cursor.offset;
+            for (int p = 0; p < 3 && written < len; p++) {
+                if (skip >= partLen[p]) {
+                    skip -= partLen[p];
+                    continue;
+                }
+                size_t n = partLen[p] - skip;
+                if (n > len - written) n = len - written;
+                memcpy(buf + written, parts[p] + skip, n);
+                written += n;
+                cursor.offset += n;
+                skip = 0;
+            }
+
+            if (cursor.offset == partLen[0] + partLen[1] + partLen[2]) {
+                i++;
+                cursor.seq++;
+                cursor.offset = 0;
+            }
+        }
+    }
+
+    xSemaphoreGive(logMutex);
+    return (int)written;
+}
+
 bool LogManager::saveLogsToFile() {
     bool success = false;
     
@@ -205,21 +273,17 @@ bool LogManager::loadLogsFromFile() {
                                 String levelStr = line.substring(firstBracket + 3, secondBracket);
                                 String msg = line.substring(secondBracket + 2);
                                 
-                                // Create log entry
-                                LogEntry entry;
-                                entry.timestamp = timestampStr.toInt();
-                                entry.message = msg;
-                                
                                 // Parse level
-                                if (levelStr == "DEBUG") entry.level = DEBUG;
-                                else if (levelStr == "INFO") entry.level = INFO;
-                                else if (levelStr == "WARNING") entry.level = WARNING;
-                                else if (levelStr == "ERROR") entry.level = ERROR;
-                                else if (levelStr == "CRITICAL") entry.level = CRITICAL;
-                                else entry.level = INFO; // Default
+                                LogLevel level;
+                                if (levelStr == "DEBUG") level = DEBUG;
+                                else if (levelStr == "INFO") level = INFO;
+                                else if (levelStr == "WARNING") level = WARNING;
+                                else if (levelStr == "ERROR") level = ERROR;
+                                else if (levelStr == "CRITICAL") level = CRITICAL;
+                                else level = INFO; // Default
                                 
                                 // Add to logs
-                                logs.push_back(entry);
+                                pushEntry(timestampStr.toInt(), level, msg);
                             }
                         }
                     }
@@ -229,11 +293,7 @@ bool LogManager::loadLogsFromFile() {
                 success = true;
                 
                 // Log successful load
-                LogEntry entry;
-                entry.timestamp = millis();
-                entry.level = INFO;
-                entry.message = "Loaded " + String(logs.size()) + " log entries from file";
-                logs.push_back(entry);
+                pushEntry(millis(), INFO, "Loaded " + String(logs.size()) + " log entries from file");
             } else {
                 Serial.println("Failed to open log file for reading");
             }
@@ -264,11 +324,7 @@ void LogManager::clearLogs() {
         logs.clear();
         
         // Log clear action
-        LogEntry entry;
-        entry.timestamp = millis();
-        entry.level = INFO;
-        entry.message = "Logs cleared";
-        logs.push_back(entry);
+        pushEntry(millis(), INFO, "Logs cleared");
         pendingFlushCount = 0;
         lastFlushMillis = millis();
         cleared = true;
@@ -280,11 +336,34 @@ void LogManager::clearLogs() {
     }
 
     if (cleared) {
+        requestFlush();
+    }
+}
+
+// Writing /logs.txt takes tens of milliseconds and log() is called from the
+// web server and render paths, so the write goes to the worker task. At most
+// one flush is queued; entries logged meanwhile are picked up by it.
+void LogManager::requestFlush() {
+    WorkQueue& queue = WorkQueue::getInstance();
+    if (!queue.isRunning()) {
         saveLogsToFile();
+        return;
+    }
+    // Test and set in one step, so two callers cannot both queue a flush
+    if (flushQueued.exchange(true)) {
+        return;
+    }
+    if (!queue.post("logFlush", []() {
+            LogManager& manager = LogManager::getInstance();
+            manager.flushQueued = false;
+            return manager.saveLogsToFile();
+        })) {
+        // Queue full; the next flush trigger retries
+        flushQueued = false;
     }
 }
 
-String LogManager::levelToString(LogLevel level) {
+const char* LogManager::levelName(LogLevel level) {
     switch (level) {
         case DEBUG: return "DEBUG";
         case INFO: return "INFO";
@@ -295,6 +374,10 @@ String LogManager::levelToString(LogLevel level) {
     }
 }
 
+String LogManager::levelToString(LogLevel level) {
+    return String(levelName(level));
+}
+
 // Global log functions
 void systemLog(LogManager::LogLevel level, const String& message) {
     LogManager::getInstance().log(level, message);
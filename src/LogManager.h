@@ -3,6 +3,7 @@
 
 #include <Arduino.h>
 #include <vector>
+#include <atomic>
 #include <FS.h>
 #include <SPIFFS.h>
 
@@ -45,6 +46,19 @@ public:
     
     // Get logs for a specific level or above
     String getLogs(LogLevel minLevel);
+
+    // Position in the log for incremental reads. Sequence numbers survive
+    // entries being trimmed from the front between two reads.
+    struct LogCursor {
+        uint32_t seq;     // next entry to emit
+        size_t offset;    // bytes of that entry's line already emitted
+    };
+
+    // Copies formatted lines ("[ts] [LEVEL] message\n") at or above minLevel
+    // into buf, continuing from cursor. Returns bytes written, 0 when done,
+    // or -1 if the log is busy; the cursor is then unchanged and the read
+    // can be retried.
+    int readLogs(LogLevel minLevel, LogCursor& cursor, char* buf, size_t len);
     
     // Write logs to SPIFFS
     bool saveLogsToFile();
@@ -61,6 +75,7 @@ private:
     
     // Log entry structure
     struct LogEntry {
+        uint32_t seq;
         unsigned long timestamp;
         LogLevel level;
         String message;
@@ -68,9 +83,13 @@ private:
 
     // Private methods
     String levelToString(LogLevel level);
+    static const char* levelName(LogLevel level);
+    void pushEntry(unsigned long timestamp, LogLevel level, const String& message);
+    void requestFlush();
     
     // Log storage
     std::vector<LogEntry> logs;
+    uint32_t nextSeq;
     
     // Mutex for thread safety
     SemaphoreHandle_t logMutex;
@@ -78,6 +97,8 @@ private:
     // Flush bookkeeping
     uint16_t pendingFlushCount;
     unsigned long lastFlushMillis;
+    // Set by web/telnet callers, cleared by the worker task
+    std::atomic<bool> flushQueued;
     static constexpr uint16_t FLUSH_THRESHOLD = 12;
     static constexpr unsigned long FLUSH_INTERVAL_MS = 60000;
 };
@@ -0,0 +1,273 @@
+// File: OutputStage.cpp
+// Final brightness, gamma, calibration, dithering and current limiting pass
+
+#include "OutputStage.h"
+#include <math.h>
+
+// FastLED's TypicalLEDStrip correction, which the controller applied
+// before calibration moved here
+static const PanelCalibration DEFAULT_CALIBRATION = { 255, 176, 240 };
+
+OutputStage::OutputStage()
+    : _brightness(32)
+    , _gamma(2.2f)
+    , _dither(true)
+    , _dirty(true)
+    , _budgetMa(0)
+    , _railPanels(MAX_PANELS)
+    , _railsUsed(0)
+    , _activations(0)
+{
+    for (uint8_t p = 0; p < MAX_PANELS; p++) {
+        _calibration[p] = DEFAULT_CALIBRATION;
+    }
+    resetLimiter();
+    clear();
+}
+
+void OutputStage::setBrightness(uint8_t brightness) {
+    if (brightness != _brightness) {
+        _brightness = brightness;
+        _dirty = true;
+    }
+}
+
+void OutputStage::setGamma(float gamma) {
+    if (gamma < 1.0f) gamma = 1.0f;
+    if (gamma > 3.0f) gamma = 3.0f;
+    if (gamma != _gamma) {
+        _gamma = gamma;
+        _dirty = true;
+    }
+}
+
+void OutputStage::setDither(bool enabled) {
+    if (enabled && !_dither) {
+        memset(_residual, 0, sizeof(_residual));
+    }
+    _dither = enabled;
+}
+
+void OutputStage::setCalibration(uint8_t panel, const PanelCalibration& calibration) {
+    if (panel >= MAX_PANELS) {
+        return;
+    }
+    _calibration[panel] = calibration;
+    _dirty = true;
+}
+
+PanelCalibration OutputStage::calibration(uint8_t panel) const {
+    return panel < MAX_PANELS ? _calibration[panel] : DEFAULT_CALIBRATION;
+}
+
+void OutputStage::setPowerBudget(uint16_t budgetMa) {
+    if (budgetMa != _budgetMa) {
+        _budgetMa = budgetMa;
+        resetLimiter();
+    }
+}
+
+void OutputStage::setRailPanels(uint8_t panels) {
+    if (panels < 1) panels = 1;
+    if (panels > MAX_PANELS) panels = MAX_PANELS;
+    if (panels != _railPanels) {
+        _railPanels = panels;
+        resetLimiter();
+    }
+}
+
+void OutputStage::resetLimiter() {
+    for (uint8_t r = 0; r < MAX_PANELS; r++) {
+        _rails[r].estimatedMa = 0;
+        _rails[r].scale = 256;
+    }
+}
+
+OutputStage::PowerStats OutputStage::powerStats() const {
+    PowerStats stats;
+    stats.budgetMa = _budgetMa;
+    stats.railPanels = _railPanels;
+    stats.rails = _railsUsed;
+    stats.activations = _activations;
+    stats.totalMa = 0;
+    for (uint8_t r = 0; r < MAX_PANELS; r++) {
+        stats.rail[r] = _rails[r];
+        if (r < _railsUsed) {
+            stats.totalMa += _rails[r].estimatedMa;
+        }
+    }
+    return stats;
+}
+
+void OutputStage::clear() {
+    fill_solid(_out, MAX_PIXELS, CRGB::Black);
+    memset(_residual, 0, sizeof(_residual));
+}
+
+void OutputStage::rebuild() {
+    // Shared curve with brightness applied, then one gain per table
+    float curve[256];
+    const float scale = _brightness / 255.0f * 65280.0f;
+    for (int v = 0; v < 256; v++) {
+        curve[v] = powf(v / 255.0f, _gamma) * scale;
+    }
+    for (uint8_t p = 0; p < MAX_PANELS; p++) {
+        const uint8_t gains[3] = { _calibration[p].r, _calibration[p].g, _calibration[p].b };
+        for (int c = 0; c < 3; c++) {
+            const float gain = gains[c] / 255.0f;
+            uint16_t* lut = _lut[p][c];
+            for (int v = 0; v < 256; v++) {
+                lut[v] = (uint16_t)(curve[v] * gain + 0.5f);
+            }
+        }
+    }
+    _dirty = false;
+}
+
+// One panel's worth of pixels through the tables, optionally scaled by a
+// rail limit (256 = none) and dithered. Returns the sum of every output
+// channel for the current estimate.
+template <bool DITHER, bool SCALED>
+static uint32_t convertSpan(const CRGB* in, CRGB* out, uint8_t* residual, int count,
+                            const uint16_t* lutR, const uint16_t* lutG, const uint16_t* lutB,
+                            uint16_t scale) {
+    uint32_t sum = 0;
+    for (int i = 0; i < count; i++) {
+        uint32_t r = lutR[in[i].r];
+        uint32_t g = lutG[in[i].g];
+        uint32_t b = lutB[in[i].b];
+        if (SCALED) {
+            r = (r * scale) >> 8;
+            g = (g * scale) >> 8;
+            b = (b * scale) >> 8;
+        }
+        if (DITHER) {
+            // Table values top out at 255 * 256, so adding a carried
+            // fraction below 256 cannot overflow a channel
+            r += residual[0];
+            g += residual[1];
+            b += residual[2];
+            residual[0] = (uint8_t)r;
+            residual[1] = (uint8_t)g;
+            residual[2] = (uint8_t)b;
+            residual += 3;
+            r >>= 8;
+            g >>= 8;
+            b >>= 8;
+        } else {
+            r = (r + 128) >> 8;
+            g = (g + 128) >> 8;
+            b = (b + 128) >> 8;
+        }
+        out[i].r = (uint8_t)r;
+        out[i].g = (uint8_t)g;
+        out[i].b = (uint8_t)b;
+        sum += r + g + b;
+    }
+    return sum;
+}
+
+void OutputStage::process(const CRGB* in, uint16_t count) {
+    if (_dirty) {
+        rebuild();
+    }
+    if (count > MAX_PIXELS) {
+        count = MAX_PIXELS;
+    }
+
+    const int panelPixels = PanelLayout::PANEL_SIZE * PanelLayout::PANEL_SIZE;
+    const int panels = (count + panelPixels - 1) / panelPixels;
+    _railsUsed = (uint8_t)((panels + _railPanels - 1) / _railPanels);
+
+    uint32_t railSum = 0;
+    int railStart = 0;
+    for (int p = 0; p < panels; p++) {
+        const int base = p * panelPixels;
+        const int n = base + panelPixels < count ? panelPixels : count - base;
+        const uint8_t rail = (uint8_t)(p / _railPanels);
+        const uint16_t scale = _rails[rail].scale;
+        const uint16_t* lutR = _lut[p][0];
+        const uint16_t* lutG = _lut[p][1];
+        const uint16_t* lutB = _lut[p][2];
+        uint8_t* residual = _residual + base * 3;
+
+        if (_dither) {
+            railSum += scale < 256
+                ? convertSpan<true, true>(in + base, _out + base, residual, n, lutR, lutG, lutB, scale)
+                : convertSpan<true, false>(in + base, _out + base, residual, n, lutR, lutG, lutB, scale);
+        } else {
+            railSum += scale < 256
+                ? convertSpan<false, true>(in + base, _out + base, residual, n, lutR, lutG, lutB, scale)
+                : convertSpan<false, false>(in + base, _out + base, residual, n, lutR, lutG, lutB, scale);
+        }
+
+        if (p + 1 == panels || (p + 1) % _railPanels == 0) {
+            limitRail(rail, railSum, railStart, base + n);
+            railSum = 0;
+            railStart = base + n;
+        }
+    }
+}
+
+void OutputStage::limitRail(uint8_t rail, uint32_t channelSum, int start, int end) {
+    RailStats& stats = _rails[rail];
+    const uint32_t idleMa = IDLE_MA_PER_LED * (uint32_t)(end - start);
+    const uint32_t activeMa = channelSum * MA_PER_CHANNEL / 255;
+    stats.estimatedMa = idleMa + activeMa;
+
+    if (_budgetMa == 0) {
+        return;
+    }
+    // activeMa is 0 only for a black rail, which nothing can reduce
+    if (stats.estimatedMa <= _budgetMa || activeMa == 0) {
+        // Within budget: ease a held limit back up
+        if (stats.scale < 256) {
+            stats.scale = stats.scale + RELEASE_STEP > 256 ? 256 : stats.scale + RELEASE_STEP;
+        }
+        return;
+    }
+
+    // Over budget: scale this frame down so the LED load fits, and keep
+    // that limit for the next frames
+    const uint32_t available = _budgetMa > idleMa ? _budgetMa - idleMa : 0;
+    uint32_t factor = available * 256 / activeMa;
+    if (factor > 255) factor = 255;
+    uint32_t scale = (stats.scale * factor) >> 8;
+    if (scale < MIN_SCALE) {
+        // A budget at or near the rail's idle current cannot be met. Going
+        // to black would read as within budget next frame and release,
+        // so the rail pulses; hold it steady at the floor instead.
+        scale = MIN_SCALE;
+        factor = stats.scale > MIN_SCALE ? MIN_SCALE * 256 / stats.scale : 256;
+    }
+    if (factor < 256) {
+        nscale8(_out + start, end - start, (uint8_t)factor);
+    }
+    if (stats.scale == 256) {
+        _activations++;
+    }
+    stats.scale = (uint16_t)scale;
+    stats.estimatedMa = idleMa + activeMa * factor / 256;
+}
+
+uint32_t OutputStage::railIdleMa() const {
+    return IDLE_MA_PER_LED * PanelLayout::PANEL_SIZE * PanelLayout::PANEL_SIZE * _railPanels;
+}
+
+String OutputStage::format(const PanelCalibration& calibration) {
+    char line[16];
+    snprintf(line, sizeof(line), "%u,%u,%u",
+             (unsigned)calibration.r, (unsigned)calibration.g, (unsigned)calibration.b);
+    return String(line);
+}
+
+bool OutputStage::parse(const String& line, PanelCalibration& calibration) {
+    unsigned r, g, b;
+    if (sscanf(line.c_str(), "%u,%u,%u", &r, &g, &b) != 3 || r > 255 || g > 255 || b > 255) {
+        return false;
+    }
+    calibration.r = (uint8_t)r;
+    calibration.g = (uint8_t)g;
+    calibration.b = (uint8_t)b;
+    return true;
+}
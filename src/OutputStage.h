@@ -0,0 +1,131 @@
+// File: OutputStage.h
+// Final brightness, gamma, calibration, dithering and current limiting pass
+
+#ifndef OUTPUTSTAGE_H
+#define OUTPUTSTAGE_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include "PanelLayout.h"
+
+// Per-channel gain of one physical panel, 255 = unity
+struct PanelCalibration {
+    uint8_t r, g, b;
+};
+
+/**
+ * Turns the rendered frame into what is sent to the strip in one pass per
+ * frame. Global brightness, the gamma curve and each panel's calibration
+ * are folded into per-panel, per-channel 256-entry tables of 8.8 fixed
+ * point values, so a channel costs one table read whatever is enabled.
+ *
+ * With dithering on, the fractional part left over by each channel is
+ * carried to the same pixel's next frame (temporal error diffusion), so
+ * dim colours average out to their exact level instead of banding.
+ *
+ * The same pass sums the output per power rail (a run of railPanels
+ * panels along the strip) into an estimated current. When a rail would
+ * exceed its budget it is scaled down proportionally before the frame is
+ * sent, and the limit carries into the following frames, easing back up
+ * by RELEASE_STEP per frame once the load drops. The limit never goes
+ * below MIN_SCALE, so a budget the rail cannot meet gives a steady dim
+ * output rather than pulsing. A rail that stays within budget costs
+ * nothing beyond the running sum.
+ *
+ * The render buffer is never modified: animations that build on their
+ * previous frame see exactly what they drew. Settings changes mark the
+ * tables dirty; they are rebuilt by the next process().
+ */
+class OutputStage {
+public:
+    static const uint8_t MAX_PANELS = PanelLayout::MAX_PANELS;
+    static const int MAX_PIXELS = PanelLayout::MAX_PIXELS;
+
+    // WS2812B: about 20 mA per channel at full duty, 1 mA idle per LED
+    static const uint32_t MA_PER_CHANNEL = 20;
+    static const uint32_t IDLE_MA_PER_LED = 1;
+
+    struct RailStats {
+        uint32_t estimatedMa;   // after limiting, as sent
+        uint16_t scale;         // 256 = not limited
+    };
+
+    struct PowerStats {
+        uint16_t budgetMa;      // per rail, 0 = unlimited
+        uint8_t railPanels;
+        uint8_t rails;          // rails in use at the current panel count
+        uint32_t activations;   // times a rail went from unlimited to limited
+        uint32_t totalMa;
+        RailStats rail[MAX_PANELS];
+    };
+
+    OutputStage();
+
+    // The buffer the LED controller sends
+    CRGB* output() { return _out; }
+
+    void setBrightness(uint8_t brightness);
+    uint8_t brightness() const { return _brightness; }
+
+    // 1.0 = linear
+    void setGamma(float gamma);
+    float gamma() const { return _gamma; }
+
+    void setDither(bool enabled);
+    bool dither() const { return _dither; }
+
+    // Panel index along the strip (physical order)
+    void setCalibration(uint8_t panel, const PanelCalibration& calibration);
+    PanelCalibration calibration(uint8_t panel) const;
+
+    // Current limit per rail in mA (0 = unlimited) and panels per rail
+    void setPowerBudget(uint16_t budgetMa);
+    uint16_t powerBudget() const { return _budgetMa; }
+    void setRailPanels(uint8_t panels);
+    uint8_t railPanels() const { return _railPanels; }
+    // What a full rail draws with every LED off; budgets at or below it
+    // leave the rail held at MIN_SCALE
+    uint32_t railIdleMa() const;
+    PowerStats powerStats() const;
+
+    // Fills output() from in; count is a multiple of the panel size
+    void process(const CRGB* in, uint16_t count);
+
+    // Blanks the output and forgets carried dither error
+    void clear();
+
+    // One line of /calibration.cfg: "r,g,b"
+    static String format(const PanelCalibration& calibration);
+    static bool parse(const String& line, PanelCalibration& calibration);
+
+private:
+    void rebuild();
+    void resetLimiter();
+    // Estimates rail's current from its channel sum and limits it if over
+    // budget, rescaling out[start, end) in place
+    void limitRail(uint8_t rail, uint32_t channelSum, int start, int end);
+
+    static const uint16_t RELEASE_STEP = 2;
+    // Lowest held limit (1/16); see limitRail()
+    static const uint16_t MIN_SCALE = 16;
+
+    uint8_t _brightness;
+    float _gamma;
+    bool _dither;
+    bool _dirty;
+    PanelCalibration _calibration[MAX_PANELS];
+
+    uint16_t _budgetMa;
+    uint8_t _railPanels;
+    uint8_t _railsUsed;
+    uint32_t _activations;
+    RailStats _rails[MAX_PANELS];
+
+    // [panel][channel][value], value * 256 after every correction
+    uint16_t _lut[MAX_PANELS][3][256];
+    // Fraction carried to the next frame, per pixel and channel
+    uint8_t _residual[MAX_PIXELS * 3];
+    CRGB _out[MAX_PIXELS];
+};
+
+#endif // OUTPUTSTAGE_H
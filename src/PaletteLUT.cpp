@@ -0,0 +1,34 @@
+// File: PaletteLUT.cpp
+// Palettes compiled into 256-entry interpolated gradients
+
+#include "PaletteLUT.h"
+
+std::shared_ptr<const PaletteLUT> PaletteLUT::compile(const std::vector<CRGB>& stops, bool wrap) {
+    const int n = (int)stops.size();
+    if (n == 0) {
+        return nullptr;
+    }
+    std::shared_ptr<PaletteLUT> lut = std::make_shared<PaletteLUT>();
+    if (n == 1) {
+        fill_solid(lut->_colors, SIZE, stops[0]);
+        return lut;
+    }
+
+    // Position in 8.8 fixed point: whole part = segment, fraction = blend
+    const int segments = wrap ? n : n - 1;
+    const int last = wrap ? SIZE : SIZE - 1;
+    for (int i = 0; i < SIZE; i++) {
+        const int pos = i * segments * 256 / last;
+        int seg = pos >> 8;
+        uint8_t frac = (uint8_t)pos;
+        if (seg >= segments) {
+            // Only reached by the last entry without wrap
+            seg = segments - 1;
+            frac = 255;
+        }
+        const CRGB& from = stops[seg];
+        const CRGB& to = stops[seg + 1 < n ? seg + 1 : 0];
+        lut->_colors[i] = blend(from, to, frac);
+    }
+    return lut;
+}
@@ -0,0 +1,38 @@
+// File: PaletteLUT.h
+// Palettes compiled into 256-entry interpolated gradients
+
+#ifndef PALETTELUT_H
+#define PALETTELUT_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <memory>
+#include <vector>
+
+/**
+ * A palette's colour stops spread evenly over 256 entries, blending
+ * linearly between neighbours, so animations index it with a byte and
+ * colours flow instead of jumping from stop to stop.
+ *
+ * Without wrap the first stop is at 0 and the last at 255. With wrap the
+ * stops sit every 256 / n entries and the last blends back into the first,
+ * for indices that cycle through the palette.
+ *
+ * Tables are immutable and shared: an animation compiles a new one when
+ * its palette changes and swaps its pointer, so a frame never sees a
+ * half-built table.
+ */
+class PaletteLUT {
+public:
+    static const int SIZE = 256;
+
+    // nullptr for an empty palette
+    static std::shared_ptr<const PaletteLUT> compile(const std::vector<CRGB>& stops, bool wrap);
+
+    const CRGB& colorAt(uint8_t index) const { return _colors[index]; }
+
+private:
+    CRGB _colors[SIZE];
+};
+
+#endif // PALETTELUT_H
@@ -0,0 +1,99 @@
+// File: PaletteStore.cpp
+// User palettes and their compact binary file
+
+#include "PaletteStore.h"
+
+const char* const PaletteStore::PATH = "/palettes.bin";
+
+static const uint8_t MAGIC[4] = { 'P', 'A', 'L', '1' };
+
+std::vector<uint8_t> PaletteStore::encode(const std::vector<PaletteDef>& palettes) {
+    std::vector<uint8_t> data(MAGIC, MAGIC + sizeof(MAGIC));
+    data.push_back((uint8_t)palettes.size());
+    for (const PaletteDef& p : palettes) {
+        data.push_back((uint8_t)p.name.length());
+        data.insert(data.end(), p.name.c_str(), p.name.c_str() + p.name.length());
+        data.push_back((uint8_t)p.stops.size());
+        for (const CRGB& c : p.stops) {
+            data.push_back(c.r);
+            data.push_back(c.g);
+            data.push_back(c.b);
+        }
+    }
+    return data;
+}
+
+bool PaletteStore::decode(const uint8_t* data, size_t length, std::vector<PaletteDef>& out) {
+    out.clear();
+    if (length < sizeof(MAGIC) + 1 || memcmp(data, MAGIC, sizeof(MAGIC)) != 0) {
+        return false;
+    }
+    size_t pos = sizeof(MAGIC);
+    const uint8_t count = data[pos++];
+    if (count > MAX_PALETTES) {
+        return false;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        PaletteDef p;
+        if (pos >= length) break;
+        const uint8_t nameLength = data[pos++];
+        if (nameLength == 0 || nameLength > MAX_NAME || pos + nameLength >= length) break;
+        char name[MAX_NAME + 1];
+        memcpy(name, data + pos, nameLength);
+        name[nameLength] = '\0';
+        p.name = name;
+        pos += nameLength;
+
+        const uint8_t stops = data[pos++];
+        if (stops == 0 || stops > MAX_STOPS || pos + stops * 3 > length) break;
+        for (uint8_t s = 0; s < stops; s++, pos += 3) {
+            p.stops.push_back(CRGB(data[pos], data[pos + 1], data[pos + 2]));
+        }
+        if (!validName(p.name)) break;
+        out.push_back(p);
+    }
+    if (out.size() != count) {
+        out.clear();
+        return false;
+    }
+    return true;
+}
+
+bool PaletteStore::validName(const String& name) {
+    if (name.length() == 0 || name.length() > MAX_NAME) {
+        return false;
+    }
+    for (unsigned i = 0; i < name.length(); i++) {
+        char c = name[i];
+        if (!isalnum((unsigned char)c) && c != '_' && c != '-') {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PaletteStore::parseStops(const String& text, std::vector<CRGB>& stops) {
+    stops.clear();
+    int start = 0;
+    while (start <= (int)text.length()) {
+        int comma = text.indexOf(',', start);
+        String item = text.substring(start, comma < 0 ? text.length() : comma);
+        item.trim();
+        if (item.startsWith("#")) {
+            item = item.substring(1);
+        }
+        bool hex = item.length() == 6;
+        for (unsigned i = 0; hex && i < item.length(); i++) {
+            hex = isxdigit((unsigned char)item[i]) != 0;
+        }
+        if (!hex || stops.size() >= MAX_STOPS) {
+            stops.clear();
+            return false;
+        }
+        unsigned long rgb = strtoul(item.c_str(), nullptr, 16);
+        stops.push_back(CRGB((uint8_t)(rgb >> 16), (uint8_t)(rgb >> 8), (uint8_t)rgb));
+        if (comma < 0) break;
+        start = comma + 1;
+    }
+    return !stops.empty();
+}
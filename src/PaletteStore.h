@@ -0,0 +1,46 @@
+// File: PaletteStore.h
+// User palettes and their compact binary file
+
+#ifndef PALETTESTORE_H
+#define PALETTESTORE_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <vector>
+
+// One user palette: evenly spaced gradient stops, like the built-in ones
+struct PaletteDef {
+    String name;
+    std::vector<CRGB> stops;
+};
+
+/**
+ * /palettes.bin layout (bytes):
+ *
+ *   Header   magic "PAL1", uint8 palette count
+ *   Palette  uint8 name length, name (no terminator),
+ *            uint8 stop count, r g b per stop
+ *
+ * A palette with the maximum name and stop count takes 74 bytes, so the
+ * whole catalogue stays within a couple of kilobytes. Only the stops are
+ * kept in RAM; the 256-entry table is compiled by whichever animation
+ * selects the palette.
+ */
+class PaletteStore {
+public:
+    static const char* const PATH;
+    static const uint8_t MAX_PALETTES = 16;
+    static const uint8_t MAX_STOPS = 16;
+    static const uint8_t MAX_NAME = 24;
+
+    static std::vector<uint8_t> encode(const std::vector<PaletteDef>& palettes);
+    // False, with out cleared, if data is not a valid file
+    static bool decode(const uint8_t* data, size_t length, std::vector<PaletteDef>& out);
+
+    // Letters, digits, '_' and '-', 1 to MAX_NAME characters
+    static bool validName(const String& name);
+    // "rrggbb,rrggbb,...": 1 to MAX_STOPS hex colours, '#' optional
+    static bool parseStops(const String& text, std::vector<CRGB>& stops);
+};
+
+#endif // PALETTESTORE_H
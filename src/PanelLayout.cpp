@@ -0,0 +1,88 @@
+// File: PanelLayout.cpp
+// Logical canvas -> physical LED index mapping for a row of 16x16 panels
+
+#include "PanelLayout.h"
+
+PanelLayout::PanelLayout()
+    : _panelCount(0)
+    , _width(0)
+    , _height(PANEL_SIZE)
+{
+    static const int noRotation[3] = { 0, 0, 0 };
+    configure(1, 0, noRotation);
+}
+
+void PanelLayout::configure(int panelCount, int panelOrder, const int rotations[3]) {
+    if (panelCount < 1) panelCount = 1;
+    if (panelCount > MAX_PANELS) panelCount = MAX_PANELS;
+
+    _panelCount = panelCount;
+    _width = panelCount * PANEL_SIZE;
+    _height = PANEL_SIZE;
+
+    for (int p = 0; p < _panelCount; p++) {
+        int physicalPanel = (panelOrder == 0) ? p : (_panelCount - 1 - p);
+        _panelBase[p] = physicalPanel * PANEL_SIZE * PANEL_SIZE;
+
+        PanelInfo& info = _panels[p];
+        info.originX = p * PANEL_SIZE;
+        info.originY = 0;
+        info.width = PANEL_SIZE;
+        info.height = PANEL_SIZE;
+        info.rotationAngle = (p < 3) ? rotations[p] : 0;
+        info.zigzag = true;
+    }
+
+    for (int y = 0; y < _height; y++) {
+        for (int x = 0; x < _width; x++) {
+            int p = x / PANEL_SIZE;
+            int localX = x % PANEL_SIZE;
+            int localY = y;
+            rotateCoordinates(localX, localY, _panels[p].rotationAngle);
+
+            // Serpentine wiring: odd rows run right-to-left
+            if (localY % 2 != 0) {
+                localX = (PANEL_SIZE - 1) - localX;
+            }
+            _map[y * _width + x] = (uint16_t)(_panelBase[p] + localY * PANEL_SIZE + localX);
+        }
+    }
+}
+
+int PanelLayout::indexChecked(int x, int y) const {
+    if (x < 0 || y < 0 || x >= _width || y >= _height) {
+        return -1;
+    }
+    return _map[y * _width + x];
+}
+
+void PanelLayout::rotateCoordinates(int& x, int& y, int angle) {
+    int normalizedAngle = angle % 360;
+    if (normalizedAngle < 0) {
+        normalizedAngle += 360;
+    }
+
+    int tmpX, tmpY;
+    switch (normalizedAngle) {
+        case 90:
+            tmpX = y;
+            tmpY = PANEL_SIZE - 1 - x;
+            x = tmpX;
+            y = tmpY;
+            break;
+        case 180:
+            tmpX = PANEL_SIZE - 1 - x;
+            tmpY = PANEL_SIZE - 1 - y;
+            x = tmpX;
+            y = tmpY;
+            break;
+        case 270:
+            tmpX = PANEL_SIZE - 1 - y;
+            tmpY = x;
+            x = tmpX;
+            y = tmpY;
+            break;
+        default:
+            break;
+    }
+}
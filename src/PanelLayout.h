@@ -0,0 +1,57 @@
+// File: PanelLayout.h
+// Logical canvas -> physical LED index mapping for a row of 16x16 panels
+
+#ifndef PANELLAYOUT_H
+#define PANELLAYOUT_H
+
+#include <Arduino.h>
+#include "PanelInfo.h"
+
+/**
+ * The logical canvas is panelCount*16 pixels wide and 16 pixels high, with
+ * (0,0) at the top-left. Each panel is wired as a zigzag strip; panels can be
+ * rotated individually and chained left-to-right or right-to-left.
+ *
+ * The mapping is precomputed into a lookup table whenever the layout changes,
+ * so per-pixel lookups are a single array read.
+ */
+class PanelLayout {
+public:
+    static const int PANEL_SIZE = 16;
+    static const int MAX_PANELS = 8;
+    static const int MAX_PIXELS = PANEL_SIZE * PANEL_SIZE * MAX_PANELS;
+
+    PanelLayout();
+
+    // rotations[] holds the angle for the first three panels, the rest are unrotated
+    void configure(int panelCount, int panelOrder, const int rotations[3]);
+
+    int width() const { return _width; }
+    int height() const { return _height; }
+    int panelCount() const { return _panelCount; }
+    int pixelCount() const { return _width * _height; }
+
+    // Caller guarantees 0 <= x < width() and 0 <= y < height()
+    uint16_t index(int x, int y) const { return _map[y * _width + x]; }
+
+    // Returns -1 for coordinates outside the canvas
+    int indexChecked(int x, int y) const;
+
+    // Physical position of a panel on the canvas and how it is wired
+    const PanelInfo& panel(int p) const { return _panels[p]; }
+
+    // First physical LED index of the given logical panel
+    int panelBase(int p) const { return _panelBase[p]; }
+
+private:
+    static void rotateCoordinates(int& x, int& y, int angle);
+
+    int _panelCount;
+    int _width;
+    int _height;
+    PanelInfo _panels[MAX_PANELS];
+    int _panelBase[MAX_PANELS];
+    uint16_t _map[MAX_PIXELS];
+};
+
+#endif // PANELLAYOUT_H
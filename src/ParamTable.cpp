@@ -0,0 +1,267 @@
+// File: ParamTable.cpp
+// Descriptor table for the generic /api/param/{name} router
+
+#include "ParamTable.h"
+#include "LEDManager.h"
+#include "WorkQueue.h"
+#include <SPIFFS.h>
+#include <string.h>
+
+extern LEDManager ledManager;
+
+/****************************************************
+ * Accessors
+ ****************************************************/
+#define INT_PARAM(id, getter, setter, type)                                        \
+    static void get_##id(ParamValue& v) { v.i = (long)ledManager.getter(); }       \
+    static bool set_##id(const ParamValue& v) { ledManager.setter((type)v.i); return true; }
+
+#define FLOAT_PARAM(id, getter, setter)                                            \
+    static void get_##id(ParamValue& v) { v.f = ledManager.getter(); }             \
+    static bool set_##id(const ParamValue& v) { ledManager.setter(v.f); return true; }
+
+#define BOOL_PARAM(id, getter, setter)                                             \
+    static void get_##id(ParamValue& v) { v.b = ledManager.getter(); }             \
+    static bool set_##id(const ParamValue& v) { ledManager.setter(v.b); return true; }
+
+INT_PARAM(antCount, getAntCount, setAntCount, uint8_t)
+INT_PARAM(antSteps, getAntSteps, setAntSteps, uint8_t)
+BOOL_PARAM(antWrap, getAntWrap, setAntWrap)
+INT_PARAM(brightness, getBrightness, setBrightness, uint8_t)
+INT_PARAM(carpetDepth, getCarpetDepth, setCarpetDepth, uint8_t)
+BOOL_PARAM(carpetInvert, getCarpetInvert, setCarpetInvert)
+INT_PARAM(carpetShift, getCarpetColorShift, setCarpetColorShift, uint8_t)
+BOOL_PARAM(dither, getDither, setDither)
+INT_PARAM(fadeAmount, getFadeAmount, setFadeAmount, uint8_t)
+FLOAT_PARAM(fireworkGravity, getFireworkGravity, setFireworkGravity)
+FLOAT_PARAM(fireworkLaunch, getFireworkLaunchProbability, setFireworkLaunchProbability)
+INT_PARAM(fireworkMax, getFireworkMax, setFireworkMax, int)
+INT_PARAM(fireworkParticles, getFireworkParticles, setFireworkParticles, int)
+FLOAT_PARAM(gamma, getGamma, setGamma)
+INT_PARAM(lifeColorMode, getLifeColorMode, setLifeColorMode, uint8_t)
+INT_PARAM(lifeDensity, getLifeSeedDensity, setLifeSeedDensity, uint8_t)
+INT_PARAM(lifeRule, getLifeRuleIndex, setLifeRuleIndex, int)
+INT_PARAM(lifeStagnation, getLifeStagnationLimit, setLifeStagnationLimit, uint16_t)
+BOOL_PARAM(lifeWrap, getLifeWrap, setLifeWrap)
+INT_PARAM(maxFlakes, getMaxFlakes, setMaxFlakes, int)
+INT_PARAM(rainbowHueScale, getRainbowHueScale, setRainbowHueScale, uint8_t)
+INT_PARAM(randomSeed, getRandomSeed, setRandomSeed, uint32_t)
+FLOAT_PARAM(spawnRate, getSpawnRate, setSpawnRate)
+INT_PARAM(speed, getUpdateSpeed, setUpdateSpeed, unsigned long)
+INT_PARAM(tailLength, getTailLength, setTailLength, int)
+INT_PARAM(textFont, getTextFont, setTextFont, uint8_t)
+INT_PARAM(textMode, getTextMode, setTextMode, uint8_t)
+INT_PARAM(textSpeed, getTextSpeed, setTextSpeed, uint8_t)
+INT_PARAM(transitionCurve, getTransitionCurve, setTransitionCurve, uint8_t)
+INT_PARAM(transitionMs, getTransitionDuration, setTransitionDuration, uint16_t)
+INT_PARAM(transitionWipe, getTransitionWipe, setTransitionWipe, uint8_t)
+
+static void get_antRule(ParamValue& v) { v.s = ledManager.getAntRule(); }
+static bool set_antRule(const ParamValue& v) { ledManager.setAntRule(v.s); return true; }
+
+static void get_textMessage(ParamValue& v) { v.s = ledManager.getTextMessage(); }
+static bool set_textMessage(const ParamValue& v) { ledManager.setTextMessage(v.s); return true; }
+
+static void get_panelOrder(ParamValue& v) { v.s = ledManager.getPanelOrder() == 0 ? "left" : "right"; }
+static bool set_panelOrder(const ParamValue& v) {
+    if (!v.s.equalsIgnoreCase("left") && !v.s.equalsIgnoreCase("right")) {
+        return false;
+    }
+    ledManager.setPanelOrder(v.s);
+    return true;
+}
+
+// The current limit protects the supply, so it must survive a reset: both
+// power settings are written to /power.cfg, which setup() loads before the
+// first frame is shown
+static bool writePowerConfig(uint16_t budgetMa, uint8_t railPanels) {
+    if (!SPIFFS.begin(false)) {
+        return false;
+    }
+    File f = SPIFFS.open("/power.cfg", "w");
+    if (!f) {
+        return false;
+    }
+    f.printf("budget=%u\n", (unsigned)budgetMa);
+    f.printf("railPanels=%u\n", (unsigned)railPanels);
+    f.close();
+    return true;
+}
+
+static void savePowerConfig() {
+    const uint16_t budgetMa = ledManager.getPowerBudget();
+    const uint8_t railPanels = ledManager.getPowerRailPanels();
+    bool queued = WorkQueue::getInstance().post("power", [budgetMa, railPanels]() {
+        return writePowerConfig(budgetMa, railPanels);
+    });
+    if (!queued) {
+        Serial.println("Power settings applied but /power.cfg could not be queued for writing");
+    }
+}
+
+static void get_powerBudget(ParamValue& v) { v.i = ledManager.getPowerBudget(); }
+static bool set_powerBudget(const ParamValue& v) {
+    ledManager.setPowerBudget((uint16_t)v.i);
+    savePowerConfig();
+    return true;
+}
+
+static void get_powerRailPanels(ParamValue& v) { v.i = ledManager.getPowerRailPanels(); }
+static bool set_powerRailPanels(const ParamValue& v) {
+    ledManager.setPowerRailPanels((uint8_t)v.i);
+    savePowerConfig();
+    return true;
+}
+
+#define ROTATION_PARAM(n)                                                          \
+    static void get_rotation##n(ParamValue& v) { v.i = ledManager.getRotation("PANEL" #n); } \
+    static bool set_rotation##n(const ParamValue& v) {                             \
+        if (v.i % 90 != 0) return false;                                           \
+        ledManager.rotatePanel("PANEL" #n, (int)v.i);                              \
+        return true;                                                               \
+    }
+
+ROTATION_PARAM(1)
+ROTATION_PARAM(2)
+ROTATION_PARAM(3)
+
+/****************************************************
+ * Table (must stay sorted by name, checked below)
+ ****************************************************/
+#define W PARAM_WRITE_AUTH
+#define WC (PARAM_WRITE_AUTH | PARAM_CLAMP)
+
+static constexpr ParamDescriptor PARAMS[] = {
+    { "antCount",          PARAM_INT,    WC, 0, 1,     6,    get_antCount,          set_antCount },
+    { "antRule",           PARAM_STRING, W,  0, 0,     0,    get_antRule,           set_antRule },
+    { "antSteps",          PARAM_INT,    WC, 0, 1,     50,   get_antSteps,          set_antSteps },
+    { "antWrap",           PARAM_BOOL,   W,  0, 0,     1,    get_antWrap,           set_antWrap },
+    { "brightness",        PARAM_INT,    W,  0, 0,     255,  get_brightness,        set_brightness },
+    { "carpetDepth",       PARAM_INT,    WC, 0, 1,     6,    get_carpetDepth,       set_carpetDepth },
+    { "carpetInvert",      PARAM_BOOL,   W,  0, 0,     1,    get_carpetInvert,      set_carpetInvert },
+    { "carpetShift",       PARAM_INT,    WC, 0, 1,     20,   get_carpetShift,       set_carpetShift },
+    { "dither",            PARAM_BOOL,   W,  0, 0,     1,    get_dither,            set_dither },
+    { "fadeAmount",        PARAM_INT,    WC, 0, 0,     255,  get_fadeAmount,        set_fadeAmount },
+    { "fireworkGravity",   PARAM_FLOAT,  WC, 3, 0.01f, 0.5f, get_fireworkGravity,   set_fireworkGravity },
+    { "fireworkLaunch",    PARAM_FLOAT,  WC, 2, 0.01f, 1,    get_fireworkLaunch,    set_fireworkLaunch },
+    { "fireworkMax",       PARAM_INT,    WC, 0, 1,     25,   get_fireworkMax,       set_fireworkMax },
+    { "fireworkParticles", PARAM_INT,    WC, 0, 10,    120,  get_fireworkParticles, set_fireworkParticles },
+    { "gamma",             PARAM_FLOAT,  WC, 2, 1,     3,    get_gamma,             set_gamma },
+    { "lifeColorMode",     PARAM_INT,    WC, 0, 0,     2,    get_lifeColorMode,     set_lifeColorMode },
+    { "lifeDensity",       PARAM_INT,    WC, 0, 0,     100,  get_lifeDensity,       set_lifeDensity },
+    { "lifeRule",          PARAM_INT,    W,  0, 0,     255,  get_lifeRule,          set_lifeRule },
+    { "lifeStagnation",    PARAM_INT,    WC, 0, 5,     250,  get_lifeStagnation,    set_lifeStagnation },
+    { "lifeWrap",          PARAM_BOOL,   W,  0, 0,     1,    get_lifeWrap,          set_lifeWrap },
+    { "maxFlakes",         PARAM_INT,    W,  0, 10,    500,  get_maxFlakes,         set_maxFlakes },
+    { "panelOrder",        PARAM_STRING, W,  0, 0,     0,    get_panelOrder,        set_panelOrder },
+    { "powerBudget",       PARAM_INT,    WC, 0, 0,     50000, get_powerBudget,      set_powerBudget },
+    { "powerRailPanels",   PARAM_INT,    WC, 0, 1,     8,    get_powerRailPanels,   set_powerRailPanels },
+    { "rainbowHueScale",   PARAM_INT,    WC, 0, 1,     12,   get_rainbowHueScale,   set_rainbowHueScale },
+    { "randomSeed",        PARAM_INT,    W,  0, 0,     16777215, get_randomSeed,    set_randomSeed },
+    { "rotation1",         PARAM_INT,    W,  0, 0,     270,  get_rotation1,         set_rotation1 },
+    { "rotation2",         PARAM_INT,    W,  0, 0,     270,  get_rotation2,         set_rotation2 },
+    { "rotation3",         PARAM_INT,    W,  0, 0,     270,  get_rotation3,         set_rotation3 },
+    { "spawnRate",         PARAM_FLOAT,  W,  2, 0,     1,    get_spawnRate,         set_spawnRate },
+    { "speed",             PARAM_INT,    WC, 0, 3,     1500, get_speed,             set_speed },
+    { "tailLength",        PARAM_INT,    W,  0, 1,     30,   get_tailLength,        set_tailLength },
+    { "textFont",          PARAM_INT,    WC, 0, 0,     1,    get_textFont,          set_textFont },
+    { "textMessage",       PARAM_STRING, W,  0, 0,     0,    get_textMessage,       set_textMessage },
+    { "textMode",          PARAM_INT,    WC, 0, 0,     1,    get_textMode,          set_textMode },
+    { "textSpeed",         PARAM_INT,    WC, 0, 1,     100,  get_textSpeed,         set_textSpeed },
+    { "transitionCurve",   PARAM_INT,    WC, 0, 0,     3,    get_transitionCurve,   set_transitionCurve },
+    { "transitionMs",      PARAM_INT,    WC, 0, 0,     5000, get_transitionMs,      set_transitionMs },
+    { "transitionWipe",    PARAM_INT,    WC, 0, 0,     5,    get_transitionWipe,    set_transitionWipe }
+};
+
+#undef W
+#undef WC
+
+static constexpr size_t PARAM_COUNT = sizeof(PARAMS) / sizeof(PARAMS[0]);
+
+static constexpr bool nameLess(const char* a, const char* b) {
+    return (*a == *b) ? (*a != '\0' && nameLess(a + 1, b + 1))
+                      : ((unsigned char)*a < (unsigned char)*b);
+}
+
+static constexpr bool isSorted(const ParamDescriptor* table, size_t n) {
+    return n < 2 || (nameLess(table[0].name, table[1].name) && isSorted(table + 1, n - 1));
+}
+
+static_assert(isSorted(PARAMS, PARAM_COUNT), "PARAMS must be sorted by name for binary search");
+
+/****************************************************
+ * Lookup and conversion
+ ****************************************************/
+const ParamDescriptor* findParam(const char* name) {
+    size_t lo = 0;
+    size_t hi = PARAM_COUNT;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        int cmp = strcmp(name, PARAMS[mid].name);
+        if (cmp == 0) {
+            return &PARAMS[mid];
+        }
+        if (cmp < 0) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return nullptr;
+}
+
+size_t paramCount() {
+    return PARAM_COUNT;
+}
+
+const ParamDescriptor& paramAt(size_t index) {
+    return PARAMS[index];
+}
+
+bool parseParamValue(const ParamDescriptor& desc, const String& raw, ParamValue& out, const char*& error) {
+    bool clamp = (desc.flags & PARAM_CLAMP) != 0;
+    switch (desc.type) {
+        case PARAM_INT: {
+            long v = raw.toInt();
+            if (v < (long)desc.minValue || v > (long)desc.maxValue) {
+                if (!clamp) {
+                    error = "Value out of range";
+                    return false;
+                }
+                v = v < (long)desc.minValue ? (long)desc.minValue : (long)desc.maxValue;
+            }
+            out.i = v;
+            return true;
+        }
+        case PARAM_FLOAT: {
+            float v = raw.toFloat();
+            if (v < desc.minValue || v > desc.maxValue) {
+                if (!clamp) {
+                    error = "Value out of range";
+                    return false;
+                }
+                v = v < desc.minValue ? desc.minValue : desc.maxValue;
+            }
+            out.f = v;
+            return true;
+        }
+        case PARAM_BOOL:
+            out.b = raw.equalsIgnoreCase("1") || raw.equalsIgnoreCase("true") || raw.equalsIgnoreCase("on");
+            return true;
+        case PARAM_STRING:
+            out.s = raw;
+            return true;
+    }
+    error = "Unsupported parameter type";
+    return false;
+}
+
+String formatParamValue(const ParamDescriptor& desc, const ParamValue& value) {
+    switch (desc.type) {
+        case PARAM_INT:    return String(value.i);
+        case PARAM_FLOAT:  return String(value.f, (unsigned int)desc.decimals);
+        case PARAM_BOOL:   return value.b ? "1" : "0";
+        case PARAM_STRING: return value.s;
+    }
+    return "";
+}
@@ -0,0 +1,59 @@
+// File: ParamTable.h
+// Descriptor table for the generic /api/param/{name} router
+
+#ifndef PARAMTABLE_H
+#define PARAMTABLE_H
+
+#include <Arduino.h>
+
+enum ParamType : uint8_t {
+    PARAM_INT,
+    PARAM_FLOAT,
+    PARAM_BOOL,
+    PARAM_STRING
+};
+
+enum ParamFlags : uint8_t {
+    PARAM_CLAMP      = 0x01,  // out-of-range values are clamped instead of rejected
+    PARAM_WRITE_AUTH = 0x02,  // setting requires the API token
+    PARAM_READ_AUTH  = 0x04   // reading requires the API token
+};
+
+struct ParamValue {
+    long i;
+    float f;
+    bool b;
+    String s;
+};
+
+// Getters fill the member matching the descriptor type. Setters receive a
+// value that has already been parsed and range checked; they return false
+// for values only the setter can validate (e.g. rotation angles).
+typedef void (*ParamGetter)(ParamValue& out);
+typedef bool (*ParamSetter)(const ParamValue& in);
+
+struct ParamDescriptor {
+    const char* name;
+    ParamType type;
+    uint8_t flags;
+    uint8_t decimals;   // PARAM_FLOAT output precision
+    float minValue;
+    float maxValue;
+    ParamGetter get;
+    ParamSetter set;
+};
+
+// Binary search over the name-sorted table; nullptr if unknown
+const ParamDescriptor* findParam(const char* name);
+
+size_t paramCount();
+const ParamDescriptor& paramAt(size_t index);
+
+// Parses raw into out according to desc (range check / clamp included).
+// On failure returns false and sets error to a message for the client.
+bool parseParamValue(const ParamDescriptor& desc, const String& raw, ParamValue& out, const char*& error);
+
+// Formats a value the way the legacy /api/getX routes did
+String formatParamValue(const ParamDescriptor& desc, const ParamValue& value);
+
+#endif // PARAMTABLE_H
@@ -0,0 +1,298 @@
+// File: ParticleSystem.cpp
+// Pooled particle engine with emitters, forces and lifetime colour ramps
+
+#include "ParticleSystem.h"
+#include "HueTable.h"
+#include <esp_heap_caps.h>
+#include <string.h>
+
+ParticleSystem::Emitter::Emitter()
+    : shape(SHAPE_POINT)
+    , x(0), y(0), w(0), h(0)
+    , direction(0)
+    , spread(0)
+    , speedMin(0), speedMax(0)
+    , lifeMin(0), lifeMax(0)
+    , colorMin(0), colorMax(255)
+    , rate(0)
+    , carry(0)
+{
+}
+
+ParticleSystem::Forces::Forces()
+    : gravityX(0), gravityY(0)
+    , windX(0), windY(0)
+    , drag(0)
+    , attract(false)
+    , attractX(0), attractY(0)
+    , attractStrength(0)
+{
+}
+
+ParticleSystem::Look::Look()
+    : rampSpan(0)
+    , blend(BLEND_ADD)
+    , opacity(255)
+    , fadeOut(false)
+{
+}
+
+ParticleSystem::ParticleSystem()
+    : _x(nullptr), _y(nullptr), _vx(nullptr), _vy(nullptr)
+    , _age(nullptr), _life(nullptr), _color(nullptr)
+    , _block(nullptr)
+    , _capacity(0)
+    , _count(0)
+    , _width(0)
+    , _height(0)
+    , _wrapX(false)
+{
+}
+
+ParticleSystem::~ParticleSystem() {
+    release();
+}
+
+bool ParticleSystem::reserve(uint16_t capacity) {
+    release();
+    if (capacity == 0) {
+        return true;
+    }
+    void* block = allocate(capacity);
+    if (!block) {
+        return false;
+    }
+    attach(block, capacity);
+    return true;
+}
+
+bool ParticleSystem::resize(uint16_t capacity) {
+    if (capacity == _capacity) {
+        return true;
+    }
+    if (capacity == 0) {
+        release();
+        return true;
+    }
+    void* block = allocate(capacity);
+    if (!block) {
+        return false;
+    }
+    ParticleSystem old;
+    old.attach(_block, _capacity);
+    old._count = _count;
+    attach(block, capacity);
+
+    const uint16_t kept = old._count < capacity ? old._count : capacity;
+    memcpy(_x, old._x, kept * sizeof(q16_16));
+    memcpy(_y, old._y, kept * sizeof(q16_16));
+    memcpy(_vx, old._vx, kept * sizeof(q16_16));
+    memcpy(_vy, old._vy, kept * sizeof(q16_16));
+    memcpy(_age, old._age, kept * sizeof(uint16_t));
+    memcpy(_life, old._life, kept * sizeof(uint16_t));
+    memcpy(_color, old._color, kept);
+    _count = kept;
+    return true;    // old frees the previous block
+}
+
+void* ParticleSystem::allocate(uint16_t capacity) {
+    const size_t size = (size_t)capacity * BYTES_PER_PARTICLE;
+    void* block = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!block) {
+        block = heap_caps_malloc(size, MALLOC_CAP_8BIT);
+    }
+    if (!block) {
+        Serial.println("ParticleSystem: Failed to allocate pool");
+    }
+    return block;
+}
+
+// Carves block into the arrays; widest first, so each one stays aligned
+void ParticleSystem::attach(void* block, uint16_t capacity) {
+    q16_16* words = static_cast<q16_16*>(block);
+    _x = words;
+    _y = words + capacity;
+    _vx = words + 2 * capacity;
+    _vy = words + 3 * capacity;
+    uint16_t* halves = reinterpret_cast<uint16_t*>(words + 4 * capacity);
+    _age = halves;
+    _life = halves + capacity;
+    _color = reinterpret_cast<uint8_t*>(halves + 2 * capacity);
+    _block = block;
+    _capacity = capacity;
+    _count = 0;
+}
+
+void ParticleSystem::release() {
+    if (_block) {
+        heap_caps_free(_block);
+    }
+    _x = _y = _vx = _vy = nullptr;
+    _age = _life = nullptr;
+    _color = nullptr;
+    _block = nullptr;
+    _capacity = 0;
+    _count = 0;
+}
+
+void ParticleSystem::setBounds(int width, int height, bool wrapX) {
+    _width = q16FromInt(width);
+    _height = q16FromInt(height);
+    _wrapX = wrapX;
+}
+
+bool ParticleSystem::spawn(q16_16 x, q16_16 y, q16_16 vx, q16_16 vy, uint16_t life, uint8_t color) {
+    if (_count >= _capacity) {
+        return false;
+    }
+    const uint16_t i = _count++;
+    _x[i] = x;
+    _y[i] = y;
+    _vx[i] = vx;
+    _vy[i] = vy;
+    _age[i] = 0;
+    _life[i] = life;
+    _color[i] = color;
+    return true;
+}
+
+void ParticleSystem::kill(uint16_t i) {
+    const uint16_t last = --_count;
+    if (i != last) {
+        _x[i] = _x[last];
+        _y[i] = _y[last];
+        _vx[i] = _vx[last];
+        _vy[i] = _vy[last];
+        _age[i] = _age[last];
+        _life[i] = _life[last];
+        _color[i] = _color[last];
+    }
+}
+
+uint16_t ParticleSystem::burst(const Emitter& e, uint16_t count, Rng& rng) {
+    uint16_t spawned = 0;
+    for (; spawned < count && _count < _capacity; spawned++) {
+        q16_16 x = e.x;
+        q16_16 y = e.y;
+        switch (e.shape) {
+            case SHAPE_EDGE_TOP:
+                x = (q16_16)rng.below(_width);
+                y = 0;
+                break;
+            case SHAPE_EDGE_BOTTOM:
+                x = (q16_16)rng.below(_width);
+                y = _height - Q16_ONE;
+                break;
+            case SHAPE_EDGE_LEFT:
+                x = 0;
+                y = (q16_16)rng.below(_height);
+                break;
+            case SHAPE_EDGE_RIGHT:
+                x = _width - Q16_ONE;
+                y = (q16_16)rng.below(_height);
+                break;
+            case SHAPE_AREA:
+                x = e.x + (q16_16)rng.below(e.w);
+                y = e.y + (q16_16)rng.below(e.h);
+                break;
+            default:
+                break;
+        }
+
+        // Anywhere in the cone, at any speed in the range
+        const angle16 angle = e.direction - e.spread / 2
+            + (angle16)(((uint32_t)(rng.next() >> 16) * e.spread) >> 16);
+        const q16_16 speed = e.speedMax > e.speedMin
+            ? e.speedMin + (q16_16)rng.below(e.speedMax - e.speedMin) : e.speedMin;
+        const uint16_t life = e.lifeMax ? (uint16_t)rng.range(e.lifeMin, e.lifeMax + 1) : 0;
+        const uint8_t color = (uint8_t)rng.range(e.colorMin, e.colorMax + 1);
+
+        spawn(x, y, q16Mul(fxCos(angle), speed), q16Mul(fxSin(angle), speed), life, color);
+    }
+    return spawned;
+}
+
+uint16_t ParticleSystem::emit(Emitter& e, Rng& rng) {
+    const int32_t due = (int32_t)e.carry + e.rate;
+    e.carry = (q8_8)(due & 0xFF);
+    return burst(e, (uint16_t)(due >> 8), rng);
+}
+
+void ParticleSystem::step(const Forces& f) {
+    const q16_16 margin = MARGIN * Q16_ONE;
+    const bool drag = f.drag != 0;
+
+    uint16_t i = 0;
+    while (i < _count) {
+        q16_16 vx = _vx[i] + f.gravityX;
+        q16_16 vy = _vy[i] + f.gravityY;
+        if (drag) {
+            vx += q16Mul(f.windX - vx, f.drag);
+            vy += q16Mul(f.windY - vy, f.drag);
+        }
+        if (f.attract) {
+            // strength * d / (|d|^2 + 1): 1/distance falloff with no root,
+            // and no blow-up at the centre
+            const q16_16 dx = f.attractX - _x[i];
+            const q16_16 dy = f.attractY - _y[i];
+            const q16_16 d2 = q16Saturate((((int64_t)dx * dx + (int64_t)dy * dy) >> 16) + Q16_ONE);
+            vx += q16Div(q16Mul(f.attractStrength, dx), d2);
+            vy += q16Div(q16Mul(f.attractStrength, dy), d2);
+        }
+        _vx[i] = vx;
+        _vy[i] = vy;
+
+        q16_16 x = _x[i] + vx;
+        const q16_16 y = _y[i] + vy;
+        if (_wrapX) {
+            if (x < 0) x += _width;
+            else if (x >= _width) x -= _width;
+        }
+        _x[i] = x;
+        _y[i] = y;
+
+        const uint16_t age = ++_age[i];
+        const bool expired = _life[i] && age >= _life[i];
+        const bool outside = y < -margin || y >= _height + margin
+            || (!_wrapX && (x < -margin || x >= _width + margin));
+        if (expired || outside) {
+            kill(i);    // the last particle moves into i; look at it next
+        } else {
+            i++;
+        }
+    }
+}
+
+void ParticleSystem::render(CRGB* pixels, const PanelLayout& layout, const Look& look) const {
+    const int width = layout.width();
+    const int height = layout.height();
+    const PaletteLUT* lut = look.lut.get();
+
+    for (uint16_t i = 0; i < _count; i++) {
+        int px = q16Round(_x[i]);
+        if (_wrapX && px >= width) {
+            px -= width;
+        }
+        const int py = q16Round(_y[i]);
+        if (px < 0 || px >= width || py < 0 || py >= height) {
+            continue;
+        }
+
+        // Fraction of the lifetime gone, 0-255
+        const uint16_t life = _life[i];
+        const uint8_t aged = life ? (uint8_t)(((uint32_t)_age[i] * 255) / life) : 0;
+        const uint8_t index = _color[i] + scale8(aged, look.rampSpan);
+        CRGB color = lut ? lut->colorAt(index) : HueTable::color(index);
+        const uint8_t remaining = look.fadeOut ? 255 - aged : 255;
+
+        CRGB& dst = pixels[layout.index(px, py)];
+        if (look.blend == BLEND_ALPHA) {
+            nblend(dst, color, scale8(look.opacity, remaining));
+        } else {
+            if (remaining != 255) {
+                color.nscale8(remaining);
+            }
+            dst += color;
+        }
+    }
+}
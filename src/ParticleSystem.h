@@ -0,0 +1,152 @@
+// File: ParticleSystem.h
+// Pooled particle engine with emitters, forces and lifetime colour ramps
+
+#ifndef PARTICLESYSTEM_H
+#define PARTICLESYSTEM_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <memory>
+#include "FixedMath.h"
+#include "PaletteLUT.h"
+#include "PanelLayout.h"
+#include "Rng.h"
+
+/**
+ * A fixed-capacity pool of point particles for snow, rain, sparks and
+ * similar effects. Storage is structure-of-arrays in a single block
+ * allocated by reserve(), in PSRAM when there is some. Nothing is
+ * allocated after that: spawning appends at the end of the live range and
+ * despawning moves the last particle into the gap, both O(1). Particle
+ * order is therefore not stable.
+ *
+ * Positions and velocities are Q16.16 pixels and pixels per step on the
+ * logical canvas. Every step() applies the Forces, moves the particles and
+ * ages them. A particle dies when its lifetime runs out, or when it leaves
+ * the canvas by more than MARGIN pixels. With wrapX set, particles leaving
+ * at a side come back in at the other side instead.
+ *
+ * Colour comes from a ramp: each particle has a start index and walks
+ * rampSpan entries of the Look's palette LUT over its lifetime (rainbow
+ * hues without a LUT). Rendering either adds with saturation or blends
+ * over what is already in the buffer. The effect owns the background.
+ *
+ * Randomness comes from the caller's Rng, so seeded animations stay
+ * reproducible.
+ */
+class ParticleSystem {
+public:
+    static const int MARGIN = 2;
+
+    enum Shape : uint8_t {
+        SHAPE_POINT = 0,     // at (x, y)
+        SHAPE_EDGE_TOP,      // anywhere along one canvas edge
+        SHAPE_EDGE_BOTTOM,
+        SHAPE_EDGE_LEFT,
+        SHAPE_EDGE_RIGHT,
+        SHAPE_AREA           // anywhere in the (x, y, w, h) rectangle
+    };
+
+    enum BlendMode : uint8_t {
+        BLEND_ADD = 0,
+        BLEND_ALPHA
+    };
+
+    struct Emitter {
+        Shape shape;
+        q16_16 x, y, w, h;
+        angle16 direction;          // cone centre; 0 = +x, ANGLE_QUARTER = down
+        angle16 spread;             // full cone width, 0 = a single direction
+        q16_16 speedMin, speedMax;  // pixels per step
+        uint16_t lifeMin, lifeMax;  // steps; 0 = until it leaves the canvas
+        uint8_t colorMin, colorMax; // ramp start, picked per particle
+        q8_8 rate;                  // particles per step for emit()
+        q8_8 carry;                 // fraction left over from the last emit()
+
+        Emitter();
+    };
+
+    struct Forces {
+        q16_16 gravityX, gravityY;  // pixels per step, added every step
+        // Drag pulls each velocity towards the wind's, by drag / Q16_ONE of
+        // the difference per step; drag 0 ignores the wind
+        q16_16 windX, windY;
+        q16_16 drag;
+        // Acceleration towards (attractX, attractY) of attractStrength at
+        // one pixel, falling off with distance; negative repels
+        bool attract;
+        q16_16 attractX, attractY;
+        q16_16 attractStrength;
+
+        Forces();
+    };
+
+    struct Look {
+        std::shared_ptr<const PaletteLUT> lut;  // nullptr for rainbow hues
+        uint8_t rampSpan;   // ramp entries walked over a lifetime
+        BlendMode blend;
+        uint8_t opacity;    // BLEND_ALPHA weight at full life
+        bool fadeOut;       // dim towards the end of a finite lifetime
+
+        Look();
+    };
+
+    ParticleSystem();
+    ~ParticleSystem();
+
+    // Replaces the pool with an empty one of the given capacity. Returns
+    // false (and holds nothing) if it could not be allocated.
+    bool reserve(uint16_t capacity);
+    // Like reserve(), but keeps as many live particles as fit. On failure
+    // the old pool is left as it was.
+    bool resize(uint16_t capacity);
+    void release();
+
+    uint16_t capacity() const { return _capacity; }
+    uint16_t count() const { return _count; }
+    size_t bytes() const { return (size_t)_capacity * BYTES_PER_PARTICLE; }
+
+    // Canvas the particles live on; particles outside it after the change
+    // die at the next step()
+    void setBounds(int width, int height, bool wrapX);
+
+    void clear() { _count = 0; }
+
+    // False when the pool is full
+    bool spawn(q16_16 x, q16_16 y, q16_16 vx, q16_16 vy, uint16_t life, uint8_t color);
+    // Despawns particle i; the last particle takes its index
+    void kill(uint16_t i);
+
+    // Spawns count particles at once; returns how many fitted
+    uint16_t burst(const Emitter& emitter, uint16_t count, Rng& rng);
+    // Spawns emitter.rate particles per call, carrying the fraction
+    uint16_t emit(Emitter& emitter, Rng& rng);
+
+    void step(const Forces& forces);
+
+    void render(CRGB* pixels, const PanelLayout& layout, const Look& look) const;
+
+private:
+    // x, y, vx, vy, then age, life, then color
+    static const size_t BYTES_PER_PARTICLE = 4 * sizeof(q16_16) + 2 * sizeof(uint16_t) + 1;
+
+    static void* allocate(uint16_t capacity);
+    void attach(void* block, uint16_t capacity);
+
+    q16_16* _x;
+    q16_16* _y;
+    q16_16* _vx;
+    q16_16* _vy;
+    uint16_t* _age;
+    uint16_t* _life;
+    uint8_t* _color;
+    void* _block;
+    uint16_t _capacity;
+    uint16_t _count;
+
+    q16_16 _width;
+    q16_16 _height;
+    bool _wrapX;
+};
+
+#endif // PARTICLESYSTEM_H
@@ -0,0 +1,353 @@
+// File: PixelKernels.cpp
+// Bulk operations on spans of CRGB pixels
+
+#include "PixelKernels.h"
+#include <esp_heap_caps.h>
+#include <new>
+
+// Bytes 0 and 2 of a word; bytes 1 and 3 are handled shifted down by 8
+static const uint32_t EVEN_BYTES = 0x00FF00FF;
+static const uint32_t HIGH_BITS = 0x80808080;
+
+// Word access to pixel bytes; may_alias keeps it legal next to CRGB access
+typedef uint32_t __attribute__((__may_alias__)) PixelWord;
+
+static inline uint32_t loadWord(const uint8_t* p) {
+    uint32_t w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+// Bytes up to dst's next word boundary, at most three
+static inline size_t headBytes(const uint8_t* dst, size_t n) {
+    size_t head = (4 - ((uintptr_t)dst & 3)) & 3;
+    return head < n ? head : n;
+}
+
+// (c * mul) >> 8 in all four bytes; mul <= 256 keeps each product in 16 bits
+static inline uint32_t scaleWord(uint32_t w, uint32_t mul) {
+    const uint32_t even = (((w & EVEN_BYTES) * mul) >> 8) & EVEN_BYTES;
+    const uint32_t odd = (((w >> 8) & EVEN_BYTES) * mul) & ~EVEN_BYTES;
+    return even | odd;
+}
+
+// Adds the low seven bits of each byte, fixes up bit 7, then turns every
+// byte that carried out into 0xFF
+static inline uint32_t addWord(uint32_t a, uint32_t b) {
+    const uint32_t low = (a & ~HIGH_BITS) + (b & ~HIGH_BITS);
+    const uint32_t sum = low ^ ((a ^ b) & HIGH_BITS);
+    const uint32_t carry = ((a & b) | ((a | b) & ~sum)) & HIGH_BITS;
+    return sum | ((carry >> 7) * 0xFF);
+}
+
+// blend8(): (a * 256 + b + (b - a) * amount) >> 8, rewritten as
+// a * keepA + b * takeB, which peaks at 255 * 257 and fits a 16-bit lane
+static inline uint32_t blendWord(uint32_t a, uint32_t b, uint32_t keepA, uint32_t takeB) {
+    const uint32_t even = (((a & EVEN_BYTES) * keepA + (b & EVEN_BYTES) * takeB) >> 8) & EVEN_BYTES;
+    const uint32_t odd = (((a >> 8) & EVEN_BYTES) * keepA + ((b >> 8) & EVEN_BYTES) * takeB) & ~EVEN_BYTES;
+    return even | odd;
+}
+
+void spanFill(CRGB* dst, uint16_t count, const CRGB& color) {
+    // Pixel start addresses step by 3, so one of the first four is aligned
+    while (count && ((uintptr_t)dst & 3)) {
+        *dst++ = color;
+        count--;
+    }
+    // Four pixels are exactly three words
+    const uint32_t r = color.r, g = color.g, b = color.b;
+    const uint32_t w0 = r | (g << 8) | (b << 16) | (r << 24);
+    const uint32_t w1 = g | (b << 8) | (r << 16) | (g << 24);
+    const uint32_t w2 = b | (r << 8) | (g << 16) | (b << 24);
+    PixelWord* words = (PixelWord*)dst;
+    for (; count >= 4; count -= 4) {
+        words[0] = w0;
+        words[1] = w1;
+        words[2] = w2;
+        words += 3;
+    }
+    dst = (CRGB*)words;
+    while (count--) {
+        *dst++ = color;
+    }
+}
+
+void spanScale(CRGB* dst, uint16_t count, uint8_t scale) {
+    uint8_t* p = (uint8_t*)dst;
+    size_t n = count * sizeof(CRGB);
+    const uint32_t mul = (uint32_t)scale + 1;
+
+    size_t head = headBytes(p, n);
+    n -= head;
+    while (head--) {
+        *p = (uint8_t)((*p * mul) >> 8);
+        p++;
+    }
+    PixelWord* words = (PixelWord*)p;
+    for (; n >= 4; n -= 4) {
+        *words = scaleWord(*words, mul);
+        words++;
+    }
+    p = (uint8_t*)words;
+    while (n--) {
+        *p = (uint8_t)((*p * mul) >> 8);
+        p++;
+    }
+}
+
+void spanAdd(CRGB* dst, const CRGB* src, uint16_t count) {
+    uint8_t* p = (uint8_t*)dst;
+    const uint8_t* s = (const uint8_t*)src;
+    size_t n = count * sizeof(CRGB);
+
+    size_t head = headBytes(p, n);
+    n -= head;
+    while (head--) {
+        *p = qadd8(*p, *s++);
+        p++;
+    }
+    // dst is aligned from here; src only if both started at the same offset
+    PixelWord* words = (PixelWord*)p;
+    for (; n >= 4; n -= 4) {
+        *words = addWord(*words, loadWord(s));
+        words++;
+        s += 4;
+    }
+    p = (uint8_t*)words;
+    while (n--) {
+        *p = qadd8(*p, *s++);
+        p++;
+    }
+}
+
+void spanBlend(CRGB* out, const CRGB* a, const CRGB* b, uint16_t count, uint8_t amountOfB) {
+    uint8_t* p = (uint8_t*)out;
+    const uint8_t* pa = (const uint8_t*)a;
+    const uint8_t* pb = (const uint8_t*)b;
+    size_t n = count * sizeof(CRGB);
+    const uint32_t keepA = 256 - (uint32_t)amountOfB;
+    const uint32_t takeB = (uint32_t)amountOfB + 1;
+
+    size_t head = headBytes(p, n);
+    n -= head;
+    while (head--) {
+        *p++ = (uint8_t)((*pa++ * keepA + *pb++ * takeB) >> 8);
+    }
+    PixelWord* words = (PixelWord*)p;
+    for (; n >= 4; n -= 4) {
+        *words++ = blendWord(loadWord(pa), loadWord(pb), keepA, takeB);
+        pa += 4;
+        pb += 4;
+    }
+    p = (uint8_t*)words;
+    while (n--) {
+        *p++ = (uint8_t)((*pa++ * keepA + *pb++ * takeB) >> 8);
+    }
+}
+
+// Blurs hold a pixel as three 21-bit lanes in a 64-bit word, enough for a
+// three-tap sum times the box divisor below
+static const uint64_t LANE_BYTES = 0xFFULL | (0xFFULL << 21) | (0xFFULL << 42);
+static const uint64_t LANE_ONE = 1ULL | (1ULL << 21) | (1ULL << 42);
+
+static inline uint64_t spread(const CRGB& c) {
+    return (uint64_t)c.r | ((uint64_t)c.g << 21) | ((uint64_t)c.b << 42);
+}
+
+static inline CRGB gather(uint64_t v) {
+    return CRGB((uint8_t)v, (uint8_t)(v >> 21), (uint8_t)(v >> 42));
+}
+
+// round(sum / 3): (sum + 1) * 683 >> 11 is exact for sums below 2048
+static inline uint64_t boxTaps(uint64_t prev, uint64_t cur, uint64_t next) {
+    return (((prev + cur + next + LANE_ONE) * 683) >> 11) & LANE_BYTES;
+}
+
+// round((prev + 2 cur + next) / 4)
+static inline uint64_t gaussianTaps(uint64_t prev, uint64_t cur, uint64_t next) {
+    return ((prev + cur + cur + next + LANE_ONE * 2) >> 2) & LANE_BYTES;
+}
+
+// In place: each line keeps the unblurred previous and current pixel, the
+// next one has not been written yet
+template <uint64_t (*TAPS)(uint64_t, uint64_t, uint64_t)>
+static void blurPasses(CRGB* pixels, const PanelLayout& layout) {
+    const int w = layout.width();
+    const int h = layout.height();
+    for (int y = 0; y < h; y++) {
+        uint64_t prev = spread(pixels[layout.index(0, y)]);
+        uint64_t cur = prev;
+        for (int x = 0; x < w; x++) {
+            const uint64_t next = x + 1 < w ? spread(pixels[layout.index(x + 1, y)]) : cur;
+            pixels[layout.index(x, y)] = gather(TAPS(prev, cur, next));
+            prev = cur;
+            cur = next;
+        }
+    }
+    for (int x = 0; x < w; x++) {
+        uint64_t prev = spread(pixels[layout.index(x, 0)]);
+        uint64_t cur = prev;
+        for (int y = 0; y < h; y++) {
+            const uint64_t next = y + 1 < h ? spread(pixels[layout.index(x, y + 1)]) : cur;
+            pixels[layout.index(x, y)] = gather(TAPS(prev, cur, next));
+            prev = cur;
+            cur = next;
+        }
+    }
+}
+
+void blurBox3(CRGB* pixels, const PanelLayout& layout) {
+    blurPasses<boxTaps>(pixels, layout);
+}
+
+void blurGaussian3(CRGB* pixels, const PanelLayout& layout) {
+    blurPasses<gaussianTaps>(pixels, layout);
+}
+
+// --- Bench ------------------------------------------------------------------
+
+// Scalar blur, one channel at a time, as the reference for blurPasses
+static void referenceBlur(CRGB* pixels, const PanelLayout& layout, bool gaussian) {
+    const int w = layout.width();
+    const int h = layout.height();
+    for (int pass = 0; pass < 2; pass++) {
+        const int lines = pass == 0 ? h : w;
+        const int length = pass == 0 ? w : h;
+        for (int line = 0; line < lines; line++) {
+            CRGB prev, cur;
+            for (int i = 0; i < length; i++) {
+                const int x = pass == 0 ? i : line;
+                const int y = pass == 0 ? line : i;
+                CRGB& px = pixels[layout.index(x, y)];
+                if (i == 0) {
+                    prev = cur = px;
+                }
+                CRGB next = cur;
+                if (i + 1 < length) {
+                    next = pixels[pass == 0 ? layout.index(x + 1, y) : layout.index(x, y + 1)];
+                }
+                for (int c = 0; c < 3; c++) {
+                    const int sum = gaussian ? prev[c] + 2 * cur[c] + next[c] : prev[c] + cur[c] + next[c];
+                    px[c] = gaussian ? (uint8_t)((sum + 2) / 4) : (uint8_t)((sum + 1) / 3);
+                }
+                prev = cur;
+                cur = next;
+            }
+        }
+    }
+}
+
+static uint32_t benchState = 0x9E3779B9;
+
+static void fillRandom(CRGB* pixels, uint16_t count) {
+    uint8_t* p = (uint8_t*)pixels;
+    for (size_t i = 0; i < count * sizeof(CRGB); i++) {
+        benchState ^= benchState << 13;
+        benchState ^= benchState >> 17;
+        benchState ^= benchState << 5;
+        p[i] = (uint8_t)benchState;
+    }
+}
+
+static void report(Print& out, const char* name, uint32_t fastUs, uint32_t refUs, bool match) {
+    out.printf("  %-10s %6lu us  ref %6lu us  %s\n",
+               name, (unsigned long)fastUs, (unsigned long)refUs, match ? "ok" : "MISMATCH");
+}
+
+void benchPixelKernels(Print& out, uint16_t count) {
+    if (count == 0 || count > PanelLayout::MAX_PIXELS) {
+        count = PanelLayout::MAX_PIXELS;
+    }
+    const int panelPixels = PanelLayout::PANEL_SIZE * PanelLayout::PANEL_SIZE;
+    const int panels = (count + panelPixels - 1) / panelPixels;
+    count = panels * panelPixels;
+
+    // Internal RAM like the LED buffer, so the timings are comparable
+    const size_t bytes = sizeof(CRGB) * count;
+    CRGB* a = (CRGB*)heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    CRGB* b = (CRGB*)heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    CRGB* fast = (CRGB*)heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    CRGB* ref = (CRGB*)heap_caps_malloc(bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    PanelLayout* layout = new (std::nothrow) PanelLayout();
+    if (!a || !b || !fast || !ref || !layout) {
+        out.println("Bench: not enough memory");
+        heap_caps_free(a);
+        heap_caps_free(b);
+        heap_caps_free(fast);
+        heap_caps_free(ref);
+        delete layout;
+        return;
+    }
+    const int unrotated[3] = { 0, 0, 0 };
+    layout->configure(panels, 0, unrotated);
+
+    fillRandom(a, count);
+    fillRandom(b, count);
+    out.printf("Pixel kernels, %u pixels:\n", (unsigned)count);
+
+    uint32_t t, fastUs, refUs;
+    const CRGB color(200, 100, 50);
+
+    t = micros(); spanFill(fast, count, color); fastUs = micros() - t;
+    t = micros(); fill_solid(ref, count, color); refUs = micros() - t;
+    report(out, "fill", fastUs, refUs, memcmp(fast, ref, bytes) == 0);
+
+    memcpy(fast, a, bytes);
+    memcpy(ref, a, bytes);
+    t = micros(); spanScale(fast, count, 100); fastUs = micros() - t;
+    t = micros(); nscale8(ref, count, 100); refUs = micros() - t;
+    report(out, "scale", fastUs, refUs, memcmp(fast, ref, bytes) == 0);
+
+    memcpy(fast, a, bytes);
+    memcpy(ref, a, bytes);
+    t = micros(); spanAdd(fast, b, count); fastUs = micros() - t;
+    t = micros();
+    for (uint16_t i = 0; i < count; i++) {
+        ref[i] += b[i];
+    }
+    refUs = micros() - t;
+    report(out, "add", fastUs, refUs, memcmp(fast, ref, bytes) == 0);
+
+    // Offset by one pixel so source and destination are misaligned
+    memcpy(fast, a, bytes);
+    memcpy(ref, a, bytes);
+    t = micros(); spanAdd(fast + 1, b, count - 1); fastUs = micros() - t;
+    t = micros();
+    for (uint16_t i = 0; i + 1 < count; i++) {
+        ref[i + 1] += b[i];
+    }
+    refUs = micros() - t;
+    report(out, "add/skew", fastUs, refUs, memcmp(fast, ref, bytes) == 0);
+
+    bool match = true;
+    fastUs = refUs = 0;
+    const uint8_t amounts[] = { 0, 1, 77, 128, 254, 255 };
+    for (size_t k = 0; k < sizeof(amounts); k++) {
+        t = micros(); spanBlend(fast, a, b, count, amounts[k]); fastUs += micros() - t;
+        t = micros();
+        for (uint16_t i = 0; i < count; i++) {
+            ref[i] = blend(a[i], b[i], amounts[k]);
+        }
+        refUs += micros() - t;
+        match = match && memcmp(fast, ref, bytes) == 0;
+    }
+    report(out, "blend x6", fastUs, refUs, match);
+
+    memcpy(fast, a, bytes);
+    memcpy(ref, a, bytes);
+    t = micros(); blurBox3(fast, *layout); fastUs = micros() - t;
+    t = micros(); referenceBlur(ref, *layout, false); refUs = micros() - t;
+    report(out, "blur box", fastUs, refUs, memcmp(fast, ref, bytes) == 0);
+
+    memcpy(fast, a, bytes);
+    memcpy(ref, a, bytes);
+    t = micros(); blurGaussian3(fast, *layout); fastUs = micros() - t;
+    t = micros(); referenceBlur(ref, *layout, true); refUs = micros() - t;
+    report(out, "blur gauss", fastUs, refUs, memcmp(fast, ref, bytes) == 0);
+
+    heap_caps_free(a);
+    heap_caps_free(b);
+    heap_caps_free(fast);
+    heap_caps_free(ref);
+    delete layout;
+}
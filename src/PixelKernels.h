@@ -0,0 +1,53 @@
+// File: PixelKernels.h
+// Bulk operations on spans of CRGB pixels
+
+#ifndef PIXELKERNELS_H
+#define PIXELKERNELS_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include "PanelLayout.h"
+
+/**
+ * Whole-buffer versions of the per-pixel loops animations and compositors
+ * run every frame. The span kernels treat the pixels as a plain byte array
+ * and work on four channels per 32-bit word (SWAR), splitting each word
+ * into even and odd bytes so products get 16 bits of room. Buffers of any
+ * alignment are accepted: a few leading and trailing bytes go through the
+ * scalar path.
+ *
+ * Results are bit-exact with FastLED's scalar functions (scale8, blend8,
+ * qadd8 with the library's default FIXED rounding), which the bench checks
+ * against on the target.
+ *
+ * The blurs work on the logical canvas through a PanelLayout, in place,
+ * as a horizontal pass followed by a vertical one. Edge pixels repeat, so
+ * a blur keeps the total brightness of an evenly lit canvas.
+ */
+
+// dst[i] = color
+void spanFill(CRGB* dst, uint16_t count, const CRGB& color);
+
+// Every channel * (scale + 1) / 256, like nscale8()
+void spanScale(CRGB* dst, uint16_t count, uint8_t scale);
+
+// Like fadeToBlackBy(): spanScale(255 - amount)
+inline void spanFade(CRGB* dst, uint16_t count, uint8_t amount) {
+    spanScale(dst, count, 255 - amount);
+}
+
+// dst[i] += src[i], saturating per channel
+void spanAdd(CRGB* dst, const CRGB* src, uint16_t count);
+
+// out[i] = blend(a[i], b[i], amountOfB); out may be a
+void spanBlend(CRGB* out, const CRGB* a, const CRGB* b, uint16_t count, uint8_t amountOfB);
+
+// 3x3 box and [1 2 1] x [1 2 1] / 16 Gaussian over the canvas
+void blurBox3(CRGB* pixels, const PanelLayout& layout);
+void blurGaussian3(CRGB* pixels, const PanelLayout& layout);
+
+// Checks every kernel against the scalar reference on random data and
+// times both over count pixels
+void benchPixelKernels(Print& out, uint16_t count);
+
+#endif // PIXELKERNELS_H
@@ -0,0 +1,333 @@
+// File: RequestScheduler.cpp
+// Admission control for HTTP requests, by route class
+
+#include "RequestScheduler.h"
+
+// maxActive, burst, refillPerSec, shedLevel, retryAfterSec, maxWaitMs
+const RequestScheduler::ClassConfig RequestScheduler::CONFIG[REQ_CLASS_COUNT] = {
+    { 3, 10,  5, 0, 1, 2000 },  // REQ_CONTROL: the UI serialises writes already
+    { 4, 40, 20, 2, 2, 1000 },  // REQ_READ: control.html loads settings via /api/params
+    { 4, 30, 15, 0, 1, 1000 },  // REQ_STATIC
+    { 1,  3,  1, 1, 5,    0 }   // REQ_LOGS: logs.html polls every 5 s, no point waiting
+};
+
+// Load thresholds relative to the baseline frame period
+static const uint32_t SHED_MARGIN_US = 4000;
+
+RequestScheduler::RequestScheduler()
+    : _totalActive(0)
+    , _nextOrder(0)
+    , _fastPeriodUs(0)
+    , _baselineUs(0)
+    , _loadLevel(0)
+{
+    unsigned long now = millis();
+    for (int i = 0; i < REQ_CLASS_COUNT; i++) {
+        _tokens[i] = (uint32_t)CONFIG[i].burst * 1000;
+        _lastRefill[i] = now;
+        _stats[i].active = 0;
+        _stats[i].peakActive = 0;
+        _stats[i].waiting = 0;
+        _stats[i].peakWaiting = 0;
+        _stats[i].admitted = 0;
+        _stats[i].queued = 0;
+        _stats[i].rejectedBusy = 0;
+        _stats[i].rejectedWait = 0;
+        _stats[i].rejectedRate = 0;
+        _stats[i].rejectedShed = 0;
+    }
+    for (uint8_t i = 0; i < MAX_WAITING; i++) {
+        _waiting[i].key = nullptr;
+    }
+    portMUX_TYPE unlocked = portMUX_INITIALIZER_UNLOCKED;
+    _mux = unlocked;
+}
+
+void RequestScheduler::refill(RequestClass cls, unsigned long now) {
+    const ClassConfig& config = CONFIG[cls];
+    unsigned long elapsed = now - _lastRefill[cls];
+    _lastRefill[cls] = now;
+
+    // refillPerSec tokens per second is refillPerSec milli-tokens per ms
+    uint32_t capacity = (uint32_t)config.burst * 1000;
+    uint32_t added = elapsed >= capacity ? capacity : (uint32_t)elapsed * config.refillPerSec;
+    _tokens[cls] = (_tokens[cls] + added > capacity) ? capacity : _tokens[cls] + added;
+}
+
+bool RequestScheduler::fits(RequestClass cls) const {
+    if (_stats[cls].active >= CONFIG[cls].maxActive || _totalActive >= TOTAL_ACTIVE_LIMIT) {
+        return false;
+    }
+    return cls == REQ_CONTROL || _totalActive < TOTAL_ACTIVE_LIMIT - CONTROL_RESERVE;
+}
+
+// A newcomer must not overtake requests of its own or a higher class that
+// are already waiting for a slot
+bool RequestScheduler::waitingAhead(RequestClass cls) const {
+    for (int c = 0; c <= cls; c++) {
+        if (_stats[c].waiting) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void RequestScheduler::take(RequestClass cls) {
+    ClassStats& stats = _stats[cls];
+    stats.active++;
+    if (stats.active > stats.peakActive) {
+        stats.peakActive = stats.active;
+    }
+    stats.admitted++;
+    _totalActive++;
+}
+
+RequestScheduler::Verdict RequestScheduler::admit(RequestClass cls, uint32_t& retryAfterSec) {
+    const ClassConfig& config = CONFIG[cls];
+    ClassStats& stats = _stats[cls];
+    Verdict verdict = ADMITTED;
+    retryAfterSec = 0;
+
+    // Lets expired waiters go before deciding whether this one has to wait
+    dispatchWaiting();
+
+    portENTER_CRITICAL(&_mux);
+    refill(cls, millis());
+
+    if (config.shedLevel != 0 && _loadLevel >= config.shedLevel) {
+        verdict = REJECTED_SHED;
+        stats.rejectedShed++;
+        retryAfterSec = config.retryAfterSec;
+    } else if (_tokens[cls] < 1000) {
+        verdict = REJECTED_RATE;
+        stats.rejectedRate++;
+        uint32_t perSecond = (uint32_t)config.refillPerSec * 1000;
+        retryAfterSec = (1000 - _tokens[cls] + perSecond - 1) / perSecond;
+        if (retryAfterSec == 0) retryAfterSec = 1;
+    } else if (!fits(cls) || waitingAhead(cls)) {
+        retryAfterSec = config.retryAfterSec;
+        if (config.maxWaitMs) {
+            verdict = WAIT;
+        } else {
+            verdict = REJECTED_BUSY;
+            stats.rejectedBusy++;
+        }
+    } else {
+        _tokens[cls] -= 1000;
+        take(cls);
+    }
+    portEXIT_CRITICAL(&_mux);
+
+    return verdict;
+}
+
+bool RequestScheduler::wait(RequestClass cls, const void* key, const Waiter& waiter) {
+    int slot = -1;
+    int displaced = -1;
+
+    portENTER_CRITICAL(&_mux);
+    for (uint8_t i = 0; i < MAX_WAITING && slot < 0; i++) {
+        if (!_waiting[i].key) {
+            slot = i;
+        }
+    }
+    if (slot < 0) {
+        // Full: displace the newest waiter of the lowest class below this one
+        for (uint8_t i = 0; i < MAX_WAITING; i++) {
+            const WaitSlot& w = _waiting[i];
+            if (w.cls > cls && (displaced < 0 || w.cls > _waiting[displaced].cls ||
+                                (w.cls == _waiting[displaced].cls && w.order > _waiting[displaced].order))) {
+                displaced = i;
+            }
+        }
+        if (displaced >= 0) {
+            ClassStats& other = _stats[_waiting[displaced].cls];
+            other.waiting--;
+            other.rejectedWait++;
+            slot = displaced;
+        }
+    }
+    ClassStats& stats = _stats[cls];
+    if (slot >= 0) {
+        if (_tokens[cls] >= 1000) {
+            _tokens[cls] -= 1000;
+        }
+        _waiting[slot].key = key;
+        _waiting[slot].order = _nextOrder++;
+        _waiting[slot].since = millis();
+        _waiting[slot].cls = cls;
+        stats.waiting++;
+        if (stats.waiting > stats.peakWaiting) {
+            stats.peakWaiting = stats.waiting;
+        }
+        stats.queued++;
+    } else {
+        stats.rejectedBusy++;
+    }
+    portEXIT_CRITICAL(&_mux);
+
+    if (slot < 0) {
+        return false;
+    }
+    Waiter previous;
+    previous.swap(_waiters[slot]);
+    _waiters[slot] = waiter;
+    if (displaced >= 0) {
+        previous(false);
+    }
+    // A slot may have come free between admit() and here
+    dispatchWaiting();
+    return true;
+}
+
+void RequestScheduler::cancel(const void* key) {
+    int slot = -1;
+    portENTER_CRITICAL(&_mux);
+    for (uint8_t i = 0; i < MAX_WAITING; i++) {
+        if (_waiting[i].key == key) {
+            _stats[_waiting[i].cls].waiting--;
+            _waiting[i].key = nullptr;
+            slot = i;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&_mux);
+    if (slot >= 0) {
+        Waiter dropped;
+        dropped.swap(_waiters[slot]);
+    }
+}
+
+void RequestScheduler::release(RequestClass cls) {
+    portENTER_CRITICAL(&_mux);
+    if (_stats[cls].active > 0) {
+        _stats[cls].active--;
+    }
+    if (_totalActive > 0) {
+        _totalActive--;
+    }
+    portEXIT_CRITICAL(&_mux);
+
+    dispatchWaiting();
+}
+
+// One queued request per pass: the first expired one, else the highest
+// class (oldest first) that fits now. The waiter runs outside the critical
+// section and may itself release or queue requests.
+void RequestScheduler::dispatchWaiting() {
+    for (;;) {
+        int pick = -1;
+        bool admitted = false;
+        RequestClass cls = REQ_CONTROL;
+
+        portENTER_CRITICAL(&_mux);
+        const unsigned long now = millis();
+        for (uint8_t i = 0; i < MAX_WAITING; i++) {
+            const WaitSlot& w = _waiting[i];
+            if (w.key && now - w.since >= CONFIG[w.cls].maxWaitMs) {
+                pick = i;
+                break;
+            }
+        }
+        if (pick < 0) {
+            for (uint8_t i = 0; i < MAX_WAITING; i++) {
+                const WaitSlot& w = _waiting[i];
+                if (w.key && fits(w.cls) &&
+                    (pick < 0 || w.cls < _waiting[pick].cls ||
+                     (w.cls == _waiting[pick].cls && w.order < _waiting[pick].order))) {
+                    pick = i;
+                }
+            }
+            admitted = pick >= 0;
+        }
+        if (pick >= 0) {
+            WaitSlot& w = _waiting[pick];
+            cls = w.cls;
+            _stats[w.cls].waiting--;
+            if (admitted) {
+                take(w.cls);
+            } else {
+                _stats[w.cls].rejectedWait++;
+            }
+            w.key = nullptr;
+        }
+        portEXIT_CRITICAL(&_mux);
+
+        if (pick < 0) {
+            return;
+        }
+        Waiter waiter;
+        waiter.swap(_waiters[pick]);
+        if (waiter) {
+            waiter(admitted);
+        } else if (admitted) {
+            // Nobody to hand the slot to
+            release(cls);
+        }
+    }
+}
+
+uint32_t RequestScheduler::retryAfterSec(RequestClass cls) {
+    return CONFIG[cls].retryAfterSec;
+}
+
+// The fast average follows the loop within a few frames. The baseline drops
+// immediately to any faster period and rises by 1/1024 of the gap per frame,
+// so a lasting change (more panels, a heavier animation) becomes the new
+// normal after several seconds while short bursts of web traffic do not.
+void RequestScheduler::reportFramePeriod(uint32_t periodUs) {
+    uint32_t fast = _fastPeriodUs;
+    uint32_t baseline = _baselineUs;
+
+    if (fast == 0) {
+        fast = periodUs;
+        baseline = periodUs;
+    } else {
+        fast = (uint32_t)((int32_t)fast + ((int32_t)periodUs - (int32_t)fast) / 8);
+    }
+
+    if (fast < baseline) {
+        baseline = fast;
+    } else {
+        uint32_t step = (fast - baseline) / 1024;
+        baseline += step ? step : (fast > baseline ? 1 : 0);
+    }
+
+    uint32_t enter1 = baseline + baseline / 2 + SHED_MARGIN_US;
+    uint32_t enter2 = baseline * 2 + SHED_MARGIN_US * 2;
+    uint32_t exit1  = baseline + baseline / 4 + SHED_MARGIN_US / 2;
+    uint32_t exit2  = baseline + baseline / 2 + SHED_MARGIN_US;
+
+    uint8_t level = _loadLevel;
+    if (fast > enter2) {
+        level = 2;
+    } else if (level == 2 && fast < exit2) {
+        level = 1;
+    }
+    if (level == 0 && fast > enter1) {
+        level = 1;
+    } else if (level == 1 && fast < exit1) {
+        level = 0;
+    }
+
+    _fastPeriodUs = fast;
+    _baselineUs = baseline;
+    _loadLevel = level;
+}
+
+RequestScheduler::ClassStats RequestScheduler::stats(RequestClass cls) const {
+    portENTER_CRITICAL(const_cast<portMUX_TYPE*>(&_mux));
+    ClassStats copy = _stats[cls];
+    portEXIT_CRITICAL(const_cast<portMUX_TYPE*>(&_mux));
+    return copy;
+}
+
+const char* RequestScheduler::className(RequestClass cls) {
+    switch (cls) {
+        case REQ_CONTROL: return "control";
+        case REQ_READ:    return "read";
+        case REQ_STATIC:  return "static";
+        case REQ_LOGS:    return "logs";
+        default:          return "unknown";
+    }
+}
@@ -0,0 +1,163 @@
+// File: RequestScheduler.h
+// Admission control for HTTP requests, by route class
+
+#ifndef REQUESTSCHEDULER_H
+#define REQUESTSCHEDULER_H
+
+#include <Arduino.h>
+#include <functional>
+#include <freertos/FreeRTOS.h>
+
+// Route classes, highest priority first
+enum RequestClass {
+    REQ_CONTROL = 0,  // state-changing API calls
+    REQ_READ,         // API reads (status, lists, current values)
+    REQ_STATIC,       // web UI files
+    REQ_LOGS,         // log polling
+    REQ_CLASS_COUNT
+};
+
+/**
+ * Every handler asks admit() before doing any work. A request is refused
+ * (HTTP 429 with Retry-After) when
+ *
+ *  - its class has used up its token bucket, or
+ *  - the render loop is falling behind and the class is being shed:
+ *    LOGS first, then READ. CONTROL and STATIC are never shed.
+ *
+ * A request that finds its class full (maxActive connections in flight),
+ * the server near the socket limit (the last few slots are reserved for
+ * CONTROL), or requests of its own or a higher class already waiting, is
+ * told to WAIT. It then joins a small wait queue for up to maxWaitMs. When
+ * a slot is released the queue is served in priority order, CONTROL first
+ * and FIFO within a class. A request arriving at a full queue takes the
+ * place of the newest waiter of a lower class, if there is one. Otherwise
+ * it is refused, as are requests still waiting after maxWaitMs. LOGS never
+ * waits.
+ *
+ * Waiting requests keep their socket, so the queue is kept short. Expiry
+ * is checked whenever a request arrives or a slot is released. admit(),
+ * wait(), cancel() and release() run on the AsyncTCP task, which is also
+ * where waiters are called.
+ *
+ * The render loop reports its period through reportFramePeriod(). A fast
+ * moving average is compared with a slowly rising baseline, so the
+ * threshold adapts to the panel count and animation instead of relying on
+ * a fixed frame budget.
+ */
+class RequestScheduler {
+public:
+    enum Verdict {
+        ADMITTED,
+        WAIT,            // no slot now; call wait() to queue for one
+        REJECTED_BUSY,   // no slot and the class does not wait
+        REJECTED_RATE,   // token bucket empty
+        REJECTED_SHED    // shed because frames are overrunning
+    };
+
+    struct ClassStats {
+        uint16_t active;
+        uint16_t peakActive;
+        uint16_t waiting;       // current queue depth
+        uint16_t peakWaiting;
+        uint32_t admitted;      // including after waiting
+        uint32_t queued;        // admitted or not, after waiting
+        uint32_t rejectedBusy;  // no slot and no room in the queue
+        uint32_t rejectedWait;  // timed out or displaced while waiting
+        uint32_t rejectedRate;
+        uint32_t rejectedShed;
+    };
+
+    // Called once with true when the queued request has been given a slot
+    // (release() is then owed as for ADMITTED), or with false when it timed
+    // out or was displaced by a higher class
+    typedef std::function<void(bool admitted)> Waiter;
+
+    // Concurrent requests the server handles before reserving slots for CONTROL
+    static const uint16_t TOTAL_ACTIVE_LIMIT = 7;
+    static const uint16_t CONTROL_RESERVE = 2;
+    // Requests that can wait at once; each holds one of the 10 LWIP sockets
+    static const uint8_t MAX_WAITING = 2;
+
+    static RequestScheduler& getInstance() {
+        static RequestScheduler instance;
+        return instance;
+    }
+
+    // On ADMITTED the caller must call release() once the request is finished.
+    // retryAfterSec is set for WAIT and rejections.
+    Verdict admit(RequestClass cls, uint32_t& retryAfterSec);
+    void release(RequestClass cls);
+
+    // After WAIT: queues key (non-null, unique while queued). False if there
+    // is no room; the request is then refused. The waiter may be called
+    // before wait() returns.
+    bool wait(RequestClass cls, const void* key, const Waiter& waiter);
+    // Drops a queued request without calling its waiter (client went away)
+    void cancel(const void* key);
+
+    static uint32_t retryAfterSec(RequestClass cls);
+
+    // Called by the render loop once per iteration
+    void reportFramePeriod(uint32_t periodUs);
+
+    // 0 = normal, 1 = shedding LOGS, 2 = shedding LOGS and READ
+    uint8_t loadLevel() const { return _loadLevel; }
+    uint32_t framePeriodUs() const { return _fastPeriodUs; }
+    uint32_t baselinePeriodUs() const { return _baselineUs; }
+    uint16_t totalActive() const { return _totalActive; }
+
+    ClassStats stats(RequestClass cls) const;
+    static const char* className(RequestClass cls);
+
+private:
+    struct ClassConfig {
+        uint16_t maxActive;
+        uint16_t burst;         // bucket capacity
+        uint16_t refillPerSec;  // tokens added per second
+        uint8_t shedLevel;      // shed at this load level and above (0 = never)
+        uint8_t retryAfterSec;  // hint when rejected for concurrency or load
+        uint16_t maxWaitMs;     // time allowed in the wait queue (0 = never waits)
+    };
+
+    struct WaitSlot {
+        const void* key;        // nullptr = free
+        uint32_t order;         // arrival order, FIFO within a class
+        unsigned long since;
+        RequestClass cls;
+    };
+
+    static const ClassConfig CONFIG[REQ_CLASS_COUNT];
+
+    RequestScheduler();
+    RequestScheduler(const RequestScheduler&);
+    RequestScheduler& operator=(const RequestScheduler&);
+
+    void refill(RequestClass cls, unsigned long now);
+    // These three expect _mux to be held
+    bool fits(RequestClass cls) const;
+    bool waitingAhead(RequestClass cls) const;
+    void take(RequestClass cls);
+    // Admits or expires queued requests until none can move
+    void dispatchWaiting();
+
+    // Token buckets in milli-tokens so refills stay integral
+    uint32_t _tokens[REQ_CLASS_COUNT];
+    unsigned long _lastRefill[REQ_CLASS_COUNT];
+    ClassStats _stats[REQ_CLASS_COUNT];
+    uint16_t _totalActive;
+
+    WaitSlot _waiting[MAX_WAITING];
+    // Kept apart from the slots: copying a std::function may allocate, which
+    // must not happen inside the critical section
+    Waiter _waiters[MAX_WAITING];
+    uint32_t _nextOrder;
+
+    volatile uint32_t _fastPeriodUs;
+    volatile uint32_t _baselineUs;
+    volatile uint8_t _loadLevel;
+
+    portMUX_TYPE _mux;
+};
+
+#endif // REQUESTSCHEDULER_H
@@ -0,0 +1,106 @@
+// File: Rng.h
+// Small, fast, seedable pseudo-random generator for animations
+
+#ifndef RNG_H
+#define RNG_H
+
+#include <Arduino.h>
+
+/**
+ * xoshiro128** with 128 bits of state, using only 32-bit shifts, rotates
+ * and multiplies. A draw costs a few instructions where Arduino's random()
+ * goes through the hardware RNG, and the same seed always gives the same
+ * sequence, which is what makes animation output reproducible.
+ *
+ * seed() expands a 32-bit seed into the state with splitmix32, so any
+ * value (including 0) is a valid seed and nearby seeds give unrelated
+ * sequences.
+ *
+ * The helpers mirror the Arduino calls they replace: below(n) is
+ * random(n) and range(lo, hi) is random(lo, hi), both low bias and no
+ * division: a multiply-shift maps the 32-bit draw onto [0, n), so some
+ * results are at most one part in 2^32 / n more likely than others.
+ * bits() draws 32 independent coin flips at once for bulk fills.
+ */
+class Rng {
+public:
+    explicit Rng(uint32_t seedValue = 0) { seed(seedValue); }
+
+    void seed(uint32_t seedValue) {
+        uint32_t x = seedValue;
+        for (int i = 0; i < 4; i++) {
+            _s[i] = splitmix32(x);
+        }
+    }
+
+    uint32_t next() {
+        const uint32_t result = rotl(_s[1] * 5, 7) * 9;
+        const uint32_t t = _s[1] << 9;
+        _s[2] ^= _s[0];
+        _s[3] ^= _s[1];
+        _s[1] ^= _s[2];
+        _s[0] ^= _s[3];
+        _s[2] ^= t;
+        _s[3] = rotl(_s[3], 11);
+        return result;
+    }
+
+    // [0, n) by multiply-shift, no rejection step; 0 when n is 0
+    uint32_t below(uint32_t n) {
+        return (uint32_t)(((uint64_t)next() * n) >> 32);
+    }
+
+    // [lo, hi); lo when the range is empty
+    int32_t range(int32_t lo, int32_t hi) {
+        if (hi <= lo) {
+            return lo;
+        }
+        return lo + (int32_t)below((uint32_t)(hi - lo));
+    }
+
+    uint8_t byte() { return next() >> 24; }
+
+    // True with probability percent / 100
+    bool chance(uint8_t percent) { return below(100) < percent; }
+
+    // [0, 1) with 24 bits of resolution
+    float unit() { return (next() >> 8) * (1.0f / 16777216.0f); }
+
+    // 32 bits, each set with probability p256 / 256 (256 or more = all set).
+    // Builds the mask from the binary expansion of p256, lowest set bit
+    // first: OR with a fresh draw for a 1 bit, AND for a 0 bit, so it takes
+    // at most eight draws and one for p256 = 128.
+    uint32_t bits(uint16_t p256) {
+        if (p256 >= 256) {
+            return 0xFFFFFFFFu;
+        }
+        if (p256 == 0) {
+            return 0;
+        }
+        int bit = 0;
+        while (!(p256 & (1 << bit))) {
+            bit++;
+        }
+        uint32_t mask = next();
+        for (bit++; bit < 8; bit++) {
+            mask = (p256 & (1 << bit)) ? (mask | next()) : (mask & next());
+        }
+        return mask;
+    }
+
+private:
+    static uint32_t rotl(uint32_t x, int k) {
+        return (x << k) | (x >> (32 - k));
+    }
+
+    static uint32_t splitmix32(uint32_t& x) {
+        uint32_t z = (x += 0x9E3779B9u);
+        z = (z ^ (z >> 16)) * 0x85EBCA6Bu;
+        z = (z ^ (z >> 13)) * 0xC2B2AE35u;
+        return z ^ (z >> 16);
+    }
+
+    uint32_t _s[4];
+};
+
+#endif // RNG_H
@@ -0,0 +1,155 @@
+// File: StaticAssets.cpp
+// Serves the pre-compressed web UI produced by scripts/compress_assets.py
+
+#include "StaticAssets.h"
+
+static const char* MANIFEST_PATH = "/etags.txt";
+
+StaticAssets::StaticAssets()
+    : _fs(nullptr)
+    , _manifestStamp(0) {
+}
+
+bool StaticAssets::load(fs::FS& fs) {
+    _fs = &fs;
+    _assets.clear();
+    const bool manifest = loadManifest(fs);
+    if (!_bundle.begin()) {
+        return manifest;
+    }
+    // A filesystem image uploaded after the bundle was flashed wins, so
+    // /updatefs keeps working once a bundle is in place
+    if (manifest && _bundle.buildStamp() < _manifestStamp) {
+        Serial.printf("StaticAssets: SPIFFS build %u is newer than bundle build %u, using SPIFFS\n",
+                      (unsigned)_manifestStamp, (unsigned)_bundle.buildStamp());
+        _bundle.end();
+        return true;
+    }
+    std::vector<Asset> fromFs;
+    fromFs.swap(_assets);
+    if (loadBundle()) {
+        return true;
+    }
+    _assets.swap(fromFs);
+    _bundle.end();
+    return manifest;
+}
+
+bool StaticAssets::loadBundle() {
+    for (size_t i = 0; i < _bundle.count(); i++) {
+        const AssetBundle::Entry& e = _bundle.entry(i);
+        String etag;
+        etag.reserve(AssetBundle::ETAG_SIZE);
+        for (size_t c = 0; c < AssetBundle::ETAG_SIZE && e.etag[c]; c++) {
+            etag += e.etag[c];
+        }
+        addAsset(String(e.path), etag, AssetBundle::gzipped(e),
+                 _bundle.data(e), AssetBundle::length(e));
+    }
+    return !_assets.empty();
+}
+
+bool StaticAssets::loadManifest(fs::FS& fs) {
+    File f = fs.open(MANIFEST_PATH, "r");
+    if (!f) {
+        return false;
+    }
+
+    _manifestStamp = 0;
+    while (f.available()) {
+        String line = f.readStringUntil('\n');
+        line.trim();
+        if (line.startsWith("#build ")) {
+            _manifestStamp = (uint32_t)strtoul(line.c_str() + 7, nullptr, 10);
+            continue;
+        }
+        int sp1 = line.indexOf(' ');
+        int sp2 = line.lastIndexOf(' ');
+        if (sp1 <= 0 || sp2 <= sp1) {
+            continue;
+        }
+        addAsset(line.substring(0, sp1), line.substring(sp1 + 1, sp2),
+                 line.substring(sp2 + 1) == "1", nullptr, 0);
+    }
+    f.close();
+
+    Serial.printf("StaticAssets: %u entries in manifest\n", (unsigned)_assets.size());
+    return !_assets.empty();
+}
+
+void StaticAssets::addAsset(const String& path, const String& etag, bool gzipped,
+                            const uint8_t* data, size_t length) {
+    Asset asset;
+    asset.path = path;
+    asset.etag = "\"" + etag + "\"";
+    asset.gzipped = gzipped;
+    asset.data = data;
+    asset.length = length;
+    asset.contentType = contentTypeFor(path);
+    asset.cacheControl = cacheControlFor(path);
+    _assets.push_back(asset);
+}
+
+const StaticAssets::Asset* StaticAssets::find(const String& path) const {
+    for (size_t i = 0; i < _assets.size(); i++) {
+        if (_assets[i].path == path) {
+            return &_assets[i];
+        }
+    }
+    return nullptr;
+}
+
+void StaticAssets::serve(AsyncWebServerRequest* request, const Asset& asset) const {
+    if (request->hasHeader("If-None-Match")) {
+        const String& match = request->getHeader("If-None-Match")->value();
+        if (match.indexOf(asset.etag) >= 0 || match == "*") {
+            AsyncWebServerResponse* response = request->beginResponse(304);
+            response->addHeader("ETag", asset.etag);
+            response->addHeader("Cache-Control", asset.cacheControl);
+            request->send(response);
+            return;
+        }
+    }
+
+    AsyncWebServerResponse* response;
+    if (asset.data) {
+        // Sent directly from mapped flash, no copy and no filesystem lock
+        response = request->beginResponse(200, asset.contentType, asset.data, asset.length);
+    } else if (_fs) {
+        String filePath = asset.gzipped ? asset.path + ".gz" : asset.path;
+        response = request->beginResponse(*_fs, filePath, asset.contentType);
+    } else {
+        request->send(503, "text/plain", "Filesystem not ready");
+        return;
+    }
+    if (!response) {
+        request->send(404, "text/plain", "Not found");
+        return;
+    }
+    if (asset.gzipped) {
+        response->addHeader("Content-Encoding", "gzip");
+        response->addHeader("Vary", "Accept-Encoding");
+    }
+    response->addHeader("ETag", asset.etag);
+    response->addHeader("Cache-Control", asset.cacheControl);
+    request->send(response);
+}
+
+const char* StaticAssets::contentTypeFor(const String& path) {
+    if (path.endsWith(".html") || path.endsWith(".htm")) return "text/html";
+    if (path.endsWith(".js"))   return "application/javascript";
+    if (path.endsWith(".css"))  return "text/css";
+    if (path.endsWith(".json")) return "application/json";
+    if (path.endsWith(".svg"))  return "image/svg+xml";
+    if (path.endsWith(".png"))  return "image/png";
+    if (path.endsWith(".ico"))  return "image/x-icon";
+    return "application/octet-stream";
+}
+
+const char* StaticAssets::cacheControlFor(const String& path) {
+    // Only js/css are referenced with a ?v=<etag> cache buster
+    if (path.endsWith(".js") || path.endsWith(".css")) {
+        return "public, max-age=31536000, immutable";
+    }
+    return "no-cache";
+}
@@ -0,0 +1,69 @@
+// File: StaticAssets.h
+// Serves the pre-compressed web UI produced by scripts/compress_assets.py
+
+#ifndef STATICASSETS_H
+#define STATICASSETS_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include <ESPAsyncWebServer.h>
+#include <vector>
+#include "AssetBundle.h"
+
+/**
+ * Assets come from the memory-mapped "assets" partition when it holds a
+ * valid bundle; responses are then sent straight from mapped flash. If not,
+ * they are read from SPIFFS. Both carry the build stamp of the step that
+ * produced them, and a SPIFFS manifest newer than the bundle is preferred,
+ * so a filesystem upload is not hidden by an older bundle.
+ *
+ * On SPIFFS the build step stores text assets as "<path>.gz" and writes /etags.txt:
+ * a "#build <stamp>" line, then one line per served path:
+ * "<path> <etag> <gzipped 0|1>". The manifest is
+ * read once at boot, so a conditional request that matches its ETag is
+ * answered with 304 without touching the filesystem.
+ *
+ * HTML is sent with "no-cache" (always revalidated, usually a 304). The
+ * build step appends ?v=<etag> to js/css references, so those are cached
+ * as immutable for a year.
+ */
+class StaticAssets {
+public:
+    struct Asset {
+        String path;        // URL path, e.g. "/control.html"
+        String etag;        // quoted strong ETag
+        bool gzipped;       // gzip encoded (on SPIFFS: stored as path + ".gz")
+        const uint8_t* data; // mapped bundle contents, nullptr when on SPIFFS
+        size_t length;
+        const char* contentType;
+        const char* cacheControl;
+    };
+
+    StaticAssets();
+
+    // Uses the asset partition unless the SPIFFS manifest is from a newer
+    // build or the partition is empty. Returns false if neither is available.
+    bool load(fs::FS& fs);
+
+    bool fromBundle() const { return _bundle.mapped(); }
+
+    const std::vector<Asset>& assets() const { return _assets; }
+    const Asset* find(const String& path) const;
+
+    void serve(AsyncWebServerRequest* request, const Asset& asset) const;
+
+private:
+    bool loadBundle();
+    bool loadManifest(fs::FS& fs);
+    void addAsset(const String& path, const String& etag, bool gzipped,
+                  const uint8_t* data, size_t length);
+    static const char* contentTypeFor(const String& path);
+    static const char* cacheControlFor(const String& path);
+
+    AssetBundle _bundle;
+    fs::FS* _fs;
+    uint32_t _manifestStamp;    // 0 when the manifest has no "#build" line
+    std::vector<Asset> _assets;
+};
+
+#endif // STATICASSETS_H
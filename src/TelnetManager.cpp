@@ -1,5 +1,8 @@
 // TelnetManager.cpp
 #include "TelnetManager.h"
+#include "PixelKernels.h"
+#include "HueTable.h"
+#include "FixedMath.h"
 
 TelnetManager::TelnetManager(uint16_t port, LEDManager* ledManager)
     : _telnetServer(port), _ledManager(ledManager), _port(port) {}
@@ -120,6 +123,23 @@ void TelnetManager::processCommand(String input){
     else if(command.startsWith("GET SPEED")){
         getSpeed();
     }
+    else if(command.startsWith("SET SEED")){
+        String value = input.substring(strlen("SET SEED"));
+        value.trim();
+        setSeed(value);
+    }
+    else if(command.startsWith("GET SEED")){
+        getSeed();
+    }
+    else if(command.startsWith("BENCH KERNELS")){
+        benchKernels();
+    }
+    else if(command.startsWith("BENCH HUES")){
+        benchHues();
+    }
+    else if(command.startsWith("BENCH FIXED")){
+        benchFixed();
+    }
     else if(command.startsWith("HELP")){
         showHelp();
     }
@@ -304,6 +324,40 @@ void TelnetManager::getSpeed(){
     _telnetClient.printf("Current LED update speed: %lu ms\n", speed);
 }
 
+void TelnetManager::benchKernels(){
+    int panels = _ledManager->getPanelCount();
+    benchPixelKernels(_telnetClient, panels * PanelLayout::PANEL_SIZE * PanelLayout::PANEL_SIZE);
+}
+
+void TelnetManager::setSeed(const String& value){
+    char* end = nullptr;
+    unsigned long seed = strtoul(value.c_str(), &end, 10);
+    if(value.length() == 0 || *end != '\0' || !isdigit((unsigned char)value[0]) || seed > 16777215UL){
+        _telnetClient.println("Invalid seed. Enter a number between 0 and 16777215.");
+        return;
+    }
+    _ledManager->setRandomSeed((uint32_t)seed);
+    if(seed){
+        _telnetClient.printf("Deterministic mode on, seed %lu.\n", seed);
+    }
+    else{
+        _telnetClient.println("Deterministic mode off.");
+    }
+}
+
+void TelnetManager::getSeed(){
+    _telnetClient.printf("Current seed: %lu\n", (unsigned long)_ledManager->getRandomSeed());
+}
+
+void TelnetManager::benchHues(){
+    int panels = _ledManager->getPanelCount();
+    HueTable::bench(_telnetClient, panels * PanelLayout::PANEL_SIZE * PanelLayout::PANEL_SIZE);
+}
+
+void TelnetManager::benchFixed(){
+    benchFixedMath(_telnetClient, 4096);
+}
+
 void TelnetManager::showHelp(){
     _telnetClient.println("Available commands:");
     _telnetClient.println("  LIST PALETTES - List all palettes");
@@ -329,5 +383,10 @@ void TelnetManager::showHelp(){
     _telnetClient.println("  IDENTIFY PANELS - Show panel numbering");
     _telnetClient.println("  SPEED <ms> - Set LED update speed (3-1500)");
     _telnetClient.println("  GET SPEED - Get LED update speed");
+    _telnetClient.println("  SET SEED <0-16777215> - Replay animations from a seed (0 = off)");
+    _telnetClient.println("  GET SEED - Get the deterministic mode seed");
+    _telnetClient.println("  BENCH KERNELS - Check and time the pixel kernels");
+    _telnetClient.println("  BENCH HUES - Compare hue table and CHSV conversion");
+    _telnetClient.println("  BENCH FIXED - Check and time fixed-point math against float");
     _telnetClient.println("  HELP - Show this help message");
 }
@@ -42,6 +42,11 @@ private:
   void getSpeed();
   void showHelp();
   void identifyPanels();
+  void setSeed(const String& value);
+  void getSeed();
+  void benchKernels();
+  void benchHues();
+  void benchFixed();
 };
 
 #endif // TELNETMANAGER_H
@@ -0,0 +1,72 @@
+// File: TextCache.cpp
+// Pre-rendered 1-bit text strips, shared by everything that draws text
+
+#include "TextCache.h"
+#include <new>
+
+TextCache& TextCache::getInstance() {
+    static TextCache instance;
+    return instance;
+}
+
+TextCache::TextCache()
+    : _hits(0)
+    , _misses(0)
+{
+    _entries.reserve(MAX_ENTRIES);
+}
+
+std::shared_ptr<const TextStrip> TextCache::get(uint8_t fontId, const String& text) {
+    for (size_t i = 0; i < _entries.size(); i++) {
+        if (_entries[i]->fontId == fontId && _entries[i]->text == text) {
+            std::shared_ptr<const TextStrip> strip = _entries[i];
+            // Move to the front
+            for (size_t j = i; j > 0; j--) {
+                _entries[j] = _entries[j - 1];
+            }
+            _entries[0] = strip;
+            _hits++;
+            return strip;
+        }
+    }
+
+    _misses++;
+    std::shared_ptr<const TextStrip> strip = render(fontId, text);
+    if (!strip) {
+        return strip;
+    }
+    if (_entries.size() >= MAX_ENTRIES) {
+        _entries.pop_back();
+    }
+    _entries.insert(_entries.begin(), strip);
+    return strip;
+}
+
+std::shared_ptr<const TextStrip> TextCache::render(uint8_t fontId, const String& text) {
+    const BitmapFont& font = fontById(fontId);
+    size_t length = text.length() < MAX_TEXT_LENGTH ? text.length() : MAX_TEXT_LENGTH;
+
+    std::shared_ptr<TextStrip> strip(new (std::nothrow) TextStrip());
+    if (!strip) {
+        return std::shared_ptr<const TextStrip>();
+    }
+    strip->text = text;
+    strip->fontId = fontId < FONT_COUNT ? fontId : FONT_5X7;
+    strip->height = font.height;
+    strip->columns.reserve(length * font.advance());
+
+    for (size_t i = 0; i < length; i++) {
+        char c = text.charAt(i);
+        for (uint8_t col = 0; col < font.width; col++) {
+            strip->columns.push_back(font.column(c, col));
+        }
+        for (uint8_t gap = 0; gap < font.spacing; gap++) {
+            strip->columns.push_back(0);
+        }
+    }
+    // No trailing gap after the last glyph
+    for (uint8_t gap = 0; gap < font.spacing && !strip->columns.empty(); gap++) {
+        strip->columns.pop_back();
+    }
+    return strip;
+}
@@ -0,0 +1,57 @@
+// File: TextCache.h
+// Pre-rendered 1-bit text strips, shared by everything that draws text
+
+#ifndef TEXTCACHE_H
+#define TEXTCACHE_H
+
+#include <Arduino.h>
+#include <memory>
+#include <vector>
+#include "BitmapFont.h"
+
+/**
+ * A message rendered once in a given font: one byte per column, bit 0 =
+ * top row, including the spacing after each glyph. Drawing a window of it
+ * is a column lookup per pixel, whatever the message length.
+ */
+struct TextStrip {
+    String text;
+    uint8_t fontId;
+    uint8_t height;
+    std::vector<uint8_t> columns;
+
+    uint16_t width() const { return (uint16_t)columns.size(); }
+};
+
+/**
+ * Small most-recently-used cache of strips. Strips are immutable and
+ * handed out as shared pointers, so an evicted strip stays valid for
+ * whoever is still drawing it. Only used from the render path, which runs
+ * under the LEDManager lock.
+ */
+class TextCache {
+public:
+    static TextCache& getInstance();
+
+    std::shared_ptr<const TextStrip> get(uint8_t fontId, const String& text);
+
+    uint32_t hits() const { return _hits; }
+    uint32_t misses() const { return _misses; }
+
+private:
+    TextCache();
+    TextCache(const TextCache&) = delete;
+    TextCache& operator=(const TextCache&) = delete;
+
+    static std::shared_ptr<const TextStrip> render(uint8_t fontId, const String& text);
+
+    static const size_t MAX_ENTRIES = 6;
+    static const size_t MAX_TEXT_LENGTH = 160;
+
+    // Most recently used first
+    std::vector<std::shared_ptr<const TextStrip>> _entries;
+    uint32_t _hits;
+    uint32_t _misses;
+};
+
+#endif // TEXTCACHE_H
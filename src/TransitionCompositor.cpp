@@ -0,0 +1,155 @@
+// File: TransitionCompositor.cpp
+// Blends the outgoing and incoming animation during an animation switch
+
+#include "TransitionCompositor.h"
+#include "AnimationClock.h"
+#include "PixelKernels.h"
+#include <esp_heap_caps.h>
+#include <string.h>
+
+// Width of the soft edge of a wipe, in logical pixels (as fixed point x16)
+static const int EDGE = 4 * 16;
+
+TransitionCompositor::TransitionCompositor()
+    : _active(false)
+    , _startMillis(0)
+    , _durationMs(0)
+    , _curve(CURVE_EASE_IN_OUT)
+    , _wipe(WIPE_CROSSFADE)
+{
+    _buffers[0] = _buffers[1] = nullptr;
+}
+
+TransitionCompositor::~TransitionCompositor() {
+    for (int i = 0; i < 2; i++) {
+        if (_buffers[i]) {
+            heap_caps_free(_buffers[i]);
+            _buffers[i] = nullptr;
+        }
+    }
+}
+
+bool TransitionCompositor::allocate() {
+    const size_t bytes = sizeof(CRGB) * PanelLayout::MAX_PIXELS;
+    for (int i = 0; i < 2; i++) {
+        if (_buffers[i]) continue;
+        _buffers[i] = (CRGB*)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!_buffers[i]) {
+            _buffers[i] = (CRGB*)heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+        }
+        if (!_buffers[i]) {
+            Serial.println("TransitionCompositor: Failed to allocate buffer");
+            return false;
+        }
+        fill_solid(_buffers[i], PanelLayout::MAX_PIXELS, CRGB::Black);
+    }
+    return true;
+}
+
+void TransitionCompositor::start(uint32_t durationMs, Curve curve, Wipe wipe) {
+    _startMillis = AnimationClock::now();
+    _durationMs = durationMs ? durationMs : 1;
+    _curve = curve < CURVE_COUNT ? curve : CURVE_LINEAR;
+    _wipe = wipe < WIPE_COUNT ? wipe : WIPE_CROSSFADE;
+    _active = true;
+}
+
+bool TransitionCompositor::finished() const {
+    return !_active || AnimationClock::now() - _startMillis >= _durationMs;
+}
+
+uint8_t TransitionCompositor::progress() const {
+    unsigned long elapsed = AnimationClock::now() - _startMillis;
+    if (elapsed >= _durationMs) {
+        return 255;
+    }
+    return (uint8_t)((elapsed * 255UL) / _durationMs);
+}
+
+uint8_t TransitionCompositor::shape(uint8_t t, Curve curve) {
+    switch (curve) {
+        case CURVE_EASE_IN_OUT: return ease8InOutCubic(t);
+        case CURVE_EASE_IN:     return scale8(t, t);
+        case CURVE_EASE_OUT:    return 255 - scale8(255 - t, 255 - t);
+        default:                return t;
+    }
+}
+
+// Mix for a pixel at 'position' behind a front at 'front' (both x16)
+uint8_t TransitionCompositor::edgeAmount(int front, int position) {
+    int d = front - position;
+    if (d <= 0) return 0;
+    if (d >= EDGE) return 255;
+    return (uint8_t)(d * 255 / EDGE);
+}
+
+bool TransitionCompositor::compose(CRGB* out, const PanelLayout& layout) {
+    const CRGB* from = _buffers[0];
+    const CRGB* to = _buffers[1];
+    const int width = layout.width();
+    const int height = layout.height();
+    const int count = layout.pixelCount();
+
+    uint8_t t = progress();
+    uint8_t p = shape(t, _curve);
+
+    if (t == 255) {
+        memcpy(out, to, sizeof(CRGB) * count);
+        _active = false;
+        return false;
+    }
+
+    if (_wipe == WIPE_CROSSFADE) {
+        spanBlend(out, from, to, count, p);
+        return true;
+    }
+
+    // Distance covered by the front, x16, including the soft edge
+    int span;
+    switch (_wipe) {
+        case WIPE_DOWN:   span = height * 16 + EDGE; break;
+        case WIPE_CENTER: span = width * 8 + EDGE; break;
+        default:          span = width * 16 + EDGE; break;
+    }
+    int front = (p * span) / 255;
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            uint8_t amount;
+            switch (_wipe) {
+                case WIPE_LEFT:
+                    amount = edgeAmount(front, x * 16);
+                    break;
+                case WIPE_RIGHT:
+                    amount = edgeAmount(front, (width - 1 - x) * 16);
+                    break;
+                case WIPE_DOWN:
+                    amount = edgeAmount(front, y * 16);
+                    break;
+                case WIPE_CENTER: {
+                    int d = (2 * x + 1 - width) * 8;
+                    amount = edgeAmount(front, d < 0 ? -d : d);
+                    break;
+                }
+                default: {
+                    // Fixed per-pixel threshold; 8x ramp so every pixel is
+                    // fully switched before p reaches 255
+                    uint32_t h = (uint32_t)x * 2654435761u ^ (uint32_t)y * 40503u;
+                    uint8_t threshold = scale8((uint8_t)(h >> 24), 223);
+                    int ramp = ((int)p - threshold) * 8;
+                    amount = ramp <= 0 ? 0 : (ramp >= 255 ? 255 : (uint8_t)ramp);
+                    break;
+                }
+            }
+            uint16_t i = layout.index(x, y);
+            if (amount == 0) {
+                out[i] = from[i];
+            } else if (amount == 255) {
+                out[i] = to[i];
+            } else {
+                out[i] = blend(from[i], to[i], amount);
+            }
+        }
+    }
+    return true;
+}
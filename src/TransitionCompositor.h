@@ -0,0 +1,71 @@
+// File: TransitionCompositor.h
+// Blends the outgoing and incoming animation during an animation switch
+
+#ifndef TRANSITIONCOMPOSITOR_H
+#define TRANSITIONCOMPOSITOR_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include "PanelLayout.h"
+
+/**
+ * While a transition runs, both animations draw into private buffers owned
+ * by the compositor (same physical LED order as leds[]) and compose() mixes
+ * them into the output. The mix amount per pixel comes from the elapsed
+ * time shaped by a curve, and a wipe pattern that varies it across the
+ * logical canvas. Wipes have a soft edge a few pixels wide.
+ *
+ * The buffers are allocated on first use (PSRAM preferred) and kept.
+ */
+class TransitionCompositor {
+public:
+    enum Curve : uint8_t {
+        CURVE_LINEAR = 0,
+        CURVE_EASE_IN_OUT,
+        CURVE_EASE_IN,
+        CURVE_EASE_OUT,
+        CURVE_COUNT
+    };
+
+    enum Wipe : uint8_t {
+        WIPE_CROSSFADE = 0,
+        WIPE_LEFT,       // incoming sweeps in from the left
+        WIPE_RIGHT,      // ... from the right
+        WIPE_DOWN,       // ... from the top
+        WIPE_CENTER,     // ... from the middle outwards
+        WIPE_DISSOLVE,   // pixels switch over in a fixed random order
+        WIPE_COUNT
+    };
+
+    TransitionCompositor();
+    ~TransitionCompositor();
+
+    bool allocate();
+
+    // Valid after allocate()
+    CRGB* outgoing() { return _buffers[0]; }
+    CRGB* incoming() { return _buffers[1]; }
+
+    void start(uint32_t durationMs, Curve curve, Wipe wipe);
+    void stop() { _active = false; }
+    bool active() const { return _active; }
+    bool finished() const;
+
+    // Writes the mix for the current time into out. Returns false once the
+    // transition has completed (out then holds the incoming frame).
+    bool compose(CRGB* out, const PanelLayout& layout);
+
+private:
+    uint8_t progress() const;
+    static uint8_t shape(uint8_t t, Curve curve);
+    static uint8_t edgeAmount(int front, int position);
+
+    CRGB* _buffers[2];
+    bool _active;
+    unsigned long _startMillis;
+    uint32_t _durationMs;
+    Curve _curve;
+    Wipe _wipe;
+};
+
+#endif // TRANSITIONCOMPOSITOR_H
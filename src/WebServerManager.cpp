@@ -14,9 +14,16 @@
 #include "LEDManager.h"   // So we can call LEDManager methods
 #include "esp_task_wdt.h" // Include ESP32 watchdog timer control
 #include "LogManager.h"   // Include LogManager for system logs
+#include "JsonWriter.h"   // Streaming JSON for API responses
+#include "ParamTable.h"   // Descriptor table behind /api/param/{name}
+#include "WorkQueue.h"    // Worker task for flash writes and slow jobs
+#include "RequestScheduler.h" // Per-class admission control
+#include "PaletteStore.h"     // User palette file format
 #include <ESPmDNS.h>       // mDNS for hostname resolution
 #include <WiFi.h>
 #include <stdio.h>
+#include <string.h>
+#include <memory>
 
 static bool g_spiffsMounted = false;
 
@@ -63,6 +70,187 @@ static bool requireApiToken(AsyncWebServerRequest* request) {
     return false;
 }
 
+static void sendTooManyRequests(AsyncWebServerRequest* request, uint32_t retryAfter) {
+    AsyncWebServerResponse* response = request->beginResponse(429, "text/plain", "Too many requests, try again later");
+    response->addHeader("Retry-After", String(retryAfter));
+    request->send(response);
+}
+
+// Runs handler once the request holds a slot of its class: straight away,
+// or from the scheduler's wait queue when a slot is released. Refused and
+// timed-out requests get 429 + Retry-After. The slot is released when the
+// connection closes.
+static void admitRequest(AsyncWebServerRequest* request, RequestClass cls,
+                         const ArRequestHandlerFunction& handler) {
+    RequestScheduler& scheduler = RequestScheduler::getInstance();
+    uint32_t retryAfter = 0;
+    RequestScheduler::Verdict verdict = scheduler.admit(cls, retryAfter);
+    if (verdict == RequestScheduler::ADMITTED) {
+        request->onDisconnect([cls]() {
+            RequestScheduler::getInstance().release(cls);
+        });
+        handler(request);
+        return;
+    }
+    if (verdict == RequestScheduler::WAIT) {
+        // Set first: an admitted waiter replaces it with the release
+        request->onDisconnect([request]() {
+            RequestScheduler::getInstance().cancel(request);
+        });
+        bool queued = scheduler.wait(cls, request, [request, cls, handler](bool admitted) {
+            if (!admitted) {
+                sendTooManyRequests(request, RequestScheduler::retryAfterSec(cls));
+                return;
+            }
+            request->onDisconnect([cls]() {
+                RequestScheduler::getInstance().release(cls);
+            });
+            handler(request);
+        });
+        if (queued) {
+            return;
+        }
+    }
+    sendTooManyRequests(request, retryAfter);
+}
+
+// Route handler that goes through admitRequest() first
+static ArRequestHandlerFunction gated(RequestClass cls, ArRequestHandlerFunction handler) {
+    return [cls, handler](AsyncWebServerRequest* request) {
+        admitRequest(request, cls, handler);
+    };
+}
+
+// How long a handler waits for a queued job before answering 202 instead
+static const uint32_t JOB_WAIT_MS = 50;
+
+// Replies 200 if the job finished within JOB_WAIT_MS, 202 if it is still
+// queued or running, 500 if it failed and 503 if it was never accepted.
+static void sendJobResult(AsyncWebServerRequest* request, const WorkQueue::Ticket& ticket,
+                          const String& doneMessage, const String& pendingMessage,
+                          const char* failMessage) {
+    if (!ticket.valid()) {
+        request->send(503, "text/plain", "Server busy, try again later");
+        return;
+    }
+    switch (ticket.wait(JOB_WAIT_MS)) {
+        case WorkQueue::DONE:
+            request->send(200, "text/plain", doneMessage);
+            break;
+        case WorkQueue::FAILED:
+            request->send(500, "text/plain", failMessage);
+            break;
+        default:
+            request->send(202, "text/plain", pendingMessage);
+            break;
+    }
+}
+
+// Runs on the worker task
+static bool writeNetworkConfig(const String& mode, const String& ip, const String& gw,
+                               const String& mask, const String& dns) {
+    if (!ensureSpiffsMounted()) {
+        return false;
+    }
+    File f = SPIFFS.open("/net.cfg", "w");
+    if (!f) {
+        return false;
+    }
+    f.printf("mode=%s\n", mode.c_str());
+    f.printf("ip=%s\n", ip.c_str());
+    f.printf("gw=%s\n", gw.c_str());
+    f.printf("mask=%s\n", mask.c_str());
+    f.printf("dns=%s\n", dns.c_str());
+    f.close();
+    return true;
+}
+
+// Runs on the worker task; keeps the stored addresses when only the mode changes
+static bool writeNetworkMode(const String& mode) {
+    if (!ensureSpiffsMounted()) {
+        return false;
+    }
+    String ip="192.168.2.38", gw="192.168.2.1", mask="255.255.255.0", dns="8.8.8.8";
+    if(SPIFFS.exists("/net.cfg")){
+        File fr = SPIFFS.open("/net.cfg","r");
+        while(fr && fr.available()){
+            String line = fr.readStringUntil('\n'); line.trim();
+            int eq = line.indexOf('='); if(eq>0){
+                String k=line.substring(0,eq); String v=line.substring(eq+1); k.trim(); v.trim();
+                if(k.equalsIgnoreCase("ip")) ip=v;
+                else if(k.equalsIgnoreCase("gw")) gw=v;
+                else if(k.equalsIgnoreCase("mask")) mask=v;
+                else if(k.equalsIgnoreCase("dns")) dns=v;
+            }
+        }
+        if(fr) fr.close();
+    }
+    return writeNetworkConfig(mode, ip, gw, mask, dns);
+}
+
+// Runs on the worker task
+static bool writePanelConfig(int count) {
+    if (!ensureSpiffsMounted()) {
+        return false;
+    }
+    File f = SPIFFS.open("/panel.cfg", "w");
+    if (!f) {
+        return false;
+    }
+    f.printf("count=%d\n", count);
+    f.close();
+    return true;
+}
+
+// Runs on the worker task; zones is a snapshot taken by the handler
+static bool writeZoneConfig(const std::vector<ZoneConfig>& zones) {
+    if (!ensureSpiffsMounted()) {
+        return false;
+    }
+    File f = SPIFFS.open("/zones.cfg", "w");
+    if (!f) {
+        return false;
+    }
+    for (size_t i = 0; i < zones.size(); i++) {
+        if (zones[i].animation >= 0) {
+            f.printf("zone%u=%s\n", (unsigned)i, ZoneSet::format(zones[i]).c_str());
+        }
+    }
+    f.close();
+    return true;
+}
+
+// Runs on the worker task; calibration is a snapshot taken by the handler
+static bool writeCalibrationConfig(const std::vector<PanelCalibration>& calibration) {
+    if (!ensureSpiffsMounted()) {
+        return false;
+    }
+    File f = SPIFFS.open("/calibration.cfg", "w");
+    if (!f) {
+        return false;
+    }
+    for (size_t i = 0; i < calibration.size(); i++) {
+        f.printf("panel%u=%s\n", (unsigned)i, OutputStage::format(calibration[i]).c_str());
+    }
+    f.close();
+    return true;
+}
+
+// Runs on the worker task; palettes is a snapshot taken by the handler
+static bool writeUserPalettes(const std::vector<PaletteDef>& palettes) {
+    if (!ensureSpiffsMounted()) {
+        return false;
+    }
+    std::vector<uint8_t> data = PaletteStore::encode(palettes);
+    File f = SPIFFS.open(PaletteStore::PATH, "w");
+    if (!f) {
+        return false;
+    }
+    bool ok = f.write(data.data(), data.size()) == data.size();
+    f.close();
+    return ok;
+}
+
 static bool isValidIPv4(const String& value) {
     int a, b, c, d;
     char dot1, dot2, dot3;
@@ -75,9 +263,161 @@ static bool isValidIPv4(const String& value) {
     return a >= 0 && a <= 255 && b >= 0 && b <= 255 && c >= 0 && c <= 255 && d >= 0 && d <= 255;
 }
 
+// Shared GET/POST handler for every entry in the parameter table, once admitted
+static void runParamRequest(AsyncWebServerRequest* request, const String& name, bool isSet) {
+    const ParamDescriptor* desc = findParam(name.c_str());
+    if (!desc) {
+        request->send(404, "text/plain", "Unknown parameter");
+        return;
+    }
+    uint8_t authFlag = isSet ? PARAM_WRITE_AUTH : PARAM_READ_AUTH;
+    if ((desc->flags & authFlag) && !requireApiToken(request)) {
+        return;
+    }
+
+    ParamValue value;
+    if (isSet) {
+        if (!request->hasParam("val")) {
+            request->send(400, "text/plain", "Missing val param");
+            return;
+        }
+        const char* error = nullptr;
+        if (!parseParamValue(*desc, request->getParam("val")->value(), value, error)) {
+            request->send(400, "text/plain", error);
+            return;
+        }
+    }
+
+    if (!acquireLEDManager(500)) {
+        request->send(503, "text/plain", "Server busy, try again later");
+        return;
+    }
+
+    if (isSet) {
+        bool ok = desc->set(value);
+        releaseLEDManager();
+        if (!ok) {
+            request->send(400, "text/plain", String("Invalid value for ") + desc->name);
+            return;
+        }
+        String msg = String(desc->name) + " set to " + formatParamValue(*desc, value);
+        request->send(200, "text/plain", msg);
+        Serial.println(msg);
+    } else {
+        desc->get(value);
+        releaseLEDManager();
+        request->send(200, "text/plain", formatParamValue(*desc, value));
+    }
+}
+
+static void handleParamRequest(AsyncWebServerRequest* request, const String& name, bool isSet) {
+    admitRequest(request, isSet ? REQ_CONTROL : REQ_READ, [name, isSet](AsyncWebServerRequest* request) {
+        runParamRequest(request, name, isSet);
+    });
+}
+
+// Frame stream clients must send "AUTH <token>" as a text message before any
+// binary frame is accepted. Browsers cannot set headers on a WebSocket upgrade.
+// The reply is "OK", "Unauthorized", or "Busy..." followed by a close when
+// MAX_FRAME_CLIENTS clients are already authorised.
+static const size_t MAX_FRAME_CLIENTS = 2;
+static uint32_t g_frameClientsAuthed[MAX_FRAME_CLIENTS] = { 0, 0 };
+
+static bool isFrameClientAuthed(uint32_t id) {
+    for (size_t i = 0; i < MAX_FRAME_CLIENTS; i++) {
+        if (g_frameClientsAuthed[i] == id) return true;
+    }
+    return false;
+}
+
+// Returns false if the client was to be authorised but every slot is taken
+static bool setFrameClientAuthed(uint32_t id, bool authed) {
+    for (size_t i = 0; i < MAX_FRAME_CLIENTS; i++) {
+        if (authed && g_frameClientsAuthed[i] == 0) {
+            g_frameClientsAuthed[i] = id;
+            return true;
+        }
+        if (!authed && g_frameClientsAuthed[i] == id) {
+            g_frameClientsAuthed[i] = 0;
+        }
+    }
+    return !authed;
+}
+
+static void sendFrameAck(AsyncWebSocketClient* client, FrameIngest::Status status, uint16_t seq) {
+    uint8_t ack[FrameIngest::ACK_SIZE];
+    ledManager.frameIngest().buildAck(status, seq, ack);
+    client->binary(ack, sizeof(ack));
+}
+
+static void onFrameSocketEvent(AsyncWebSocket* server, AsyncWebSocketClient* client,
+                               AwsEventType type, void* arg, uint8_t* data, size_t len) {
+    switch (type) {
+        case WS_EVT_CONNECT:
+            server->cleanupClients(MAX_FRAME_CLIENTS);
+            if (!ledManager.frameIngest().allocate()) {
+                systemError("Frame stream: out of memory for frame buffers");
+                client->close();
+            }
+            break;
+
+        case WS_EVT_DISCONNECT:
+            setFrameClientAuthed(client->id(), false);
+            break;
+
+        case WS_EVT_DATA: {
+            AwsFrameInfo* info = (AwsFrameInfo*)arg;
+            if (info->opcode == WS_TEXT) {
+                // Only single-fragment text messages carry the auth token
+                if (info->index == 0 && info->final && info->len == len) {
+                    size_t tokenLen = strlen(apiToken);
+                    bool ok = len == 5 + tokenLen &&
+                              memcmp(data, "AUTH ", 5) == 0 &&
+                              memcmp(data + 5, apiToken, tokenLen) == 0;
+                    if (!ok) {
+                        client->text("Unauthorized");
+                    } else if (isFrameClientAuthed(client->id()) ||
+                               setFrameClientAuthed(client->id(), true)) {
+                        client->text("OK");
+                    } else {
+                        // Frames from this client would only be dropped
+                        client->text("Busy: too many frame stream clients");
+                        client->close();
+                    }
+                }
+                break;
+            }
+            if (!isFrameClientAuthed(client->id())) {
+                if (info->index == 0) {
+                    sendFrameAck(client, FrameIngest::UNAUTHORIZED, 0);
+                }
+                break;
+            }
+            // Messages split across several websocket frames are not supported
+            if (info->num != 0 || info->opcode != WS_BINARY) {
+                if (info->index == 0) {
+                    sendFrameAck(client, FrameIngest::REJECTED, 0);
+                }
+                break;
+            }
+            uint16_t seq = 0;
+            FrameIngest::Status status = ledManager.frameIngest().receive(
+                client->id(), data, len, info->index, info->len, seq);
+            if (status != FrameIngest::INCOMPLETE) {
+                sendFrameAck(client, status, seq);
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
 // Constructor
 WebServerManager::WebServerManager(int port)
-    : _server(port) {
+    : _server(port)
+    , _frameSocket("/ws/frames") {
     // Subscribe current thread to TWDT
     esp_task_wdt_add(NULL);
 }
@@ -107,6 +447,40 @@ bool WebServerManager::initSPIFFS() {
     return true;
 }
 
+// Registers a GET route per manifest entry plus the page aliases. These are
+// added before the serveStatic fallbacks so they take precedence.
+void WebServerManager::setupStaticAssets() {
+    if (!_assets.load(SPIFFS)) {
+        Serial.println("No asset bundle or manifest found, serving files uncompressed");
+        return;
+    }
+
+    static const char* const aliases[][2] = {
+        { "/",         "/index.html" },
+        { "/status",   "/status.html" },
+        { "/update",   "/update.html" },
+        { "/reboot",   "/reboot.html" },
+        { "/updatefs", "/updatefs.html" },
+        { "/control",  "/control.html" },
+        { "/logs",     "/logs.html" }
+    };
+
+    const std::vector<StaticAssets::Asset>& list = _assets.assets();
+    for (size_t i = 0; i < list.size(); i++) {
+        const StaticAssets::Asset* asset = &list[i];
+        _server.on(asset->path.c_str(), HTTP_GET, gated(REQ_STATIC, [this, asset](AsyncWebServerRequest* request) {
+            _assets.serve(request, *asset);
+        }));
+    }
+    for (size_t i = 0; i < sizeof(aliases) / sizeof(aliases[0]); i++) {
+        const StaticAssets::Asset* asset = _assets.find(aliases[i][1]);
+        if (!asset) continue;
+        _server.on(aliases[i][0], HTTP_GET, gated(REQ_STATIC, [this, asset](AsyncWebServerRequest* request) {
+            _assets.serve(request, *asset);
+        }));
+    }
+}
+
 // Begin the web server
 void WebServerManager::begin() {
     // Init SPIFFS first with proper error handling
@@ -134,6 +508,9 @@ void WebServerManager::begin() {
     /****************************************************
      * Serve SPIFFS-based files
      ****************************************************/
+    setupStaticAssets();
+
+    // Fallback for filesystem images built without the asset manifest
     _server.serveStatic("/",       SPIFFS, "/").setDefaultFile("index.html");
     _server.serveStatic("/status", SPIFFS, "/status.html");
     _server.serveStatic("/update", SPIFFS, "/update.html");
@@ -144,6 +521,12 @@ void WebServerManager::begin() {
     // System logs page
     _server.serveStatic("/logs", SPIFFS, "/logs.html");
 
+    /****************************************************
+     * Binary frame stream (see FrameIngest.h for format)
+     ****************************************************/
+    _frameSocket.onEvent(onFrameSocketEvent);
+    _server.addHandler(&_frameSocket);
+
     /****************************************************
      * OTA Firmware Update
      ****************************************************/
@@ -225,7 +608,7 @@ void WebServerManager::begin() {
     /****************************************************
      * RebootNow route
      ****************************************************/
-    _server.on("/rebootNow", HTTP_POST, [](AsyncWebServerRequest *request){
+    _server.on("/rebootNow", HTTP_POST, gated(REQ_CONTROL, [](AsyncWebServerRequest *request){
         if (!requireApiToken(request)) {
             return;
         }
@@ -233,29 +616,33 @@ void WebServerManager::begin() {
         Serial.println("Manual reboot requested, restarting in 1 second...");
         delay(1000);
         ESP.restart();
-    });
+    }));
 
     /****************************************************
      * List Animations
      ****************************************************/
-    _server.on("/api/listAnimations", HTTP_GET, [](AsyncWebServerRequest *request){
+    _server.on("/api/listAnimations", HTTP_GET, gated(REQ_READ, [](AsyncWebServerRequest *request){
         size_t count = ledManager.getAnimationCount();
-        String json = "{\"animations\":[";
+        AsyncResponseStream* response = request->beginResponseStream("application/json", 256);
+        JsonWriter json(*response);
+        json.beginObject();
+        json.key("animations");
+        json.beginArray();
         for(size_t i = 0; i < count; i++){
-            json += "\"" + ledManager.getAnimationName(i) + "\"";
-            if (i + 1 < count) {
-                json += ",";
-            }
+            json.value(ledManager.getAnimationName(i));
         }
-        json += "],\"current\":" + String(ledManager.getAnimation()) + "}";
-        request->send(200, "application/json", json);
-    });
+        json.endArray();
+        json.member("current", ledManager.getAnimation());
+        json.endObject();
+        json.flush();
+        request->send(response);
+    }));
 
 
      /****************************************************
      * Set Animations
      ****************************************************/
-    _server.on("/api/setAnimation", HTTP_POST, [](AsyncWebServerRequest *request){
+    _server.on("/api/setAnimation", HTTP_POST, gated(REQ_CONTROL, [](AsyncWebServerRequest *request){
         if (!requireApiToken(request)) {
             return;
         }
@@ -285,61 +672,70 @@ void WebServerManager::begin() {
         
         request->send(200, "text/plain", msg);
         Serial.println(msg);
-    });
+    }));
 
     /****************************************************
      * Get Current Animation
      ****************************************************/
-    _server.on("/api/getAnimation", HTTP_GET, [](AsyncWebServerRequest *request){
+    _server.on("/api/getAnimation", HTTP_GET, gated(REQ_READ, [](AsyncWebServerRequest *request){
         int currentAnim = ledManager.getAnimation();
         request->send(200, "text/plain", String(currentAnim));
-    });
+    }));
 
     /****************************************************
      * API endpoints
      ****************************************************/
     // 1) listPalettes => JSON array of palette names
-    _server.on("/api/listPalettes", HTTP_GET, [](AsyncWebServerRequest *request){
+    _server.on("/api/listPalettes", HTTP_GET, gated(REQ_READ, [](AsyncWebServerRequest *request){
         if (!acquireLEDManager(500)) {
             request->send(503, "text/plain", "Server busy, try again later");
             return;
         }
         
-        String json = "{\"palettes\":[";
+        AsyncResponseStream* response = request->beginResponseStream("application/json", 512);
+        JsonWriter json(*response);
+        json.beginObject();
+        json.key("palettes");
+        json.beginArray();
         for (size_t i = 0; i < ledManager.getPaletteCount(); i++) {
-            json += "\"" + ledManager.getPaletteNameAt(i) + "\"";
-            if (i < ledManager.getPaletteCount() - 1) json += ",";
+            json.value(ledManager.getPaletteNameAt(i));
         }
-        json += "],\"current\":" + String(ledManager.getCurrentPalette()) + "}";
+        json.endArray();
+        json.member("current", ledManager.getCurrentPalette());
+        json.member("builtin", (unsigned)ledManager.getBuiltinPaletteCount());
+        json.endObject();
+        json.flush();
         
         releaseLEDManager();
-        request->send(200, "application/json", json);
-    });
+        request->send(response);
+    }));
 
     // 2) listPaletteDetails => (unused for now, same as above)
-    _server.on("/api/listPaletteDetails", HTTP_GET, [](AsyncWebServerRequest *request){
+    _server.on("/api/listPaletteDetails", HTTP_GET, gated(REQ_READ, [](AsyncWebServerRequest *request){
         if (!acquireLEDManager(500)) {
             request->send(503, "text/plain", "Server busy, try again later");
             return;
         }
         
-        String json = "[";
+        AsyncResponseStream* response = request->beginResponseStream("application/json", 512);
+        JsonWriter json(*response);
+        json.beginArray();
         for (size_t i = 0; i < ledManager.getPaletteCount(); i++) {
-            json += "\"" + ledManager.getPaletteNameAt(i) + "\"";
-            if (i < ledManager.getPaletteCount() - 1) json += ",";
+            json.value(ledManager.getPaletteNameAt(i));
         }
-        json += "]";
+        json.endArray();
+        json.flush();
         
         releaseLEDManager();
-        request->send(200, "application/json", json);
-    });
+        request->send(response);
+    }));
 
 
     /****************************************************
     * setPalette => expects ?val=<0-based index>
     * Example: /api/setPalette?val=2
     ****************************************************/
-    _server.on("/api/setPalette", HTTP_POST, [](AsyncWebServerRequest *request){
+    _server.on("/api/setPalette", HTTP_POST, gated(REQ_CONTROL, [](AsyncWebServerRequest *request){
         if (!requireApiToken(request)) {
             return;
         }
@@ -377,763 +773,479 @@ void WebServerManager::begin() {
         releaseLEDManager();
         request->send(200, "text/plain", msg);
         Serial.println(msg);
-    });
+    }));
 
 
 
     // 4) getPalette => returns { current: X, name: "..." }
-    _server.on("/api/getPalette", HTTP_GET, [](AsyncWebServerRequest *request){
+    _server.on("/api/getPalette", HTTP_GET, gated(REQ_READ, [](AsyncWebServerRequest *request){
         if (!acquireLEDManager(500)) {
             request->send(503, "text/plain", "Server busy, try again later");
             return;
         }
         
         int current = ledManager.getCurrentPalette(); // 0-based
-        String name = ledManager.getPaletteNameAt(current);
-        // for the UI, we might show them 1-based in the JSON if you want
-        String json = "{\"current\":" + String(current) + ",\"name\":\"" + name + "\"}";
+        AsyncResponseStream* response = request->beginResponseStream("application/json", 96);
+        JsonWriter json(*response);
+        json.beginObject();
+        json.member("current", current);
+        json.member("name", ledManager.getPaletteNameAt(current));
+        json.endObject();
+        json.flush();
         
         releaseLEDManager();
-        request->send(200, "application/json", json);
-    });
+        request->send(response);
+    }));
 
-    // 5) setBrightness => param "val" (0..255)
-    _server.on("/api/setBrightness", HTTP_POST, [](AsyncWebServerRequest *request){
+    /****************************************************
+     * User palettes, kept in /palettes.bin
+     ****************************************************/
+    _server.on("/api/userPalettes", HTTP_GET, gated(REQ_READ, [](AsyncWebServerRequest *request){
+        std::vector<PaletteDef> palettes = ledManager.getUserPalettes();
+        AsyncResponseStream* response = request->beginResponseStream("application/json", 512);
+        JsonWriter json(*response);
+        json.beginArray();
+        for (const PaletteDef& p : palettes) {
+            json.beginObject();
+            json.member("name", p.name);
+            json.key("stops");
+            json.beginArray();
+            for (const CRGB& c : p.stops) {
+                char hex[7];
+                snprintf(hex, sizeof(hex), "%02x%02x%02x", c.r, c.g, c.b);
+                json.value(hex);
+            }
+            json.endArray();
+            json.endObject();
+        }
+        json.endArray();
+        json.flush();
+        request->send(response);
+    }));
+
+    // name (letters, digits, '_', '-') and stops=rrggbb,rrggbb,...; an
+    // existing user palette of that name is replaced
+    _server.on("/api/palette", HTTP_POST, gated(REQ_CONTROL, [](AsyncWebServerRequest *request){
         if (!requireApiToken(request)) {
             return;
         }
-        if (!acquireLEDManager(500)) {
-            request->send(503, "text/plain", "Server busy, try again later");
+        if (!request->hasParam("name") || !request->hasParam("stops")) {
+            request->send(400, "text/plain", "Missing 'name' or 'stops' param");
             return;
         }
-        
-        if (!request->hasParam("val")) {
-            releaseLEDManager();
-            request->send(400, "text/plain", "Missing val param");
+        String name = request->getParam("name")->value();
+        std::vector<CRGB> stops;
+        if (!PaletteStore::validName(name)) {
+            request->send(400, "text/plain", "Invalid palette name");
             return;
         }
-        int value = request->getParam("val")->value().toInt();
-        if(value>=0 && value<=255){
-            ledManager.setBrightness((uint8_t)value);
-            String msg = "Brightness set to " + String(value);
-            
-            releaseLEDManager();
-            request->send(200, "text/plain", msg);
-            Serial.println(msg);
-        } else {
-            releaseLEDManager();
-            request->send(400, "text/plain","Brightness must be 0..255");
+        if (!PaletteStore::parseStops(request->getParam("stops")->value(), stops)) {
+            request->send(400, "text/plain",
+                "Invalid stops, expected 1-" + String(PaletteStore::MAX_STOPS) + " rrggbb colours");
+            return;
         }
-    });
 
-    // 6) getBrightness
-    _server.on("/api/getBrightness", HTTP_GET, [](AsyncWebServerRequest *request){
         if (!acquireLEDManager(500)) {
             request->send(503, "text/plain", "Server busy, try again later");
             return;
         }
-        
-        int b = ledManager.getBrightness();
-        
+        bool ok = ledManager.setUserPalette(name, stops);
+        std::vector<PaletteDef> palettes = ledManager.getUserPalettes();
         releaseLEDManager();
-        request->send(200, "text/plain", String(b));
-    });
+        if (!ok) {
+            request->send(400, "text/plain", "Name is a built-in palette or the palette limit is reached");
+            return;
+        }
+
+        WorkQueue::Ticket ticket = WorkQueue::getInstance().submit("palettes", [palettes]() {
+            return writeUserPalettes(palettes);
+        });
+        sendJobResult(request, ticket, "Palette " + name + " saved",
+                      "Palette " + name + " applied, saving",
+                      "Palette applied but /palettes.bin could not be written");
+    }));
 
-    // 7) setTailLength => param "val" (1..30)
-    _server.on("/api/setTailLength", HTTP_POST, [](AsyncWebServerRequest *request){
+    _server.on("/api/palette", HTTP_DELETE, gated(REQ_CONTROL, [](AsyncWebServerRequest *request){
         if (!requireApiToken(request)) {
             return;
         }
+        if (!request->hasParam("name")) {
+            request->send(400, "text/plain", "Missing 'name' param");
+            return;
+        }
+        String name = request->getParam("name")->value();
+
         if (!acquireLEDManager(500)) {
             request->send(503, "text/plain", "Server busy, try again later");
             return;
         }
-        
-        if (!request->hasParam("val")) {
-            releaseLEDManager();
-            request->send(400, "text/plain", "Missing val param");
-            return;
+        bool ok = ledManager.removeUserPalette(name);
+        std::vector<PaletteDef> palettes = ledManager.getUserPalettes();
+        // Zone palette indices may have been renumbered
+        std::vector<ZoneConfig> zones;
+        for (uint8_t i = 0; i < ZoneSet::MAX_ZONES; i++) {
+            zones.push_back(ledManager.getZone(i));
         }
-        int tLen = request->getParam("val")->value().toInt();
-        if(tLen<1 || tLen>30){
-            releaseLEDManager();
-            request->send(400, "text/plain","Tail length must be 1..30");
+        releaseLEDManager();
+        if (!ok) {
+            request->send(404, "text/plain", "No user palette named " + name);
             return;
         }
-        ledManager.setTailLength(tLen);
-        String msg = "Tail length set to " + String(tLen);
-        
-        releaseLEDManager();
-        request->send(200, "text/plain", msg);
-        Serial.println(msg);
+
+        WorkQueue::getInstance().post("zones", [zones]() {
+            return writeZoneConfig(zones);
+        });
+        WorkQueue::Ticket ticket = WorkQueue::getInstance().submit("palettes", [palettes]() {
+            return writeUserPalettes(palettes);
+        });
+        sendJobResult(request, ticket, "Palette " + name + " removed",
+                      "Palette " + name + " removed, saving",
+                      "Palette removed but /palettes.bin could not be written");
+    }));
+
+    /****************************************************
+     * Parameters: GET/POST /api/param/{name}?val=...
+     * All simple settings live in the table in ParamTable.cpp
+     ****************************************************/
+    _server.on("^\\/api\\/param\\/([A-Za-z0-9]+)$", HTTP_GET | HTTP_POST, [](AsyncWebServerRequest *request){
+        handleParamRequest(request, request->pathArg(0), request->method() == HTTP_POST);
     });
 
-    // 8) getTailLength
-    _server.on("/api/getTailLength", HTTP_GET, [](AsyncWebServerRequest *request){
+    // Parameter metadata and current values in one read, so a page can load
+    // every setting without a request per parameter. Values of read-protected
+    // parameters are left out unless the API token is sent.
+    _server.on("/api/params", HTTP_GET, gated(REQ_READ, [](AsyncWebServerRequest *request){
         if (!acquireLEDManager(500)) {
             request->send(503, "text/plain", "Server busy, try again later");
             return;
         }
-        
-        int tailLen = ledManager.getTailLength();
-        
+        const String token = readApiTokenHeader(request);
+        const bool authorized = token.length() > 0 && String(apiToken) == token;
+
+        static const char* const TYPE_NAMES[] = { "int", "float", "bool", "string" };
+        AsyncResponseStream* response = request->beginResponseStream("application/json", 4096);
+        JsonWriter json(*response);
+        json.beginArray();
+        for (size_t i = 0; i < paramCount(); i++) {
+            const ParamDescriptor& desc = paramAt(i);
+            json.beginObject();
+            json.member("name", desc.name);
+            json.member("type", TYPE_NAMES[desc.type]);
+            if (desc.type == PARAM_INT || desc.type == PARAM_FLOAT) {
+                json.key("min");
+                json.value(desc.minValue, desc.decimals);
+                json.key("max");
+                json.value(desc.maxValue, desc.decimals);
+            }
+            if (!(desc.flags & PARAM_READ_AUTH) || authorized) {
+                ParamValue value;
+                desc.get(value);
+                json.member("value", formatParamValue(desc, value));
+            }
+            json.endObject();
+        }
+        json.endArray();
+        json.flush();
         releaseLEDManager();
-        request->send(200, "text/plain", String(tailLen));
+        request->send(response);
+    }));
+
+    // Legacy rotation routes
+    _server.on("^\\/api\\/rotatePanel([1-3])$", HTTP_POST, [](AsyncWebServerRequest *request){
+        handleParamRequest(request, "rotation" + request->pathArg(0), true);
     });
 
-    // 9) setFadeAmount => param "val" (0..255)
-    _server.on("/api/setFadeAmount", HTTP_POST, [](AsyncWebServerRequest *request){
-        if (!requireApiToken(request)) {
-            return;
-        }
-        if (!acquireLEDManager(500)) {
-            request->send(503, "text/plain", "Server busy, try again later");
+    _server.on("/api/getRotation", HTTP_GET, [](AsyncWebServerRequest *request){
+        if (!request->hasParam("panel")) {
+            request->send(400, "text/plain", "Missing panel param");
             return;
         }
-        
-        if(!request->hasParam("val")){
-            releaseLEDManager();
-            request->send(400, "text/plain", "Missing val param");
+        String panel = request->getParam("panel")->value();
+        panel.toLowerCase();
+        if (!panel.startsWith("panel")) {
+            request->send(400, "text/plain", "Invalid panel identifier");
             return;
         }
-        int fadeVal = request->getParam("val")->value().toInt();
-        if(fadeVal<0) fadeVal=0;
-        if(fadeVal>255) fadeVal=255;
-        ledManager.setFadeAmount((uint8_t)fadeVal);
-        String msg = "Fade amount set to " + String(fadeVal);
-        
-        releaseLEDManager();
-        request->send(200, "text/plain", msg);
-        Serial.println(msg);
+        handleParamRequest(request, "rotation" + panel.substring(5), false);
     });
 
-    // 10) getFadeAmount
-    _server.on("/api/getFadeAmount", HTTP_GET, [](AsyncWebServerRequest *request){
+    // 15) swapPanels
+    _server.on("/api/swapPanels", HTTP_POST, gated(REQ_CONTROL, [](AsyncWebServerRequest *request){
+        if (!requireApiToken(request)) {
+            return;
+        }
         if (!acquireLEDManager(500)) {
             request->send(503, "text/plain", "Server busy, try again later");
             return;
         }
         
-        uint8_t f = ledManager.getFadeAmount();
+        ledManager.swapPanels();
         
         releaseLEDManager();
-        request->send(200, "text/plain", String(f));
-    });
+        request->send(200, "text/plain", "Panels swapped successfully.");
+    }));
+
+    /****************************************************
+     * Animation-specific settings
+     ****************************************************/
+    // Life-like rules list
+    _server.on("/api/listLifeRules", HTTP_GET, gated(REQ_READ, [](AsyncWebServerRequest *request){
+        size_t count = ledManager.getLifeRuleCount();
+        AsyncResponseStream* response = request->beginResponseStream("application/json", 256);
+        JsonWriter json(*response);
+        json.beginObject();
+        json.key("rules");
+        json.beginArray();
+        for (size_t i = 0; i < count; i++) {
+            json.value(ledManager.getLifeRuleName(i));
+        }
+        json.endArray();
+        json.member("current", ledManager.getLifeRuleIndex());
+        json.endObject();
+        json.flush();
+        request->send(response);
+    }));
 
-    // 11) setSpawnRate => param "val" (0..1 float)
-    _server.on("/api/setSpawnRate", HTTP_POST, [](AsyncWebServerRequest *request){
+    _server.on("/api/lifeReseed", HTTP_POST, gated(REQ_CONTROL, [](AsyncWebServerRequest *request){
         if (!requireApiToken(request)) {
             return;
         }
-        if (!acquireLEDManager(500)) {
-            request->send(503, "text/plain", "Server busy, try again later");
+        ledManager.lifeReseed();
+        request->send(200, "text/plain", "Life reseeded");
+    }));
+
+    /****************************************************
+     * Zones
+     ****************************************************/
+    _server.on("/api/zones", HTTP_GET, gated(REQ_READ, [](AsyncWebServerRequest *request){
+        AsyncResponseStream* response = request->beginResponseStream("application/json", 512);
+        JsonWriter json(*response);
+        json.beginArray();
+        for (uint8_t i = 0; i < ZoneSet::MAX_ZONES; i++) {
+            ZoneConfig zone = ledManager.getZone(i);
+            json.beginObject();
+            json.member("slot", (unsigned)i);
+            json.member("animation", (int)zone.animation);
+            json.member("x", (int)zone.x);
+            json.member("y", (int)zone.y);
+            json.member("w", (int)zone.w);
+            json.member("h", (int)zone.h);
+            json.member("palette", (int)zone.palette);
+            json.member("interval", (unsigned)zone.intervalMs);
+            json.member("speed", (int)zone.speed);
+            json.key("spawn");
+            json.value(zone.spawnRate < 0 ? -1.0f : zone.spawnRate, 2);
+            json.member("fade", (int)zone.fade);
+            json.member("message", zone.message);
+            json.endObject();
+        }
+        json.endArray();
+        json.flush();
+        request->send(response);
+    }));
+
+    // slot and animation are required (animation -1 removes the zone);
+    // x,y,w,h, palette (-1 = global) and interval (ms) describe it. speed
+    // (3-1500 ms), spawn (0-1), fade (0-255) and message (Text) override
+    // the global settings for this zone; left out or -1 they follow them.
+    _server.on("/api/setZone", HTTP_POST, gated(REQ_CONTROL, [](AsyncWebServerRequest *request){
+        if (!requireApiToken(request)) {
             return;
         }
-        
-        if(!request->hasParam("val")){
-            releaseLEDManager();
-            request->send(400, "text/plain","Missing val param");
+        if (!request->hasParam("slot") || !request->hasParam("animation")) {
+            request->send(400, "text/plain", "Missing 'slot' or 'animation' param");
             return;
         }
-        float rate = request->getParam("val")->value().toFloat();
-        if(rate<0.0f || rate>1.0f){
-            releaseLEDManager();
-            request->send(400, "text/plain","Spawn rate must be 0..1");
+        auto getInt = [&](const char* k, int fallback) -> int {
+            return request->hasParam(k) ? request->getParam(k)->value().toInt() : fallback;
+        };
+        int slot = getInt("slot", -1);
+        int animation = getInt("animation", -1);
+        if (slot < 0 || slot >= ZoneSet::MAX_ZONES || animation >= (int)ledManager.getAnimationCount()) {
+            request->send(400, "text/plain", "Invalid zone slot or animation");
+            return;
+        }
+        ZoneConfig config;
+        config.x = (int16_t)constrain(getInt("x", 0), 0, PanelLayout::MAX_PANELS * PanelLayout::PANEL_SIZE);
+        config.y = (int16_t)constrain(getInt("y", 0), 0, PanelLayout::PANEL_SIZE);
+        config.w = (int16_t)constrain(getInt("w", 16), 0, PanelLayout::MAX_PANELS * PanelLayout::PANEL_SIZE);
+        config.h = (int16_t)constrain(getInt("h", PanelLayout::PANEL_SIZE), 0, PanelLayout::PANEL_SIZE);
+        config.animation = (int8_t)(animation < 0 ? -1 : animation);
+        config.palette = (int8_t)constrain(getInt("palette", -1), -1, 127);
+        config.intervalMs = (uint16_t)constrain(getInt("interval", 0), 0, 60000);
+        int speed = getInt("speed", -1);
+        config.speed = (int16_t)(speed >= 3 && speed <= 1500 ? speed : -1);
+        int fade = getInt("fade", -1);
+        config.fade = (int16_t)(fade >= 0 && fade <= 255 ? fade : -1);
+        float spawn = request->hasParam("spawn") ? request->getParam("spawn")->value().toFloat() : -1.0f;
+        config.spawnRate = spawn >= 0 && spawn <= 1 ? spawn : -1.0f;
+        if (request->hasParam("message")) {
+            config.message = request->getParam("message")->value();
+        }
+        if (config.animation >= 0 && (config.w == 0 || config.h == 0)) {
+            request->send(400, "text/plain", "Zone needs a non-empty w and h");
             return;
         }
-        ledManager.setSpawnRate(rate);
-        String msg = "Spawn rate set to " + String(rate,2);
-        
-        releaseLEDManager();
-        request->send(200, "text/plain", msg);
-        Serial.println(msg);
-    });
 
-    // 12) getSpawnRate
-    _server.on("/api/getSpawnRate", HTTP_GET, [](AsyncWebServerRequest *request){
         if (!acquireLEDManager(500)) {
             request->send(503, "text/plain", "Server busy, try again later");
             return;
         }
-        
-        float r = ledManager.getSpawnRate();
-        
+        bool ok = ledManager.setZone((uint8_t)slot, config);
+        std::vector<ZoneConfig> zones;
+        for (uint8_t i = 0; i < ZoneSet::MAX_ZONES; i++) {
+            zones.push_back(ledManager.getZone(i));
+        }
         releaseLEDManager();
-        request->send(200, "text/plain", String(r,2));
-    });
+        if (!ok) {
+            request->send(500, "text/plain", "Could not create zone animation");
+            return;
+        }
+
+        WorkQueue::Ticket ticket = WorkQueue::getInstance().submit("zones", [zones]() {
+            return writeZoneConfig(zones);
+        });
+        sendJobResult(request, ticket, "Zone " + String(slot) + " saved",
+                      "Zone " + String(slot) + " applied, saving", "Zone applied but /zones.cfg could not be written");
+    }));
 
-    // 13) setMaxFlakes => param "val" (10..500)
-    _server.on("/api/setMaxFlakes", HTTP_POST, [](AsyncWebServerRequest *request){
+    /****************************************************
+     * Output calibration
+     ****************************************************/
+    _server.on("/api/calibration", HTTP_GET, gated(REQ_READ, [](AsyncWebServerRequest *request){
+        AsyncResponseStream* response = request->beginResponseStream("application/json", 512);
+        JsonWriter json(*response);
+        json.beginArray();
+        for (uint8_t i = 0; i < OutputStage::MAX_PANELS; i++) {
+            PanelCalibration calibration = ledManager.getPanelCalibration(i);
+            json.beginObject();
+            json.member("panel", (unsigned)i);
+            json.member("r", (unsigned)calibration.r);
+            json.member("g", (unsigned)calibration.g);
+            json.member("b", (unsigned)calibration.b);
+            json.endObject();
+        }
+        json.endArray();
+        json.flush();
+        request->send(response);
+    }));
+
+    // panel (along the strip) and r, g, b gains 0-255; missing channels
+    // keep their current value
+    _server.on("/api/setCalibration", HTTP_POST, gated(REQ_CONTROL, [](AsyncWebServerRequest *request){
         if (!requireApiToken(request)) {
             return;
         }
-        if (!acquireLEDManager(500)) {
-            request->send(503, "text/plain", "Server busy, try again later");
+        if (!request->hasParam("panel")) {
+            request->send(400, "text/plain", "Missing 'panel' param");
             return;
         }
-        
-        if(!request->hasParam("val")){
-            releaseLEDManager();
-            request->send(400, "text/plain","Missing val param");
+        int panel = request->getParam("panel")->value().toInt();
+        if (panel < 0 || panel >= OutputStage::MAX_PANELS) {
+            request->send(400, "text/plain", "Invalid panel");
             return;
         }
-        int maxF = request->getParam("val")->value().toInt();
-        if(maxF<10 || maxF>500){
-            releaseLEDManager();
-            request->send(400, "text/plain","Max flakes must be 10..500");
+
+        if (!acquireLEDManager(500)) {
+            request->send(503, "text/plain", "Server busy, try again later");
             return;
         }
-        ledManager.setMaxFlakes(maxF);
-        String msg = "Max flakes set to " + String(maxF);
-        
+        PanelCalibration calibration = ledManager.getPanelCalibration((uint8_t)panel);
+        auto getGain = [&](const char* k, uint8_t fallback) -> uint8_t {
+            return request->hasParam(k) ? (uint8_t)constrain(request->getParam(k)->value().toInt(), 0, 255) : fallback;
+        };
+        calibration.r = getGain("r", calibration.r);
+        calibration.g = getGain("g", calibration.g);
+        calibration.b = getGain("b", calibration.b);
+        ledManager.setPanelCalibration((uint8_t)panel, calibration);
+        std::vector<PanelCalibration> all;
+        for (uint8_t i = 0; i < OutputStage::MAX_PANELS; i++) {
+            all.push_back(ledManager.getPanelCalibration(i));
+        }
         releaseLEDManager();
-        request->send(200, "text/plain", msg);
-        Serial.println(msg);
-    });
-
-    // 14) getMaxFlakes
-    _server.on("/api/getMaxFlakes", HTTP_GET, [](AsyncWebServerRequest *request){
-        if (!acquireLEDManager(500)) {
-            request->send(503, "text/plain", "Server busy, try again later");
-            return;
-        }
-        
-        int mf = ledManager.getMaxFlakes();
-        
-        releaseLEDManager();
-        request->send(200, "text/plain", String(mf));
-    });
-
-    // 15) swapPanels
-    _server.on("/api/swapPanels", HTTP_POST, [](AsyncWebServerRequest *request){
-        if (!requireApiToken(request)) {
-            return;
-        }
-        if (!acquireLEDManager(500)) {
-            request->send(503, "text/plain", "Server busy, try again later");
-            return;
-        }
-        
-        ledManager.swapPanels();
-        
-        releaseLEDManager();
-        request->send(200, "text/plain", "Panels swapped successfully.");
-    });
-
-    // 16) setPanelOrder => param "val" (left|right)
-    _server.on("/api/setPanelOrder", HTTP_POST, [](AsyncWebServerRequest *request){
-        if (!requireApiToken(request)) {
-            return;
-        }
-        if (!acquireLEDManager(500)) {
-            request->send(503, "text/plain", "Server busy, try again later");
-            return;
-        }
-        
-        if(!request->hasParam("val")){
-            releaseLEDManager();
-            request->send(400, "text/plain","Missing val param");
-            return;
-        }
-        String order = request->getParam("val")->value();
-        if(order.equalsIgnoreCase("left") || order.equalsIgnoreCase("right")){
-            ledManager.setPanelOrder(order);
-            String msg = "Panel order set to " + order;
-            
-            releaseLEDManager();
-            request->send(200, "text/plain", msg);
-            Serial.println(msg);
-        } else {
-            releaseLEDManager();
-            request->send(400,"text/plain","Invalid panel order (left or right).");
-        }
-    });
-
-    // 16.5) getPanelOrder
-    _server.on("/api/getPanelOrder", HTTP_GET, [](AsyncWebServerRequest *request){
-        if (!acquireLEDManager(500)) {
-            request->send(503, "text/plain", "Server busy, try again later");
-            return;
-        }
-        int order = ledManager.getPanelOrder();
-        String label = (order == 0) ? "left" : "right";
-        releaseLEDManager();
-        request->send(200, "text/plain", label);
-    });
 
-    // 17) rotatePanel1 => param "val" in {0,90,180,270}
-    _server.on("/api/rotatePanel1", HTTP_POST, [](AsyncWebServerRequest *request){
-        if (!requireApiToken(request)) {
-            return;
-        }
-        if (!acquireLEDManager(500)) {
-            request->send(503, "text/plain", "Server busy, try again later");
-            return;
-        }
-        
-        if(!request->hasParam("val")){
-            releaseLEDManager();
-            request->send(400,"text/plain","Missing val param");
-            return;
-        }
-        int angle = request->getParam("val")->value().toInt();
-        if(angle==0||angle==90||angle==180||angle==270){
-            ledManager.rotatePanel("PANEL1", angle);
-            String msg="Rotation angle for PANEL1 set to "+String(angle);
-            
-            releaseLEDManager();
-            request->send(200,"text/plain", msg);
-            Serial.println(msg);
-        } else {
-            releaseLEDManager();
-            request->send(400,"text/plain","Valid angles: 0,90,180,270");
-        }
-    });
+        WorkQueue::Ticket ticket = WorkQueue::getInstance().submit("calibration", [all]() {
+            return writeCalibrationConfig(all);
+        });
+        sendJobResult(request, ticket, "Panel " + String(panel) + " calibration saved",
+                      "Panel " + String(panel) + " calibration applied, saving",
+                      "Calibration applied but /calibration.cfg could not be written");
+    }));
 
-    // 18) rotatePanel2 => param "val" in {0,90,180,270}
-    _server.on("/api/rotatePanel2", HTTP_POST, [](AsyncWebServerRequest *request){
-        if (!requireApiToken(request)) {
-            return;
-        }
-        if (!acquireLEDManager(500)) {
-            request->send(503, "text/plain", "Server busy, try again later");
-            return;
-        }
-        
-        if(!request->hasParam("val")){
-            releaseLEDManager();
-            request->send(400,"text/plain","Missing val param");
-            return;
-        }
-        int angle=request->getParam("val")->value().toInt();
-        if(angle==0||angle==90||angle==180||angle==270){
-            ledManager.rotatePanel("PANEL2", angle);
-            String msg="Rotation angle for PANEL2 set to "+String(angle);
-            
-            releaseLEDManager();
-            request->send(200,"text/plain", msg);
-            Serial.println(msg);
-        } else {
-            releaseLEDManager();
-            request->send(400,"text/plain","Valid angles: 0,90,180,270");
-        }
-    });
-
-    // 18.5) rotatePanel3 => param "val" in {0,90,180,270}
-    _server.on("/api/rotatePanel3", HTTP_POST, [](AsyncWebServerRequest *request){
+    /****************************************************
+     * Overlay layers
+     ****************************************************/
+    _server.on("/api/layers", HTTP_GET, gated(REQ_READ, [](AsyncWebServerRequest *request){
+        AsyncResponseStream* response = request->beginResponseStream("application/json", 512);
+        JsonWriter json(*response);
+        json.beginArray();
+        for (uint8_t i = 0; i < LayerStack::MAX_LAYERS; i++) {
+            LayerStack::LayerInfo info = ledManager.getLayerInfo(i);
+            json.beginObject();
+            json.member("slot", (unsigned)i);
+            json.member("animation", info.source);
+            json.member("opacity", (unsigned)info.opacity);
+            json.member("blend", (unsigned)info.blend);
+            json.member("mask", (unsigned)info.mask);
+            json.member("x", (int)info.x);
+            json.member("y", (int)info.y);
+            json.member("w", (int)info.w);
+            json.member("h", (int)info.h);
+            json.endObject();
+        }
+        json.endArray();
+        json.flush();
+        request->send(response);
+    }));
+
+    // slot is required; animation (-1 clears), opacity, blend and
+    // mask (with x,y,w,h for a rectangle) are applied when present
+    _server.on("/api/setLayer", HTTP_POST, gated(REQ_CONTROL, [](AsyncWebServerRequest *request){
         if (!requireApiToken(request)) {
             return;
         }
-        if (!acquireLEDManager(500)) {
-            request->send(503, "text/plain", "Server busy, try again later");
+        if (!request->hasParam("slot")) {
+            request->send(400, "text/plain", "Missing 'slot' param");
             return;
         }
-        
-        if(!request->hasParam("val")){
-            releaseLEDManager();
-            request->send(400,"text/plain","Missing val param");
+        int slot = request->getParam("slot")->value().toInt();
+        if (slot < 0 || slot >= LayerStack::MAX_LAYERS) {
+            request->send(400, "text/plain", "Invalid layer slot");
             return;
         }
-        int angle=request->getParam("val")->value().toInt();
-        if(angle==0||angle==90||angle==180||angle==270){
-            ledManager.rotatePanel("PANEL3", angle);
-            String msg="Rotation angle for PANEL3 set to "+String(angle);
-            
-            releaseLEDManager();
-            request->send(200,"text/plain", msg);
-            Serial.println(msg);
-        } else {
-            releaseLEDManager();
-            request->send(400,"text/plain","Valid angles: 0,90,180,270");
-        }
-    });
-
-    // 18.8) getRotation => param "panel" (PANEL1/PANEL2/PANEL3)
-    _server.on("/api/getRotation", HTTP_GET, [](AsyncWebServerRequest *request){
+        auto getInt = [&](const char* k, int fallback) -> int {
+            return request->hasParam(k) ? request->getParam(k)->value().toInt() : fallback;
+        };
         if (!acquireLEDManager(500)) {
             request->send(503, "text/plain", "Server busy, try again later");
             return;
         }
-        if (!request->hasParam("panel")) {
-            releaseLEDManager();
-            request->send(400, "text/plain", "Missing panel param");
-            return;
+        bool ok = true;
+        if (request->hasParam("animation")) {
+            ok = ledManager.setLayer((uint8_t)slot, getInt("animation", -1));
         }
-        String panel = request->getParam("panel")->value();
-        int angle = ledManager.getRotation(panel);
-        if (angle < 0) {
-            releaseLEDManager();
-            request->send(400, "text/plain", "Invalid panel identifier");
-            return;
+        if (ok && request->hasParam("opacity")) {
+            ledManager.setLayerOpacity((uint8_t)slot, (uint8_t)constrain(getInt("opacity", 255), 0, 255));
         }
-        releaseLEDManager();
-        request->send(200, "text/plain", String(angle));
-    });
-
-    // 19) setSpeed => param "val" in milliseconds
-    _server.on("/api/setSpeed", HTTP_POST, [](AsyncWebServerRequest *request){
-        if (!requireApiToken(request)) {
-            return;
-        }
-        if (!acquireLEDManager(500)) {
-            request->send(503, "text/plain", "Server busy, try again later");
-            return;
+        if (ok && request->hasParam("blend")) {
+            ledManager.setLayerBlend((uint8_t)slot, (uint8_t)constrain(getInt("blend", 0), 0, 255));
         }
-        
-        if(!request->hasParam("val")){
-            releaseLEDManager();
-            request->send(400,"text/plain","Missing val param");
-            return;
+        if (ok && request->hasParam("mask")) {
+            ledManager.setLayerMask((uint8_t)slot, (uint8_t)constrain(getInt("mask", 0), 0, 255),
+                                    getInt("x", 0), getInt("y", 0), getInt("w", 0), getInt("h", 0));
         }
-        int speed = request->getParam("val")->value().toInt();
-        if(speed < 3) speed = 3;  // Minimum 3ms
-        if(speed > 1500) speed = 1500; // Max 1.5 seconds
-        
-        ledManager.setUpdateSpeed(speed);
-        String msg = "Speed set to " + String(speed) + "ms";
-        
         releaseLEDManager();
-        request->send(200,"text/plain", msg);
-        Serial.println(msg);
-    });
-
-    // 20) getSpeed => returns current speed in ms
-    _server.on("/api/getSpeed", HTTP_GET, [](AsyncWebServerRequest *request){
-        if (!acquireLEDManager(500)) {
-            request->send(503, "text/plain", "Server busy, try again later");
+        if (!ok) {
+            request->send(400, "text/plain", "Could not set layer animation");
             return;
         }
-        
-        unsigned long speed = ledManager.getUpdateSpeed();
-        
-        releaseLEDManager();
-        request->send(200,"text/plain", String(speed));
-    });
-
-    /****************************************************
-     * Animation-specific settings
-     ****************************************************/
-    // Life-like rules list
-    _server.on("/api/listLifeRules", HTTP_GET, [](AsyncWebServerRequest *request){
-        String json = "{\"rules\":[";
-        size_t count = ledManager.getLifeRuleCount();
-        for (size_t i = 0; i < count; i++) {
-            json += "\"" + ledManager.getLifeRuleName(i) + "\"";
-            if (i + 1 < count) json += ",";
-        }
-        json += "],\"current\":" + String(ledManager.getLifeRuleIndex()) + "}";
-        request->send(200, "application/json", json);
-    });
-
-    _server.on("/api/setLifeRule", HTTP_POST, [](AsyncWebServerRequest *request){
-        if (!requireApiToken(request)) {
-            return;
-        }
-        if (!request->hasParam("val")) {
-            request->send(400, "text/plain", "Missing val param");
-            return;
-        }
-        int idx = request->getParam("val")->value().toInt();
-        ledManager.setLifeRuleIndex(idx);
-        request->send(200, "text/plain", "Life rule updated");
-    });
-
-    _server.on("/api/getLifeRule", HTTP_GET, [](AsyncWebServerRequest *request){
-        request->send(200, "text/plain", String(ledManager.getLifeRuleIndex()));
-    });
-
-    _server.on("/api/setLifeDensity", HTTP_POST, [](AsyncWebServerRequest *request){
-        if (!requireApiToken(request)) {
-            return;
-        }
-        if (!request->hasParam("val")) {
-            request->send(400, "text/plain", "Missing val param");
-            return;
-        }
-        int density = request->getParam("val")->value().toInt();
-        if (density < 0) density = 0;
-        if (density > 100) density = 100;
-        ledManager.setLifeSeedDensity((uint8_t)density);
-        request->send(200, "text/plain", "Life seed density updated");
-    });
-
-    _server.on("/api/getLifeDensity", HTTP_GET, [](AsyncWebServerRequest *request){
-        request->send(200, "text/plain", String(ledManager.getLifeSeedDensity()));
-    });
-
-    _server.on("/api/setLifeWrap", HTTP_POST, [](AsyncWebServerRequest *request){
-        if (!requireApiToken(request)) {
-            return;
-        }
-        if (!request->hasParam("val")) {
-            request->send(400, "text/plain", "Missing val param");
-            return;
-        }
-        String val = request->getParam("val")->value();
-        bool wrap = val.equalsIgnoreCase("1") || val.equalsIgnoreCase("true") || val.equalsIgnoreCase("on");
-        ledManager.setLifeWrap(wrap);
-        request->send(200, "text/plain", "Life wrap mode updated");
-    });
-
-    _server.on("/api/getLifeWrap", HTTP_GET, [](AsyncWebServerRequest *request){
-        request->send(200, "text/plain", ledManager.getLifeWrap() ? "1" : "0");
-    });
-
-    _server.on("/api/setLifeStagnation", HTTP_POST, [](AsyncWebServerRequest *request){
-        if (!requireApiToken(request)) {
-            return;
-        }
-        if (!request->hasParam("val")) {
-            request->send(400, "text/plain", "Missing val param");
-            return;
-        }
-        int limit = request->getParam("val")->value().toInt();
-        ledManager.setLifeStagnationLimit((uint16_t)limit);
-        request->send(200, "text/plain", "Life stagnation limit updated");
-    });
-
-    _server.on("/api/getLifeStagnation", HTTP_GET, [](AsyncWebServerRequest *request){
-        request->send(200, "text/plain", String(ledManager.getLifeStagnationLimit()));
-    });
-
-    _server.on("/api/setLifeColorMode", HTTP_POST, [](AsyncWebServerRequest *request){
-        if (!requireApiToken(request)) {
-            return;
-        }
-        if (!request->hasParam("val")) {
-            request->send(400, "text/plain", "Missing val param");
-            return;
-        }
-        int mode = request->getParam("val")->value().toInt();
-        ledManager.setLifeColorMode((uint8_t)mode);
-        request->send(200, "text/plain", "Life color mode updated");
-    });
-
-    _server.on("/api/getLifeColorMode", HTTP_GET, [](AsyncWebServerRequest *request){
-        request->send(200, "text/plain", String(ledManager.getLifeColorMode()));
-    });
-
-    _server.on("/api/lifeReseed", HTTP_POST, [](AsyncWebServerRequest *request){
-        if (!requireApiToken(request)) {
-            return;
-        }
-        ledManager.lifeReseed();
-        request->send(200, "text/plain", "Life reseeded");
-    });
-
-    // Langton's Ant settings
-    _server.on("/api/setAntRule", HTTP_POST, [](AsyncWebServerRequest *request){
-        if (!requireApiToken(request)) {
-            return;
-        }
-        if (!request->hasParam("val")) {
-            request->send(400, "text/plain", "Missing val param");
-            return;
-        }
-        ledManager.setAntRule(request->getParam("val")->value());
-        request->send(200, "text/plain", "Ant rule updated");
-    });
-
-    _server.on("/api/getAntRule", HTTP_GET, [](AsyncWebServerRequest *request){
-        request->send(200, "text/plain", ledManager.getAntRule());
-    });
-
-    _server.on("/api/setAntCount", HTTP_POST, [](AsyncWebServerRequest *request){
-        if (!requireApiToken(request)) {
-            return;
-        }
-        if (!request->hasParam("val")) {
-            request->send(400, "text/plain", "Missing val param");
-            return;
-        }
-        int count = request->getParam("val")->value().toInt();
-        ledManager.setAntCount((uint8_t)count);
-        request->send(200, "text/plain", "Ant count updated");
-    });
-
-    _server.on("/api/getAntCount", HTTP_GET, [](AsyncWebServerRequest *request){
-        request->send(200, "text/plain", String(ledManager.getAntCount()));
-    });
-
-    _server.on("/api/setAntSteps", HTTP_POST, [](AsyncWebServerRequest *request){
-        if (!requireApiToken(request)) {
-            return;
-        }
-        if (!request->hasParam("val")) {
-            request->send(400, "text/plain", "Missing val param");
-            return;
-        }
-        int steps = request->getParam("val")->value().toInt();
-        ledManager.setAntSteps((uint8_t)steps);
-        request->send(200, "text/plain", "Ant steps updated");
-    });
-
-    _server.on("/api/getAntSteps", HTTP_GET, [](AsyncWebServerRequest *request){
-        request->send(200, "text/plain", String(ledManager.getAntSteps()));
-    });
-
-    _server.on("/api/setAntWrap", HTTP_POST, [](AsyncWebServerRequest *request){
-        if (!requireApiToken(request)) {
-            return;
-        }
-        if (!request->hasParam("val")) {
-            request->send(400, "text/plain", "Missing val param");
-            return;
-        }
-        String val = request->getParam("val")->value();
-        bool wrap = val.equalsIgnoreCase("1") || val.equalsIgnoreCase("true") || val.equalsIgnoreCase("on");
-        ledManager.setAntWrap(wrap);
-        request->send(200, "text/plain", "Ant wrap mode updated");
-    });
-
-    _server.on("/api/getAntWrap", HTTP_GET, [](AsyncWebServerRequest *request){
-        request->send(200, "text/plain", ledManager.getAntWrap() ? "1" : "0");
-    });
-
-    // Sierpinski carpet settings
-    _server.on("/api/setCarpetDepth", HTTP_POST, [](AsyncWebServerRequest *request){
-        if (!requireApiToken(request)) {
-            return;
-        }
-        if (!request->hasParam("val")) {
-            request->send(400, "text/plain", "Missing val param");
-            return;
-        }
-        int depth = request->getParam("val")->value().toInt();
-        ledManager.setCarpetDepth((uint8_t)depth);
-        request->send(200, "text/plain", "Carpet depth updated");
-    });
-
-    _server.on("/api/getCarpetDepth", HTTP_GET, [](AsyncWebServerRequest *request){
-        request->send(200, "text/plain", String(ledManager.getCarpetDepth()));
-    });
-
-    _server.on("/api/setCarpetInvert", HTTP_POST, [](AsyncWebServerRequest *request){
-        if (!requireApiToken(request)) {
-            return;
-        }
-        if (!request->hasParam("val")) {
-            request->send(400, "text/plain", "Missing val param");
-            return;
-        }
-        String val = request->getParam("val")->value();
-        bool invert = val.equalsIgnoreCase("1") || val.equalsIgnoreCase("true") || val.equalsIgnoreCase("on");
-        ledManager.setCarpetInvert(invert);
-        request->send(200, "text/plain", "Carpet invert updated");
-    });
-
-    _server.on("/api/getCarpetInvert", HTTP_GET, [](AsyncWebServerRequest *request){
-        request->send(200, "text/plain", ledManager.getCarpetInvert() ? "1" : "0");
-    });
-
-    _server.on("/api/setCarpetShift", HTTP_POST, [](AsyncWebServerRequest *request){
-        if (!requireApiToken(request)) {
-            return;
-        }
-        if (!request->hasParam("val")) {
-            request->send(400, "text/plain", "Missing val param");
-            return;
-        }
-        int shift = request->getParam("val")->value().toInt();
-        ledManager.setCarpetColorShift((uint8_t)shift);
-        request->send(200, "text/plain", "Carpet color shift updated");
-    });
-
-    _server.on("/api/getCarpetShift", HTTP_GET, [](AsyncWebServerRequest *request){
-        request->send(200, "text/plain", String(ledManager.getCarpetColorShift()));
-    });
-
-    // Firework settings
-    _server.on("/api/setFireworkMax", HTTP_POST, [](AsyncWebServerRequest *request){
-        if (!requireApiToken(request)) {
-            return;
-        }
-        if (!request->hasParam("val")) {
-            request->send(400, "text/plain", "Missing val param");
-            return;
-        }
-        int maxFw = request->getParam("val")->value().toInt();
-        ledManager.setFireworkMax(maxFw);
-        request->send(200, "text/plain", "Firework max updated");
-    });
-
-    _server.on("/api/getFireworkMax", HTTP_GET, [](AsyncWebServerRequest *request){
-        request->send(200, "text/plain", String(ledManager.getFireworkMax()));
-    });
-
-    _server.on("/api/setFireworkParticles", HTTP_POST, [](AsyncWebServerRequest *request){
-        if (!requireApiToken(request)) {
-            return;
-        }
-        if (!request->hasParam("val")) {
-            request->send(400, "text/plain", "Missing val param");
-            return;
-        }
-        int count = request->getParam("val")->value().toInt();
-        ledManager.setFireworkParticles(count);
-        request->send(200, "text/plain", "Firework particles updated");
-    });
-
-    _server.on("/api/getFireworkParticles", HTTP_GET, [](AsyncWebServerRequest *request){
-        request->send(200, "text/plain", String(ledManager.getFireworkParticles()));
-    });
-
-    _server.on("/api/setFireworkGravity", HTTP_POST, [](AsyncWebServerRequest *request){
-        if (!requireApiToken(request)) {
-            return;
-        }
-        if (!request->hasParam("val")) {
-            request->send(400, "text/plain", "Missing val param");
-            return;
-        }
-        float gravity = request->getParam("val")->value().toFloat();
-        ledManager.setFireworkGravity(gravity);
-        request->send(200, "text/plain", "Firework gravity updated");
-    });
-
-    _server.on("/api/getFireworkGravity", HTTP_GET, [](AsyncWebServerRequest *request){
-        request->send(200, "text/plain", String(ledManager.getFireworkGravity(), 3));
-    });
-
-    _server.on("/api/setFireworkLaunch", HTTP_POST, [](AsyncWebServerRequest *request){
-        if (!requireApiToken(request)) {
-            return;
-        }
-        if (!request->hasParam("val")) {
-            request->send(400, "text/plain", "Missing val param");
-            return;
-        }
-        float probability = request->getParam("val")->value().toFloat();
-        ledManager.setFireworkLaunchProbability(probability);
-        request->send(200, "text/plain", "Firework launch probability updated");
-    });
-
-    _server.on("/api/getFireworkLaunch", HTTP_GET, [](AsyncWebServerRequest *request){
-        request->send(200, "text/plain", String(ledManager.getFireworkLaunchProbability(), 2));
-    });
-
-    // Rainbow wave settings
-    _server.on("/api/setRainbowHueScale", HTTP_POST, [](AsyncWebServerRequest *request){
-        if (!requireApiToken(request)) {
-            return;
-        }
-        if (!request->hasParam("val")) {
-            request->send(400, "text/plain", "Missing val param");
-            return;
-        }
-        int scale = request->getParam("val")->value().toInt();
-        ledManager.setRainbowHueScale((uint8_t)scale);
-        request->send(200, "text/plain", "Rainbow hue scale updated");
-    });
-
-    _server.on("/api/getRainbowHueScale", HTTP_GET, [](AsyncWebServerRequest *request){
-        request->send(200, "text/plain", String(ledManager.getRainbowHueScale()));
-    });
+        request->send(200, "text/plain", "Layer " + String(slot) + " updated");
+    }));
 
     /****************************************************
      * Status endpoint (used by status.html)
      ****************************************************/
-    _server.on("/api/status", HTTP_GET, [](AsyncWebServerRequest *request){
+    _server.on("/api/status", HTTP_GET, gated(REQ_READ, [](AsyncWebServerRequest *request){
         bool connected = WiFi.status() == WL_CONNECTED;
         String ssid = connected ? WiFi.SSID() : String("");
         int rssi = connected ? WiFi.RSSI() : 0;
@@ -1147,24 +1259,105 @@ void WebServerManager::begin() {
         unsigned long hours = (uptimeSeconds % 86400) / 3600;
         unsigned long minutes = (uptimeSeconds % 3600) / 60;
         unsigned long seconds = uptimeSeconds % 60;
-        String uptimeStr = String(days) + "d " + String(hours) + "h " + String(minutes) + "m " + String(seconds) + "s";
-
-        String json = "{";
-        json += "\"wifi\":{\"connected\":" + String(connected ? "true" : "false");
-        json += ",\"ssid\":\"" + ssid + "\",\"rssi\":" + String(rssi) + "},";
-        json += "\"network\":{\"ip\":\"" + ip.toString() + "\",\"subnet\":\"" + subnet.toString() + "\",\"gateway\":\"" + gateway.toString() + "\"},";
-        json += "\"system\":{\"uptime\":\"" + uptimeStr + "\",\"freeMemory\":" + String(ESP.getFreeHeap());
-        json += ",\"version\":\"" + String(ESP.getSdkVersion()) + "\",\"buildDate\":\"" + String(__DATE__) + " " + String(__TIME__) + "\"}";
-        json += "}";
-
-        request->send(200, "application/json", json);
-    });
+        char uptimeStr[32];
+        snprintf(uptimeStr, sizeof(uptimeStr), "%lud %luh %lum %lus", days, hours, minutes, seconds);
+
+        AsyncResponseStream* response = request->beginResponseStream("application/json", 1536);
+        JsonWriter json(*response);
+        json.beginObject();
+        json.key("wifi");
+        json.beginObject();
+        json.member("connected", connected);
+        json.member("ssid", ssid);
+        json.member("rssi", rssi);
+        json.endObject();
+        json.key("network");
+        json.beginObject();
+        json.member("ip", ip.toString());
+        json.member("subnet", subnet.toString());
+        json.member("gateway", gateway.toString());
+        json.endObject();
+        json.key("system");
+        json.beginObject();
+        json.member("uptime", uptimeStr);
+        json.member("freeMemory", (unsigned long)ESP.getFreeHeap());
+        json.member("version", ESP.getSdkVersion());
+        json.member("buildDate", __DATE__ " " __TIME__);
+        json.endObject();
+        AnimationCache::Stats cache = ledManager.getAnimationCacheStats();
+        json.key("animationCache");
+        json.beginObject();
+        json.member("hits", (unsigned long)cache.hits);
+        json.member("misses", (unsigned long)cache.misses);
+        json.member("evictions", (unsigned long)cache.evictions);
+        json.member("entries", (unsigned)cache.entries);
+        json.member("bytes", (unsigned long)cache.bytes);
+        json.member("budget", (unsigned long)cache.budget);
+        json.endObject();
+        OutputStage::PowerStats power = ledManager.getPowerStats();
+        json.key("power");
+        json.beginObject();
+        json.member("budgetMa", (unsigned)power.budgetMa);
+        json.member("railPanels", (unsigned)power.railPanels);
+        json.member("estimatedMa", (unsigned long)power.totalMa);
+        json.member("limiterActivations", (unsigned long)power.activations);
+        json.key("rails");
+        json.beginArray();
+        for (uint8_t i = 0; i < power.rails; i++) {
+            const OutputStage::RailStats& rail = power.rail[i];
+            json.beginObject();
+            json.member("estimatedMa", (unsigned long)rail.estimatedMa);
+            if (power.budgetMa) {
+                json.member("headroomMa", (long)power.budgetMa - (long)rail.estimatedMa);
+            }
+            json.member("scalePercent", (unsigned)(rail.scale * 100 / 256));
+            json.endObject();
+        }
+        json.endArray();
+        json.endObject();
+        WorkQueue& queue = WorkQueue::getInstance();
+        json.key("workQueue");
+        json.beginObject();
+        json.member("depth", (unsigned)queue.depth());
+        json.member("completed", (unsigned long)queue.completedJobs());
+        json.member("failed", (unsigned long)queue.failedJobs());
+        json.member("rejected", (unsigned long)queue.rejectedJobs());
+        json.endObject();
+        RequestScheduler& scheduler = RequestScheduler::getInstance();
+        json.key("requests");
+        json.beginObject();
+        json.member("active", (unsigned)scheduler.totalActive());
+        json.member("loadLevel", (unsigned)scheduler.loadLevel());
+        json.member("framePeriodUs", (unsigned long)scheduler.framePeriodUs());
+        json.member("baselinePeriodUs", (unsigned long)scheduler.baselinePeriodUs());
+        for (int i = 0; i < REQ_CLASS_COUNT; i++) {
+            RequestScheduler::ClassStats stats = scheduler.stats((RequestClass)i);
+            json.key(RequestScheduler::className((RequestClass)i));
+            json.beginObject();
+            json.member("active", (unsigned)stats.active);
+            json.member("peakActive", (unsigned)stats.peakActive);
+            json.member("waiting", (unsigned)stats.waiting);
+            json.member("peakWaiting", (unsigned)stats.peakWaiting);
+            json.member("admitted", (unsigned long)stats.admitted);
+            json.member("queued", (unsigned long)stats.queued);
+            json.member("rejectedBusy", (unsigned long)stats.rejectedBusy);
+            json.member("rejectedWait", (unsigned long)stats.rejectedWait);
+            json.member("rejectedRate", (unsigned long)stats.rejectedRate);
+            json.member("rejectedShed", (unsigned long)stats.rejectedShed);
+            json.endObject();
+        }
+        json.endObject();
+        json.endObject();
+        json.flush();
+
+        request->send(response);
+    }));
 
     /****************************************************
      * Network settings
      ****************************************************/
     // Set network mode: dhcp or static
-    _server.on("/api/setNetworkMode", HTTP_POST, [](AsyncWebServerRequest *request){
+    _server.on("/api/setNetworkMode", HTTP_POST, gated(REQ_CONTROL, [](AsyncWebServerRequest *request){
         if (!requireApiToken(request)) {
             return;
         }
@@ -1177,39 +1370,16 @@ void WebServerManager::begin() {
             request->send(400, "text/plain", "Invalid mode. Use dhcp or static");
             return;
         }
-        if(!ensureSpiffsMounted()){
-            request->send(500,"text/plain","SPIFFS mount failed");
-            return;
-        }
-        // Read existing IP entries to preserve them
-        String ip="192.168.2.38", gw="192.168.2.1", mask="255.255.255.0", dns="8.8.8.8";
-        if(SPIFFS.exists("/net.cfg")){
-            File fr = SPIFFS.open("/net.cfg","r");
-            while(fr && fr.available()){
-                String line = fr.readStringUntil('\n'); line.trim();
-                int eq = line.indexOf('='); if(eq>0){
-                    String k=line.substring(0,eq); String v=line.substring(eq+1); k.trim(); v.trim();
-                    if(k.equalsIgnoreCase("ip")) ip=v;
-                    else if(k.equalsIgnoreCase("gw")) gw=v;
-                    else if(k.equalsIgnoreCase("mask")) mask=v;
-                    else if(k.equalsIgnoreCase("dns")) dns=v;
-                }
-            }
-            if(fr) fr.close();
-        }
-        File f = SPIFFS.open("/net.cfg","w");
-        if(!f){ request->send(500,"text/plain","Failed to write net.cfg"); return; }
-        f.printf("mode=%s\n", mode.equalsIgnoreCase("static")?"static":"dhcp");
-        f.printf("ip=%s\n", ip.c_str());
-        f.printf("gw=%s\n", gw.c_str());
-        f.printf("mask=%s\n", mask.c_str());
-        f.printf("dns=%s\n", dns.c_str());
-        f.close();
-        request->send(200, "text/plain", "Network mode updated. Reboot to apply.");
-    });
+        String stored = mode.equalsIgnoreCase("static") ? "static" : "dhcp";
+        WorkQueue::Ticket ticket = WorkQueue::getInstance().submit("netMode", [stored]() {
+            return writeNetworkMode(stored);
+        });
+        sendJobResult(request, ticket, "Network mode updated. Reboot to apply.",
+                      "Network mode update queued. Reboot to apply.", "Failed to write net.cfg");
+    }));
 
     // Set static IP parameters
-    _server.on("/api/setStaticIP", HTTP_POST, [](AsyncWebServerRequest *request){
+    _server.on("/api/setStaticIP", HTTP_POST, gated(REQ_CONTROL, [](AsyncWebServerRequest *request){
         if (!requireApiToken(request)) {
             return;
         }
@@ -1223,23 +1393,15 @@ void WebServerManager::begin() {
             request->send(400, "text/plain", "Invalid IP format");
             return;
         }
-        if(!ensureSpiffsMounted()){
-            request->send(500,"text/plain","SPIFFS mount failed");
-            return;
-        }
-        File f = SPIFFS.open("/net.cfg","w");
-        if(!f){ request->send(500,"text/plain","Failed to write net.cfg"); return; }
-        f.println("mode=static");
-        f.printf("ip=%s\n", ip.c_str());
-        f.printf("gw=%s\n", gw.c_str());
-        f.printf("mask=%s\n", mask.c_str());
-        f.printf("dns=%s\n", dns.c_str());
-        f.close();
-        request->send(200, "text/plain", "Static IP saved. Reboot to apply.");
-    });
+        WorkQueue::Ticket ticket = WorkQueue::getInstance().submit("staticIP", [ip, gw, mask, dns]() {
+            return writeNetworkConfig("static", ip, gw, mask, dns);
+        });
+        sendJobResult(request, ticket, "Static IP saved. Reboot to apply.",
+                      "Static IP update queued. Reboot to apply.", "Failed to write net.cfg");
+    }));
 
     // Get network config
-    _server.on("/api/getNetwork", HTTP_GET, [](AsyncWebServerRequest *request){
+    _server.on("/api/getNetwork", HTTP_GET, gated(REQ_READ, [](AsyncWebServerRequest *request){
         if(!ensureSpiffsMounted()){
             request->send(500,"text/plain","SPIFFS mount failed");
             return;
@@ -1260,62 +1422,65 @@ void WebServerManager::begin() {
             }
             if(fr) fr.close();
         }
-        String json = String("{\"mode\":\"")+mode+"\",\"ip\":\""+ip+"\",\"gw\":\""+gw+"\",\"mask\":\""+mask+"\",\"dns\":\""+dns+"\"}";
-        request->send(200, "application/json", json);
-    });
+        AsyncResponseStream* response = request->beginResponseStream("application/json", 160);
+        JsonWriter json(*response);
+        json.beginObject();
+        json.member("mode", mode);
+        json.member("ip", ip);
+        json.member("gw", gw);
+        json.member("mask", mask);
+        json.member("dns", dns);
+        json.endObject();
+        json.flush();
+        request->send(response);
+    }));
 
     // 21) setPanelCount => param "val" (1..8)
-    _server.on("/api/setPanelCount", HTTP_POST, [](AsyncWebServerRequest *request){
+    _server.on("/api/setPanelCount", HTTP_POST, gated(REQ_CONTROL, [](AsyncWebServerRequest *request){
         if (!requireApiToken(request)) {
             return;
         }
-        if (!acquireLEDManager(500)) {
-            request->send(503, "text/plain", "Server busy, try again later");
-            return;
-        }
-        
         if(!request->hasParam("val")){
-            releaseLEDManager();
             request->send(400,"text/plain","Missing val param");
             return;
         }
         int count = request->getParam("val")->value().toInt();
         if(count < 1) count = 1;
         if(count > 8) count = 8;
-        
-        ledManager.setPanelCount(count);
-
-        if (ensureSpiffsMounted()) {
-            File f = SPIFFS.open("/panel.cfg", "w");
-            if (f) {
-                f.printf("count=%d\n", count);
-                f.close();
-            }
-        }
 
+        // The LED side only records the change (applied at the next frame);
+        // rewriting /panel.cfg is too slow for the network task
+        WorkQueue::Ticket ticket = WorkQueue::getInstance().submit("panelCount", [count]() {
+            ledManager.setPanelCount(count);
+            return writePanelConfig(count);
+        });
         String msg = "Panel count set to " + String(count);
-        
-        releaseLEDManager();
-        request->send(200,"text/plain", msg);
+        sendJobResult(request, ticket, msg, "Panel count change to " + String(count) + " queued",
+                      "Panel count applied but /panel.cfg could not be written");
         Serial.println(msg);
-    });
+    }));
 
     // 22) getPanelCount => returns current panel count
-    _server.on("/api/getPanelCount", HTTP_GET, [](AsyncWebServerRequest *request){
+    _server.on("/api/getPanelCount", HTTP_GET, gated(REQ_READ, [](AsyncWebServerRequest *request){
         if (!acquireLEDManager(500)) {
             request->send(503, "text/plain", "Server busy, try again later");
             return;
         }
         
         int count = ledManager.getPanelCount();
-        String json = "{\"panelCount\":" + String(count) + "}";
+        AsyncResponseStream* response = request->beginResponseStream("application/json", 32);
+        JsonWriter json(*response);
+        json.beginObject();
+        json.member("panelCount", count);
+        json.endObject();
+        json.flush();
         
         releaseLEDManager();
-        request->send(200,"application/json", json);
-    });
+        request->send(response);
+    }));
 
-    // 23) identifyPanels => flash each panel in sequence
-    _server.on("/api/identifyPanels", HTTP_POST, [](AsyncWebServerRequest *request){
+    // 23) identifyPanels => overlay number and wiring on each panel
+    _server.on("/api/identifyPanels", HTTP_POST, gated(REQ_CONTROL, [](AsyncWebServerRequest *request){
         if (!requireApiToken(request)) {
             return;
         }
@@ -1323,18 +1488,19 @@ void WebServerManager::begin() {
             request->send(503, "text/plain", "Server busy, try again later");
             return;
         }
-        
+
+        // Starts a timed overlay and returns straight away
         ledManager.identifyPanels();
-        
+
         releaseLEDManager();
         request->send(200,"text/plain", "Identifying panels...");
-    });
+    }));
 
     /****************************************************
      * System Logs API
      ****************************************************/
     // Get system logs
-    _server.on("/api/getLogs", HTTP_GET, [](AsyncWebServerRequest *request) {
+    _server.on("/api/getLogs", HTTP_GET, gated(REQ_LOGS, [](AsyncWebServerRequest *request) {
         String level = "info";
         if (request->hasParam("level")) {
             level = request->getParam("level")->value();
@@ -1348,18 +1514,27 @@ void WebServerManager::begin() {
         
         // Don't acquire the LED manager for logs - this can cause deadlocks
         try {
-            // Get logs directly - avoid mutex contention
-            String logs = LogManager::getInstance().getLogs(logLevel);
-            request->send(200, "text/plain", logs);
+            // Stream the log in chunks straight from LogManager; the cursor is
+            // the only per-request state, whatever the size of the log
+            std::shared_ptr<LogManager::LogCursor> cursor = std::make_shared<LogManager::LogCursor>();
+            cursor->seq = 0;
+            cursor->offset = 0;
+            AsyncWebServerResponse* response = request->beginChunkedResponse("text/plain",
+                [cursor, logLevel](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+                    int n = LogManager::getInstance().readLogs(logLevel, *cursor, (char*)buffer, maxLen);
+                    // A busy log is retried on the next poll instead of ending the response
+                    return n < 0 ? RESPONSE_TRY_AGAIN : (size_t)n;
+                });
+            request->send(response);
         } catch (...) {
             // Catch any exception to prevent server crashes
             request->send(200, "text/plain", "Error retrieving logs - see serial console");
             Serial.println("Error retrieving logs in /api/getLogs");
         }
-    });
+    }));
     
     // Clear system logs
-    _server.on("/api/clearLogs", HTTP_POST, [](AsyncWebServerRequest *request) {
+    _server.on("/api/clearLogs", HTTP_POST, gated(REQ_CONTROL, [](AsyncWebServerRequest *request) {
         if (!requireApiToken(request)) {
             return;
         }
@@ -1370,6 +1545,21 @@ void WebServerManager::begin() {
             request->send(200, "text/plain", "Error clearing logs - see serial console");
             Serial.println("Error clearing logs in /api/clearLogs");
         }
+    }));
+
+    /****************************************************
+     * Legacy /api/getX (GET) and /api/setX (POST) names for table
+     * parameters. Registered last so explicit routes win.
+     ****************************************************/
+    _server.on("^\\/api\\/(get|set)([A-Z][A-Za-z0-9]*)$", HTTP_GET | HTTP_POST, [](AsyncWebServerRequest *request){
+        bool isSet = request->pathArg(0) == "set";
+        if (isSet != (request->method() == HTTP_POST)) {
+            request->send(405, "text/plain", "Method not allowed");
+            return;
+        }
+        String name = request->pathArg(1);
+        name.setCharAt(0, (char)tolower(name.charAt(0)));
+        handleParamRequest(request, name, isSet);
     });
 
     // Start server
@@ -3,6 +3,7 @@
 
 #include <ESPAsyncWebServer.h> // Async WebServer
 #include <Arduino.h>
+#include "StaticAssets.h"
 
 class WebServerManager {
 public:
@@ -17,8 +18,11 @@ public:
 
 private:
     AsyncWebServer _server; // Async WebServer instance
+    AsyncWebSocket _frameSocket; // Binary frame stream (/ws/frames)
+    StaticAssets _assets;        // Pre-compressed web UI files
 
     bool initSPIFFS();      // Initialize SPIFFS with error handling
+    void setupStaticAssets(); // Routes for files listed in the asset manifest
     void setupRoutes();     // Function to define routes
     String createPageTemplate(const String& title, const String& content); // HTML template generator
 };
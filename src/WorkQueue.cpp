@@ -0,0 +1,136 @@
+// File: WorkQueue.cpp
+// Low-priority worker task for flash I/O and other slow jobs
+
+#include "WorkQueue.h"
+
+// Jobs slower than this are reported on Serial
+static const unsigned long SLOW_JOB_MS = 2000;
+
+struct WorkQueue::Ticket::Completion {
+    SemaphoreHandle_t done;
+    volatile State state;
+
+    Completion()
+        : done(xSemaphoreCreateBinary())
+        , state(PENDING)
+    {
+    }
+
+    ~Completion() {
+        if (done) {
+            vSemaphoreDelete(done);
+        }
+    }
+};
+
+WorkQueue::State WorkQueue::Ticket::wait(uint32_t timeoutMs) const {
+    if (!_completion) {
+        return FAILED;
+    }
+    if (_completion->state == PENDING && _completion->done) {
+        if (xSemaphoreTake(_completion->done, pdMS_TO_TICKS(timeoutMs)) == pdTRUE) {
+            // Leave it signalled for any later wait()
+            xSemaphoreGive(_completion->done);
+        }
+    }
+    return _completion->state;
+}
+
+WorkQueue::WorkQueue()
+    : _queue(nullptr)
+    , _task(nullptr)
+    , _completed(0)
+    , _failed(0)
+    , _rejected(0)
+{
+}
+
+bool WorkQueue::begin() {
+    if (_task) {
+        return true;
+    }
+    if (!_queue) {
+        _queue = xQueueCreate(QUEUE_DEPTH, sizeof(Item*));
+        if (!_queue) {
+            Serial.println("WorkQueue: Failed to create queue");
+            return false;
+        }
+    }
+    if (xTaskCreatePinnedToCore(taskEntry, "worker", STACK_SIZE, this,
+                                TASK_PRIORITY, &_task, TASK_CORE) != pdPASS) {
+        _task = nullptr;
+        Serial.println("WorkQueue: Failed to start worker task");
+        return false;
+    }
+    return true;
+}
+
+WorkQueue::Ticket WorkQueue::submit(const char* name, const Job& job) {
+    Ticket ticket;
+    std::shared_ptr<Ticket::Completion> completion = std::make_shared<Ticket::Completion>();
+    if (!completion->done) {
+        _rejected++;
+        return ticket;
+    }
+
+    Item* item = new Item;
+    item->name = name;
+    item->job = job;
+    item->completion = completion;
+    if (enqueue(item)) {
+        ticket._completion = completion;
+    }
+    return ticket;
+}
+
+bool WorkQueue::post(const char* name, const Job& job) {
+    Item* item = new Item;
+    item->name = name;
+    item->job = job;
+    return enqueue(item);
+}
+
+bool WorkQueue::enqueue(Item* item) {
+    if (!_task || xQueueSend(_queue, &item, 0) != pdTRUE) {
+        Serial.printf("WorkQueue: Rejected job '%s'\n", item->name);
+        delete item;
+        _rejected++;
+        return false;
+    }
+    return true;
+}
+
+UBaseType_t WorkQueue::depth() const {
+    return _queue ? uxQueueMessagesWaiting(_queue) : 0;
+}
+
+void WorkQueue::taskEntry(void* arg) {
+    static_cast<WorkQueue*>(arg)->run();
+}
+
+void WorkQueue::run() {
+    for (;;) {
+        Item* item = nullptr;
+        if (xQueueReceive(_queue, &item, portMAX_DELAY) != pdTRUE || !item) {
+            continue;
+        }
+
+        unsigned long start = millis();
+        bool ok = item->job ? item->job() : false;
+        unsigned long elapsed = millis() - start;
+        if (elapsed > SLOW_JOB_MS) {
+            Serial.printf("WorkQueue: Job '%s' took %lu ms\n", item->name, elapsed);
+        }
+
+        if (ok) {
+            _completed++;
+        } else {
+            _failed++;
+        }
+        if (item->completion) {
+            item->completion->state = ok ? DONE : FAILED;
+            xSemaphoreGive(item->completion->done);
+        }
+        delete item;
+    }
+}
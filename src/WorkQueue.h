@@ -0,0 +1,97 @@
+// File: WorkQueue.h
+// Low-priority worker task for flash I/O and other slow jobs
+
+#ifndef WORKQUEUE_H
+#define WORKQUEUE_H
+
+#include <Arduino.h>
+#include <functional>
+#include <memory>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+/**
+ * Web handlers run inside the AsyncTCP task, so anything slow there (SPIFFS
+ * writes, FastLED reinit, multi-second waits) stalls every connection. Such
+ * work is handed to a single worker task through a bounded queue instead.
+ *
+ * submit() never blocks. The returned ticket can be waited on for a short
+ * deadline so quick jobs still produce a synchronous answer; slower jobs keep
+ * running after the handler has replied with 202.
+ */
+class WorkQueue {
+public:
+    // A job returns false to report failure to a waiting handler
+    typedef std::function<bool()> Job;
+
+    enum State {
+        PENDING,
+        DONE,
+        FAILED
+    };
+
+    class Ticket {
+    public:
+        // False when the job was not accepted (queue full or not started)
+        bool valid() const { return (bool)_completion; }
+
+        // Waits up to timeoutMs for the job; PENDING if it is still queued/running
+        State wait(uint32_t timeoutMs) const;
+
+    private:
+        friend class WorkQueue;
+        struct Completion;
+        std::shared_ptr<Completion> _completion;
+    };
+
+    static const UBaseType_t QUEUE_DEPTH = 8;
+    static const uint32_t STACK_SIZE = 6144;
+    static const UBaseType_t TASK_PRIORITY = 1;
+    static const BaseType_t TASK_CORE = 0;
+
+    static WorkQueue& getInstance() {
+        static WorkQueue instance;
+        return instance;
+    }
+
+    // Creates the queue and starts the worker task. Safe to call repeatedly.
+    bool begin();
+    bool isRunning() const { return _task != nullptr; }
+
+    // Queues a job whose outcome the caller wants to see
+    Ticket submit(const char* name, const Job& job);
+
+    // Queues a fire-and-forget job
+    bool post(const char* name, const Job& job);
+
+    UBaseType_t depth() const;
+    uint32_t completedJobs() const { return _completed; }
+    uint32_t failedJobs() const { return _failed; }
+    uint32_t rejectedJobs() const { return _rejected; }
+
+private:
+    struct Item {
+        const char* name;
+        Job job;
+        std::shared_ptr<Ticket::Completion> completion;
+    };
+
+    WorkQueue();
+    WorkQueue(const WorkQueue&);
+    WorkQueue& operator=(const WorkQueue&);
+
+    bool enqueue(Item* item);
+    static void taskEntry(void* arg);
+    void run();
+
+    QueueHandle_t _queue;
+    TaskHandle_t _task;
+
+    volatile uint32_t _completed;
+    volatile uint32_t _failed;
+    volatile uint32_t _rejected;
+};
+
+#endif // WORKQUEUE_H
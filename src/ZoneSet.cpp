@@ -0,0 +1,256 @@
+// File: ZoneSet.cpp
+// Independent animations on rectangular regions of the canvas
+
+#include "ZoneSet.h"
+#include "AnimationClock.h"
+#include "animations/BaseAnimation.h"
+#include <esp_heap_caps.h>
+#include <new>
+
+ZoneConfig::ZoneConfig()
+    : x(0), y(0), w(0), h(0)
+    , animation(-1)
+    , palette(-1)
+    , intervalMs(0)
+    , speed(-1)
+    , fade(-1)
+    , spawnRate(-1.0f)
+{
+}
+
+ZoneSet::ZoneSet()
+    : _assigned(0)
+    , _canvasPixels(0)
+    , _coversCanvas(false)
+{
+    for (uint8_t i = 0; i < MAX_ZONES; i++) {
+        Zone& zone = _zones[i];
+        zone.anim = nullptr;
+        zone.pixels = nullptr;
+        zone.lastUpdate = 0;
+    }
+}
+
+ZoneSet::~ZoneSet() {
+    clearAll();
+}
+
+int ZoneSet::panelsFor(const ZoneConfig& config) {
+    int panels = (config.w + PanelLayout::PANEL_SIZE - 1) / PanelLayout::PANEL_SIZE;
+    if (panels < 1) panels = 1;
+    if (panels > PanelLayout::MAX_PANELS) panels = PanelLayout::MAX_PANELS;
+    return panels;
+}
+
+bool ZoneSet::assign(uint8_t slot, const ZoneConfig& config, BaseAnimation* anim, const PanelLayout& layout) {
+    if (slot >= MAX_ZONES || !anim) {
+        delete anim;
+        return false;
+    }
+    const int count = panelsFor(config) * PanelLayout::PANEL_SIZE * PanelLayout::PANEL_SIZE;
+    const size_t bytes = sizeof(CRGB) * count;
+    CRGB* pixels = (CRGB*)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!pixels) {
+        pixels = (CRGB*)heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+    }
+    if (!pixels) {
+        Serial.println("ZoneSet: Failed to allocate zone buffer");
+        delete anim;
+        return false;
+    }
+
+    Zone& zone = _zones[slot];
+    if (zone.anim) {
+        release(zone);
+    } else {
+        _assigned++;
+    }
+    fill_solid(pixels, count, CRGB::Black);
+    zone.config = config;
+    zone.anim = anim;
+    zone.pixels = pixels;
+    zone.lastUpdate = 0;
+    anim->setTarget(pixels);
+    buildMap(zone, layout);
+    _canvasPixels = layout.pixelCount();
+    updateCoverage();
+    return true;
+}
+
+void ZoneSet::clear(uint8_t slot) {
+    if (slot >= MAX_ZONES || !_zones[slot].anim) {
+        return;
+    }
+    release(_zones[slot]);
+    _zones[slot].config = ZoneConfig();
+    _assigned--;
+    updateCoverage();
+}
+
+void ZoneSet::clearAll() {
+    for (uint8_t i = 0; i < MAX_ZONES; i++) {
+        clear(i);
+    }
+}
+
+void ZoneSet::release(Zone& zone) {
+    if (zone.anim) {
+        zone.anim->end();
+        delete zone.anim;
+        zone.anim = nullptr;
+    }
+    if (zone.pixels) {
+        heap_caps_free(zone.pixels);
+        zone.pixels = nullptr;
+    }
+    std::vector<uint16_t>().swap(zone.source);
+    std::vector<uint16_t>().swap(zone.target);
+}
+
+ZoneConfig ZoneSet::config(uint8_t slot) const {
+    if (slot >= MAX_ZONES) {
+        return ZoneConfig();
+    }
+    return _zones[slot].config;
+}
+
+void ZoneSet::setPalette(uint8_t slot, int8_t palette) {
+    if (slot < MAX_ZONES && _zones[slot].anim) {
+        _zones[slot].config.palette = palette;
+    }
+}
+
+BaseAnimation* ZoneSet::animation(uint8_t slot) const {
+    return slot < MAX_ZONES ? _zones[slot].anim : nullptr;
+}
+
+void ZoneSet::relayout(const PanelLayout& layout) {
+    for (uint8_t i = 0; i < MAX_ZONES; i++) {
+        if (_zones[i].anim) {
+            buildMap(_zones[i], layout);
+        }
+    }
+    _canvasPixels = layout.pixelCount();
+    updateCoverage();
+}
+
+// Every canvas pixel is some zone's target exactly when the distinct
+// targets number as many as the canvas has pixels
+void ZoneSet::updateCoverage() {
+    _coversCanvas = false;
+    if (_assigned == 0 || _canvasPixels <= 0) {
+        return;
+    }
+    std::vector<bool> hit(PanelLayout::MAX_PIXELS, false);
+    int distinct = 0;
+    for (uint8_t i = 0; i < MAX_ZONES; i++) {
+        const std::vector<uint16_t>& target = _zones[i].target;
+        for (size_t p = 0; p < target.size(); p++) {
+            if (!hit[target[p]]) {
+                hit[target[p]] = true;
+                distinct++;
+            }
+        }
+    }
+    _coversCanvas = distinct >= _canvasPixels;
+}
+
+// The zone animation draws an unrotated strip of panelsFor() panels; its
+// own mapping of (x, y) is read back through a layout configured the same
+// way. Pixels outside the canvas are dropped.
+void ZoneSet::buildMap(Zone& zone, const PanelLayout& layout) {
+    zone.source.clear();
+    zone.target.clear();
+
+    PanelLayout* local = new (std::nothrow) PanelLayout();
+    if (!local) {
+        Serial.println("ZoneSet: Failed to allocate zone layout");
+        return;
+    }
+    const int unrotated[3] = { 0, 0, 0 };
+    local->configure(panelsFor(zone.config), 0, unrotated);
+
+    const ZoneConfig& c = zone.config;
+    int w = c.w < local->width() ? c.w : local->width();
+    int h = c.h < local->height() ? c.h : local->height();
+    zone.source.reserve(w * h);
+    zone.target.reserve(w * h);
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            int index = layout.indexChecked(c.x + x, c.y + y);
+            if (index < 0) continue;
+            zone.source.push_back(local->index(x, y));
+            zone.target.push_back((uint16_t)index);
+        }
+    }
+    delete local;
+}
+
+void ZoneSet::update() {
+    unsigned long now = AnimationClock::now();
+    for (uint8_t i = 0; i < MAX_ZONES; i++) {
+        Zone& zone = _zones[i];
+        if (!zone.anim || zone.source.empty()) continue;
+        if (zone.config.intervalMs && now - zone.lastUpdate < zone.config.intervalMs) continue;
+        zone.lastUpdate = now;
+        zone.anim->update();
+    }
+}
+
+void ZoneSet::compose(CRGB* out) {
+    for (uint8_t i = 0; i < MAX_ZONES; i++) {
+        const Zone& zone = _zones[i];
+        const size_t count = zone.source.size();
+        const uint16_t* source = zone.source.data();
+        const uint16_t* target = zone.target.data();
+        for (size_t p = 0; p < count; p++) {
+            out[target[p]] = zone.pixels[source[p]];
+        }
+    }
+}
+
+String ZoneSet::format(const ZoneConfig& config) {
+    char line[80];
+    snprintf(line, sizeof(line), "%d,%d,%d,%d,%d,%d,%u,%d,%.2f,%d,",
+             config.x, config.y, config.w, config.h,
+             config.animation, config.palette, (unsigned)config.intervalMs,
+             config.speed, config.spawnRate < 0 ? -1.0f : config.spawnRate, config.fade);
+    String message = config.message;
+    message.replace('\n', ' ');
+    message.replace('\r', ' ');
+    return String(line) + message;
+}
+
+bool ZoneSet::parse(const String& line, ZoneConfig& config) {
+    int x, y, w, h, animation, palette;
+    unsigned interval;
+    int speed = -1, fade = -1;
+    float spawnRate = -1.0f;
+    int messageAt = 0;
+    int fields = sscanf(line.c_str(), "%d,%d,%d,%d,%d,%d,%u,%d,%f,%d,%n",
+                        &x, &y, &w, &h, &animation, &palette, &interval,
+                        &speed, &spawnRate, &fade, &messageAt);
+    if (fields < 7) {
+        return false;
+    }
+    if (w <= 0 || h <= 0 || animation < 0 || animation > 127) {
+        return false;
+    }
+    config = ZoneConfig();
+    config.x = (int16_t)x;
+    config.y = (int16_t)y;
+    config.w = (int16_t)w;
+    config.h = (int16_t)h;
+    config.animation = (int8_t)animation;
+    config.palette = (int8_t)(palette < 0 || palette > 127 ? -1 : palette);
+    config.intervalMs = (uint16_t)(interval > 60000 ? 60000 : interval);
+    if (fields == 10) {
+        config.speed = (int16_t)(speed < 3 || speed > 1500 ? -1 : speed);
+        config.spawnRate = spawnRate < 0 || spawnRate > 1 ? -1.0f : spawnRate;
+        config.fade = (int16_t)(fade < 0 || fade > 255 ? -1 : fade);
+        if (messageAt > 0) {
+            config.message = line.substring(messageAt);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,107 @@
+// File: ZoneSet.h
+// Independent animations on rectangular regions of the canvas
+
+#ifndef ZONESET_H
+#define ZONESET_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+#include <vector>
+#include "PanelLayout.h"
+
+class BaseAnimation;
+
+// What /zones.cfg stores for one zone. The animation settings below
+// override the global ones for this zone only; at their "unset" value the
+// zone follows the global setting.
+struct ZoneConfig {
+    int16_t x, y, w, h;     // logical canvas rectangle
+    int8_t animation;       // animation index, -1 = zone unused
+    int8_t palette;         // palette index, -1 = follow the global palette
+    uint16_t intervalMs;    // minimum time between updates, 0 = every frame
+    int16_t speed;          // as the global speed (ms), -1 = global
+    int16_t fade;           // trail fade 0-255, -1 = global
+    float spawnRate;        // 0-1, negative = global
+    String message;         // Text zones, empty = global message
+
+    ZoneConfig();
+};
+
+/**
+ * Up to MAX_ZONES rectangles on the logical canvas, each running its own
+ * animation instance over the main animation.
+ *
+ * A zone's animation is sized to the panels its rectangle spans
+ * (ceil(w / 16) panels, unrotated and left to right) and renders into a
+ * private buffer of that size, so a zone covering four of eight panels
+ * costs a four-panel render. When the zone is assigned, and whenever the
+ * layout changes, the rectangle is resolved into a list of (source,
+ * destination) pixel indices; compose() is then a plain gather copy into
+ * the output. Later zones are drawn over earlier ones.
+ *
+ * coversCanvas() tells the caller when the zones between them cover every
+ * canvas pixel, so whatever is drawn underneath would never show.
+ */
+class ZoneSet {
+public:
+    static const uint8_t MAX_ZONES = 4;
+
+    ZoneSet();
+    ~ZoneSet();
+
+    bool active() const { return _assigned > 0; }
+    bool coversCanvas() const { return _coversCanvas; }
+
+    // Panels, and so LEDs, an animation for this rectangle is created with
+    static int panelsFor(const ZoneConfig& config);
+
+    // Takes ownership of anim, created for panelsFor(config) panels.
+    // Replaces whatever the slot held. Returns false (and deletes anim) if
+    // the buffers could not be allocated.
+    bool assign(uint8_t slot, const ZoneConfig& config, BaseAnimation* anim, const PanelLayout& layout);
+    void clear(uint8_t slot);
+    void clearAll();
+
+    ZoneConfig config(uint8_t slot) const;
+    // Changes only the stored palette index (e.g. after palettes were
+    // renumbered); the caller hands the palette to the animation
+    void setPalette(uint8_t slot, int8_t palette);
+    BaseAnimation* animation(uint8_t slot) const;
+
+    // Canvas mapping changed (panel count, order or rotation)
+    void relayout(const PanelLayout& layout);
+
+    // Advances each zone's animation when its interval has elapsed
+    void update();
+
+    // Copies every zone's pixels into out (physical order)
+    void compose(CRGB* out);
+
+    // One line of /zones.cfg:
+    // "x,y,w,h,animation,palette,intervalMs,speed,spawnRate,fade,message"
+    // The message runs to the end of the line and may contain commas.
+    // Lines with only the first seven fields leave the rest at global.
+    static String format(const ZoneConfig& config);
+    static bool parse(const String& line, ZoneConfig& config);
+
+private:
+    struct Zone {
+        ZoneConfig config;
+        BaseAnimation* anim;
+        CRGB* pixels;
+        std::vector<uint16_t> source;   // index into pixels
+        std::vector<uint16_t> target;   // index into the output
+        unsigned long lastUpdate;
+    };
+
+    void buildMap(Zone& zone, const PanelLayout& layout);
+    void release(Zone& zone);
+    void updateCoverage();
+
+    Zone _zones[MAX_ZONES];
+    uint8_t _assigned;
+    int _canvasPixels;      // as of the last assign() or relayout()
+    bool _coversCanvas;
+};
+
+#endif // ZONESET_H
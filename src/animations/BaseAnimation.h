@@ -5,6 +5,11 @@
 
 #include <Arduino.h>
 #include <FastLED.h>
+#include "../AnimationClock.h"
+#include "../Rng.h"
+
+// The LED array owned by LEDManager; the default draw target
+extern CRGB leds[];
 
 /**
  * A generic base class for animations. 
@@ -17,6 +22,8 @@ public:
         : _numLeds(numLeds)
         , _brightness(brightness)
         , _panelCount(panelCount)
+        , _leds(leds)
+        , _rng(esp_random())
     {
     }
 
@@ -31,14 +38,48 @@ public:
     // Called repeatedly in loop
     virtual void update() = 0;
 
+    // Called when the panel count changes while running. Overrides keep as
+    // much state as they can instead of restarting.
+    virtual void resize(uint16_t numLeds, int panelCount) {
+        _numLeds = numLeds;
+        _panelCount = panelCount;
+    }
+
+    // Called when the animation is switched away from and kept in the warm
+    // cache, and when it is switched back to after suspendedMs. The default
+    // freezes: timers compare against AnimationClock::now(), so the next
+    // update simply continues where the animation stopped. Simulations that
+    // want to catch up on the missed time override resume().
+    virtual void suspend() {}
+    virtual void resume(uint32_t suspendedMs) { (void)suspendedMs; }
+
+    // Heap owned by the instance beyond the object itself, for the cache
+    // budget
+    virtual size_t memoryUsage() const { return 0; }
+
+    // Buffer the animation draws into: the LED array, or a private buffer
+    // while it takes part in a transition. Same physical order either way.
+    void setTarget(CRGB* target) { _leds = target; }
+
+    // Restarts the animation's random sequence. LEDManager seeds every
+    // instance before begin(); with the same seed and settings, an
+    // animation makes the same random choices run after run.
+    void seedRandom(uint32_t seed) { _rng.seed(seed); }
+
     // A virtual setter for brightness (can be overridden)
     virtual void setBrightness(uint8_t b) { _brightness = b; }
 
 protected:
+    void clearTarget() { fill_solid(_leds, _numLeds, CRGB::Black); }
+
     // Shared with derived classes
     uint16_t _numLeds;
     uint8_t  _brightness;
     int _panelCount;
+    CRGB* _leds;
+    // Use this rather than random(): it is faster and follows seedRandom().
+    // Likewise read the time from AnimationClock::now(), not millis().
+    Rng _rng;
 };
 
 #endif // BASEANIMATION_H
@@ -1,33 +1,30 @@
 // File: BlinkAnimation.cpp
 
 #include "BlinkAnimation.h"
+#include "../PixelKernels.h"
 #include <Arduino.h>
 #include <FastLED.h>
 
-// Declared in LEDManager.cpp
-extern CRGB leds[];
-
 BlinkAnimation::BlinkAnimation(uint16_t numLeds, uint8_t brightness, int panelCount)
   : BaseAnimation(numLeds, brightness) // call the base class constructor
   , _panelCount(panelCount)
   , _intervalMs(500)
   , _lastToggle(0)
   , _isOn(false)
-  , _palette(nullptr)
   , _paletteIndex(0)
 {
 }
 
 void BlinkAnimation::begin() {
     // Turn off to start
-    FastLED.clear(true);
+    clearTarget();
     _isOn = false;
-    _lastToggle = millis();
+    _lastToggle = AnimationClock::now();
     _paletteIndex = 0;
 }
 
 void BlinkAnimation::update() {
-    unsigned long now = millis();
+    unsigned long now = AnimationClock::now();
     if ((now - _lastToggle) >= _intervalMs) {
         _lastToggle = now;
         // Toggle state
@@ -36,20 +33,16 @@ void BlinkAnimation::update() {
         if (_isOn) {
             // If we have a palette, pick the next color
             CRGB color = CRGB::White;
-            if (_palette && !_palette->empty()) {
-                color = (*_palette)[_paletteIndex % _palette->size()];
+            if (!_palette.empty()) {
+                color = _palette[_paletteIndex % _palette.size()];
                 _paletteIndex++;
             }
             // Fill all
-            for (int i = 0; i < _numLeds; i++) {
-                leds[i] = color;
-            }
-            FastLED.setBrightness(_brightness);
+            spanFill(_leds, _numLeds, color);
         } else {
             // Turn all LEDs off
-            FastLED.clear(true);
+            clearTarget();
         }
-        FastLED.show();
     }
 }
 
@@ -57,11 +50,16 @@ void BlinkAnimation::setBrightness(uint8_t b) {
     _brightness = b;
 }
 
+void BlinkAnimation::resize(uint16_t numLeds, int panelCount) {
+    BaseAnimation::resize(numLeds, panelCount);
+    _panelCount = panelCount;
+}
+
 void BlinkAnimation::setInterval(unsigned long intervalMs) {
     _intervalMs = intervalMs;
 }
 
 void BlinkAnimation::setPalette(const std::vector<CRGB>* palette) {
-    _palette = palette;
+    _palette = palette ? *palette : std::vector<CRGB>();
     _paletteIndex = 0;
 }
@@ -25,6 +25,7 @@ public:
 
     // Overridden brightness
     void setBrightness(uint8_t b) override;
+    void resize(uint16_t numLeds, int panelCount) override;
 
     // Set how fast we blink
     void setInterval(unsigned long intervalMs);
@@ -40,8 +41,8 @@ private:
     unsigned long _lastToggle;
     bool          _isOn;
 
-    // We'll cycle through a palette
-    const std::vector<CRGB>* _palette;
+    // We'll cycle through our own copy of a palette
+    std::vector<CRGB> _palette;
     int   _paletteIndex; // which color in the palette
 };
 
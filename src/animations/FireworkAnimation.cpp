@@ -1,9 +1,9 @@
 #include "FireworkAnimation.h"
+#include "../Canvas.h"
+#include "../HueTable.h"
 #include <Arduino.h>
 #include <FastLED.h>
 
-extern CRGB leds[];
-
 // Constructor
 FireworkAnimation::FireworkAnimation(uint16_t numLeds, uint8_t brightness, int panelCount)
     : BaseAnimation(numLeds, brightness)
@@ -18,9 +18,10 @@ FireworkAnimation::FireworkAnimation(uint16_t numLeds, uint8_t brightness, int p
     , _rotationAngle3(90)
     , _maxFireworks(10)
     , _particleCount(40)
-    , _gravity(0.15f)
-    , _launchProbability(0.15f)
+    , _gravity(q16(0.15f))
+    , _launchPercent(15)
 {
+    relayout();
     Serial.printf("Firework Animation created. Grid size: %d x %d, panels: %d\n", 
                   _width * _panelCount, _height, _panelCount);
 }
@@ -28,8 +29,8 @@ FireworkAnimation::FireworkAnimation(uint16_t numLeds, uint8_t brightness, int p
 // Initialize the animation
 void FireworkAnimation::begin() {
     Serial.println("Firework Animation: begin()");
-    FastLED.clear(true);
-    _lastUpdate = millis();
+    clearTarget();
+    _lastUpdate = AnimationClock::now();
     _fireworks.clear();
     
     // Launch a few initial fireworks
@@ -48,19 +49,23 @@ void FireworkAnimation::setUpdateInterval(unsigned long intervalMs) {
 // Set panel order
 void FireworkAnimation::setPanelOrder(int order) {
     _panelOrder = order;
+    relayout();
 }
 
 // Set rotation angles
 void FireworkAnimation::setRotationAngle1(int angle) {
     _rotationAngle1 = angle;
+    relayout();
 }
 
 void FireworkAnimation::setRotationAngle2(int angle) {
     _rotationAngle2 = angle;
+    relayout();
 }
 
 void FireworkAnimation::setRotationAngle3(int angle) {
     _rotationAngle3 = angle;
+    relayout();
 }
 
 // Set maximum number of fireworks
@@ -75,23 +80,38 @@ void FireworkAnimation::setParticleCount(int count) {
 
 // Set gravity effect
 void FireworkAnimation::setGravity(float gravity) {
-    _gravity = gravity;
+    _gravity = q16(gravity);
 }
 
 // Set launch probability
 void FireworkAnimation::setLaunchProbability(float prob) {
-    _launchProbability = prob;
+    _launchPercent = (uint8_t)constrain(prob * 100.0f + 0.5f, 0.0f, 100.0f);
+}
+
+size_t FireworkAnimation::memoryUsage() const {
+    // The layout table is part of the object but dwarfs the rest of it
+    size_t bytes = sizeof(PanelLayout) + _fireworks.capacity() * sizeof(Firework);
+    for (size_t i = 0; i < _fireworks.size(); i++) {
+        bytes += _fireworks[i].particles.capacity() * sizeof(Particle);
+    }
+    return bytes;
 }
 
-// Override brightness setting
-void FireworkAnimation::setBrightness(uint8_t b) {
-    _brightness = b;
-    FastLED.setBrightness(b);
+// Fireworks in flight keep going; drawing clips to the new width
+void FireworkAnimation::resize(uint16_t numLeds, int panelCount) {
+    BaseAnimation::resize(numLeds, panelCount);
+    _panelCount = panelCount;
+    relayout();
+}
+
+void FireworkAnimation::relayout() {
+    const int rotations[3] = { _rotationAngle1, _rotationAngle2, _rotationAngle3 };
+    _layout.configure(_panelCount, _panelOrder, rotations);
 }
 
 // Update the animation (called in the main loop)
 void FireworkAnimation::update() {
-    unsigned long now = millis();
+    unsigned long now = AnimationClock::now();
     if ((now - _lastUpdate) >= _intervalMs) {
         _lastUpdate = now;
         
@@ -99,7 +119,7 @@ void FireworkAnimation::update() {
         yield();
         
         // Clear the display
-        FastLED.clear();
+        clearTarget();
         
         // Update fireworks
         updateFireworks();
@@ -107,11 +127,8 @@ void FireworkAnimation::update() {
         // Draw fireworks
         drawFireworks();
         
-        // Show the LEDs
-        FastLED.show();
-        
         // Randomly launch new fireworks if we have room
-        if (_fireworks.size() < _maxFireworks && random(100) < (_launchProbability * 100)) {
+        if (_fireworks.size() < _maxFireworks && _rng.chance(_launchPercent)) {
             launchFirework();
         }
     }
@@ -126,10 +143,10 @@ void FireworkAnimation::updateFireworks() {
         if (!fw.exploded) {
             // Update rising firework
             fw.y -= fw.vy;
-            fw.vy *= 0.98f; // Slow down due to gravity
+            fw.vy = q16Mul(fw.vy, RISE_DRAG); // Slow down due to gravity
             
             // If it reached peak height, explode
-            if (fw.vy < 0.3f) {
+            if (fw.vy < EXPLODE_SPEED) {
                 explodeFirework(fw);
             }
             
@@ -149,7 +166,7 @@ void FireworkAnimation::updateFireworks() {
                 // Decrease life
                 if (p.life > 0) {
                     p.life--;
-                    p.brightness = map(p.life, 0, 100, 0, 255);
+                    p.brightness = (p.life * 653) >> 8; // life * 2.55
                     allDead = false;
                 }
             }
@@ -169,14 +186,14 @@ void FireworkAnimation::launchFirework() {
     Firework fw;
     
     // Random starting position at bottom
-    fw.x = random(_width * _panelCount);
-    fw.y = _height - 1;
+    fw.x = q16FromInt(_rng.below(_width * _panelCount));
+    fw.y = q16FromInt(_height - 1);
     
-    // Random upward velocity
-    fw.vy = 0.5f + (random(50) / 100.0f);
+    // Random upward velocity, 0.5 to 0.99 pixels per step
+    fw.vy = Q16_ONE / 2 + (q16_16)_rng.below(50) * (Q16_ONE / 100);
     
     // Random color
-    fw.hue = random(256);
+    fw.hue = _rng.byte();
     
     // Not exploded yet
     fw.exploded = false;
@@ -199,22 +216,22 @@ void FireworkAnimation::explodeFirework(Firework& fw) {
         p.y = fw.y;
         
         // Random velocity in all directions
-        float angle = random(360) * PI / 180.0f;
-        float speed = 0.1f + (random(40) / 100.0f);
-        p.vx = cos(angle) * speed;
-        p.vy = sin(angle) * speed;
+        angle16 angle = (angle16)_rng.next();
+        q16_16 speed = Q16_ONE / 10 + (q16_16)_rng.below(40) * (Q16_ONE / 100);
+        p.vx = q16Mul(fxCos(angle), speed);
+        p.vy = q16Mul(fxSin(angle), speed);
         
         // Gravity effect
         p.gravity = _gravity;
         
         // Color similar to firework with slight variation
-        p.hue = fw.hue + random(-10, 10);
+        p.hue = fw.hue + _rng.range(-10, 10);
         
         // Full brightness initially
         p.brightness = 255;
         
         // Random life
-        p.life = 50 + random(50);
+        p.life = 50 + _rng.below(50);
         
         // Add to firework
         fw.particles.push_back(p);
@@ -223,100 +240,21 @@ void FireworkAnimation::explodeFirework(Firework& fw) {
 
 // Draw all fireworks
 void FireworkAnimation::drawFireworks() {
-    // Set brightness
-    FastLED.setBrightness(_brightness);
-    
+    Canvas canvas(_leds, _layout);
+
     // Draw each firework
     for (const auto& fw : _fireworks) {
         if (!fw.exploded) {
-            // Draw rising firework as a trail
+            // Draw rising firework as a fading trail
             for (int i = 0; i < 3; i++) {
-                int y = fw.y + i;
-                if (y >= 0 && y < _height) {
-                    int ledIndex = getLedIndex(fw.x, y);
-                    if (ledIndex >= 0 && ledIndex < _numLeds) {
-                        // Fade trail
-                        uint8_t fade = 255 - (i * 80);
-                        leds[ledIndex] = CHSV(fw.hue, 255, fade);
-                    }
-                }
+                uint8_t fade = 255 - (i * 80);
+                canvas.pixel(q16Floor(fw.x), q16Floor(fw.y) + i, HueTable::color(fw.hue, fade));
             }
         } else {
             // Draw particles
             for (const auto& p : fw.particles) {
-                int x = round(p.x);
-                int y = round(p.y);
-                
-                if (x >= 0 && x < _width * _panelCount && y >= 0 && y < _height) {
-                    int ledIndex = getLedIndex(x, y);
-                    if (ledIndex >= 0 && ledIndex < _numLeds) {
-                        leds[ledIndex] = CHSV(p.hue, 255, p.brightness);
-                    }
-                }
+                canvas.pixel(q16Round(p.x), q16Round(p.y), HueTable::color(p.hue, p.brightness));
             }
         }
     }
 }
-
-// Get the LED index for a given (x,y) coordinate
-int FireworkAnimation::getLedIndex(int x, int y) {
-    // Determine which panel this pixel belongs to
-    int panel = x / _width;
-    int localX = x % _width;
-    int localY = y;
-    
-    // Apply panel rotation if needed
-    int angle = 0;
-    switch (panel) {
-        case 0: angle = _rotationAngle1; break;
-        case 1: angle = _rotationAngle2; break;
-        case 2: angle = _rotationAngle3; break;
-    }
-    
-    // Rotate the coordinates if needed
-    rotateCoordinates(localX, localY, angle);
-    
-    // Adjust the panel based on panel order
-    int adjustedPanel = panel;
-    if (_panelOrder == 1) { // Right to left
-        adjustedPanel = _panelCount - 1 - panel;
-    }
-    
-    // Calculate the LED index using zigzag pattern
-    int index = adjustedPanel * 256; // 16x16 = 256 LEDs per panel
-    
-    // Even rows go left to right, odd rows go right to left (zigzag)
-    if (localY % 2 == 0) {
-        index += localY * 16 + localX;
-    } else {
-        index += localY * 16 + (15 - localX);
-    }
-    
-    return index;
-}
-
-// Rotate coordinates based on angle
-void FireworkAnimation::rotateCoordinates(int &x, int &y, int angle) {
-    int rotatedX = x;
-    int rotatedY = y;
-    
-    switch (angle) {
-        case 0:   // No rotation
-            break;
-        case 90:  // 90 degrees
-            rotatedX = y;
-            rotatedY = 15 - x;
-            break;
-        case 180: // 180 degrees
-            rotatedX = 15 - x;
-            rotatedY = 15 - y;
-            break;
-        case 270: // 270 degrees
-            rotatedX = 15 - y;
-            rotatedY = x;
-            break;
-    }
-    
-    x = rotatedX;
-    y = rotatedY;
-}
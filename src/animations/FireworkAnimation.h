@@ -2,21 +2,24 @@
 #define FIREWORKANIMATION_H
 
 #include "BaseAnimation.h"
+#include "../PanelLayout.h"
+#include "../FixedMath.h"
 #include <vector>
 #include <FastLED.h>
 
+// Positions and velocities in pixels (per step), 16.16 fixed point
 struct Particle {
-    float x, y;       // Position
-    float vx, vy;     // Velocity
-    float gravity;    // Gravity effect
+    q16_16 x, y;      // Position
+    q16_16 vx, vy;    // Velocity
+    q16_16 gravity;   // Gravity effect
     uint8_t hue;      // Color
     uint8_t brightness; // Brightness
     uint8_t life;     // Remaining life
 };
 
 struct Firework {
-    float x, y;       // Launch position
-    float vy;         // Launch velocity
+    q16_16 x, y;      // Launch position
+    q16_16 vy;        // Launch velocity
     uint8_t hue;      // Color
     bool exploded;    // Whether it has exploded
     std::vector<Particle> particles; // Particles after explosion
@@ -30,7 +33,8 @@ public:
     // Required BaseAnimation methods
     virtual void begin() override;
     virtual void update() override;
-    virtual void setBrightness(uint8_t b) override;
+    void resize(uint16_t numLeds, int panelCount) override;
+    size_t memoryUsage() const override;
 
     // Specific methods for this animation
     void setUpdateInterval(unsigned long intervalMs);
@@ -48,8 +52,11 @@ private:
     void launchFirework();
     void explodeFirework(Firework& firework);
     void drawFireworks();
-    int getLedIndex(int x, int y);
-    void rotateCoordinates(int &x, int &y, int angle);
+    void relayout();
+
+    // Rockets lose 2% of their speed per step and burst below 0.3 px/step
+    static const q16_16 RISE_DRAG = 64225;
+    static const q16_16 EXPLODE_SPEED = 19661;
 
 private:
     int _panelCount;
@@ -63,9 +70,10 @@ private:
     int _rotationAngle3;
     int _maxFireworks;
     int _particleCount;
-    float _gravity;
-    float _launchProbability;
+    q16_16 _gravity;
+    uint8_t _launchPercent;
     std::vector<Firework> _fireworks;
+    PanelLayout _layout;
 };
 
 #endif // FIREWORKANIMATION_H
\ No newline at end of file
@@ -2,6 +2,8 @@
 // Conway's Game of Life animation for LED matrices
 
 #include "GameOfLifeAnimation.h"
+#include "../PixelKernels.h"
+#include "../HueTable.h"
 #include <Arduino.h>
 #include <FastLED.h>
 #include <algorithm>
@@ -9,9 +11,6 @@
 #include <cstring>
 #include <new>
 
-// External reference to LED array
-extern CRGB leds[];
-
 // Constructor
 GameOfLifeAnimation::GameOfLifeAnimation(uint16_t numLeds, uint8_t brightness, int panelCount)
     : BaseAnimation(numLeds, brightness, panelCount),
@@ -28,7 +27,6 @@ GameOfLifeAnimation::GameOfLifeAnimation(uint16_t numLeds, uint8_t brightness, i
       _rotationAngle1(0),
       _rotationAngle2(0),
       _rotationAngle3(0),
-      _currentPalette(nullptr),
       _allPalettes(nullptr),
       _birthMask(0),
       _surviveMask(0),
@@ -113,7 +111,7 @@ void GameOfLifeAnimation::begin() {
     }
     
     // Reset animation state
-    _lastUpdateTime = millis();
+    _lastUpdateTime = AnimationClock::now();
     
     // Start with a random pattern
     randomize(_seedDensity); // Use configured density
@@ -128,7 +126,7 @@ void GameOfLifeAnimation::update() {
     }
     
     // Check if it's time to update the simulation
-    unsigned long currentTime = millis();
+    unsigned long currentTime = AnimationClock::now();
     if (currentTime - _lastUpdateTime < _intervalMs) {
         return;
     }
@@ -182,6 +180,74 @@ void GameOfLifeAnimation::update() {
     drawGrid();
 }
 
+// Frozen while suspended; only the picture is redrawn into the new target
+void GameOfLifeAnimation::resume(uint32_t suspendedMs) {
+    (void)suspendedMs;
+    drawGrid();
+}
+
+size_t GameOfLifeAnimation::memoryUsage() const {
+    return (size_t)_gridSizeBytes * 2 + (size_t)_width * _height + (_lut ? sizeof(PaletteLUT) : 0);
+}
+
+// Extends or crops the board in place: cells and ages in the overlapping
+// columns are kept and only newly added columns are seeded.
+void GameOfLifeAnimation::resize(uint16_t numLeds, int panelCount) {
+    BaseAnimation::resize(numLeds, panelCount);
+    int newWidth = 16 * (panelCount > 1 ? panelCount : 1);
+    if (newWidth == _width || !_grid1) {
+        return;
+    }
+
+    int newSizeBytes = (newWidth * _height + 7) / 8;
+    uint8_t* grid1 = new (std::nothrow) uint8_t[newSizeBytes];
+    uint8_t* grid2 = new (std::nothrow) uint8_t[newSizeBytes];
+    uint8_t* ageGrid = new (std::nothrow) uint8_t[newWidth * _height];
+    if (!grid1 || !grid2 || !ageGrid) {
+        Serial.println("GameOfLife: Failed to allocate memory for resize");
+        delete[] grid1;
+        delete[] grid2;
+        delete[] ageGrid;
+        return;
+    }
+    memset(grid1, 0, newSizeBytes);
+    memset(grid2, 0, newSizeBytes);
+    memset(ageGrid, 0, newWidth * _height);
+
+    int keepWidth = std::min(_width, newWidth);
+    for (int y = 0; y < _height; y++) {
+        for (int x = 0; x < newWidth; x++) {
+            int newCell = y * newWidth + x;
+            bool alive;
+            if (x < keepWidth) {
+                int oldCell = y * _width + x;
+                alive = (_grid1[oldCell / 8] >> (oldCell % 8)) & 1;
+                if (_ageGrid) {
+                    ageGrid[newCell] = _ageGrid[oldCell];
+                }
+            } else {
+                alive = _rng.chance(_seedDensity);
+            }
+            if (alive) {
+                grid1[newCell / 8] |= (1 << (newCell % 8));
+            }
+        }
+    }
+
+    delete[] _grid1;
+    delete[] _grid2;
+    delete[] _ageGrid;
+    _grid1 = grid1;
+    _grid2 = grid2;
+    _ageGrid = ageGrid;
+    _width = newWidth;
+    _gridSizeBytes = newSizeBytes;
+
+    // Hashes of the old board no longer compare
+    resetHistory();
+    _stagnationCounter = 0;
+}
+
 // Randomize the grid with a given density (0-100%)
 void GameOfLifeAnimation::randomize(uint8_t density) {
     if (!_grid1 || !_grid2) return;
@@ -190,7 +256,7 @@ void GameOfLifeAnimation::randomize(uint8_t density) {
     _seedDensity = density;
 
     resetHistory();
-    _lastUpdateTime = millis();
+    _lastUpdateTime = AnimationClock::now();
     
     // Reset the simulation state
     memset(_grid1, 0, _gridSizeBytes);
@@ -199,17 +265,21 @@ void GameOfLifeAnimation::randomize(uint8_t density) {
         memset(_ageGrid, 0, _width * _height);
     }
     
-    // Add random live cells based on density
-    for (int y = 0; y < _height; y++) {
-        for (int x = 0; x < _width; x++) {
-            if (random(100) < density) {
-                // Set bit to 1 (cell alive)
-                int byteIndex = (y * _width + x) / 8;
-                int bitIndex = (y * _width + x) % 8;
-                _grid1[byteIndex] |= (1 << bitIndex);
-            }
+    // Seed 32 cells per draw; the grid is bit-packed in cell order, so
+    // each draw fills four bytes. The density is rounded to 1/256.
+    const uint16_t p256 = (density * 256 + 50) / 100;
+    for (int i = 0; i < _gridSizeBytes; i += 4) {
+        uint32_t word = _rng.bits(p256);
+        int n = std::min(4, _gridSizeBytes - i);
+        for (int b = 0; b < n; b++) {
+            _grid1[i + b] = (uint8_t)(word >> (8 * b));
         }
     }
+    // Bits past the last cell stay dead
+    int cells = _width * _height;
+    if (cells % 8) {
+        _grid1[cells / 8] &= (1 << (cells % 8)) - 1;
+    }
 }
 
 // Set a predefined pattern (future feature)
@@ -315,15 +385,13 @@ void GameOfLifeAnimation::drawGrid() {
     
     // Use color palette if available
     CRGB aliveColor = CRGB::Green; // Default live cell color
-    bool hasPalette = _currentPalette && !_currentPalette->empty();
-    if (hasPalette) {
-        aliveColor = (*_currentPalette)[0];
+    const PaletteLUT* lut = _lut.get();
+    if (lut) {
+        aliveColor = lut->colorAt(0);
     }
     
     // Clear all LEDs first
-    for (int i = 0; i < _numLeds; i++) {
-        leds[i] = CRGB::Black;
-    }
+    spanFill(_leds, _numLeds, CRGB::Black);
     
     // Draw live cells
     for (int y = 0; y < _height; y++) {
@@ -342,20 +410,16 @@ void GameOfLifeAnimation::drawGrid() {
                     CRGB color = aliveColor;
                     if (_colorMode == 1 && _ageGrid) {
                         uint8_t age = _ageGrid[y * _width + x];
-                        if (hasPalette) {
-                            size_t paletteSize = _currentPalette->size();
-                            size_t idx = (paletteSize > 1)
-                                ? (age * (paletteSize - 1)) / 255
-                                : 0;
-                            color = (*_currentPalette)[idx];
+                        if (lut) {
+                            color = lut->colorAt(age);
                         } else {
-                            color = CHSV(age, 255, 255);
+                            color = HueTable::color(age);
                         }
                     } else if (_colorMode == 2 && _ageGrid) {
                         uint8_t age = _ageGrid[y * _width + x];
-                        color = CHSV(age * 2, 255, 255);
+                        color = HueTable::color((uint8_t)(age * 2));
                     }
-                    leds[ledIndex] = color;
+                    _leds[ledIndex] = color;
                 }
             }
         }
@@ -482,6 +546,11 @@ uint32_t GameOfLifeAnimation::computeStateHash(const uint8_t* grid) const {
 // Set current palette
 void GameOfLifeAnimation::setCurrentPalette(int index) {
     if (_allPalettes && index >= 0 && index < _allPalettes->size()) {
-        _currentPalette = &(*_allPalettes)[index];
+        setPalette(&(*_allPalettes)[index]);
     }
 }
+
+// Ages run from the first stop to the last
+void GameOfLifeAnimation::setPalette(const std::vector<CRGB>* palette) {
+    _lut = palette ? PaletteLUT::compile(*palette, false) : nullptr;
+}
@@ -5,6 +5,8 @@
 #define GAMEOFLIFEANIMATION_H
 
 #include "BaseAnimation.h"
+#include "../PaletteLUT.h"
+#include "../FixedMath.h"
 #include <array>
 #include <vector>
 
@@ -19,13 +21,14 @@ public:
     // Virtual methods from BaseAnimation
     virtual void begin() override;
     virtual void update() override;
+    virtual void resize(uint16_t numLeds, int panelCount) override;
+    virtual void resume(uint32_t suspendedMs) override;
+    virtual size_t memoryUsage() const override;
     
     // Set simulation speed (interval between generations)
     void setSpeed(uint8_t speed) {
-        const long minInterval = 20;
-        const long maxInterval = 500;
-        long mapped = map(speed, 0, 255, minInterval, maxInterval);
-        _intervalMs = static_cast<uint32_t>(constrain(mapped, minInterval, maxInterval));
+        // 20 ms at 0 to 500 ms at 255
+        _intervalMs = static_cast<uint32_t>(fxLerp8(20, 500, speed));
     }
 
     // Life-like rules
@@ -64,7 +67,7 @@ public:
     // Palette support
     void setAllPalettes(const std::vector<std::vector<CRGB>>* allPalettes) { _allPalettes = allPalettes; }
     void setCurrentPalette(int index);
-    void setPalette(const std::vector<CRGB>* palette) { _currentPalette = palette; }
+    void setPalette(const std::vector<CRGB>* palette);
 
 private:
     // Update the simulation by one generation
@@ -110,7 +113,7 @@ private:
     
     // Color and palette
     const std::vector<std::vector<CRGB>>* _allPalettes;  // Pointer to all palettes
-    const std::vector<CRGB>* _currentPalette;           // Current palette
+    std::shared_ptr<const PaletteLUT> _lut;              // Current palette, compiled
 
     // Life-like rule masks
     uint16_t _birthMask;
@@ -2,14 +2,13 @@
 // Langton's Ant cellular automaton for LED matrices
 
 #include "LangtonsAntAnimation.h"
+#include "../HueTable.h"
 #include <Arduino.h>
 #include <FastLED.h>
 #include <cstring>
 #include <ctype.h>
 #include <new>
 
-extern CRGB leds[];
-
 LangtonsAntAnimation::LangtonsAntAnimation(uint16_t numLeds, uint8_t brightness, int panelCount)
     : BaseAnimation(numLeds, brightness, panelCount)
     , _panelCount(panelCount)
@@ -27,7 +26,6 @@ LangtonsAntAnimation::LangtonsAntAnimation(uint16_t numLeds, uint8_t brightness,
     , _stepsPerFrame(8)
     , _wrapEdges(true)
     , _cells(nullptr)
-    , _currentPalette(nullptr)
 {
     size_t cellCount = _width * _height;
     try {
@@ -47,14 +45,64 @@ LangtonsAntAnimation::~LangtonsAntAnimation() {
 }
 
 void LangtonsAntAnimation::begin() {
-    FastLED.clear(true);
-    _lastUpdate = millis();
+    clearTarget();
+    _lastUpdate = AnimationClock::now();
     resetSimulation();
 }
 
-void LangtonsAntAnimation::setBrightness(uint8_t b) {
-    _brightness = b;
-    FastLED.setBrightness(b);
+// Keeps the trail in the overlapping columns; ants beyond the new edge
+// re-enter from the left
+void LangtonsAntAnimation::resize(uint16_t numLeds, int panelCount) {
+    BaseAnimation::resize(numLeds, panelCount);
+    int newWidth = panelCount * 16;
+    if (newWidth == _width || !_cells) {
+        _panelCount = panelCount;
+        return;
+    }
+
+    uint8_t* cells = new (std::nothrow) uint8_t[newWidth * _height];
+    if (!cells) {
+        Serial.println("LangtonsAnt: Failed to allocate cell grid for resize");
+        return;
+    }
+    memset(cells, 0, newWidth * _height);
+    int keepWidth = _width < newWidth ? _width : newWidth;
+    for (int y = 0; y < _height; y++) {
+        memcpy(cells + y * newWidth, _cells + y * _width, keepWidth);
+    }
+
+    delete[] _cells;
+    _cells = cells;
+    _width = newWidth;
+    _panelCount = panelCount;
+
+    for (size_t i = 0; i < _ants.size(); i++) {
+        _ants[i].x %= _width;
+    }
+}
+
+// Replays the steps missed while suspended (bounded), so the pattern has
+// grown on return as if it had kept running
+void LangtonsAntAnimation::resume(uint32_t suspendedMs) {
+    if (!_cells || _ants.empty()) {
+        return;
+    }
+    uint32_t frames = _intervalMs ? suspendedMs / _intervalMs : 0;
+    uint32_t steps = frames * _stepsPerFrame;
+    uint32_t limit = MAX_CATCHUP_STEPS / _ants.size();
+    if (steps > limit) steps = limit;
+
+    for (uint32_t step = 0; step < steps; step++) {
+        for (size_t i = 0; i < _ants.size(); i++) {
+            stepAnt(_ants[i]);
+        }
+    }
+    _lastUpdate = AnimationClock::now();
+    drawGrid();
+}
+
+size_t LangtonsAntAnimation::memoryUsage() const {
+    return (size_t)_width * _height + _ants.capacity() * sizeof(Ant) + _rule.length();
 }
 
 void LangtonsAntAnimation::setRule(const String& rule) {
@@ -73,6 +121,10 @@ void LangtonsAntAnimation::setRule(const String& rule) {
     if (cleaned.length() == 0) {
         cleaned = "LR";
     }
+    if (cleaned == _rule) {
+        // Reapplied settings (e.g. on resume) must not wipe the trail
+        return;
+    }
     _rule = cleaned;
     _ruleLen = (uint8_t)_rule.length();
     resetSimulation();
@@ -81,6 +133,9 @@ void LangtonsAntAnimation::setRule(const String& rule) {
 void LangtonsAntAnimation::setAntCount(uint8_t count) {
     if (count < 1) count = 1;
     if (count > 6) count = 6;
+    if (count == _antCount) {
+        return;
+    }
     _antCount = count;
     resetSimulation();
 }
@@ -113,7 +168,7 @@ void LangtonsAntAnimation::update() {
     if (!_cells) {
         return;
     }
-    unsigned long now = millis();
+    unsigned long now = AnimationClock::now();
     if (now - _lastUpdate < _intervalMs) {
         return;
     }
@@ -125,7 +180,6 @@ void LangtonsAntAnimation::update() {
         }
     }
     drawGrid();
-    FastLED.show();
 }
 
 void LangtonsAntAnimation::stepAnt(Ant& ant) {
@@ -170,8 +224,8 @@ void LangtonsAntAnimation::stepAnt(Ant& ant) {
 void LangtonsAntAnimation::drawGrid() {
     if (!_cells) return;
 
-    bool hasPalette = _currentPalette && !_currentPalette->empty();
-    size_t paletteSize = hasPalette ? _currentPalette->size() : 0;
+    bool hasPalette = !_palette.empty();
+    size_t paletteSize = _palette.size();
 
     for (int y = 0; y < _height; y++) {
         for (int x = 0; x < _width; x++) {
@@ -180,15 +234,15 @@ void LangtonsAntAnimation::drawGrid() {
             CRGB color = CRGB::Black;
             if (state > 0) {
                 if (hasPalette) {
-                    color = (*_currentPalette)[state % paletteSize];
+                    color = _palette[state % paletteSize];
                 } else {
-                    color = CHSV(state * (255 / _ruleLen), 255, 255);
+                    color = HueTable::color((uint8_t)(state * (255 / _ruleLen)));
                 }
             }
 
             int ledIndex = mapXYtoLED(x, y);
             if (ledIndex >= 0 && ledIndex < _numLeds) {
-                leds[ledIndex] = color;
+                _leds[ledIndex] = color;
             }
         }
     }
@@ -197,11 +251,9 @@ void LangtonsAntAnimation::drawGrid() {
     for (size_t i = 0; i < _ants.size(); i++) {
         int ledIndex = mapXYtoLED(_ants[i].x, _ants[i].y);
         if (ledIndex >= 0 && ledIndex < _numLeds) {
-            leds[ledIndex] = CRGB::White;
+            _leds[ledIndex] = CRGB::White;
         }
     }
-
-    FastLED.setBrightness(_brightness);
 }
 
 int LangtonsAntAnimation::mapXYtoLED(int x, int y) const {
@@ -14,7 +14,9 @@ public:
 
     void begin() override;
     void update() override;
-    void setBrightness(uint8_t b) override;
+    void resize(uint16_t numLeds, int panelCount) override;
+    void resume(uint32_t suspendedMs) override;
+    size_t memoryUsage() const override;
 
     void setUpdateInterval(unsigned long intervalMs) { _intervalMs = intervalMs; }
     void setPanelOrder(int order) { _panelOrder = order; }
@@ -26,7 +28,7 @@ public:
     void setAntCount(uint8_t count);
     void setStepsPerFrame(uint8_t steps);
     void setWrapMode(bool wrap) { _wrapEdges = wrap; }
-    void setPalette(const std::vector<CRGB>* palette) { _currentPalette = palette; }
+    void setPalette(const std::vector<CRGB>* palette) { _palette = palette ? *palette : std::vector<CRGB>(); }
     void resetSimulation();
 
 private:
@@ -41,6 +43,9 @@ private:
     int mapXYtoLED(int x, int y) const;
     void rotateCoordinates(int& x, int& y, int angle) const;
 
+    // Upper bound on ant steps replayed by resume()
+    static const uint32_t MAX_CATCHUP_STEPS = 20000;
+
 private:
     int _panelCount;
     int _width;
@@ -60,7 +65,7 @@ private:
 
     uint8_t* _cells; // state per cell (0..ruleLen-1)
     std::vector<Ant> _ants;
-    const std::vector<CRGB>* _currentPalette;
+    std::vector<CRGB> _palette; // colour per cell state
 };
 
 #endif // LANGTONSANTANIMATION_H
@@ -1,11 +1,10 @@
 // File: RainbowWaveAnimation.cpp
 
 #include "RainbowWaveAnimation.h"
+#include "../HueTable.h"
 #include <Arduino.h>
 #include <FastLED.h>
 
-extern CRGB leds[];
-
 RainbowWaveAnimation::RainbowWaveAnimation(uint16_t numLeds, uint8_t brightness, int panelCount)
     : BaseAnimation(numLeds, brightness)
     , _panelCount(panelCount)
@@ -14,7 +13,7 @@ RainbowWaveAnimation::RainbowWaveAnimation(uint16_t numLeds, uint8_t brightness,
     , _intervalMs(8)  // Consistent fast frame rate for smooth animation
     , _lastUpdate(0)
     , _phase(0)
-    , _speedMultiplier(1.0f)  // Default speed
+    , _speedMultiplier(Q8_ONE)  // Default speed
     , _hueScale(4)
     , _panelOrder(1)
     , _rotationAngle1(90)
@@ -24,21 +23,20 @@ RainbowWaveAnimation::RainbowWaveAnimation(uint16_t numLeds, uint8_t brightness,
 }
 
 void RainbowWaveAnimation::begin() {
-    FastLED.clear(true);
+    clearTarget();
     _phase = 0;
-    _lastUpdate = millis();
+    _lastUpdate = AnimationClock::now();
 }
 
 void RainbowWaveAnimation::update() {
-    unsigned long now = millis();
+    unsigned long now = AnimationClock::now();
     if ((now - _lastUpdate) >= _intervalMs) {
         _lastUpdate = now;
         
         // Apply speed multiplier to phase increment
-        _phase += (uint8_t)(8 * _speedMultiplier);
+        _phase += (uint8_t)((8 * _speedMultiplier) >> 8);
         
         fillRainbowWave();
-        FastLED.show();
     }
 }
 
@@ -48,34 +46,33 @@ void RainbowWaveAnimation::fillRainbowWave() {
         for (int x = 0; x < _width; x++) {
             // compute hue based on x + _phase
             uint8_t hue = (x * _hueScale + _phase) & 255; 
-            CHSV colorHSV(hue, 255, 255);
-            CRGB colorRGB;
-            hsv2rgb_rainbow(colorHSV, colorRGB);
 
             // get index for (x,y) 
             int index = getLedIndex(x, y);
             if (index >= 0 && index < _numLeds) {
-                leds[index] = colorRGB;
+                _leds[index] = HueTable::color(hue);
             }
         }
     }
-    // Scale overall brightness
-    FastLED.setBrightness(_brightness);
 }
 
-void RainbowWaveAnimation::setBrightness(uint8_t b) {
-    _brightness = b;
-    FastLED.setBrightness(b);
+// Stateless per frame; the next frame simply covers the new width
+void RainbowWaveAnimation::resize(uint16_t numLeds, int panelCount) {
+    BaseAnimation::resize(numLeds, panelCount);
+    _panelCount = panelCount;
+    _width = panelCount * 16;
 }
 
 void RainbowWaveAnimation::setUpdateInterval(unsigned long intervalMs) {
     _intervalMs = intervalMs;
 }
 
-void RainbowWaveAnimation::setSpeedMultiplier(float speedMultiplier) {
+void RainbowWaveAnimation::setSpeedMultiplier(q8_8 speedMultiplier) {
     // Limit to reasonable range (0.1 to 5.0)
-    if (speedMultiplier < 0.1f) speedMultiplier = 0.1f;
-    if (speedMultiplier > 5.0f) speedMultiplier = 5.0f;
+    const q8_8 minMultiplier = Q8_ONE / 10;
+    const q8_8 maxMultiplier = 5 * Q8_ONE;
+    if (speedMultiplier < minMultiplier) speedMultiplier = minMultiplier;
+    if (speedMultiplier > maxMultiplier) speedMultiplier = maxMultiplier;
     _speedMultiplier = speedMultiplier;
 }
 
@@ -3,6 +3,7 @@
 
 #include "BaseAnimation.h"
 #include <FastLED.h>
+#include "../FixedMath.h"
 
 /**
  * A "Rainbow Wave" animation that scrolls a rainbow horizontally across a variable
@@ -21,9 +22,9 @@ public:
     void begin() override;
     void update() override;
 
-    void setBrightness(uint8_t b) override;
+    void resize(uint16_t numLeds, int panelCount) override;
     void setUpdateInterval(unsigned long intervalMs);
-    void setSpeedMultiplier(float speedMultiplier);
+    void setSpeedMultiplier(q8_8 speedMultiplier);
     void setHueScale(uint8_t scale);
 
     // Dynamic panel geometry
@@ -45,7 +46,7 @@ private:
 
     // Phase offset in hue
     uint8_t       _phase;
-    float         _speedMultiplier;  // Controls how fast colors change (1.0 = normal)
+    q8_8          _speedMultiplier;  // Controls how fast colors change (Q8_ONE = normal)
     uint8_t       _hueScale;
 
     // Panel geometry
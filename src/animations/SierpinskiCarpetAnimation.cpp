@@ -2,10 +2,13 @@
 // Recursive Sierpinski carpet fractal for LED matrices
 
 #include "SierpinskiCarpetAnimation.h"
+#include "../HueTable.h"
 #include <Arduino.h>
 #include <FastLED.h>
 
-extern CRGB leds[];
+// Gradient entries per diagonal step: the wrapped palette repeats every
+// 256 / GRADIENT_STEP diagonals, and a phase step moves it by one
+static const int GRADIENT_STEP = 16;
 
 SierpinskiCarpetAnimation::SierpinskiCarpetAnimation(uint16_t numLeds, uint8_t brightness, int panelCount)
     : BaseAnimation(numLeds, brightness, panelCount)
@@ -22,18 +25,18 @@ SierpinskiCarpetAnimation::SierpinskiCarpetAnimation(uint16_t numLeds, uint8_t b
     , _rotationAngle1(0)
     , _rotationAngle2(0)
     , _rotationAngle3(0)
-    , _currentPalette(nullptr)
 {
 }
 
 void SierpinskiCarpetAnimation::begin() {
-    FastLED.clear(true);
-    _lastUpdate = millis();
+    clearTarget();
+    _lastUpdate = AnimationClock::now();
 }
 
-void SierpinskiCarpetAnimation::setBrightness(uint8_t b) {
-    _brightness = b;
-    FastLED.setBrightness(b);
+void SierpinskiCarpetAnimation::resize(uint16_t numLeds, int panelCount) {
+    BaseAnimation::resize(numLeds, panelCount);
+    _panelCount = panelCount;
+    _width = panelCount * 16;
 }
 
 void SierpinskiCarpetAnimation::setDepth(uint8_t depth) {
@@ -43,14 +46,13 @@ void SierpinskiCarpetAnimation::setDepth(uint8_t depth) {
 }
 
 void SierpinskiCarpetAnimation::update() {
-    unsigned long now = millis();
+    unsigned long now = AnimationClock::now();
     if (now - _lastUpdate < _intervalMs) {
         return;
     }
     _lastUpdate = now;
     _phase += _colorShift;
     drawCarpet();
-    FastLED.show();
 }
 
 void SierpinskiCarpetAnimation::drawCarpet() {
@@ -60,8 +62,7 @@ void SierpinskiCarpetAnimation::drawCarpet() {
     int offsetX = (_width - size) / 2;
     int offsetY = (_height - size) / 2;
 
-    bool hasPalette = _currentPalette && !_currentPalette->empty();
-    size_t paletteSize = hasPalette ? _currentPalette->size() : 0;
+    const PaletteLUT* lut = _lut.get();
 
     for (int y = 0; y < _height; y++) {
         for (int x = 0; x < _width; x++) {
@@ -73,22 +74,24 @@ void SierpinskiCarpetAnimation::drawCarpet() {
                 bool hole = isCarpetHole(localX, localY, size, _depth);
                 bool draw = _invert ? hole : !hole;
                 if (draw) {
-                    if (hasPalette) {
-                        size_t idx = (localX + localY + _phase) % paletteSize;
-                        color = (*_currentPalette)[idx];
+                    if (lut) {
+                        color = lut->colorAt((uint8_t)((localX + localY + _phase) * GRADIENT_STEP));
                     } else {
-                        color = CHSV((uint8_t)(localX * 4 + localY * 3 + _phase), 255, 255);
+                        color = HueTable::color((uint8_t)(localX * 4 + localY * 3 + _phase));
                     }
                 }
             }
 
             int ledIndex = mapXYtoLED(x, y);
             if (ledIndex >= 0 && ledIndex < _numLeds) {
-                leds[ledIndex] = color;
+                _leds[ledIndex] = color;
             }
         }
     }
-    FastLED.setBrightness(_brightness);
+}
+
+void SierpinskiCarpetAnimation::setPalette(const std::vector<CRGB>* palette) {
+    _lut = palette ? PaletteLUT::compile(*palette, true) : nullptr;
 }
 
 bool SierpinskiCarpetAnimation::isCarpetHole(int x, int y, int size, int depth) const {
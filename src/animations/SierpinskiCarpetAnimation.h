@@ -5,6 +5,7 @@
 #define SIERPINSKICARPETANIMATION_H
 
 #include "BaseAnimation.h"
+#include "../PaletteLUT.h"
 #include <vector>
 
 class SierpinskiCarpetAnimation : public BaseAnimation {
@@ -14,7 +15,8 @@ public:
 
     void begin() override;
     void update() override;
-    void setBrightness(uint8_t b) override;
+    void resize(uint16_t numLeds, int panelCount) override;
+    size_t memoryUsage() const override { return _lut ? sizeof(PaletteLUT) : 0; }
 
     void setUpdateInterval(unsigned long intervalMs) { _intervalMs = intervalMs; }
     void setPanelOrder(int order) { _panelOrder = order; }
@@ -25,7 +27,7 @@ public:
     void setDepth(uint8_t depth);
     void setInvert(bool invert) { _invert = invert; }
     void setColorShift(uint8_t shift) { _colorShift = shift; }
-    void setPalette(const std::vector<CRGB>* palette) { _currentPalette = palette; }
+    void setPalette(const std::vector<CRGB>* palette);
 
 private:
     void drawCarpet();
@@ -47,7 +49,7 @@ private:
     int _rotationAngle1;
     int _rotationAngle2;
     int _rotationAngle3;
-    const std::vector<CRGB>* _currentPalette;
+    std::shared_ptr<const PaletteLUT> _lut;
 };
 
 #endif // SIERPINSKICARPETANIMATION_H
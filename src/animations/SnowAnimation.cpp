@@ -0,0 +1,140 @@
+// File: SnowAnimation.cpp
+// Drifting snow on the particle engine
+
+#include "SnowAnimation.h"
+#include "../PixelKernels.h"
+#include <Arduino.h>
+#include <FastLED.h>
+
+// Pixels per step: flakes settle at FALL_SPEED, the wind swings between
+// +/- WIND_SPEED over a cycle of 65536 / WIND_STEP steps
+static const q16_16 FALL_SPEED = 5243;      // 0.08
+static const q16_16 WIND_SPEED = 3932;      // 0.06
+static const q16_16 AIR_DRAG = 1966;        // 3% of the difference per step
+static const angle16 WIND_STEP = 96;
+
+SnowAnimation::SnowAnimation(uint16_t numLeds, uint8_t brightness, int panelCount)
+    : BaseAnimation(numLeds, brightness, panelCount)
+    , _intervalMs(38)
+    , _lastUpdate(0)
+    , _panelOrder(1)
+    , _rotationAngle1(90)
+    , _rotationAngle2(90)
+    , _rotationAngle3(90)
+    , _spawnRate(1.0f)
+    , _maxFlakes(200)
+    , _fadeAmount(64)
+    , _windPhase(0)
+{
+    _emitter.shape = ParticleSystem::SHAPE_EDGE_TOP;
+    _emitter.direction = ANGLE_QUARTER;     // down
+    _emitter.spread = fxDegrees(40);
+    _emitter.speedMin = 1966;               // 0.03
+    _emitter.speedMax = 6554;               // 0.1
+
+    _forces.windY = FALL_SPEED;
+    _forces.drag = AIR_DRAG;
+
+    relayout();
+    applyRate();
+}
+
+void SnowAnimation::begin() {
+    clearTarget();
+    reservePool();
+    _emitter.carry = 0;
+    _windPhase = 0;
+    _lastUpdate = AnimationClock::now();
+}
+
+void SnowAnimation::update() {
+    unsigned long now = AnimationClock::now();
+    if (now - _lastUpdate < _intervalMs) {
+        return;
+    }
+    _lastUpdate = now;
+
+    _windPhase += WIND_STEP;
+    _forces.windX = q16Mul(fxSin(_windPhase), WIND_SPEED);
+
+    _particles.emit(_emitter, _rng);
+    _particles.step(_forces);
+
+    spanFade(_leds, _numLeds, _fadeAmount);
+    _particles.render(_leds, _layout, _look);
+}
+
+// Flakes keep falling; those past a narrower canvas wrap back in. The
+// pool follows the panel count, keeping the flakes that fit.
+void SnowAnimation::resize(uint16_t numLeds, int panelCount) {
+    BaseAnimation::resize(numLeds, panelCount);
+    relayout();
+    applyRate();
+    if (_particles.capacity() > 0) {
+        resizePool();
+    }
+}
+
+size_t SnowAnimation::memoryUsage() const {
+    return sizeof(PanelLayout) + _particles.bytes() + (_look.lut ? sizeof(PaletteLUT) : 0);
+}
+
+void SnowAnimation::setPanelOrder(int order) {
+    _panelOrder = order;
+    relayout();
+}
+
+void SnowAnimation::setRotationAngle1(int angle) {
+    _rotationAngle1 = angle;
+    relayout();
+}
+
+void SnowAnimation::setRotationAngle2(int angle) {
+    _rotationAngle2 = angle;
+    relayout();
+}
+
+void SnowAnimation::setRotationAngle3(int angle) {
+    _rotationAngle3 = angle;
+    relayout();
+}
+
+void SnowAnimation::setSpawnRate(float rate) {
+    _spawnRate = rate;
+    applyRate();
+}
+
+// A running pool is resized on the spot; flakes beyond a smaller limit go
+void SnowAnimation::setMaxFlakes(int max) {
+    _maxFlakes = max < 1 ? 1 : max;
+    if (_particles.capacity() > 0) {
+        resizePool();
+    }
+}
+
+void SnowAnimation::setPalette(const std::vector<CRGB>* palette) {
+    _look.lut = palette ? PaletteLUT::compile(*palette, false) : nullptr;
+}
+
+void SnowAnimation::relayout() {
+    const int rotations[3] = { _rotationAngle1, _rotationAngle2, _rotationAngle3 };
+    _layout.configure(_panelCount, _panelOrder, rotations);
+    _particles.setBounds(_layout.width(), _layout.height(), true);
+}
+
+uint16_t SnowAnimation::poolCapacity() const {
+    int capacity = _maxFlakes * _panelCount;
+    return (uint16_t)(capacity > MAX_POOL ? MAX_POOL : capacity);
+}
+
+void SnowAnimation::reservePool() {
+    _particles.reserve(poolCapacity());
+}
+
+void SnowAnimation::resizePool() {
+    _particles.resize(poolCapacity());
+}
+
+void SnowAnimation::applyRate() {
+    _emitter.rate = q8(_spawnRate * _panelCount * 0.5f);
+}
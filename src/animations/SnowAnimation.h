@@ -0,0 +1,70 @@
+// File: SnowAnimation.h
+// Drifting snow on the particle engine
+
+#ifndef SNOWANIMATION_H
+#define SNOWANIMATION_H
+
+#include "BaseAnimation.h"
+#include "../PanelLayout.h"
+#include "../ParticleSystem.h"
+#include <vector>
+
+/**
+ * Flakes enter along the top edge and settle to a slow fall through drag,
+ * while a wind that swings back and forth pushes them sideways; they wrap
+ * around the sides and melt away below the bottom edge. Each flake keeps
+ * one colour from the palette, and the fade amount leaves short trails.
+ *
+ * The pool holds maxFlakes per panel, so flake density stays the same on
+ * any number of panels.
+ */
+class SnowAnimation : public BaseAnimation {
+public:
+    SnowAnimation(uint16_t numLeds, uint8_t brightness, int panelCount = 2);
+
+    void begin() override;
+    void update() override;
+    void resize(uint16_t numLeds, int panelCount) override;
+    size_t memoryUsage() const override;
+
+    void setUpdateInterval(unsigned long intervalMs) { _intervalMs = intervalMs; }
+    void setPanelOrder(int order);
+    void setRotationAngle1(int angle);
+    void setRotationAngle2(int angle);
+    void setRotationAngle3(int angle);
+
+    // 1.0 = a new flake every other step on each panel
+    void setSpawnRate(float rate);
+    void setMaxFlakes(int max);
+    void setFadeAmount(uint8_t amount) { _fadeAmount = amount; }
+    void setPalette(const std::vector<CRGB>* palette);
+
+private:
+    void relayout();
+    uint16_t poolCapacity() const;
+    void reservePool();
+    void resizePool();
+    void applyRate();
+
+    static const uint16_t MAX_POOL = 4096;
+
+    unsigned long _intervalMs;
+    unsigned long _lastUpdate;
+    int _panelOrder;
+    int _rotationAngle1;
+    int _rotationAngle2;
+    int _rotationAngle3;
+
+    float _spawnRate;
+    int _maxFlakes;
+    uint8_t _fadeAmount;
+    angle16 _windPhase;
+
+    ParticleSystem _particles;
+    ParticleSystem::Emitter _emitter;
+    ParticleSystem::Forces _forces;
+    ParticleSystem::Look _look;
+    PanelLayout _layout;
+};
+
+#endif // SNOWANIMATION_H
@@ -0,0 +1,189 @@
+// File: TextAnimation.cpp
+// Scrolling messages and a clock drawn with the bitmap fonts
+
+#include "TextAnimation.h"
+#include "../HueTable.h"
+#include <Arduino.h>
+#include <FastLED.h>
+#include <time.h>
+
+// How often the clock text is checked for a change
+static const unsigned long CLOCK_CHECK_MS = 1000;
+
+TextAnimation::TextAnimation(uint16_t numLeds, uint8_t brightness, int panelCount)
+    : BaseAnimation(numLeds, brightness, panelCount)
+    , _lastUpdate(0)
+    , _lastClockCheck(0)
+    , _message("Hello")
+    , _mode(MODE_MESSAGE)
+    , _fontId(FONT_5X7)
+    , _scrollSpeed(12)
+    , _scrollPos(0)
+    , _panelOrder(0)
+    , _rotationAngle1(0)
+    , _rotationAngle2(0)
+    , _rotationAngle3(0)
+{
+    relayout();
+}
+
+void TextAnimation::begin() {
+    clearTarget();
+    _lastUpdate = AnimationClock::now();
+    _lastClockCheck = 0;
+    _scrollPos = 0;
+    refreshStrip();
+}
+
+void TextAnimation::resize(uint16_t numLeds, int panelCount) {
+    BaseAnimation::resize(numLeds, panelCount);
+    relayout();
+}
+
+size_t TextAnimation::memoryUsage() const {
+    return sizeof(PanelLayout) + _message.length() + _shownText.length();
+}
+
+void TextAnimation::setPanelOrder(int order) {
+    _panelOrder = order;
+    relayout();
+}
+
+void TextAnimation::setRotationAngle1(int angle) {
+    _rotationAngle1 = angle;
+    relayout();
+}
+
+void TextAnimation::setRotationAngle2(int angle) {
+    _rotationAngle2 = angle;
+    relayout();
+}
+
+void TextAnimation::setRotationAngle3(int angle) {
+    _rotationAngle3 = angle;
+    relayout();
+}
+
+void TextAnimation::relayout() {
+    const int rotations[3] = { _rotationAngle1, _rotationAngle2, _rotationAngle3 };
+    _layout.configure(_panelCount, _panelOrder, rotations);
+}
+
+void TextAnimation::setMessage(const String& message) {
+    if (message == _message) {
+        return;
+    }
+    _message = message;
+    if (_mode == MODE_MESSAGE) {
+        _scrollPos = 0;
+        refreshStrip();
+    }
+}
+
+void TextAnimation::setMode(uint8_t mode) {
+    if (mode >= MODE_COUNT) mode = MODE_MESSAGE;
+    if (mode == _mode) {
+        return;
+    }
+    _mode = mode;
+    _scrollPos = 0;
+    _lastClockCheck = 0;
+    refreshStrip();
+}
+
+void TextAnimation::setFont(uint8_t fontId) {
+    if (fontId >= FONT_COUNT) fontId = FONT_5X7;
+    if (fontId == _fontId) {
+        return;
+    }
+    _fontId = fontId;
+    refreshStrip();
+}
+
+void TextAnimation::setScrollSpeed(uint8_t columnsPerSecond) {
+    if (columnsPerSecond < 1) columnsPerSecond = 1;
+    if (columnsPerSecond > 100) columnsPerSecond = 100;
+    _scrollSpeed = columnsPerSecond;
+}
+
+// Picks the text for the current mode and fetches its strip; the cache
+// renders it only the first time
+void TextAnimation::refreshStrip() {
+    String text = _message;
+    if (_mode == MODE_CLOCK) {
+        struct tm timeinfo;
+        char buffer[8];
+        if (getLocalTime(&timeinfo, 0)) {
+            strftime(buffer, sizeof(buffer), "%H:%M", &timeinfo);
+            text = buffer;
+        } else {
+            text = "--:--";
+        }
+    }
+    if (_strip && text == _shownText && _strip->fontId == _fontId) {
+        return;
+    }
+    _shownText = text;
+    _strip = TextCache::getInstance().get(_fontId, _shownText);
+}
+
+void TextAnimation::update() {
+    unsigned long now = AnimationClock::now();
+    unsigned long elapsed = now - _lastUpdate;
+    _lastUpdate = now;
+
+    if (_mode == MODE_CLOCK && now - _lastClockCheck >= CLOCK_CHECK_MS) {
+        _lastClockCheck = now;
+        refreshStrip();
+    }
+
+    // Elapsed time is capped so a stall does not jump the text
+    if (elapsed > 250) elapsed = 250;
+    _scrollPos += (uint32_t)elapsed * _scrollSpeed * 256 / 1000;
+
+    drawText();
+}
+
+void TextAnimation::drawText() {
+    clearTarget();
+    if (!_strip || _strip->columns.empty()) {
+        return;
+    }
+
+    const int width = _layout.width();
+    const int height = _layout.height();
+    const int length = _strip->width();
+    const int textHeight = _strip->height < height ? _strip->height : height;
+    const int top = (height - textHeight) / 2;
+    const uint8_t* columns = _strip->columns.data();
+    const uint8_t advance = fontById(_strip->fontId).advance();
+
+    // Canvas column x shows strip column x - origin
+    int origin;
+    if (_mode == MODE_CLOCK && length <= width) {
+        origin = (width - length) / 2;
+    } else {
+        // Text enters at the right edge and leaves fully before re-entering
+        int period = length + width;
+        origin = width - (int)((_scrollPos >> 8) % (uint32_t)period);
+    }
+
+    bool hasPalette = !_palette.empty();
+    int xStart = origin > 0 ? origin : 0;
+    int xEnd = origin + length < width ? origin + length : width;
+    for (int x = xStart; x < xEnd; x++) {
+        int column = x - origin;
+        uint8_t bits = columns[column];
+        if (!bits) continue;
+
+        int glyph = column / advance;
+        CRGB color = hasPalette
+            ? _palette[glyph % _palette.size()]
+            : HueTable::color((uint8_t)(glyph * 24));
+        for (int row = 0; row < textHeight; row++) {
+            if (bits & (1 << row)) {
+                _leds[_layout.index(x, top + row)] = color;
+            }
+        }
+    }
+}
@@ -0,0 +1,73 @@
+// File: TextAnimation.h
+// Scrolling messages and a clock drawn with the bitmap fonts
+
+#ifndef TEXTANIMATION_H
+#define TEXTANIMATION_H
+
+#include "BaseAnimation.h"
+#include "../PanelLayout.h"
+#include "../TextCache.h"
+#include <vector>
+
+/**
+ * Shows either a message or the local time (HH:MM) on a black background.
+ * Text is fetched from TextCache as a pre-rendered strip, so a frame only
+ * looks up one column per canvas pixel regardless of the message length.
+ * Messages always scroll right to left; the clock stands centred when it
+ * fits and scrolls otherwise. Over another animation, use it as a layer
+ * with a luma mask.
+ */
+class TextAnimation : public BaseAnimation {
+public:
+    enum Mode : uint8_t {
+        MODE_MESSAGE = 0,
+        MODE_CLOCK,
+        MODE_COUNT
+    };
+
+    TextAnimation(uint16_t numLeds, uint8_t brightness, int panelCount = 2);
+    virtual ~TextAnimation() {}
+
+    void begin() override;
+    void update() override;
+    void resize(uint16_t numLeds, int panelCount) override;
+    size_t memoryUsage() const override;
+
+    void setPanelOrder(int order);
+    void setRotationAngle1(int angle);
+    void setRotationAngle2(int angle);
+    void setRotationAngle3(int angle);
+
+    void setMessage(const String& message);
+    void setMode(uint8_t mode);
+    void setFont(uint8_t fontId);
+    void setScrollSpeed(uint8_t columnsPerSecond);
+    void setPalette(const std::vector<CRGB>* palette) { _palette = palette ? *palette : std::vector<CRGB>(); }
+
+private:
+    void refreshStrip();
+    void drawText();
+    void relayout();
+
+private:
+    unsigned long _lastUpdate;
+    unsigned long _lastClockCheck;
+
+    String _message;
+    String _shownText;
+    uint8_t _mode;
+    uint8_t _fontId;
+    uint8_t _scrollSpeed;
+    uint32_t _scrollPos;   // columns x 256
+
+    std::shared_ptr<const TextStrip> _strip;
+
+    int _panelOrder;
+    int _rotationAngle1;
+    int _rotationAngle2;
+    int _rotationAngle3;
+    std::vector<CRGB> _palette;
+    PanelLayout _layout;
+};
+
+#endif // TEXTANIMATION_H
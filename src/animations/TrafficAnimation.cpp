@@ -1,9 +1,9 @@
 #include "TrafficAnimation.h"
+#include "../Canvas.h"
+#include "../PixelKernels.h"
 #include <Arduino.h>
 #include <FastLED.h>
 
-extern CRGB leds[]; // from LEDManager
-
 TrafficAnimation::TrafficAnimation(uint16_t totalLeds, uint8_t brightness, int panelCount)
     : BaseAnimation(totalLeds, brightness)
     , _panelCount(panelCount <= 0 || panelCount > 2 ? 2 : panelCount) // Ensure panel count is valid, max 2
@@ -22,6 +22,8 @@ TrafficAnimation::TrafficAnimation(uint16_t totalLeds, uint8_t brightness, int p
     , _rotationAngle2(90)
     , _rotationAngle3(90)
 {
+    relayout();
+
     // Additional safety initialization
     Serial.printf("TrafficAnimation created with panel count: %d (Width: %d, Height: %d, LEDs: %d)\n", 
                  _panelCount, _width, _height, _numLeds);
@@ -39,11 +41,13 @@ TrafficAnimation::TrafficAnimation(uint16_t totalLeds, uint8_t brightness, int p
 
 void TrafficAnimation::begin() {
     _cars.clear();
-    FastLED.clear(true);
+    _accum.resize(_numLeds);
+    _accum.clear();
+    clearTarget();
 }
 
 void TrafficAnimation::update() {
-    unsigned long now = millis();
+    unsigned long now = AnimationClock::now();
     if ((now - _lastUpdate) >= _updateInterval) {
         performTrafficEffect();
         _lastUpdate = now;
@@ -56,14 +60,22 @@ void TrafficAnimation::performTrafficEffect() {
         return;
     }
 
-    fadeToBlackBy(leds, _numLeds, _fadeAmount);
+    const bool accumulate = _accum.size() == _numLeds;
+    if (accumulate) {
+        _accum.fade(255 - _fadeAmount);
+    } else {
+        spanFade(_leds, _numLeds, _fadeAmount);
+    }
 
-    if (random(1000) < (int)(_spawnRate * 1000) &&
+    if ((int)_rng.below(1000) < (int)(_spawnRate * 1000) &&
         (int)_cars.size() < _maxCars)
     {
         spawnCar();
     }
 
+    Canvas canvas(_leds, _layout);
+    canvas.setMode(Canvas::DRAW_ADD);
+
     auto it = _cars.begin();
     while (it != _cars.end()) {
         it->x += it->dx;
@@ -81,44 +93,38 @@ void TrafficAnimation::performTrafficEffect() {
             it->frac = 1.0f;
         }
 
-        CRGB mainC = calcColor(it->frac, it->startColor, it->endColor, it->bounce);
-        mainC.nscale8(_brightness);
-
-        int idx = getLedIndex(it->x, it->y);
-        if (idx >= 0 && idx < (int)_numLeds) {
-            leds[idx] += mainC;
+        CRGB mainC = calcColor(*it);
+        if (accumulate) {
+            _accum.add(_layout.index(it->x, it->y), mainC);
+        } else {
+            canvas.pixel(it->x, it->y, mainC);
         }
 
-        // tail - with additional safety checks
+        // tail, clipped at the canvas edge
         for(int t=1; t<=_tailLength && t <= 10; t++) { // Add max limit to tail length
-            int tx = it->x - t*it->dx;
-            int ty = it->y - t*it->dy;
-            
-            // Skip out-of-bounds coordinates
-            if(tx<0 || tx>=_width || ty<0 || ty>=_height) {
-                break; // Exit tail loop for this car
-            }
-            
-            int tidx = getLedIndex(tx, ty);
-            
-            // Validate LED index strictly
-            if(tidx<0 || tidx>=(int)_numLeds) {
-                break; // Exit tail loop for this car
-            }
-            
-            // Safety check before accessing leds array
-            if (tidx >= 0 && tidx < (int)_numLeds) {
-                float fracScale = 1.0f - (float)t / (float)(_tailLength + 1);
-                uint8_t tailB = (uint8_t)(_brightness * fracScale);
-                if(tailB < 10) tailB=10;
+            float fracScale = 1.0f - (float)t / (float)(_tailLength + 1);
+            uint8_t tailB = (uint8_t)(255 * fracScale);
+            if(tailB < 10) tailB=10;
+            const int tx = it->x - t*it->dx;
+            const int ty = it->y - t*it->dy;
+            if (accumulate) {
+                const int idx = _layout.indexChecked(tx, ty);
+                if (idx >= 0) {
+                    _accum.addScaled(idx, mainC, tailB);
+                }
+            } else {
                 CRGB tailCol = mainC;
                 tailCol.nscale8(tailB);
-                leds[tidx] += tailCol;
+                canvas.pixel(tx, ty, tailCol);
             }
         }
 
         ++it;
     }
+
+    if (accumulate) {
+        _accum.toneMap(_leds);
+    }
 }
 
 void TrafficAnimation::spawnCar() {
@@ -132,41 +138,33 @@ void TrafficAnimation::spawnCar() {
     int safeWidth = safePanelCount * 16;
     
     TrafficCar c;
-    int edge = random(0,4);
+    int edge = _rng.below(4);
 
-    // pick random start/end from current palette
-    if(_allPalettes) {
-        const auto& pal = (*_allPalettes)[_currentPalette]; // Use const reference here
-        if(pal.size() >= 2) {
-            c.startColor = pal[random(pal.size())];
-            c.endColor = pal[random(pal.size())];
-        }
-    } else {
-        c.startColor = CRGB::Red;
-        c.endColor   = CRGB::Blue;
-    }
+    // pick random start/end positions on the palette gradient
+    c.start = _rng.byte();
+    c.end = _rng.byte();
     c.bounce = false;
     c.frac   = 0.0f;
 
     switch(edge){
         case 0: // top
-            c.x = random(0, safeWidth);
+            c.x = _rng.below(safeWidth);
             c.y = 0;
             c.dx = 0; c.dy = 1;
             break;
         case 1: // bottom
-            c.x = random(0, safeWidth);
+            c.x = _rng.below(safeWidth);
             c.y = _height - 1;
             c.dx = 0; c.dy = -1;
             break;
         case 2: // left
             c.x = 0;
-            c.y = random(0, _height);
+            c.y = _rng.below(_height);
             c.dx = 1; c.dy = 0;
             break;
         case 3: // right
             c.x = safeWidth - 1;
-            c.y = random(0, _height);
+            c.y = _rng.below(_height);
             c.dx = -1; c.dy = 0;
             break;
     }
@@ -177,107 +175,64 @@ void TrafficAnimation::spawnCar() {
     }
 }
 
-CRGB TrafficAnimation::calcColor(float frac, CRGB startC, CRGB endC, bool bounce) {
-    if(!bounce){
-        return blend(startC, endC, (uint8_t)(frac * 255));
-    } else {
-        if(frac <= 0.5f){
-            return blend(startC, endC, (uint8_t)(frac*2*255));
-        } else {
-            return blend(endC, startC, (uint8_t)((frac-0.5f)*2*255));
-        }
-    }
-}
-
-int TrafficAnimation::getLedIndex(int x, int y) const {
-    // Validate input coordinates
-    if (x < 0 || y < 0 || x >= _width || y >= _height) {
-        return -1;
-    }
-
-    // Ensure panel count is valid and clamped to 2
-    int safetyPanelCount = (_panelCount <= 0 || _panelCount > 2) ? 2 : _panelCount;
-    
-    // which panel?
-    int panel = x / 16;
-    if (panel < 0 || panel >= safetyPanelCount) {
-        return -1;
-    }
-    
-    int localX = x % 16;
-    int localY = y;
-
-    // rotate - only handle panels 0 and 1 since we're enforcing max of 2 panels
-    switch(panel) {
-        case 0: rotateCoordinates(localX, localY, _rotationAngle1); break;
-        case 1: rotateCoordinates(localX, localY, _rotationAngle2); break;
-        default: break; // No need to handle more than 2 panels
+CRGB TrafficAnimation::calcColor(const TrafficCar& car) const {
+    float t = car.frac;
+    if (car.bounce) {
+        t = t <= 0.5f ? t * 2 : (1.0f - t) * 2;
     }
-
-    // zigzag
-    if (localY % 2 != 0) {
-        localX = (16 - 1) - localX;
+    if (!_lut) {
+        return blend(CRGB::Red, CRGB::Blue, (uint8_t)(t * 255));
     }
+    return _lut->colorAt((uint8_t)(car.start + (int)((car.end - car.start) * t)));
+}
 
-    // base index - only handle values 0 and 1 for _panelOrder
-    int base;
-    if (_panelOrder == 0) {
-        base = panel * 16 * 16;
-    } else {
-        base = (safetyPanelCount - 1 - panel) * 16 * 16;
-    }
-    
-    int idx = base + localY * 16 + localX;
-    
-    // Validate final index
-    if (idx < 0 || idx >= (int)_numLeds) {
-        return -1;
-    }
-    
-    return idx;
+void TrafficAnimation::compilePalette() {
+    _lut = _allPalettes && _currentPalette >= 0 && _currentPalette < (int)_allPalettes->size()
+        ? PaletteLUT::compile((*_allPalettes)[_currentPalette], false)
+        : nullptr;
 }
 
-void TrafficAnimation::rotateCoordinates(int &x, int &y, int angle) const {
-    int tmpX, tmpY;
-    switch(angle){
-        case 0: break;
-        case 90:
-            tmpX=y;
-            tmpY=15 - x;
-            x=tmpX; y=tmpY;
-            break;
-        case 180:
-            tmpX=15 - x;
-            tmpY=15 - y;
-            x=tmpX; y=tmpY;
-            break;
-        case 270:
-            tmpX=15 - y;
-            tmpY=x;
-            x=tmpX; y=tmpY;
-            break;
-        default:
-            break;
-    }
+void TrafficAnimation::relayout() {
+    const int rotations[3] = { _rotationAngle1, _rotationAngle2, _rotationAngle3 };
+    _layout.configure(_panelCount, _panelOrder, rotations);
 }
 
 // ------- Setters -------
 void TrafficAnimation::setBrightness(uint8_t b) {
     _brightness = b;
 }
+
+// Cars stay where they are; those beyond the new width are dropped
+void TrafficAnimation::resize(uint16_t totalLeds, int panelCount) {
+    BaseAnimation::resize(totalLeds, panelCount);
+    _panelCount = panelCount <= 0 || panelCount > 2 ? 2 : panelCount;
+    _width = _panelCount * 16;
+    relayout();
+    _accum.resize(_numLeds);
+
+    auto it = _cars.begin();
+    while (it != _cars.end()) {
+        if (it->x >= _width) {
+            it = _cars.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
 void TrafficAnimation::setUpdateInterval(unsigned long interval) {
     _updateInterval = interval;
 }
-void TrafficAnimation::setPanelOrder(int order)         { _panelOrder     = order; }
-void TrafficAnimation::setRotationAngle1(int angle)     { _rotationAngle1 = angle; }
-void TrafficAnimation::setRotationAngle2(int angle)     { _rotationAngle2 = angle; }
-void TrafficAnimation::setRotationAngle3(int angle)     { _rotationAngle3 = angle; }
+void TrafficAnimation::setPanelOrder(int order)         { _panelOrder     = order; relayout(); }
+void TrafficAnimation::setRotationAngle1(int angle)     { _rotationAngle1 = angle; relayout(); }
+void TrafficAnimation::setRotationAngle2(int angle)     { _rotationAngle2 = angle; relayout(); }
+void TrafficAnimation::setRotationAngle3(int angle)     { _rotationAngle3 = angle; relayout(); }
 
 void TrafficAnimation::setSpawnRate(float rate)         { _spawnRate      = rate; }
 void TrafficAnimation::setMaxCars(int max)              { _maxCars        = max; }
 void TrafficAnimation::setTailLength(int length)        { _tailLength     = length; }
 void TrafficAnimation::setFadeAmount(uint8_t amount)    { _fadeAmount     = amount; }
-void TrafficAnimation::setCurrentPalette(int index)     { _currentPalette = index; }
+void TrafficAnimation::setCurrentPalette(int index)     { _currentPalette = index; compilePalette(); }
 void TrafficAnimation::setAllPalettes(const std::vector<std::vector<CRGB>>* palettes){
     _allPalettes = palettes;
+    compilePalette();
 }
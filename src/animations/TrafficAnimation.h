@@ -2,6 +2,9 @@
 #define TRAFFIC_ANIMATION_H
 
 #include "BaseAnimation.h"
+#include "../PanelLayout.h"
+#include "../AccumBuffer.h"
+#include "../PaletteLUT.h"
 #include <Arduino.h>
 #include <FastLED.h>
 #include <vector>
@@ -23,6 +26,10 @@ public:
 
     // Overridden brightness
     void setBrightness(uint8_t b) override;
+    void resize(uint16_t numLeds, int panelCount) override;
+    size_t memoryUsage() const override {
+        return sizeof(PanelLayout) + (_lut ? sizeof(PaletteLUT) : 0) + _accum.bytes() + _cars.capacity() * sizeof(TrafficCar);
+    }
 
     // Additional setters
     void setUpdateInterval(unsigned long interval);
@@ -41,9 +48,8 @@ public:
 private:
     void performTrafficEffect();
     void spawnCar();
-    CRGB calcColor(float frac, CRGB startC, CRGB endC, bool bounce);
-    int  getLedIndex(int x, int y) const;
-    void rotateCoordinates(int &x, int &y, int angle) const;
+    void relayout();
+    void compilePalette();
 
 private:
     // For dynamic panel count
@@ -54,6 +60,7 @@ private:
     // Palettes
     const std::vector<std::vector<CRGB>>* _allPalettes;
     int   _currentPalette;
+    std::shared_ptr<const PaletteLUT> _lut;
 
     // Animation state
     float      _spawnRate;
@@ -69,13 +76,19 @@ private:
     int _rotationAngle2;
     int _rotationAngle3;
 
+    // A car's colour travels from start to end along the palette gradient
     struct TrafficCar {
         int  x, y, dx, dy;
-        CRGB startColor, endColor;
+        uint8_t start, end;
         bool bounce;
         float frac;
     };
+    CRGB calcColor(const TrafficCar& car) const;
     std::vector<TrafficCar> _cars;
+    PanelLayout _layout;
+    // Trails accumulate here and are tone-mapped into the target each step;
+    // empty if it could not be allocated, then drawing goes straight to it
+    AccumBuffer _accum;
 };
 
 #endif // TRAFFIC_ANIMATION_H
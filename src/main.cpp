@@ -15,6 +15,8 @@
 #include "TelnetManager.h"
 #include "WebServerManager.h"
 #include "LogManager.h"      // System logging
+#include "WorkQueue.h"       // Worker task for flash writes and slow jobs
+#include "RequestScheduler.h" // Sheds web load when frames overrun
 
 // These are the NEW includes for menu & rotary
 #include "Menu.h"            // <-- NEW!
@@ -158,6 +160,116 @@ static int loadPanelCountConfig() {
     return panelCount;
 }
 
+// /zones.cfg holds "zoneN=<ZoneSet::format()>" lines
+static void loadZoneConfig() {
+    if (!ensureSpiffsMounted() || !SPIFFS.exists("/zones.cfg")) {
+        return;
+    }
+    File f = SPIFFS.open("/zones.cfg", "r");
+    if (!f) {
+        return;
+    }
+    while (f.available()) {
+        String line = f.readStringUntil('\n');
+        line.trim();
+        if (!line.startsWith("zone")) continue;
+        int eq = line.indexOf('=');
+        if (eq <= 4) continue;
+        int slot = line.substring(4, eq).toInt();
+        ZoneConfig config;
+        if (slot < 0 || slot >= ZoneSet::MAX_ZONES || !ZoneSet::parse(line.substring(eq + 1), config)) {
+            systemWarning("Ignoring zone config line: " + line);
+            continue;
+        }
+        ledManager.setZone((uint8_t)slot, config);
+    }
+    f.close();
+}
+
+// /calibration.cfg holds "panelN=r,g,b" gain lines, N counted along the
+// strip; panels without a line keep the default
+static void loadCalibrationConfig() {
+    if (!ensureSpiffsMounted() || !SPIFFS.exists("/calibration.cfg")) {
+        return;
+    }
+    File f = SPIFFS.open("/calibration.cfg", "r");
+    if (!f) {
+        return;
+    }
+    while (f.available()) {
+        String line = f.readStringUntil('\n');
+        line.trim();
+        if (!line.startsWith("panel")) continue;
+        int eq = line.indexOf('=');
+        if (eq <= 5) continue;
+        int panel = line.substring(5, eq).toInt();
+        PanelCalibration calibration;
+        if (panel < 0 || panel >= OutputStage::MAX_PANELS || !OutputStage::parse(line.substring(eq + 1), calibration)) {
+            systemWarning("Ignoring calibration line: " + line);
+            continue;
+        }
+        ledManager.setPanelCalibration((uint8_t)panel, calibration);
+    }
+    f.close();
+}
+
+// /power.cfg holds "budget=<mA>" and "railPanels=<n>" lines written by the
+// power parameters; without it the output stays unlimited
+static void loadPowerConfig() {
+    if (!ensureSpiffsMounted() || !SPIFFS.exists("/power.cfg")) {
+        return;
+    }
+    File f = SPIFFS.open("/power.cfg", "r");
+    if (!f) {
+        return;
+    }
+    while (f.available()) {
+        String line = f.readStringUntil('\n');
+        line.trim();
+        int eq = line.indexOf('=');
+        if (eq <= 0) continue;
+        String key = line.substring(0, eq);
+        long val = line.substring(eq + 1).toInt();
+        if (key.equalsIgnoreCase("budget") && val >= 0 && val <= 50000) {
+            ledManager.setPowerBudget((uint16_t)val);
+        } else if (key.equalsIgnoreCase("railPanels") && val >= 1 && val <= OutputStage::MAX_PANELS) {
+            ledManager.setPowerRailPanels((uint8_t)val);
+        } else {
+            systemWarning("Ignoring power config line: " + line);
+        }
+    }
+    f.close();
+    systemInfo("Power budget loaded: " + String(ledManager.getPowerBudget()) + " mA per " +
+               String(ledManager.getPowerRailPanels()) + " panels");
+}
+
+// /palettes.bin holds the user palettes (PaletteStore format); they are
+// appended after the built-in ones, before zones refer to them by index
+static void loadUserPalettes() {
+    if (!ensureSpiffsMounted() || !SPIFFS.exists(PaletteStore::PATH)) {
+        return;
+    }
+    File f = SPIFFS.open(PaletteStore::PATH, "r");
+    if (!f) {
+        return;
+    }
+    std::vector<uint8_t> data(f.size());
+    size_t length = f.read(data.data(), data.size());
+    f.close();
+
+    std::vector<PaletteDef> palettes;
+    if (!PaletteStore::decode(data.data(), length, palettes)) {
+        systemWarning("Ignoring invalid " + String(PaletteStore::PATH));
+        return;
+    }
+    for (const PaletteDef& p : palettes) {
+        if (!ledManager.setUserPalette(p.name, p.stops)) {
+            systemWarning("Ignoring user palette " + p.name);
+        }
+    }
+    systemInfo("Loaded " + String((int)palettes.size()) + " user palettes");
+}
+
 void setup() {
     Serial.begin(115200);
     delay(1000);
@@ -172,6 +284,11 @@ void setup() {
     Serial.printf("Initial free heap: %u bytes\n", ESP.getFreeHeap());
     Serial.printf("Largest free block: %u bytes\n", ESP.getMaxAllocHeap());
     
+    // Start the worker before anything can queue flash writes
+    if (!WorkQueue::getInstance().begin()) {
+        systemError("Failed to start work queue, slow jobs will be rejected");
+    }
+
     // Set CPU frequency to maximum for better performance
     setCpuFrequencyMhz(240);
     systemInfo("CPU frequency set to 240MHz");
@@ -183,6 +300,9 @@ void setup() {
     ledManager.setPanelCount(startupPanelCount);
     systemInfo("Panel count loaded at startup: " + String(startupPanelCount));
     Serial.println("Panel count loaded at startup: " + String(startupPanelCount));
+    loadCalibrationConfig();
+    loadPowerConfig();
+    loadUserPalettes();
     
     // Configure core affinity for tasks
     // Core 0: System tasks, WiFi
@@ -249,6 +369,9 @@ void setup() {
     configTime(gmtOffset_sec, daylightOffset_sec, ntpServer);
     webServerManager.begin();
     delay(100);
+
+    // Zones start once the main animation is running
+    loadZoneConfig();
     
     telnetManager.begin();
 
@@ -333,5 +456,13 @@ void loop() {
 
     // 5) Update LEDs
     ledManager.update();
-    FastLED.show();
+    ledManager.show();
+
+    // 6) Let the web server know how well the loop keeps up
+    static unsigned long lastLoopMicros = 0;
+    unsigned long nowMicros = micros();
+    if (lastLoopMicros != 0) {
+        RequestScheduler::getInstance().reportFramePeriod(nowMicros - lastLoopMicros);
+    }
+    lastLoopMicros = nowMicros;
 }
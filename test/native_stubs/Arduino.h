@@ -0,0 +1,52 @@
+// File: Arduino.h
+// Just enough of the Arduino core for the host-side unit tests
+
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+
+inline unsigned long micros() {
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+inline unsigned long millis() {
+    return micros() / 1000;
+}
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+
+    size_t print(const char* s) {
+        size_t n = 0;
+        while (*s) {
+            n += write((uint8_t)*s++);
+        }
+        return n;
+    }
+
+    size_t println(const char* s = "") {
+        return print(s) + write('\n');
+    }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        char buffer[256];
+        va_list args;
+        va_start(args, format);
+        vsnprintf(buffer, sizeof(buffer), format, args);
+        va_end(args);
+        return print(buffer);
+    }
+};
+
+#endif // ARDUINO_H
@@ -0,0 +1,81 @@
+// File: FastLED.h
+// The parts of FastLED 3.5 the pixel kernels use, with the library's
+// default FIXED scale8/blend8 rounding, for the host-side unit tests
+
+#ifndef FASTLED_H
+#define FASTLED_H
+
+#include <Arduino.h>
+
+typedef uint8_t fract8;
+
+inline uint8_t qadd8(uint8_t i, uint8_t j) {
+    const unsigned t = i + j;
+    return t > 255 ? 255 : (uint8_t)t;
+}
+
+inline uint8_t scale8(uint8_t i, fract8 scale) {
+    return (uint8_t)(((uint16_t)i * (1 + (uint16_t)scale)) >> 8);
+}
+
+inline uint8_t blend8(uint8_t a, uint8_t b, uint8_t amountOfB) {
+    uint16_t partial = (uint16_t)((a << 8) | b);
+    partial += (uint16_t)(b * amountOfB);
+    partial -= (uint16_t)(a * amountOfB);
+    return (uint8_t)(partial >> 8);
+}
+
+struct CRGB {
+    union {
+        struct {
+            uint8_t r;
+            uint8_t g;
+            uint8_t b;
+        };
+        uint8_t raw[3];
+    };
+
+    CRGB() {}
+    CRGB(uint8_t ir, uint8_t ig, uint8_t ib) : r(ir), g(ig), b(ib) {}
+
+    uint8_t& operator[](uint8_t x) { return raw[x]; }
+    const uint8_t& operator[](uint8_t x) const { return raw[x]; }
+
+    CRGB& operator+=(const CRGB& rhs) {
+        r = qadd8(r, rhs.r);
+        g = qadd8(g, rhs.g);
+        b = qadd8(b, rhs.b);
+        return *this;
+    }
+
+    CRGB& nscale8(uint8_t scale) {
+        r = scale8(r, scale);
+        g = scale8(g, scale);
+        b = scale8(b, scale);
+        return *this;
+    }
+};
+
+inline bool operator==(const CRGB& a, const CRGB& b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+inline void fill_solid(CRGB* leds, int numToFill, const CRGB& color) {
+    for (int i = 0; i < numToFill; i++) {
+        leds[i] = color;
+    }
+}
+
+inline void nscale8(CRGB* leds, uint16_t numLeds, uint8_t scale) {
+    for (uint16_t i = 0; i < numLeds; i++) {
+        leds[i].nscale8(scale);
+    }
+}
+
+inline CRGB blend(const CRGB& p1, const CRGB& p2, fract8 amountOfP2) {
+    return CRGB(blend8(p1.r, p2.r, amountOfP2),
+                blend8(p1.g, p2.g, amountOfP2),
+                blend8(p1.b, p2.b, amountOfP2));
+}
+
+#endif // FASTLED_H
@@ -0,0 +1,157 @@
+// File: test_fixedmath.cpp
+// Host-side accuracy and saturation checks for FixedMath.h: pio test -e native
+
+#include <unity.h>
+#include <math.h>
+#include "FixedMath.h"
+
+static const float TURN = 6.28318531f;
+
+void setUp() {}
+void tearDown() {}
+
+static void assertBelow(float error, float bound, const char* what) {
+    char message[96];
+    snprintf(message, sizeof(message), "%s error %g exceeds %g", what, error, bound);
+    TEST_ASSERT_TRUE_MESSAGE(error < bound, message);
+}
+
+// Every angle16 value against sinf/cosf
+static void test_sin_cos_error() {
+    float worst = 0;
+    for (uint32_t a = 0; a < 65536; a++) {
+        const float rad = a * (TURN / 65536.0f);
+        float e = fabsf(q16ToFloat(fxSin((angle16)a)) - sinf(rad));
+        if (e > worst) worst = e;
+        e = fabsf(q16ToFloat(fxCos((angle16)a)) - cosf(rad));
+        if (e > worst) worst = e;
+    }
+    assertBelow(worst, 1.0e-4f, "sin/cos");
+}
+
+static void test_sin_cos_exact_points() {
+    TEST_ASSERT_EQUAL_INT32(0, fxSin(0));
+    TEST_ASSERT_EQUAL_INT32(Q16_ONE, fxSin(ANGLE_QUARTER));
+    TEST_ASSERT_EQUAL_INT32(0, fxSin(2 * ANGLE_QUARTER));
+    TEST_ASSERT_EQUAL_INT32(-Q16_ONE, fxSin(3 * ANGLE_QUARTER));
+    TEST_ASSERT_EQUAL_INT32(Q16_ONE, fxCos(0));
+}
+
+// Degrees, over a grid in all four quadrants
+static void test_atan2_error() {
+    float worst = 0;
+    for (int y = -100; y <= 100; y++) {
+        for (int x = -100; x <= 100; x++) {
+            if (x == 0 && y == 0) continue;
+            const float expected = atan2f((float)y, (float)x) * (360.0f / TURN);
+            float got = fxAtan2(y, x) * (360.0f / 65536.0f);
+            if (got > 180.0f) got -= 360.0f;
+            float e = fabsf(got - expected);
+            if (e > 180.0f) e = 360.0f - e;
+            if (e > worst) worst = e;
+        }
+    }
+    assertBelow(worst, 0.02f, "atan2 (degrees)");
+}
+
+static void test_atan2_axes() {
+    TEST_ASSERT_EQUAL_INT32(0, fxAtan2(0, 0));
+    TEST_ASSERT_EQUAL_INT32(0, fxAtan2(0, 5));
+    TEST_ASSERT_EQUAL_INT32(ANGLE_QUARTER, fxAtan2(5, 0));
+    TEST_ASSERT_EQUAL_INT32(2 * ANGLE_QUARTER, fxAtan2(0, -5));
+    TEST_ASSERT_EQUAL_INT32(3 * ANGLE_QUARTER, fxAtan2(-5, 0));
+}
+
+// floor(sqrt(v)) exactly, including around perfect squares
+static void test_isqrt_exact() {
+    for (uint64_t r = 0; r < 70000; r += 7) {
+        const uint64_t square = r * r;
+        TEST_ASSERT_EQUAL_UINT32(r, fxIsqrt(square));
+        if (r > 0) {
+            TEST_ASSERT_EQUAL_UINT32(r - 1, fxIsqrt(square - 1));
+        }
+        TEST_ASSERT_EQUAL_UINT32(r, fxIsqrt(square + r));
+    }
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFFu, fxIsqrt(0xFFFFFFFFFFFFFFFFull));
+}
+
+static void test_sqrt_error() {
+    float worst = 0;
+    for (q16_16 x = 1; x < INT32_MAX / 3; x = x * 3 + 1) {
+        const float expected = sqrtf(q16ToFloat(x));
+        const float e = fabsf(q16ToFloat(fxSqrt(x)) - expected) / expected;
+        if (e > worst) worst = e;
+    }
+    assertBelow(worst, 1.0e-3f, "sqrt (relative)");
+    TEST_ASSERT_EQUAL_INT32(q16FromInt(12), fxSqrt(q16FromInt(144)));
+    TEST_ASSERT_EQUAL_INT32(0, fxSqrt(-Q16_ONE));
+}
+
+static void test_q16_saturation() {
+    TEST_ASSERT_EQUAL_INT32(INT32_MAX, q16Add(INT32_MAX, 1));
+    TEST_ASSERT_EQUAL_INT32(INT32_MIN, q16Add(INT32_MIN, -1));
+    TEST_ASSERT_EQUAL_INT32(INT32_MIN, q16Sub(INT32_MIN, 1));
+    TEST_ASSERT_EQUAL_INT32(INT32_MAX, q16Sub(INT32_MAX, -1));
+    TEST_ASSERT_EQUAL_INT32(INT32_MAX, q16Mul(q16FromInt(40000), q16FromInt(40000)));
+    TEST_ASSERT_EQUAL_INT32(INT32_MIN, q16Mul(q16FromInt(-40000), q16FromInt(40000)));
+    TEST_ASSERT_EQUAL_INT32(INT32_MAX, q16Div(Q16_ONE, 0));
+    TEST_ASSERT_EQUAL_INT32(INT32_MIN, q16Div(-Q16_ONE, 0));
+    TEST_ASSERT_EQUAL_INT32(INT32_MAX, q16Div(q16FromInt(30000), 1));
+    TEST_ASSERT_EQUAL_INT32(INT32_MAX, q16FromInt(40000));
+    TEST_ASSERT_EQUAL_INT32(INT32_MAX, q16(1.0e6f));
+    TEST_ASSERT_EQUAL_INT32(INT32_MIN, q16(-1.0e6f));
+    TEST_ASSERT_EQUAL_INT32(INT16_MAX, q8Mul(q8FromInt(100), q8FromInt(100)));
+    TEST_ASSERT_EQUAL_INT32(INT16_MIN, q8(-1000.0f));
+}
+
+// Negative values go through the conversions without left-shifting a sign
+static void test_negative_conversions() {
+    TEST_ASSERT_EQUAL_INT32(-3 * Q16_ONE, q16FromInt(-3));
+    TEST_ASSERT_EQUAL_INT32(INT32_MIN, q16FromInt(-40000));
+    TEST_ASSERT_EQUAL_INT32(-3 * Q8_ONE, q8FromInt(-3));
+    TEST_ASSERT_EQUAL_INT32(INT16_MIN, q8FromInt(-128));
+    TEST_ASSERT_EQUAL_INT32(INT16_MIN, q8FromInt(-100000));
+    TEST_ASSERT_EQUAL_INT32(INT16_MAX, q8FromInt(100000));
+    TEST_ASSERT_EQUAL_INT32(-Q16_ONE, q16FromQ8(-Q8_ONE));
+    TEST_ASSERT_EQUAL_INT32(-q16FromInt(3), q16Div(q16FromInt(-9), q16FromInt(3)));
+    TEST_ASSERT_EQUAL_INT32(-q8FromInt(3), q8Div(q8FromInt(-9), q8FromInt(3)));
+}
+
+static void test_q16_rounding() {
+    TEST_ASSERT_EQUAL_INT32(Q16_ONE / 2, q16(0.5f));
+    TEST_ASSERT_EQUAL_INT32(-Q16_ONE / 2, q16(-0.5f));
+    TEST_ASSERT_EQUAL_INT32(3 * Q16_ONE / 2, q16Mul(Q16_ONE / 2, 3 * Q16_ONE));
+    TEST_ASSERT_EQUAL_INT32(1, q16Mul(1, Q16_ONE / 2));     // halves round up
+    TEST_ASSERT_EQUAL_INT32(2, q16Round(3 * Q16_ONE / 2));
+    TEST_ASSERT_EQUAL_INT32(0, q16Round(-Q16_ONE / 2));
+    TEST_ASSERT_EQUAL_INT32(-1, q16Floor(-1));
+    TEST_ASSERT_EQUAL_INT32(q16FromInt(3), q16Div(q16FromInt(9), q16FromInt(3)));
+}
+
+static void test_lerp_and_easing_ends() {
+    TEST_ASSERT_EQUAL_INT32(20, fxLerp8(20, 500, 0));
+    TEST_ASSERT_EQUAL_INT32(500, fxLerp8(20, 500, 255));
+    TEST_ASSERT_EQUAL_INT32(-7, fxLerp8(-7, 9, 0));
+    TEST_ASSERT_EQUAL_INT32(q16FromInt(5), fxLerp(q16FromInt(5), q16FromInt(9), 0));
+    TEST_ASSERT_EQUAL_UINT16(0, fxSmoothstep(0));
+    TEST_ASSERT_EQUAL_UINT16(0xFFFF, fxSmoothstep(0xFFFF));
+    TEST_ASSERT_EQUAL_UINT16(0, fxEaseInOutCubic(0));
+    TEST_ASSERT_EQUAL_UINT16(0xFFFF, fxEaseInOutCubic(0xFFFF));
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_sin_cos_error);
+    RUN_TEST(test_sin_cos_exact_points);
+    RUN_TEST(test_atan2_error);
+    RUN_TEST(test_atan2_axes);
+    RUN_TEST(test_isqrt_exact);
+    RUN_TEST(test_sqrt_error);
+    RUN_TEST(test_q16_saturation);
+    RUN_TEST(test_negative_conversions);
+    RUN_TEST(test_q16_rounding);
+    RUN_TEST(test_lerp_and_easing_ends);
+    return UNITY_END();
+}
@@ -0,0 +1,275 @@
+// File: test_pixelkernels.cpp
+// Host-side checks of the span and blur kernels against per-pixel FastLED
+// math on random, misaligned buffers: pio test -e native
+
+#include <unity.h>
+#include <stdlib.h>
+#include <string.h>
+#include "PixelKernels.h"
+
+static const uint16_t LENGTHS[] = { 0, 1, 2, 3, 4, 5, 7, 8, 13, 64, 255, 1001 };
+static const int LENGTH_COUNT = sizeof(LENGTHS) / sizeof(LENGTHS[0]);
+static const uint16_t MAX_LENGTH = 1001;
+static const uint8_t AMOUNTS[] = { 0, 1, 64, 127, 128, 200, 254, 255 };
+static const int AMOUNT_COUNT = sizeof(AMOUNTS) / sizeof(AMOUNTS[0]);
+
+// Room for MAX_LENGTH pixels starting up to three bytes into the buffer
+static uint8_t bufA[MAX_LENGTH * 3 + 4];
+static uint8_t bufB[MAX_LENGTH * 3 + 4];
+static uint8_t bufFast[MAX_LENGTH * 3 + 4];
+static uint8_t bufRef[MAX_LENGTH * 3 + 4];
+
+static uint32_t rngState = 0x12345678;
+
+static uint8_t nextByte() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return (uint8_t)rngState;
+}
+
+static void fillRandom(uint8_t* buf, size_t bytes) {
+    for (size_t i = 0; i < bytes; i++) {
+        buf[i] = nextByte();
+    }
+}
+
+static CRGB* at(uint8_t* buf, int offset) {
+    return (CRGB*)(buf + offset);
+}
+
+void setUp() {
+    fillRandom(bufA, sizeof(bufA));
+    fillRandom(bufB, sizeof(bufB));
+}
+
+void tearDown() {}
+
+// The kernels must not touch bytes outside the span, so both buffers are
+// compared whole, guard bytes included
+static void assertSame(const char* what, uint16_t count, int offset, int param) {
+    char message[96];
+    snprintf(message, sizeof(message), "%s: %u pixels at offset %d, param %d",
+             what, (unsigned)count, offset, param);
+    TEST_ASSERT_EQUAL_MEMORY_MESSAGE(bufRef, bufFast, sizeof(bufFast), message);
+}
+
+static void test_span_fill() {
+    const CRGB color(nextByte(), nextByte(), nextByte());
+    for (int offset = 0; offset < 4; offset++) {
+        for (int l = 0; l < LENGTH_COUNT; l++) {
+            const uint16_t count = LENGTHS[l];
+            memcpy(bufFast, bufA, sizeof(bufA));
+            memcpy(bufRef, bufA, sizeof(bufA));
+            spanFill(at(bufFast, offset), count, color);
+            CRGB* ref = at(bufRef, offset);
+            for (uint16_t i = 0; i < count; i++) {
+                ref[i] = color;
+            }
+            assertSame("spanFill", count, offset, 0);
+        }
+    }
+}
+
+static void test_span_scale_and_fade() {
+    for (int offset = 0; offset < 4; offset++) {
+        for (int l = 0; l < LENGTH_COUNT; l++) {
+            const uint16_t count = LENGTHS[l];
+            for (int k = 0; k < AMOUNT_COUNT; k++) {
+                const uint8_t amount = AMOUNTS[k];
+                memcpy(bufFast, bufA, sizeof(bufA));
+                memcpy(bufRef, bufA, sizeof(bufA));
+                spanScale(at(bufFast, offset), count, amount);
+                uint8_t* ref = bufRef + offset;
+                for (size_t i = 0; i < count * sizeof(CRGB); i++) {
+                    ref[i] = scale8(ref[i], amount);
+                }
+                assertSame("spanScale", count, offset, amount);
+
+                memcpy(bufFast, bufA, sizeof(bufA));
+                memcpy(bufRef, bufA, sizeof(bufA));
+                spanFade(at(bufFast, offset), count, amount);
+                for (size_t i = 0; i < count * sizeof(CRGB); i++) {
+                    ref[i] = scale8(ref[i], 255 - amount);
+                }
+                assertSame("spanFade", count, offset, amount);
+            }
+        }
+    }
+}
+
+// dst and src at every pair of offsets, so src is often misaligned with dst
+static void test_span_add() {
+    for (int dstOffset = 0; dstOffset < 4; dstOffset++) {
+        for (int srcOffset = 0; srcOffset < 4; srcOffset++) {
+            for (int l = 0; l < LENGTH_COUNT; l++) {
+                const uint16_t count = LENGTHS[l];
+                memcpy(bufFast, bufA, sizeof(bufA));
+                memcpy(bufRef, bufA, sizeof(bufA));
+                spanAdd(at(bufFast, dstOffset), at(bufB, srcOffset), count);
+                uint8_t* ref = bufRef + dstOffset;
+                const uint8_t* src = bufB + srcOffset;
+                for (size_t i = 0; i < count * sizeof(CRGB); i++) {
+                    ref[i] = qadd8(ref[i], src[i]);
+                }
+                assertSame("spanAdd", count, dstOffset * 4 + srcOffset, 0);
+            }
+        }
+    }
+}
+
+static void test_span_add_saturates() {
+    CRGB dst[5];
+    CRGB src[5];
+    for (int i = 0; i < 5; i++) {
+        dst[i] = CRGB(200, 128, 0);
+        src[i] = CRGB(100, 127, 255);
+    }
+    spanAdd(dst, src, 5);
+    for (int i = 0; i < 5; i++) {
+        TEST_ASSERT_EQUAL_UINT8(255, dst[i].r);
+        TEST_ASSERT_EQUAL_UINT8(255, dst[i].g);
+        TEST_ASSERT_EQUAL_UINT8(255, dst[i].b);
+    }
+}
+
+static void test_span_blend() {
+    const int offsets[][3] = { { 0, 0, 0 }, { 1, 0, 0 }, { 0, 3, 1 }, { 2, 1, 3 }, { 3, 2, 2 } };
+    for (int o = 0; o < 5; o++) {
+        const int outOffset = offsets[o][0];
+        for (int l = 0; l < LENGTH_COUNT; l++) {
+            const uint16_t count = LENGTHS[l];
+            for (int k = 0; k < AMOUNT_COUNT; k++) {
+                const uint8_t amount = AMOUNTS[k];
+                const CRGB* a = at(bufA, offsets[o][1]);
+                const CRGB* b = at(bufB, offsets[o][2]);
+                memset(bufFast, 0x5A, sizeof(bufFast));
+                memset(bufRef, 0x5A, sizeof(bufRef));
+                spanBlend(at(bufFast, outOffset), a, b, count, amount);
+                CRGB* ref = at(bufRef, outOffset);
+                for (uint16_t i = 0; i < count; i++) {
+                    ref[i] = blend(a[i], b[i], amount);
+                }
+                assertSame("spanBlend", count, o, amount);
+            }
+        }
+    }
+}
+
+// out == a, as the compositors call it
+static void test_span_blend_in_place() {
+    for (int offset = 0; offset < 4; offset++) {
+        for (int l = 0; l < LENGTH_COUNT; l++) {
+            const uint16_t count = LENGTHS[l];
+            memcpy(bufFast, bufA, sizeof(bufA));
+            memcpy(bufRef, bufA, sizeof(bufA));
+            CRGB* fast = at(bufFast, offset);
+            CRGB* ref = at(bufRef, offset);
+            const CRGB* b = at(bufB, 3 - offset);
+            spanBlend(fast, fast, b, count, 77);
+            for (uint16_t i = 0; i < count; i++) {
+                ref[i] = blend(ref[i], b[i], 77);
+            }
+            assertSame("spanBlend in place", count, offset, 77);
+        }
+    }
+}
+
+// Horizontal pass then vertical, edge pixels repeated, rounded division
+static void referenceBlur(CRGB* pixels, const PanelLayout& layout, bool gaussian) {
+    const int w = layout.width();
+    const int h = layout.height();
+    static uint8_t line[PanelLayout::MAX_PIXELS];
+    for (int c = 0; c < 3; c++) {
+        for (int y = 0; y < h; y++) {
+            for (int x = 0; x < w; x++) {
+                line[x] = pixels[layout.index(x, y)][c];
+            }
+            for (int x = 0; x < w; x++) {
+                const int prev = line[x > 0 ? x - 1 : x];
+                const int next = line[x + 1 < w ? x + 1 : x];
+                const int cur = line[x];
+                pixels[layout.index(x, y)][c] = gaussian ? (uint8_t)((prev + 2 * cur + next + 2) / 4)
+                                                         : (uint8_t)((prev + cur + next + 1) / 3);
+            }
+        }
+        for (int x = 0; x < w; x++) {
+            for (int y = 0; y < h; y++) {
+                line[y] = pixels[layout.index(x, y)][c];
+            }
+            for (int y = 0; y < h; y++) {
+                const int prev = line[y > 0 ? y - 1 : y];
+                const int next = line[y + 1 < h ? y + 1 : y];
+                const int cur = line[y];
+                pixels[layout.index(x, y)][c] = gaussian ? (uint8_t)((prev + 2 * cur + next + 2) / 4)
+                                                         : (uint8_t)((prev + cur + next + 1) / 3);
+            }
+        }
+    }
+}
+
+static void checkBlur(bool gaussian) {
+    static PanelLayout layout;
+    static CRGB fast[PanelLayout::MAX_PIXELS];
+    static CRGB ref[PanelLayout::MAX_PIXELS];
+    const int rotations[][3] = { { 0, 0, 0 }, { 90, 180, 270 } };
+    for (int panels = 1; panels <= 3; panels++) {
+        for (int order = 0; order < 2; order++) {
+            layout.configure(panels, order, rotations[order]);
+            const int count = layout.pixelCount();
+            fillRandom((uint8_t*)fast, count * sizeof(CRGB));
+            memcpy(ref, fast, count * sizeof(CRGB));
+            if (gaussian) {
+                blurGaussian3(fast, layout);
+            } else {
+                blurBox3(fast, layout);
+            }
+            referenceBlur(ref, layout, gaussian);
+            char message[64];
+            snprintf(message, sizeof(message), "%s: %d panels, order %d",
+                     gaussian ? "blurGaussian3" : "blurBox3", panels, order);
+            TEST_ASSERT_EQUAL_MEMORY_MESSAGE(ref, fast, count * sizeof(CRGB), message);
+        }
+    }
+}
+
+static void test_blur_box() {
+    checkBlur(false);
+}
+
+static void test_blur_gaussian() {
+    checkBlur(true);
+}
+
+// An evenly lit canvas stays exactly as it was
+static void test_blur_keeps_flat_canvas() {
+    static PanelLayout layout;
+    static CRGB pixels[PanelLayout::MAX_PIXELS];
+    const int unrotated[3] = { 0, 0, 0 };
+    layout.configure(2, 0, unrotated);
+    const int count = layout.pixelCount();
+    for (int i = 0; i < count; i++) {
+        pixels[i] = CRGB(255, 128, 1);
+    }
+    blurBox3(pixels, layout);
+    blurGaussian3(pixels, layout);
+    for (int i = 0; i < count; i++) {
+        TEST_ASSERT_TRUE(pixels[i] == CRGB(255, 128, 1));
+    }
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_span_fill);
+    RUN_TEST(test_span_scale_and_fade);
+    RUN_TEST(test_span_add);
+    RUN_TEST(test_span_add_saturates);
+    RUN_TEST(test_span_blend);
+    RUN_TEST(test_span_blend_in_place);
+    RUN_TEST(test_blur_box);
+    RUN_TEST(test_blur_gaussian);
+    RUN_TEST(test_blur_keeps_flat_canvas);
+    return UNITY_END();
+}